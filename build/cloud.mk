@@ -4,10 +4,14 @@ CLOUD_SERVER_SOURCES = \
 	$(SRC)/Cloud/Serialiser.cpp \
 	$(SRC)/Cloud/Client.cpp \
 	$(SRC)/Cloud/Thermal.cpp \
+	$(SRC)/Cloud/Index.cpp \
 	$(SRC)/Cloud/Data.cpp \
+	$(SRC)/Cloud/JournalRecord.cpp \
+	$(SRC)/Cloud/Journal.cpp \
 	$(SRC)/Cloud/Sender.cpp \
+	$(SRC)/Cloud/EventLog.cpp \
 	$(SRC)/Cloud/Main.cpp
-CLOUD_SERVER_DEPENDS = ASYNC LIBNET IO OS GEO MATH UTIL
+CLOUD_SERVER_DEPENDS = ASYNC LIBNET THREAD IO OS GEO MATH UTIL
 $(eval $(call link-program,xcsoar-cloud-server,CLOUD_SERVER))
 
 CLOUD_TO_KML_SOURCES = \
@@ -15,7 +19,9 @@ CLOUD_TO_KML_SOURCES = \
 	$(SRC)/Cloud/Serialiser.cpp \
 	$(SRC)/Cloud/Client.cpp \
 	$(SRC)/Cloud/Thermal.cpp \
+	$(SRC)/Cloud/Index.cpp \
 	$(SRC)/Cloud/Data.cpp \
+	$(SRC)/Cloud/JournalRecord.cpp \
 	$(SRC)/Cloud/ToKML.cpp
 CLOUD_TO_KML_DEPENDS = ASYNC LIBNET IO OS GEO MATH UTIL
 $(eval $(call link-program,xcsoar-cloud-to-kml,CLOUD_TO_KML))
@@ -42,7 +42,7 @@ FUZZ_TOPOGRAPHY_FILE_SOURCES = \
 	$(SRC)/Projection/Projection.cpp \
 	$(SRC)/Projection/WindowProjection.cpp \
 	$(FUZZER_SRC_DIR)/FuzzTopographyFile.cpp
-FUZZ_TOPOGRAPHY_FILE_DEPENDS = SCREEN TOPO ZZIP GEO MATH IO UTIL
+FUZZ_TOPOGRAPHY_FILE_DEPENDS = SCREEN TOPO ZZIP GEO MATH OS IO UTIL
 $(eval $(call link-program,FuzzTopographyFile,FUZZ_TOPOGRAPHY_FILE))
 
 FUZZ_TOPOGRAPHY_INDEX_SOURCES = \
@@ -15,6 +15,7 @@ HOT_SOURCES = \
 	$(SRC)/Terrain/RasterTile.cpp \
 	$(SRC)/Terrain/ScanLine.cpp \
 	$(SRC)/Terrain/Intersection.cpp \
+	$(SRC)/Terrain/MaxHeightPyramid.cpp \
 	$(SRC)/Projection/Projection.cpp \
 	$(SRC)/ui/canvas/memory/Canvas.cpp \
 	$(ENGINE_SRC_DIR)/Waypoints/Waypoints.cpp \
@@ -30,6 +31,7 @@ HOT_SOURCES = \
 	$(ENGINE_SRC_DIR)/Route/RoutePolars.cpp \
 	$(ENGINE_SRC_DIR)/Contest/Solvers/ContestDijkstra.cpp \
 	$(ENGINE_SRC_DIR)/Contest/Solvers/TraceManager.cpp \
+	$(ENGINE_SRC_DIR)/Contest/Solvers/TraceDistanceMatrix.cpp \
 	$(ENGINE_SRC_DIR)/Contest/Solvers/TriangleContest.cpp
 
 $(call SRC_TO_OBJ,$(HOT_SOURCES)): OPTIMIZE += -O3
@@ -39,6 +39,8 @@ LIBCOMPUTER_SOURCES = \
 	$(SRC)/Computer/StatsComputer.cpp \
 	$(SRC)/Computer/RouteComputer.cpp \
 	$(SRC)/Computer/TaskComputer.cpp \
+	$(SRC)/Computer/WaypointArrival.cpp \
+	$(SRC)/Computer/WaypointArrivalCache.cpp \
 	$(SRC)/Computer/GlideComputerInterface.cpp \
 	$(SRC)/Computer/Events.cpp \
 	$(SRC)/Computer/BasicComputer.cpp \
@@ -1,10 +1,12 @@
 TERRAIN_SOURCES = \
 	$(SRC)/Terrain/AsyncLoader.cpp \
 	$(SRC)/Terrain/RasterBuffer.cpp \
+	$(SRC)/Terrain/InterpolationBatch.cpp \
 	$(SRC)/Terrain/RasterProjection.cpp \
 	$(SRC)/Terrain/RasterMap.cpp \
 	$(SRC)/Terrain/RasterTile.cpp \
 	$(SRC)/Terrain/RasterTileCache.cpp \
+	$(SRC)/Terrain/MaxHeightPyramid.cpp \
 	$(SRC)/Terrain/ZzipStream.cpp \
 	$(SRC)/Terrain/Loader.cpp \
 	$(SRC)/Terrain/WorldFile.cpp \
@@ -1,6 +1,8 @@
 TOPO_SOURCES = \
 	$(SRC)/Topography/ShapeFile.cpp \
 	$(SRC)/Topography/TopographyFile.cpp \
+	$(SRC)/Topography/TiledTopography.cpp \
+	$(SRC)/Topography/TiledTopographyWriter.cpp \
 	$(SRC)/Topography/TopographyStore.cpp \
 	$(SRC)/Topography/TopographyFileRenderer.cpp \
 	$(SRC)/Topography/TopographyRenderer.cpp \
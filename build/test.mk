@@ -93,6 +93,9 @@ TEST_NAMES = \
 	test_pressure \
 	test_task \
 	TestOverwritingRingBuffer \
+	TestTripleBuffer \
+	TestMPSCQueue \
+	TestAStar \
 	TestDateTime TestRoughTime TestWrapClock \
 	TestMath \
 	TestMathTables \
@@ -100,13 +103,17 @@ TEST_NAMES = \
 	TestGrahamScan \
 	TestUnits TestEarth TestSunEphemeris \
 	TestValidity TestUTM \
+	TestNMEAMerge \
 	TestAllocatedGrid \
+	TestRasterBuffer TestMaxHeightPyramid TestRasterTileCache \
+	TestTerrainTileStore \
+	TestWaypointArrivalCache \
 	TestRadixTree TestGeoBounds TestGeoClip \
 	TestLogger TestGRecord TestClimbAvCalc \
 	TestWaypointReader TestThermalBase \
 	TestFlarmNet \
 	TestColorRamp TestGeoPoint TestDiffFilter \
-	TestFileUtil TestPolars TestCSVLine TestGlidePolar \
+	TestFileUtil TestPolars TestCSVLine TestNMEASentenceTable TestGlidePolar \
 	test_replay_task TestProjection TestFlatPoint TestFlatLine TestFlatGeoPoint \
 	TestMacCready TestOrderedTask TestAATPoint \
 	TestPlanes \
@@ -117,6 +124,8 @@ TEST_NAMES = \
 	TestAirspaceParser \
 	TestMETARParser \
 	TestIGCParser \
+	TestBinaryFlight \
+	TestTiledTopography \
 	TestStrings TestUTF8 \
 	TestCRC \
 	TestUnitsFormatter \
@@ -137,6 +146,12 @@ TEST_NAMES += \
 	TestDriver
 endif
 
+ifeq ($(TARGET),UNIX)
+# the cloud server is built only on UNIX, see cloud.mk
+TEST_NAMES += \
+	TestCloudJournal
+endif
+
 TESTS = $(call name-to-bin,$(TEST_NAMES))
 
 TEST_HEX_STRING_SOURCES = \
@@ -172,6 +187,24 @@ TEST_OVERWRITING_RING_BUFFER_SOURCES = \
 TEST_OVERWRITING_RING_BUFFER_DEPENDS = MATH
 $(eval $(call link-program,TestOverwritingRingBuffer,TEST_OVERWRITING_RING_BUFFER))
 
+TEST_TRIPLE_BUFFER_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTripleBuffer.cpp
+TEST_TRIPLE_BUFFER_DEPENDS = THREAD
+$(eval $(call link-program,TestTripleBuffer,TEST_TRIPLE_BUFFER))
+
+TEST_MPSC_QUEUE_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestMPSCQueue.cpp
+TEST_MPSC_QUEUE_DEPENDS = THREAD
+$(eval $(call link-program,TestMPSCQueue,TEST_MPSC_QUEUE))
+
+TEST_ASTAR_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestAStar.cpp
+TEST_ASTAR_DEPENDS = MATH
+$(eval $(call link-program,TestAStar,TEST_ASTAR))
+
 TEST_IGC_PARSER_SOURCES = \
 	$(SRC)/IGC/IGCParser.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -179,6 +212,28 @@ TEST_IGC_PARSER_SOURCES = \
 TEST_IGC_PARSER_DEPENDS = MATH UTIL
 $(eval $(call link-program,TestIGCParser,TEST_IGC_PARSER))
 
+TEST_BINARY_FLIGHT_SOURCES = \
+	$(SRC)/IGC/IGCParser.cpp \
+	$(TEST_SRC_DIR)/BinaryFlight.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestBinaryFlight.cpp
+TEST_BINARY_FLIGHT_DEPENDS = IO OS GEO MATH TIME UTIL
+$(eval $(call link-program,TestBinaryFlight,TEST_BINARY_FLIGHT))
+
+TEST_TILED_TOPOGRAPHY_SOURCES = \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(SRC)/system/Path.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTiledTopography.cpp
+ifeq ($(OPENGL),y)
+TEST_TILED_TOPOGRAPHY_SOURCES += \
+	$(CANVAS_SRC_DIR)/opengl/Triangulate.cpp
+endif
+TEST_TILED_TOPOGRAPHY_DEPENDS = TOPO GEO MATH THREAD OS IO SYSTEM UTIL ZZIP
+TEST_TILED_TOPOGRAPHY_CPPFLAGS = $(SCREEN_CPPFLAGS)
+$(eval $(call link-program,TestTiledTopography,TEST_TILED_TOPOGRAPHY))
+
 TEST_METAR_PARSER_SOURCES = \
 	$(SRC)/Weather/METARParser.cpp \
 	$(SRC)/Units/Descriptor.cpp \
@@ -191,6 +246,7 @@ $(eval $(call link-program,TestMETARParser,TEST_METAR_PARSER))
 
 TEST_AIRSPACE_PARSER_SOURCES = \
 	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Units/Descriptor.cpp \
 	$(SRC)/Units/System.cpp \
 	$(SRC)/Atmosphere/Pressure.cpp \
@@ -307,7 +363,7 @@ TEST_REACH_SOURCES = \
 	$(TEST_SRC_DIR)/Printing.cpp \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/test_reach.cpp
-TEST_REACH_DEPENDS = TERRAIN OPERATION IO ZZIP OS ROUTE GLIDE GEO MATH UTIL
+TEST_REACH_DEPENDS = TERRAIN OPERATION IO ZZIP OS ROUTE GLIDE GEO MATH THREAD UTIL
 $(eval $(call link-program,test_reach,TEST_REACH))
 
 TEST_ROUTE_SOURCES = \
@@ -394,6 +450,14 @@ TEST_CSV_LINE_SOURCES = \
 TEST_CSV_LINE_DEPENDS = MATH
 $(eval $(call link-program,TestCSVLine,TEST_CSV_LINE))
 
+TEST_NMEA_SENTENCE_TABLE_SOURCES = \
+	$(SRC)/NMEA/Checksum.cpp \
+	$(SRC)/NMEA/InputLine.cpp \
+	$(SRC)/io/CSVLine.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestNMEASentenceTable.cpp
+$(eval $(call link-program,TestNMEASentenceTable,TEST_NMEA_SENTENCE_TABLE))
+
 TEST_GEO_BOUNDS_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestGeoBounds.cpp
@@ -604,12 +668,74 @@ TEST_VALIDITY_SOURCES = \
 	$(TEST_SRC_DIR)/TestValidity.cpp
 $(eval $(call link-program,TestValidity,TEST_VALIDITY))
 
+TEST_NMEA_MERGE_SOURCES = \
+	$(SRC)/Atmosphere/AirDensity.cpp \
+	$(SRC)/FLARM/FlarmId.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestNMEAMerge.cpp
+TEST_NMEA_MERGE_DEPENDS = LIBNMEA GEO MATH UTIL TIME
+$(eval $(call link-program,TestNMEAMerge,TEST_NMEA_MERGE))
+
 TEST_ALLOCATED_GRID_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestAllocatedGrid.cpp
 TEST_ALLOCATED_GRID_DEPENDS = UTIL
 $(eval $(call link-program,TestAllocatedGrid,TEST_ALLOCATED_GRID))
 
+TEST_RASTER_BUFFER_SOURCES = \
+	$(SRC)/Terrain/RasterBuffer.cpp \
+	$(SRC)/Terrain/InterpolationBatch.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestRasterBuffer.cpp
+TEST_RASTER_BUFFER_DEPENDS = UTIL
+$(eval $(call link-program,TestRasterBuffer,TEST_RASTER_BUFFER))
+
+TEST_MAX_HEIGHT_PYRAMID_SOURCES = \
+	$(SRC)/Terrain/RasterBuffer.cpp \
+	$(SRC)/Terrain/InterpolationBatch.cpp \
+	$(SRC)/Terrain/MaxHeightPyramid.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestMaxHeightPyramid.cpp
+TEST_MAX_HEIGHT_PYRAMID_DEPENDS = UTIL
+$(eval $(call link-program,TestMaxHeightPyramid,TEST_MAX_HEIGHT_PYRAMID))
+
+TEST_RASTER_TILE_CACHE_SOURCES = \
+	$(SRC)/Terrain/RasterBuffer.cpp \
+	$(SRC)/Terrain/InterpolationBatch.cpp \
+	$(SRC)/Terrain/MaxHeightPyramid.cpp \
+	$(SRC)/Terrain/RasterTile.cpp \
+	$(SRC)/Terrain/RasterTileCache.cpp \
+	$(SRC)/Terrain/Intersection.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestRasterTileCache.cpp
+TEST_RASTER_TILE_CACHE_DEPENDS = JASPER IO GEO MATH UTIL
+$(eval $(call link-program,TestRasterTileCache,TEST_RASTER_TILE_CACHE))
+
+TEST_TERRAIN_TILE_STORE_SOURCES = \
+	$(SRC)/system/Path.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTerrainTileStore.cpp
+TEST_TERRAIN_TILE_STORE_DEPENDS = TERRAIN OPERATION GEO MATH OS IO ZZIP THREAD UTIL
+$(eval $(call link-program,TestTerrainTileStore,TEST_TERRAIN_TILE_STORE))
+
+TEST_WAYPOINT_ARRIVAL_CACHE_SOURCES = \
+	$(SRC)/Computer/WaypointArrival.cpp \
+	$(SRC)/Computer/WaypointArrivalCache.cpp \
+	$(SRC)/Task/ProtectedRoutePlanner.cpp \
+	$(SRC)/Task/RoutePlannerGlue.cpp \
+	$(SRC)/Airspace/ActivePredicate.cpp \
+	$(SRC)/Engine/Navigation/TraceHistory.cpp \
+	$(SRC)/Engine/Navigation/Aircraft.cpp \
+	$(SRC)/Engine/ThermalBand/ThermalBand.cpp \
+	$(SRC)/Engine/ThermalBand/ThermalSlice.cpp \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(SRC)/Atmosphere/AirDensity.cpp \
+	$(TEST_SRC_DIR)/TestWaypointArrivalCache.cpp
+TEST_WAYPOINT_ARRIVAL_CACHE_DEPENDS = \
+	HARNESS LIBNMEA TASK ROUTE TERRAIN GLIDE CONTEST WAYPOINT AIRSPACE \
+	OPERATION JASPER ZZIP IO OS THREAD GEO MATH TIME UTIL
+$(eval $(call link-program,TestWaypointArrivalCache,TEST_WAYPOINT_ARRIVAL_CACHE))
+
 TEST_RADIX_TREE_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestRadixTree.cpp
@@ -725,6 +851,8 @@ DEBUG_PROGRAM_NAMES = \
 	FlightTable \
 	BenchmarkProjection \
 	BenchmarkFAITriangleSector \
+	BenchmarkAirspaces \
+	BenchmarkNMEA \
 	DumpTextFile DumpTextZip DumpTextInflate \
 	DumpHexColor \
 	RunXMLParser \
@@ -732,8 +860,8 @@ DEBUG_PROGRAM_NAMES = \
 	RunMD5 RunSHA256 \
 	ReadGRecord VerifyGRecord AppendGRecord FixGRecord \
 	AddChecksum \
-	LoadTopography LoadTerrain \
-	RunHeightMatrix \
+	LoadTopography ConvertTopography LoadTerrain \
+	RunHeightMatrix BenchmarkHeightMatrix \
 	RunInputParser \
 	RunWaypointParser RunAirspaceParser \
 	RunFlightParser \
@@ -789,13 +917,15 @@ DEBUG_PROGRAM_NAMES += \
 	RunVegaSettings \
 	RunFlarmUtils \
 	RunLX1600Utils \
-	IGC2NMEA
+	IGC2NMEA \
+	IGC2BinaryFlight
 endif
 
 ifeq ($(TARGET),UNIX)
 DEBUG_PROGRAM_NAMES += \
 	AnalyseFlight \
-	FeedFlyNetData
+	FeedFlyNetData \
+	RunCloudLoad
 endif
 
 ifeq ($(TARGET),PC)
@@ -875,6 +1005,8 @@ DEBUG_REPLAY_SOURCES = \
 	$(TEST_SRC_DIR)/FakeGeoid.cpp \
 	$(TEST_SRC_DIR)/DebugReplayIGC.cpp \
 	$(TEST_SRC_DIR)/DebugReplayNMEA.cpp \
+	$(TEST_SRC_DIR)/BinaryFlight.cpp \
+	$(TEST_SRC_DIR)/DebugReplayBinary.cpp \
 	$(TEST_SRC_DIR)/DebugReplay.cpp
 DEBUG_REPLAY_LDADD = \
 	$(DRIVER_LDADD) \
@@ -901,6 +1033,13 @@ BENCHMARK_FAI_TRIANGLE_SECTOR_SOURCES = \
 BENCHMARK_FAI_TRIANGLE_SECTOR_DEPENDS = GEO MATH
 $(eval $(call link-program,BenchmarkFAITriangleSector,BENCHMARK_FAI_TRIANGLE_SECTOR))
 
+BENCHMARK_AIRSPACES_SOURCES = \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkAirspaces.cpp
+BENCHMARK_AIRSPACES_DEPENDS = AIRSPACE GEO MATH UTIL
+$(eval $(call link-program,BenchmarkAirspaces,BENCHMARK_AIRSPACES))
+
 DUMP_TEXT_FILE_SOURCES = \
 	$(TEST_SRC_DIR)/DumpTextFile.cpp
 DUMP_TEXT_FILE_DEPENDS = IO OS ZZIP UTIL
@@ -1030,6 +1169,27 @@ RUN_SL_TRACKING_LDADD = $(DEBUG_REPLAY_LDADD)
 RUN_SL_TRACKING_DEPENDS = ASYNC GEO MATH UTIL
 $(eval $(call link-program,RunSkyLinesTracking,RUN_SL_TRACKING))
 
+RUN_CLOUD_LOAD_SOURCES = \
+	$(SRC)/net/SocketError.cxx \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(TEST_SRC_DIR)/RunCloudLoad.cpp
+RUN_CLOUD_LOAD_DEPENDS = ASYNC LIBNET OS GEO MATH UTIL
+$(eval $(call link-program,RunCloudLoad,RUN_CLOUD_LOAD))
+
+TEST_CLOUD_JOURNAL_SOURCES = \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(SRC)/Cloud/Serialiser.cpp \
+	$(SRC)/Cloud/Client.cpp \
+	$(SRC)/Cloud/Thermal.cpp \
+	$(SRC)/Cloud/Index.cpp \
+	$(SRC)/Cloud/Data.cpp \
+	$(SRC)/Cloud/JournalRecord.cpp \
+	$(SRC)/Cloud/Journal.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestCloudJournal.cpp
+TEST_CLOUD_JOURNAL_DEPENDS = LIBNET THREAD IO OS GEO MATH UTIL
+$(eval $(call link-program,TestCloudJournal,TEST_CLOUD_JOURNAL))
+
 RUN_LIVETRACK24_SOURCES = \
 	$(DEBUG_REPLAY_SOURCES) \
 	$(SRC)/net/SocketError.cxx \
@@ -1149,10 +1309,24 @@ ifeq ($(OPENGL),y)
 LOAD_TOPOGRAPHY_SOURCES += \
 	$(CANVAS_SRC_DIR)/opengl/Triangulate.cpp
 endif
-LOAD_TOPOGRAPHY_DEPENDS = OPERATION TOPO RESOURCE GEO MATH THREAD IO SYSTEM UTIL ZZIP
+LOAD_TOPOGRAPHY_DEPENDS = OPERATION TOPO RESOURCE GEO MATH THREAD OS IO SYSTEM UTIL ZZIP
 LOAD_TOPOGRAPHY_CPPFLAGS = $(SCREEN_CPPFLAGS)
 $(eval $(call link-program,LoadTopography,LOAD_TOPOGRAPHY))
 
+CONVERT_TOPOGRAPHY_SOURCES = \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(SRC)/system/Path.cpp \
+	$(TEST_SRC_DIR)/FakeLogFile.cpp \
+	$(TEST_SRC_DIR)/ConvertTopography.cpp
+ifeq ($(OPENGL),y)
+CONVERT_TOPOGRAPHY_SOURCES += \
+	$(CANVAS_SRC_DIR)/opengl/Triangulate.cpp
+endif
+CONVERT_TOPOGRAPHY_DEPENDS = TOPO RESOURCE GEO MATH THREAD OS IO SYSTEM UTIL ZZIP
+CONVERT_TOPOGRAPHY_CPPFLAGS = $(SCREEN_CPPFLAGS)
+$(eval $(call link-program,ConvertTopography,CONVERT_TOPOGRAPHY))
+
 LOAD_TERRAIN_SOURCES = \
 	$(SRC)/Operation/ConsoleOperationEnvironment.cpp \
 	$(TEST_SRC_DIR)/LoadTerrain.cpp
@@ -1166,9 +1340,18 @@ RUN_HEIGHT_MATRIX_SOURCES = \
 	$(SRC)/Operation/ConsoleOperationEnvironment.cpp \
 	$(TEST_SRC_DIR)/RunHeightMatrix.cpp
 RUN_HEIGHT_MATRIX_CPPFLAGS = $(SCREEN_CPPFLAGS)
-RUN_HEIGHT_MATRIX_DEPENDS = TERRAIN OPERATION GEO MATH IO OS ZZIP UTIL
+RUN_HEIGHT_MATRIX_DEPENDS = TERRAIN OPERATION GEO MATH IO OS ZZIP THREAD UTIL
 $(eval $(call link-program,RunHeightMatrix,RUN_HEIGHT_MATRIX))
 
+BENCHMARK_HEIGHT_MATRIX_SOURCES = \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(SRC)/Operation/ConsoleOperationEnvironment.cpp \
+	$(TEST_SRC_DIR)/BenchmarkHeightMatrix.cpp
+BENCHMARK_HEIGHT_MATRIX_CPPFLAGS = $(SCREEN_CPPFLAGS)
+BENCHMARK_HEIGHT_MATRIX_DEPENDS = TERRAIN OPERATION GEO MATH IO OS ZZIP THREAD UTIL
+$(eval $(call link-program,BenchmarkHeightMatrix,BENCHMARK_HEIGHT_MATRIX))
+
 RUN_INPUT_PARSER_SOURCES = \
 	$(SRC)/Input/InputKeys.cpp \
 	$(SRC)/Input/InputConfig.cpp \
@@ -1309,6 +1492,12 @@ RUN_DEVICE_DRIVER_SOURCES = \
 RUN_DEVICE_DRIVER_DEPENDS = DRIVER OPERATION IO LIBNMEA OS THREAD GEO MATH UTIL TIME
 $(eval $(call link-program,RunDeviceDriver,RUN_DEVICE_DRIVER))
 
+BENCHMARK_NMEA_SOURCES = \
+	$(filter-out %/RunDeviceDriver.cpp,$(RUN_DEVICE_DRIVER_SOURCES)) \
+	$(TEST_SRC_DIR)/BenchmarkNMEA.cpp
+BENCHMARK_NMEA_DEPENDS = $(RUN_DEVICE_DRIVER_DEPENDS)
+$(eval $(call link-program,BenchmarkNMEA,BENCHMARK_NMEA))
+
 RUN_DECLARE_SOURCES = \
 	$(SRC)/Device/Port/ConfiguredPort.cpp \
 	$(SRC)/Units/Descriptor.cpp \
@@ -1604,7 +1793,7 @@ RUN_CONTEST_SOURCES = \
 	$(TEST_SRC_DIR)/ContestPrinting.cpp \
 	$(TEST_SRC_DIR)/RunContestAnalysis.cpp
 RUN_CONTEST_LDADD = $(DEBUG_REPLAY_LDADD)
-RUN_CONTEST_DEPENDS = CONTEST UTIL GEO MATH TIME
+RUN_CONTEST_DEPENDS = CONTEST THREAD UTIL GEO MATH TIME
 $(eval $(call link-program,RunContestAnalysis,RUN_CONTEST))
 
 RUN_WAVE_COMPUTER_SOURCES = \
@@ -1759,6 +1948,8 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/TeamCode/Settings.cpp \
 	$(SRC)/Logger/Settings.cpp \
 	$(SRC)/Computer/TraceComputer.cpp \
+	$(SRC)/Computer/WaypointArrival.cpp \
+	$(SRC)/Computer/WaypointArrivalCache.cpp \
 	$(SRC)/IGC/IGCParser.cpp \
 	$(SRC)/Task/ProtectedRoutePlanner.cpp \
 	$(SRC)/Task/RoutePlannerGlue.cpp \
@@ -2215,6 +2406,7 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Airspace/ActivePredicate.cpp \
 	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Airspace/AirspaceGlue.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
 	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
@@ -2506,6 +2698,14 @@ IGC2NMEA_LDADD = $(DEBUG_REPLAY_LDADD)
 
 $(eval $(call link-program,IGC2NMEA,IGC2NMEA))
 
+IGC2BINARY_FLIGHT_SOURCES = \
+	$(SRC)/IGC/IGCParser.cpp \
+	$(TEST_SRC_DIR)/BinaryFlight.cpp \
+	$(TEST_SRC_DIR)/IGC2BinaryFlight.cpp
+IGC2BINARY_FLIGHT_DEPENDS = IO OS GEO MATH TIME UTIL
+
+$(eval $(call link-program,IGC2BinaryFlight,IGC2BINARY_FLIGHT))
+
 debug: $(DEBUG_PROGRAMS)
 
 TEST_REPLAY_RETROSPECTIVE_SOURCES = \
@@ -0,0 +1,17 @@
+#include <stddef.h>
+#include <stdint.h>
+asm(
+".p2align 3\n"
+".data\n"
+"AUTHORS_gz:\n"
+"_AUTHORS_gz:\n"
+".globl AUTHORS_gz\n"
+".globl _AUTHORS_gz\n"
+".incbin \"output/data/AUTHORS.gz\"\n"
+);
+extern const uint8_t AUTHORS_gz[];
+const uint8_t * const AUTHORS_gz_end
+    = AUTHORS_gz + 3715;
+const size_t AUTHORS_gz_size
+    = 3715;
+
@@ -0,0 +1,17 @@
+#include <stddef.h>
+#include <stdint.h>
+asm(
+".p2align 3\n"
+".data\n"
+"NEWS_txt_gz:\n"
+"_NEWS_txt_gz:\n"
+".globl NEWS_txt_gz\n"
+".globl _NEWS_txt_gz\n"
+".incbin \"output/data/NEWS.txt.gz\"\n"
+);
+extern const uint8_t NEWS_txt_gz[];
+const uint8_t * const NEWS_txt_gz_end
+    = NEWS_txt_gz + 47454;
+const size_t NEWS_txt_gz_size
+    = 47454;
+
@@ -0,0 +1,17 @@
+#include <stddef.h>
+#include <stdint.h>
+asm(
+".p2align 3\n"
+".data\n"
+"egm96s_dem:\n"
+"_egm96s_dem:\n"
+".globl egm96s_dem\n"
+".globl _egm96s_dem\n"
+".incbin \"Data/other/egm96s.dem\"\n"
+);
+extern const uint8_t egm96s_dem[];
+const uint8_t * const egm96s_dem_end
+    = egm96s_dem + 16200;
+const size_t egm96s_dem_size
+    = 16200;
+
@@ -0,0 +1,131 @@
+_T("DOWN_IN_FLAP_POS"),
+_T("DOWN_IN_FLAP_ZERO"),
+_T("DOWN_IN_FLAP_NEG"),
+_T("DOWN_IN_SC"),
+_T("DOWN_IN_GEAR_RETRACTED"),
+_T("DOWN_IN_GEAR_EXTENDED"),
+_T("DOWN_IN_AIRBRAKENOTLOCKED"),
+_T("DOWN_IN_AUX"),
+_T("DOWN_IN_ACK"),
+_T("DOWN_IN_REP"),
+_T("DOWN_IN_CIRCLING_PDA"),
+_T("DOWN_IN_CIRCLING_FLARM"),
+_T("DOWN_IN_FLYING"),
+_T("DOWN_IN_NOTFLYING"),
+_T("DOWN_IN_PDA_CONNECTED"),
+_T("DOWN_IN_VELOCITY_MANOEUVERING"),
+_T("DOWN_IN_VELOCITY_FLAP"),
+_T("DOWN_IN_VELOCITY_AIRBRAKE"),
+_T("DOWN_IN_VELOCITY_TERRAIN"),
+_T("DOWN_IN_VELOCITY_NEVEREXCEED"),
+_T("DOWN_IN_STALL"),
+_T("DOWN_IN_AIRBRAKELOCKED"),
+_T("DOWN_IN_TAKINGOFF"),
+_T("DOWN_IN_USERSWUP"),
+_T("DOWN_IN_USERSWMIDDLE"),
+_T("DOWN_IN_USERSWDOWN"),
+_T("UNUSED_0"),
+_T("UNUSED_1"),
+_T("UNUSED_2"),
+_T("UNUSED_3"),
+_T("UNUSED_4"),
+_T("UNUSED_5"),
+_T("DOWN_OUT_CIRCLING"),
+_T("DOWN_OUT_VELOCITY_MANOEUVERING"),
+_T("DOWN_OUT_VELOCITY_FLAP"),
+_T("DOWN_OUT_VELOCITY_AIRBRAKE"),
+_T("DOWN_OUT_VELOCITY_TERRAIN"),
+_T("DOWN_OUT_VELOCITY_NEVEREXCEED"),
+_T("DOWN_OUT_GEAR_LANDING"),
+_T("DOWN_OUT_FLAP_LANDING"),
+_T("DOWN_OUT_AIRBRAKE_TAKEOFF"),
+_T("DOWN_OUT_STALL"),
+_T("UNUSED_6"),
+_T("UNUSED_7"),
+_T("UNUSED_8"),
+_T("UNUSED_9"),
+_T("UNUSED_10"),
+_T("UNUSED_11"),
+_T("UNUSED_12"),
+_T("UNUSED_13"),
+_T("UNUSED_14"),
+_T("UNUSED_15"),
+_T("UNUSED_16"),
+_T("UNUSED_17"),
+_T("UNUSED_18"),
+_T("UNUSED_19"),
+_T("UNUSED_20"),
+_T("UNUSED_21"),
+_T("UNUSED_22"),
+_T("UNUSED_23"),
+_T("UNUSED_24"),
+_T("UNUSED_25"),
+_T("UNUSED_26"),
+_T("UNUSED_27"),
+_T("UP_IN_FLAP_POS"),
+_T("UP_IN_FLAP_ZERO"),
+_T("UP_IN_FLAP_NEG"),
+_T("UP_IN_SC"),
+_T("UP_IN_GEAR_RETRACTED"),
+_T("UP_IN_GEAR_EXTENDED"),
+_T("UP_IN_AIRBRAKENOTLOCKED"),
+_T("UP_IN_AUX"),
+_T("UP_IN_ACK"),
+_T("UP_IN_REP"),
+_T("UP_IN_CIRCLING_PDA"),
+_T("UP_IN_CIRCLING_FLARM"),
+_T("UP_IN_FLYING"),
+_T("UP_IN_NOTFLYING"),
+_T("UP_IN_PDA_CONNECTED"),
+_T("UP_IN_VELOCITY_MANOEUVERING"),
+_T("UP_IN_VELOCITY_FLAP"),
+_T("UP_IN_VELOCITY_AIRBRAKE"),
+_T("UP_IN_VELOCITY_TERRAIN"),
+_T("UP_IN_VELOCITY_NEVEREXCEED"),
+_T("UP_IN_STALL"),
+_T("UP_IN_AIRBRAKELOCKED"),
+_T("UP_IN_TAKINGOFF"),
+_T("UP_IN_USERSWUP"),
+_T("UP_IN_USERSWMIDDLE"),
+_T("UP_IN_USERSWDOWN"),
+_T("UNUSED_28"),
+_T("UNUSED_29"),
+_T("UNUSED_30"),
+_T("UNUSED_31"),
+_T("UNUSED_32"),
+_T("UNUSED_33"),
+_T("UP_OUT_CIRCLING"),
+_T("UP_OUT_VELOCITY_MANOEUVERING"),
+_T("UP_OUT_VELOCITY_FLAP"),
+_T("UP_OUT_VELOCITY_AIRBRAKE"),
+_T("UP_OUT_VELOCITY_TERRAIN"),
+_T("UP_OUT_VELOCITY_NEVEREXCEED"),
+_T("UP_OUT_GEAR_LANDING"),
+_T("UP_OUT_FLAP_LANDING"),
+_T("UP_OUT_AIRBRAKE_TAKEOFF"),
+_T("UP_OUT_STALL"),
+_T("UNUSED_34"),
+_T("UNUSED_35"),
+_T("UNUSED_36"),
+_T("UNUSED_37"),
+_T("UNUSED_38"),
+_T("UNUSED_39"),
+_T("UNUSED_40"),
+_T("UNUSED_41"),
+_T("UNUSED_42"),
+_T("UNUSED_43"),
+_T("UNUSED_44"),
+_T("UNUSED_45"),
+_T("UNUSED_46"),
+_T("UNUSED_47"),
+_T("UNUSED_48"),
+_T("UNUSED_49"),
+_T("UNUSED_50"),
+_T("UNUSED_51"),
+_T("UNUSED_52"),
+_T("UNUSED_53"),
+_T("UNUSED_54"),
+_T("UNUSED_55"),
+_T("UNUSED_56"),
+_T("UNUSED_57"),
+_T("COUNT"),
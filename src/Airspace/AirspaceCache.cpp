@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "AirspaceCache.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "system/Path.hpp"
+#include "io/BufferedOutputStream.hxx"
+#include "io/BufferedReader.hxx"
+#include "util/tstring.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+#include <string.h>
+#include <tchar.h>
+
+struct AirspaceCacheHeader {
+  static constexpr unsigned VERSION = 1;
+
+  uint32_t version;
+
+  uint32_t n_airspaces;
+
+  /**
+   * The number of characters of the original file's path following
+   * this header.
+   */
+  uint32_t path_length;
+};
+
+/**
+ * Describes one airspace.  It is followed by the name, the type and
+ * (for polygons) the points.
+ */
+struct AirspaceCacheRecord {
+  static constexpr unsigned MAX_STRING_LENGTH = 4096;
+  static constexpr unsigned MAX_POINTS = 1024 * 1024;
+
+  AirspaceAltitude base, top;
+
+  /**
+   * The center of an #AirspaceCircle.
+   */
+  GeoPoint center;
+
+  /**
+   * The radius of an #AirspaceCircle [m].
+   */
+  double radius;
+
+  uint32_t n_points;
+  uint32_t name_length, type_length;
+
+  AbstractAirspace::Shape shape;
+  AirspaceClass asclass;
+  RadioFrequency radio_frequency;
+  AirspaceActivity days;
+};
+
+static void
+WriteString(BufferedOutputStream &os, const TCHAR *s, std::size_t length)
+{
+  os.Write(s, sizeof(*s) * length);
+}
+
+static tstring
+ReadString(BufferedReader &r, std::size_t length)
+{
+  tstring s(length, _T('\0'));
+  r.ReadFull(std::as_writable_bytes(std::span{s.data(), s.size()}));
+  return s;
+}
+
+static void
+SaveAirspace(BufferedOutputStream &os, const AbstractAirspace &airspace)
+{
+  const std::size_t name_length = _tcslen(airspace.GetName());
+  const std::size_t type_length = _tcslen(airspace.GetType());
+  if (name_length > AirspaceCacheRecord::MAX_STRING_LENGTH ||
+      type_length > AirspaceCacheRecord::MAX_STRING_LENGTH)
+    throw std::runtime_error("Airspace name too long");
+
+  AirspaceCacheRecord record;
+
+  /* zero-fill all implicit padding bytes (to make valgrind happy) */
+  memset((void *)&record, 0, sizeof(record));
+
+  record.base = airspace.GetBase();
+  record.top = airspace.GetTop();
+  record.name_length = name_length;
+  record.type_length = type_length;
+  record.shape = airspace.GetShape();
+  record.asclass = airspace.GetClass();
+  record.radio_frequency = airspace.GetRadioFrequency();
+  record.days = airspace.GetDays();
+
+  const auto &points = airspace.GetPoints();
+
+  switch (airspace.GetShape()) {
+  case AbstractAirspace::Shape::CIRCLE: {
+    const auto &circle = (const AirspaceCircle &)airspace;
+    record.center = circle.GetReferenceLocation();
+    record.radius = circle.GetRadius();
+    break;
+  }
+
+  case AbstractAirspace::Shape::POLYGON:
+    if (points.size() > AirspaceCacheRecord::MAX_POINTS)
+      throw std::runtime_error("Airspace polygon too large");
+
+    record.n_points = points.size();
+    break;
+  }
+
+  os.WriteT(record);
+  WriteString(os, airspace.GetName(), name_length);
+  WriteString(os, airspace.GetType(), type_length);
+
+  if (airspace.GetShape() == AbstractAirspace::Shape::POLYGON)
+    for (const auto &i : points)
+      os.WriteT(i.GetLocation());
+}
+
+void
+SaveAirspaceCache(BufferedOutputStream &os, Path path,
+                  std::span<const AirspacePtr> airspaces)
+{
+  AirspaceCacheHeader header;
+  memset(&header, 0, sizeof(header));
+  header.version = AirspaceCacheHeader::VERSION;
+  header.n_airspaces = airspaces.size();
+  header.path_length = _tcslen(path.c_str());
+
+  os.WriteT(header);
+  WriteString(os, path.c_str(), header.path_length);
+
+  for (const auto &i : airspaces)
+    SaveAirspace(os, *i);
+}
+
+static AirspacePtr
+LoadAirspace(BufferedReader &r, std::vector<GeoPoint> &points)
+{
+  const auto record = r.ReadFullT<AirspaceCacheRecord>();
+
+  if (record.name_length > AirspaceCacheRecord::MAX_STRING_LENGTH ||
+      record.type_length > AirspaceCacheRecord::MAX_STRING_LENGTH ||
+      record.asclass >= AIRSPACECLASSCOUNT)
+    throw std::runtime_error("Malformed airspace cache record");
+
+  tstring name = ReadString(r, record.name_length);
+  tstring type = ReadString(r, record.type_length);
+
+  std::shared_ptr<AbstractAirspace> airspace;
+
+  switch (record.shape) {
+  case AbstractAirspace::Shape::CIRCLE:
+    if (!record.center.Check() || !std::isfinite(record.radius) ||
+        record.radius <= 0)
+      throw std::runtime_error("Malformed airspace circle");
+
+    airspace = std::make_shared<AirspaceCircle>(record.center,
+                                                record.radius);
+    break;
+
+  case AbstractAirspace::Shape::POLYGON:
+    if (record.n_points < 3 ||
+        record.n_points > AirspaceCacheRecord::MAX_POINTS)
+      throw std::runtime_error("Malformed airspace polygon");
+
+    points.resize(record.n_points);
+    r.ReadFull(std::as_writable_bytes(std::span{points}));
+
+    for (const auto &i : points)
+      if (!i.Check())
+        throw std::runtime_error("Malformed airspace polygon");
+
+    airspace = std::make_shared<AirspacePolygon>(points);
+    break;
+
+  default:
+    throw std::runtime_error("Malformed airspace shape");
+  }
+
+  airspace->SetProperties(std::move(name), record.asclass, std::move(type),
+                          record.base, record.top);
+  airspace->SetRadioFrequency(record.radio_frequency);
+  airspace->SetDays(record.days);
+  return airspace;
+}
+
+std::vector<AirspacePtr>
+LoadAirspaceCache(BufferedReader &r, Path path)
+{
+  const auto header = r.ReadFullT<AirspaceCacheHeader>();
+  if (header.version != AirspaceCacheHeader::VERSION ||
+      header.path_length > AirspaceCacheRecord::MAX_STRING_LENGTH)
+    throw std::runtime_error("Malformed airspace cache header");
+
+  if (ReadString(r, header.path_length) != path.c_str())
+    throw std::runtime_error("Airspace cache belongs to a different file");
+
+  std::vector<AirspacePtr> airspaces;
+  airspaces.reserve(std::min(header.n_airspaces, 65536u));
+
+  std::vector<GeoPoint> points;
+  for (unsigned i = 0; i < header.n_airspaces; ++i)
+    airspaces.emplace_back(LoadAirspace(r, points));
+
+  return airspaces;
+}
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Engine/Airspace/Ptr.hpp"
+
+#include <span>
+#include <vector>
+
+class Path;
+class BufferedOutputStream;
+class BufferedReader;
+
+/**
+ * Write parsed airspaces to a cache file, to be restored by
+ * LoadAirspaceCache() without parsing the original file again.
+ *
+ * Throws on error.
+ *
+ * @param path the path of the original file; the cache is only valid
+ * for this path
+ */
+void
+SaveAirspaceCache(BufferedOutputStream &os, Path path,
+                  std::span<const AirspacePtr> airspaces);
+
+/**
+ * Load airspaces from a cache file written by SaveAirspaceCache().
+ *
+ * Throws on error (e.g. if the file is malformed or belongs to a
+ * different original file).
+ */
+std::vector<AirspacePtr>
+LoadAirspaceCache(BufferedReader &r, Path path);
@@ -10,23 +10,112 @@
 #include "Language/Language.hpp"
 #include "LogFile.hpp"
 #include "system/Path.hpp"
+#include "Airspace/AirspaceCache.hpp"
+#include "io/BufferedOutputStream.hxx"
+#include "io/BufferedReader.hxx"
+#include "io/FileCache.hpp"
 #include "io/FileLineReader.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/Reader.hxx"
 #include "io/ZipArchive.hpp"
 #include "io/ZipLineReader.hpp"
-#include "io/MapFile.hpp"
 #include "util/RuntimeError.hxx"
 #include "Profile/Profile.hpp"
 
 #include <string.h>
 
+static const TCHAR *const airspace_cache_name = _T("airspace");
+static const TCHAR *const additional_airspace_cache_name =
+  _T("airspace-additional");
+static const TCHAR *const map_airspace_cache_name = _T("airspace-map");
+
+static void
+AddAirspaces(Airspaces &airspaces, std::span<const AirspacePtr> src) noexcept
+{
+  for (const auto &i : src)
+    airspaces.Add(i);
+}
+
+/**
+ * Attempt to load the airspaces of the specified file from the
+ * cache.
+ *
+ * @return true on success
+ */
+static bool
+LoadAirspaceCache(Airspaces &airspaces, FileCache *cache,
+                  const TCHAR *cache_name, Path path) noexcept
+try {
+  if (cache == nullptr)
+    return false;
+
+  auto r = cache->Load(cache_name, path);
+  if (!r)
+    return false;
+
+  try {
+    BufferedReader br(*r);
+    AddAirspaces(airspaces, LoadAirspaceCache(br, path));
+  } catch (...) {
+    /* discard the broken file, to generate a new one next time */
+    r.reset();
+    cache->Flush(cache_name);
+    throw;
+  }
+
+  LogFormat("Loaded airspaces from cache");
+  return true;
+} catch (...) {
+  LogError(std::current_exception(), "Failed to load airspace cache");
+  return false;
+}
+
+static void
+SaveAirspaceCache(FileCache &cache, const TCHAR *cache_name, Path path,
+                  std::span<const AirspacePtr> airspaces)
+try {
+  auto os = cache.Save(cache_name, path);
+  BufferedOutputStream bos(*os);
+  SaveAirspaceCache(bos, path, airspaces);
+  bos.Flush();
+  os->Commit();
+} catch (...) {
+  LogError(std::current_exception(), "Failed to save airspace cache");
+}
+
+/**
+ * Parse an airspace file and add its airspaces to the database and
+ * to the cache.  Throws on error.
+ */
+static void
+ParseAndCacheAirspaceFile(Airspaces &airspaces, TLineReader &reader,
+                          FileCache *cache, const TCHAR *cache_name, Path path,
+                  OperationEnvironment &operation)
+{
+  Airspaces parsed;
+  ParseAirspaceFile(parsed, reader, operation);
+
+  const std::vector<AirspacePtr> result{parsed.GetPending().begin(),
+                                        parsed.GetPending().end()};
+  AddAirspaces(airspaces, result);
+
+  if (cache != nullptr)
+    SaveAirspaceCache(*cache, cache_name, path, result);
+}
+
 static bool
 ParseAirspaceFile(Airspaces &airspaces, Path path,
+                  FileCache *cache, const TCHAR *cache_name,
                   OperationEnvironment &operation)
 try {
+  if (LoadAirspaceCache(airspaces, cache, cache_name, path))
+    return true;
+
   FileLineReader reader(path, Charset::AUTO);
 
   try {
-    ParseAirspaceFile(airspaces, reader, operation);
+    ParseAndCacheAirspaceFile(airspaces, reader, cache, cache_name, path,
+                              operation);
   } catch (...) {
     // TODO translate this?
     std::throw_with_nested(FormatRuntimeError("Error in file %s",
@@ -40,15 +129,26 @@ try {
   return false;
 }
 
+/**
+ * @param archive_path the path of the ZIP file, used as the cache
+ * key
+ */
 static bool
 ParseAirspaceFile(Airspaces &airspaces,
                   struct zzip_dir *dir, const char *path,
+                  FileCache *cache, Path archive_path,
                   OperationEnvironment &operation)
 try {
+  if (LoadAirspaceCache(airspaces, cache, map_airspace_cache_name,
+                        archive_path))
+    return true;
+
   ZipLineReader reader(dir, path, Charset::AUTO);
 
   try {
-    ParseAirspaceFile(airspaces, reader, operation);
+    ParseAndCacheAirspaceFile(airspaces, reader,
+                              cache, map_airspace_cache_name, archive_path,
+                              operation);
   } catch (...) {
     // TODO translate this?
     std::throw_with_nested(FormatRuntimeError("Error in file %s",
@@ -63,7 +163,7 @@ try {
 }
 
 void
-ReadAirspace(Airspaces &airspaces,
+ReadAirspace(Airspaces &airspaces, FileCache *cache,
              AtmosphericPressure press,
              OperationEnvironment &operation)
 {
@@ -75,17 +175,25 @@ ReadAirspace(Airspaces &airspaces,
   // Read the airspace filenames from the registry
   if (const auto path = Profile::GetPath(ProfileKeys::AirspaceFile);
       path != nullptr)
-    airspace_ok |= ParseAirspaceFile(airspaces, path, operation);
+    airspace_ok |= ParseAirspaceFile(airspaces, path,
+                                     cache, airspace_cache_name,
+                                     operation);
 
   if (const auto path = Profile::GetPath(ProfileKeys::AdditionalAirspaceFile);
       path != nullptr)
-    airspace_ok |= ParseAirspaceFile(airspaces, path, operation);
+    airspace_ok |= ParseAirspaceFile(airspaces, path,
+                                     cache, additional_airspace_cache_name,
+                                     operation);
 
   try {
-    if (auto archive = OpenMapFile();
-        archive && archive->Exists("airspace.txt"))
-      airspace_ok |= ParseAirspaceFile(airspaces, archive->get(),
-                                       "airspace.txt", operation);
+    if (const auto path = Profile::GetPath(ProfileKeys::MapFile);
+        path != nullptr) {
+      ZipArchive archive{path};
+      if (archive.Exists("airspace.txt"))
+        airspace_ok |= ParseAirspaceFile(airspaces, archive.get(),
+                                         "airspace.txt", cache, path,
+                                         operation);
+    }
   } catch (...) {
     LogError(std::current_exception(),
              "Failed to load airspaces from map file");
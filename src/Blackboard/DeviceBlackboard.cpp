@@ -8,6 +8,34 @@
 
 #include <algorithm>
 
+void
+DeviceBlackboard::DeviceData::Init(const NMEAInfo &info) noexcept
+{
+  working = info;
+  stamps = info.GetMergeStamps();
+  published.Fill({info, versions});
+}
+
+void
+DeviceBlackboard::DeviceData::Publish() noexcept
+{
+  /* attributes updated at the current clock may have been modified
+     again without changing their stamp */
+  const auto new_stamps = working.GetMergeStamps();
+  const unsigned modified = new_stamps.Compare(stamps) |
+    new_stamps.Find(working.clock);
+  stamps = new_stamps;
+
+  for (unsigned i = 0; i < versions.size(); ++i)
+    if (modified & (1u << i))
+      ++versions[i];
+
+  auto &snapshot = published.GetBack();
+  snapshot.info = working;
+  snapshot.versions = versions;
+  published.Publish();
+}
+
 /**
  * Initializes the DeviceBlackboard
  */
@@ -22,7 +50,8 @@ DeviceBlackboard::DeviceBlackboard() noexcept
   gps_info.date_time_utc = BrokenDateTime::NowUTC();
   gps_info.time = TimeStamp{gps_info.date_time_utc.DurationSinceMidnight()};
 
-  std::fill(per_device_data.begin(), per_device_data.end(), gps_info);
+  for (auto &device : per_device_data)
+    device.Init(gps_info);
 
   real_data = simulator_data = replay_data = gps_info;
 
@@ -43,21 +72,27 @@ void
 DeviceBlackboard::SetStartupLocation(const GeoPoint &loc,
                                      const double alt) noexcept
 {
-  const std::lock_guard lock{mutex};
+  {
+    const std::lock_guard lock{mutex};
 
-  if (Calculated().flight.flying)
-    return;
+    if (Calculated().flight.flying)
+      return;
 
-  for (auto &i : per_device_data)
-    if (!i.location_available)
-      i.SetFakeLocation(loc, alt);
+    if (!real_data.location_available)
+      real_data.SetFakeLocation(loc, alt);
 
-  if (!real_data.location_available)
-    real_data.SetFakeLocation(loc, alt);
+    if (is_simulator()) {
+      simulator_data.SetFakeLocation(loc, alt);
+      simulator.Touch(simulator_data);
+    }
+  }
 
-  if (is_simulator()) {
-    simulator_data.SetFakeLocation(loc, alt);
-    simulator.Touch(simulator_data);
+  for (auto &device : per_device_data) {
+    const std::lock_guard lock{device.mutex};
+    if (!device.working.location_available) {
+      device.working.SetFakeLocation(loc, alt);
+      device.Publish();
+    }
   }
 
   ScheduleMerge();
@@ -156,18 +191,24 @@ DeviceBlackboard::SetAltitude(double val) noexcept
 void
 DeviceBlackboard::ExpireWallClock() noexcept
 {
-  const std::lock_guard lock{mutex};
-  if (!Basic().alive)
-    return;
+  {
+    const std::lock_guard lock{mutex};
+    if (!Basic().alive)
+      return;
+  }
 
   bool modified = false;
-  for (auto &basic : per_device_data) {
+  for (auto &device : per_device_data) {
+    const std::lock_guard lock{device.mutex};
+    NMEAInfo &basic = device.working;
     if (!basic.alive)
       continue;
 
     basic.ExpireWallClock();
-    if (!basic.alive)
+    if (!basic.alive) {
+      device.Publish();
       modified = true;
+    }
   }
 
   if (modified)
@@ -180,23 +221,48 @@ DeviceBlackboard::ScheduleMerge() noexcept
   TriggerMergeThread();
 }
 
-void
+unsigned
 DeviceBlackboard::Merge() noexcept
 {
-  NMEAInfo &basic = SetBasic();
+  unsigned modified = 0;
+
+  for (auto &device : per_device_data) {
+    if (device.published.Acquire()) {
+      const auto &versions = device.published.GetFront().versions;
+      for (unsigned i = 0; i < versions.size(); ++i)
+        if (versions[i] != device.merged_versions[i])
+          modified |= 1u << i;
+
+      device.merged_versions = versions;
+    }
+
+    NMEAInfo &basic = device.published.GetFront().info;
+    if ((bool)basic.alive != device.merged_alive) {
+      /* the set of devices to be merged has changed */
+      device.merged_alive = basic.alive;
+      modified = NMEAInfo::MERGE_ALL;
+    }
 
-  real_data.Reset();
-  for (auto &basic : per_device_data) {
     if (!basic.alive)
       continue;
 
+    const auto stamps = basic.GetMergeStamps();
     basic.UpdateClock();
     basic.Expire();
-    real_data.Complement(basic);
+    modified |= basic.GetMergeStamps().Compare(stamps);
   }
 
+  /* the groups which were not modified by any device still contain
+     the result of the last merge */
+  real_data.ResetMerged(modified);
+  for (const auto &device : per_device_data)
+    real_data.Complement(device.published.GetFront().info, modified);
+
   real_clock.Normalise(real_data);
 
+  NMEAInfo &basic = SetBasic();
+  Source source;
+
   if (replay_data.alive) {
     replay_data.Expire();
     basic = replay_data;
@@ -205,11 +271,20 @@ DeviceBlackboard::Merge() noexcept
        back BrokenDate modifications to the NMEA parser, as this would
        trigger its time warp checks */
     replay_clock.Normalise(basic);
+    source = Source::REPLAY;
   } else if (simulator_data.alive) {
     simulator_data.UpdateClock();
     simulator_data.Expire();
     basic = simulator_data;
+    source = Source::SIMULATOR;
   } else {
     basic = real_data;
+    source = Source::REAL;
   }
+
+  if (source != Source::REAL || source != merged_source)
+    modified = NMEAInfo::MERGE_ALL;
+
+  merged_source = source;
+  return modified;
 }
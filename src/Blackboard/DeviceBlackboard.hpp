@@ -8,6 +8,7 @@
 #include "Device/Simulator.hpp"
 #include "Device/Features.hpp"
 #include "thread/Mutex.hxx"
+#include "thread/TripleBuffer.hpp"
 #include "time/WrapClock.hpp"
 
 #include <array>
@@ -27,13 +28,68 @@ class DeviceBlackboard
   : public BaseBlackboard, public ComputerSettingsBlackboard
 {
   friend class MergeThread;
+  friend class DeviceDataEditor;
 
   Simulator simulator;
 
+  /**
+   * One version number per #NMEAInfo::MergeGroup, incremented each
+   * time an attribute of the group is modified.
+   */
+  using MergeVersions = std::array<uint32_t, NMEAInfo::N_MERGE_GROUPS>;
+
+  struct DeviceSnapshot {
+    NMEAInfo info;
+    MergeVersions versions;
+  };
+
+  struct DeviceData {
+    /**
+     * Serialises the writers of this device (its port thread, the
+     * main thread, ...).  Readers never lock it, therefore a writer
+     * never blocks Merge() or the user interface, and vice versa.
+     */
+    Mutex mutex;
+
+    /**
+     * The writers' copy which is updated by parsers.  Protected by
+     * #mutex.
+     */
+    NMEAInfo working;
+
+    /**
+     * The stamps and versions of #working as of the last Publish().
+     * Protected by #mutex.
+     */
+    NMEAInfo::MergeStamps stamps;
+    MergeVersions versions{};
+
+    /**
+     * Snapshots of #working, published by Publish() and consumed by
+     * Merge().  The front buffer is protected by
+     * DeviceBlackboard::mutex.
+     */
+    TripleBuffer<DeviceSnapshot> published;
+
+    /**
+     * The versions and the connection state of the snapshot seen by
+     * the last Merge().  Protected by DeviceBlackboard::mutex.
+     */
+    MergeVersions merged_versions{};
+    bool merged_alive = false;
+
+    void Init(const NMEAInfo &info) noexcept;
+
+    /**
+     * Publish #working.  Caller must hold #mutex.
+     */
+    void Publish() noexcept;
+  };
+
   /**
    * Data from each physical device.
    */
-  std::array<NMEAInfo, NUMDEV> per_device_data;
+  std::array<DeviceData, NUMDEV> per_device_data;
 
   /**
    * Merged data from the physical devices.
@@ -55,6 +111,15 @@ class DeviceBlackboard
    */
   WrapClock real_clock, replay_clock;
 
+  enum class Source : uint8_t {
+    NONE, REAL, SIMULATOR, REPLAY,
+  };
+
+  /**
+   * Which data was copied to gps_info by the last Merge()?
+   */
+  Source merged_source = Source::NONE;
+
 public:
   Mutex mutex;
 
@@ -86,33 +151,37 @@ protected:
   MoreData &SetMoreData() noexcept { return gps_info; }
 
 public:
+  /**
+   * Returns the device's data as of the last Merge().  Caller must
+   * lock the blackboard.
+   */
   const NMEAInfo &RealState(unsigned i) const noexcept {
-    return per_device_data[i];
-  }
-
-  NMEAInfo &SetRealState(unsigned i) noexcept {
-    return per_device_data[i];
+    return per_device_data[i].published.GetFront().info;
   }
 
   /**
    * Return a copy of a device's data after updating its clock via
    * NMEAInfo::UpdateClock().  The method takes care for locking and
-   * unlocking the mutex.
+   * unlocking the device's mutex.
    */
   NMEAInfo LockGetDeviceDataUpdateClock(unsigned i) noexcept {
-    const std::lock_guard lock{mutex};
-    per_device_data[i].UpdateClock();
-    return per_device_data[i];
+    auto &device = per_device_data[i];
+    const std::lock_guard lock{device.mutex};
+    device.working.UpdateClock();
+    return device.working;
   }
 
   /**
    * Overwrites a device's data and schedule the MergeThread.  The
-   * method takes care for locking and unlocking the mutex.
+   * method takes care for locking and unlocking the device's mutex.
    */
   void LockSetDeviceDataScheuduleMerge(unsigned i, const NMEAInfo &src) noexcept {
     {
-      const std::lock_guard lock{mutex};
-      per_device_data[i] = src;
+      auto &device = per_device_data[i];
+      const std::lock_guard lock{device.mutex};
+      device.working = src;
+      device.working.Expire();
+      device.Publish();
     }
 
     ScheduleMerge();
@@ -147,8 +216,9 @@ public:
 
   /**
    * Check the expiry time of the device connection with the wall
-   * clock time.  This method locks the blackboard, i.e. it may be
-   * called from any thread.
+   * clock time.  This method locks the blackboard and the devices,
+   * i.e. it may be called from any thread, but the caller must not
+   * hold any of these locks.
    *
    * @return true if the connection has just expired, false if the
    * connection status has not changed
@@ -162,8 +232,14 @@ public:
   void ScheduleMerge() noexcept;
 
   /**
-   * Copy real_data or simulator_data or replay_data to gps_info.
-   * Caller must lock the blackboard.
+   * Acquire the latest data published by each device, and copy
+   * real_data or simulator_data or replay_data to gps_info.  Caller
+   * must lock the blackboard.
+   *
+   * Only the #NMEAInfo::MergeGroup values which were modified by a
+   * device since the last call are merged again.
+   *
+   * @return the groups of gps_info which may have been modified
    */
-  void Merge() noexcept;
+  unsigned Merge() noexcept;
 };
@@ -14,8 +14,9 @@
 #include <boost/geometry/algorithms/intersection.hpp>
 #include <boost/geometry/strategies/strategies.hpp>
 
-CloudClientContainer::CloudClientContainer()
-  :key_set(typename KeySet::bucket_traits(key_buckets, N_KEY_BUCKETS)) {}
+CloudClientContainer::CloudClientContainer(std::atomic<unsigned> &_next_id)
+  :key_set(typename KeySet::bucket_traits(key_buckets, N_KEY_BUCKETS)),
+   next_id(_next_id) {}
 
 CloudClientContainer::~CloudClientContainer()
 {
@@ -188,30 +189,3 @@ CloudClient::Load(Deserialiser &s)
   client.stamp = stamp;
   return client;
 }
-
-void
-CloudClientContainer::Save(Serialiser &s) const
-{
-  s.Write32(next_id);
-
-  for (const auto &client : list) {
-    s.Write8(1);
-    client.Save(s);
-  }
-
-  s.Write8(0);
-  s.Write8(0);
-}
-
-void
-CloudClientContainer::Load(Deserialiser &s)
-{
-  next_id = s.Read32();
-
-  while (s.Read8() != 0) {
-    auto client = std::make_shared<CloudClient>(CloudClient::Load(s));
-    Insert(*client);
-  }
-
-  s.Read8();
-}
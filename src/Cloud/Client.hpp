@@ -11,6 +11,7 @@
 #include <boost/intrusive/unordered_set.hpp>
 #include <boost/geometry/index/rtree.hpp>
 #include <boost/range/iterator_range_core.hpp>
+#include <atomic>
 #include <memory>
 #include <chrono>
 
@@ -179,15 +180,16 @@ class CloudClientContainer {
   IdSet id_set;
 
   /**
-   * The public id assigned to the next new #CloudClient.
+   * The public id assigned to the next new #CloudClient.  It is
+   * shared by all shards of #CloudData.
    */
-  unsigned next_id = 1;
+  std::atomic<unsigned> &next_id;
 
   static constexpr size_t N_KEY_BUCKETS = 65521;
   typename KeySet::bucket_type key_buckets[N_KEY_BUCKETS];
 
 public:
-  CloudClientContainer();
+  explicit CloudClientContainer(std::atomic<unsigned> &_next_id);
   ~CloudClientContainer();
 
   void clear();
@@ -243,7 +245,4 @@ public:
 
   [[gnu::pure]]
   query_iterator_range QueryWithinRange(GeoPoint location, double range) const;
-
-  void Save(Serialiser &s) const;
-  void Load(Deserialiser &s);
 };
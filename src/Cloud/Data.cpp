@@ -3,11 +3,19 @@
 
 #include "Data.hpp"
 #include "Dump.hpp"
+#include "JournalRecord.hpp"
 #include "Serialiser.hpp"
 #include "net/ToString.hxx"
+#include "io/FileReader.hxx"
+#include "io/StringOutputStream.hxx"
+#include "system/FileUtil.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
 
 using std::cout;
 using std::cerr;
@@ -16,15 +24,60 @@ using std::endl;
 static constexpr uint32_t CLOUD_MAGIC = 0x5753f60f;
 static constexpr uint32_t CLOUD_VERSION = 1;
 
+CloudData::CloudData(unsigned n_shards)
+{
+  shards.reserve(n_shards);
+  for (unsigned i = 0; i < n_shards; ++i)
+    shards.emplace_back(std::make_unique<CloudShard>(next_id));
+}
+
+void
+CloudData::ExpireClients(std::chrono::steady_clock::time_point before)
+{
+  for (auto &shard : shards) {
+    const std::scoped_lock lock{shard->mutex};
+    shard->clients.Expire(before);
+    shard->modified = true;
+  }
+}
+
+void
+CloudData::UpdateIndex()
+{
+  bool modified = false;
+  for (auto &shard : shards) {
+    const std::scoped_lock lock{shard->mutex};
+    if (std::exchange(shard->modified, false))
+      modified = true;
+  }
+
+  if (!modified)
+    return;
+
+  std::vector<CloudIndexEntry> entries;
+  entries.reserve(index.Get()->size());
+
+  for (auto &shard : shards) {
+    const std::scoped_lock lock{shard->mutex};
+    for (const auto &client : shard->clients)
+      entries.emplace_back(client);
+  }
+
+  index.Publish(std::make_shared<const CloudIndexSnapshot>(std::move(entries)));
+}
+
 void
 CloudData::DumpClients()
 {
-  for (const auto &client : clients) {
-    cout << ToString(client.address) << '\t'
-         << std::hex << client.key << std::dec << '\t'
-         << client.id << '\t'
-         << client.location << '\t'
-         << client.altitude << "m\n";
+  for (auto &shard : shards) {
+    const std::scoped_lock lock{shard->mutex};
+    for (const auto &client : shard->clients) {
+      cout << ToString(client.address) << '\t'
+           << std::hex << client.key << std::dec << '\t'
+           << client.id << '\t'
+           << client.location << '\t'
+           << client.altitude << "m\n";
+    }
   }
 
   cout.flush();
@@ -33,11 +86,45 @@ CloudData::DumpClients()
 void
 CloudData::Save(Serialiser &s) const
 {
+  /* copy the clients while holding the locks, but serialise them
+     (which is slow because of getnameinfo()) without */
+  std::vector<CloudClient> clients;
+  clients.reserve(index.Get()->size());
+
+  for (auto &shard : shards) {
+    const std::scoped_lock lock{shard->mutex};
+    for (const auto &client : shard->clients)
+      clients.emplace_back(client);
+  }
+
+  /* there are few thermals; serialise them into a memory buffer */
+  StringOutputStream thermal_buffer;
+
+  {
+    const std::scoped_lock lock{thermal_mutex};
+    Serialiser ts(thermal_buffer);
+    thermals.Save(ts);
+    ts.Flush();
+  }
+
   s.Write32(CLOUD_MAGIC);
   s.Write32(CLOUD_VERSION);
-  clients.Save(s);
+
+  s.Write32(next_id);
+
+  for (const auto &client : clients) {
+    s.Write8(1);
+    client.Save(s);
+  }
+
+  s.Write8(0);
+  s.Write8(0);
+
   s.Write8(1);
-  thermals.Save(s);
+
+  const auto &t = thermal_buffer.GetValue();
+  s.Write(t.data(), t.size());
+
   s.Write8(0);
 }
 
@@ -50,10 +137,142 @@ CloudData::Load(Deserialiser &s)
   if (s.Read32() != CLOUD_VERSION)
     throw std::runtime_error("Bad version");
 
-  clients.Load(s);
+  next_id = s.Read32();
+
+  while (s.Read8() != 0) {
+    auto client = std::make_shared<CloudClient>(CloudClient::Load(s));
+
+    auto &shard = GetShard(client->key);
+    const std::scoped_lock lock{shard.mutex};
+    shard.clients.Insert(*client);
+    shard.modified = true;
+  }
+
+  s.Read8();
 
   if (s.Read8() != 0) {
+    const std::scoped_lock lock{thermal_mutex};
     thermals.Load(s);
     s.Read8();
   }
+
+  UpdateIndex();
+}
+
+static bool
+IsEOF(BufferedReader &r)
+{
+  if (!r.Read().empty())
+    return false;
+
+  r.Fill(false);
+  return r.Read().empty();
+}
+
+void
+CloudData::Replay(Deserialiser &s, uint64_t snapshot_serial)
+{
+  if (IsEOF(s))
+    /* the process was killed right after creating the journal */
+    return;
+
+  ReadJournalHeader(s);
+
+  /* each client record contains the complete state, so only the last
+     one of each client needs to be applied */
+  std::unordered_map<uint64_t, CloudJournalRecord> client_records;
+  std::vector<CloudJournalRecord> thermal_records;
+
+  try {
+    while (!IsEOF(s)) {
+      auto r = CloudJournalRecord::Load(s);
+      switch (r.type) {
+      case CloudJournalRecord::Type::CLIENT:
+        client_records.insert_or_assign(r.key, r);
+        break;
+
+      case CloudJournalRecord::Type::THERMAL:
+        /* the snapshot may have been written after this record was
+           (e.g. by an interrupted compaction) */
+        if (r.serial >= snapshot_serial)
+          thermal_records.push_back(r);
+        break;
+      }
+    }
+  } catch (const std::runtime_error &) {
+    /* the last record is truncated or corrupt; the journal was being
+       written when the process was killed */
+  }
+
+  unsigned max_id = 0;
+
+  for (const auto &[key, r] : client_records) {
+    auto &shard = GetShard(key);
+    const std::scoped_lock lock{shard.mutex};
+
+    auto *client = shard.clients.Find(key);
+    if (client != nullptr && client->id != r.id) {
+      /* the client was expired and came back with a new id */
+      shard.clients.Remove(*client);
+      client = nullptr;
+    }
+
+    if (client == nullptr) {
+      auto c = std::make_shared<CloudClient>(SocketAddress(r.address),
+                                             key, r.id,
+                                             r.a, int(r.a.altitude));
+      c->stamp = r.time;
+      shard.clients.Insert(*c);
+    } else {
+      shard.clients.Refresh(*client, r.address, r.a, int(r.a.altitude));
+      client->stamp = r.time;
+    }
+
+    shard.modified = true;
+    max_id = std::max(max_id, r.id);
+  }
+
+  if (max_id >= next_id)
+    next_id = max_id + 1;
+
+  {
+    const std::scoped_lock lock{thermal_mutex};
+    for (const auto &r : thermal_records) {
+      auto thermal = std::make_shared<CloudThermal>(r.key, r.a, r.b, r.lift);
+      thermal->time = r.time;
+      thermal->serial = r.serial;
+      thermals.InsertReplayed(*thermal);
+    }
+  }
+
+  UpdateIndex();
+}
+
+static void
+ReplayFile(CloudData &data, Path path, uint64_t snapshot_serial)
+{
+  if (!File::Exists(path))
+    return;
+
+  FileReader fr(path);
+  Deserialiser s(fr);
+  data.Replay(s, snapshot_serial);
+}
+
+void
+CloudData::Load(Path db_path)
+{
+  if (File::Exists(db_path)) {
+    FileReader fr(db_path);
+    Deserialiser s(fr);
+    Load(s);
+  }
+
+  /* not updated while replaying: the two journals are not ordered
+     by serial */
+  const uint64_t snapshot_serial = thermals.GetNextSerial();
+
+  /* the old journal exists only if a compaction was interrupted */
+  ReplayFile(*this, GetOldJournalPath(db_path), snapshot_serial);
+  ReplayFile(*this, GetJournalPath(db_path), snapshot_serial);
 }
@@ -5,16 +5,105 @@
 
 #include "Client.hpp"
 #include "Thermal.hpp"
+#include "Index.hpp"
+#include "thread/Mutex.hxx"
+#include "system/Path.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
 
 class Serialiser;
 class Deserialiser;
 
-struct CloudData {
+/**
+ * A subset of all clients, selected by their key.  Each shard has its
+ * own lock, so workers handling different clients don't contend.
+ */
+struct CloudShard {
+  mutable Mutex mutex;
+
   CloudClientContainer clients;
+
+  /**
+   * Was #clients modified since the last CloudData::UpdateIndex()
+   * call?  Protected by #mutex.
+   */
+  bool modified = false;
+
+  explicit CloudShard(std::atomic<unsigned> &next_id)
+    :clients(next_id) {}
+};
+
+class CloudData {
+  /**
+   * The public id assigned to the next new #CloudClient, shared by
+   * all shards.
+   */
+  std::atomic<unsigned> next_id{1};
+
+  std::vector<std::unique_ptr<CloudShard>> shards;
+
+public:
+  /**
+   * Protects #thermals.
+   */
+  mutable Mutex thermal_mutex;
+
   CloudThermalContainer thermals;
 
+  /**
+   * A snapshot of all clients for range queries, see UpdateIndex().
+   */
+  CloudIndex index;
+
+  explicit CloudData(unsigned n_shards=1);
+
+  CloudShard &GetShard(uint64_t key) noexcept {
+    return *shards[key % shards.size()];
+  }
+
+  const auto &GetShards() const noexcept {
+    return shards;
+  }
+
+  void ExpireClients(std::chrono::steady_clock::time_point before);
+
+  /**
+   * Publish a new #CloudIndexSnapshot if a shard was modified.
+   */
+  void UpdateIndex();
+
   void DumpClients();
 
+  /**
+   * Write a snapshot of all clients and thermals.  The locks are
+   * held only while copying the data, not while writing it, so this
+   * may run in a background thread.
+   */
   void Save(Serialiser &s) const;
+
   void Load(Deserialiser &s);
+
+  /**
+   * Apply the records of a #CloudJournal file.  Only the last record
+   * of each client is applied.  A truncated record at the end (after
+   * a crash) is ignored.
+   *
+   * Throws on error.
+   *
+   * @param snapshot_serial the CloudThermalContainer::GetNextSerial()
+   * value of the loaded snapshot; thermal records below it are
+   * already in the snapshot (or have expired since) and are skipped
+   */
+  void Replay(Deserialiser &s, uint64_t snapshot_serial);
+
+  /**
+   * Load the given database file (if it exists) and replay its
+   * journal files.
+   *
+   * Throws on error.
+   */
+  void Load(Path db_path);
 };
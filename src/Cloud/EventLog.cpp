@@ -0,0 +1,204 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "EventLog.hpp"
+#include "Dump.hpp"
+#include "system/FileUtil.hpp"
+#include "system/Error.hxx"
+
+#include <mutex>
+#include <sstream>
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Write events to the buffer in chunks of this size.
+ */
+static constexpr std::size_t MAX_BUFFER = 64 * 1024;
+
+CloudEventLog::CloudEventLog(Path _path, uint64_t _max_size,
+                             std::size_t capacity)
+  :Thread("CloudEventLog"),
+   queue(capacity), path(_path), max_size(_max_size)
+{
+  if (path != nullptr)
+    Open();
+}
+
+void
+CloudEventLog::Open()
+{
+  if (!fd.Open(path.c_str(), O_WRONLY|O_CREAT|O_APPEND))
+    throw FormatErrno("Failed to open %s", path.c_str());
+
+  size = fd.GetSize();
+}
+
+void
+CloudEventLog::Rotate()
+{
+  fd.Close();
+
+  for (unsigned i = MAX_ROTATED_FILES; i > 1; --i) {
+    const auto from = path + ("." + std::to_string(i - 1)).c_str();
+    const auto to = path + ("." + std::to_string(i)).c_str();
+    File::Replace(from, to);
+  }
+
+  File::Replace(path, path + ".1");
+
+  Open();
+}
+
+void
+CloudEventLog::Stop() noexcept
+{
+  if (!IsDefined())
+    return;
+
+  {
+    const std::scoped_lock lock{mutex};
+    should_stop = true;
+  }
+
+  cond.notify_one();
+  Join();
+}
+
+static void
+FormatTime(std::ostream &os, std::chrono::system_clock::time_point t) noexcept
+{
+  const auto t_s = std::chrono::system_clock::to_time_t(t);
+  const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count() % 1000;
+
+  struct tm tm;
+  gmtime_r(&t_s, &tm);
+
+  char buffer[32];
+  strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &tm);
+  os << buffer << '.' << std::setfill('0') << std::setw(3) << ms
+     << std::setfill(' ') << 'Z';
+}
+
+static void
+Format(std::ostream &os, const CloudEvent &e) noexcept
+{
+  FormatTime(os, e.time);
+  os << '\t';
+
+  switch (e.type) {
+  case CloudEvent::Type::FIX:
+    os << "FIX\t"
+       << SocketAddress(e.address) << '\t'
+       << std::hex << e.key << std::dec << '\t'
+       << e.id << '\t'
+       << e.a << '\t'
+       << e.top_altitude << 'm';
+    break;
+
+  case CloudEvent::Type::WAVE:
+    os << "WAVE\t"
+       << SocketAddress(e.address) << '\t'
+       << std::hex << e.key << std::dec << '\t'
+       << e.id << '\t'
+       << e.a << '\t'
+       << e.b << '\t'
+       << e.bottom_altitude << '-' << e.top_altitude << "m\t"
+       << e.lift << "m/s";
+    break;
+
+  case CloudEvent::Type::THERMAL:
+    os << "THERMAL\t"
+       << SocketAddress(e.address) << '\t'
+       << std::hex << e.key << std::dec << '\t'
+       << e.id << '\t'
+       << e.a << '\t'
+       << e.bottom_altitude << '-' << e.top_altitude << "m\t"
+       << e.lift << "m/s";
+    break;
+  }
+
+  os << '\n';
+}
+
+void
+CloudEventLog::Flush(std::string &buffer) noexcept
+{
+  if (buffer.empty())
+    return;
+
+  try {
+    if (path != nullptr && size > 0 && size + buffer.size() > max_size)
+      Rotate();
+
+    const FileDescriptor out = path != nullptr
+      ? FileDescriptor{fd}
+      : FileDescriptor{STDOUT_FILENO};
+    out.FullWrite(buffer.data(), buffer.size());
+    size += buffer.size();
+  } catch (...) {
+    n_errors.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  buffer.clear();
+}
+
+void
+CloudEventLog::Drain(std::string &buffer) noexcept
+{
+  std::ostringstream os;
+
+  CloudEvent event;
+  uint64_t n = 0;
+  while (queue.TryPop(event)) {
+    Format(os, event);
+    ++n;
+
+    if (os.tellp() >= std::streamoff(MAX_BUFFER)) {
+      buffer = std::move(os).str();
+      Flush(buffer);
+      os.str({});
+    }
+  }
+
+  buffer = std::move(os).str();
+  Flush(buffer);
+
+  n_written.fetch_add(n, std::memory_order_relaxed);
+}
+
+void
+CloudEventLog::Run() noexcept
+{
+  std::string buffer;
+  uint64_t reported_dropped = 0;
+
+  std::unique_lock lock{mutex};
+
+  while (true) {
+    const bool stop = should_stop;
+    lock.unlock();
+
+    Drain(buffer);
+
+    /* make the backpressure visible in the log */
+    if (const uint64_t dropped = n_dropped.load(std::memory_order_relaxed);
+        dropped != reported_dropped) {
+      std::ostringstream os;
+      FormatTime(os, std::chrono::system_clock::now());
+      os << "\tDROPPED\t" << (dropped - reported_dropped) << '\n';
+      buffer = std::move(os).str();
+      Flush(buffer);
+      reported_dropped = dropped;
+    }
+
+    lock.lock();
+    if (stop)
+      break;
+
+    if (!should_stop)
+      cond.wait_for(lock, FLUSH_INTERVAL);
+  }
+}
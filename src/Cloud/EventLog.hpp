@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Geo/GeoPoint.hpp"
+#include "net/StaticSocketAddress.hxx"
+#include "io/UniqueFileDescriptor.hxx"
+#include "system/Path.hpp"
+#include "thread/Cond.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/MPSCQueue.hpp"
+#include "thread/Thread.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * A record for the #CloudEventLog.
+ */
+struct CloudEvent {
+  enum class Type : uint8_t {
+    FIX,
+    WAVE,
+    THERMAL,
+  } type;
+
+  std::chrono::system_clock::time_point time;
+
+  StaticSocketAddress address;
+
+  uint64_t key;
+
+  /**
+   * The public client id.
+   */
+  unsigned id;
+
+  /**
+   * FIX: the location; WAVE: the first point; THERMAL: the top
+   * location.
+   */
+  GeoPoint a;
+
+  /**
+   * WAVE: the second point.
+   */
+  GeoPoint b;
+
+  /**
+   * FIX: the altitude (in #top_altitude).
+   */
+  int bottom_altitude, top_altitude;
+
+  double lift;
+};
+
+/**
+ * An asynchronous log of #CloudEvent records.  Push() copies the
+ * event into a lock-free queue and never blocks; a background thread
+ * formats the events as tab-separated lines and writes them to a file
+ * which is rotated when it gets too large, or to stdout.  If the
+ * writer cannot keep up, events are dropped and counted.
+ */
+class CloudEventLog final : Thread {
+  /**
+   * How often does the background thread wake up to drain the
+   * queue?
+   */
+  static constexpr std::chrono::milliseconds FLUSH_INTERVAL{100};
+
+  /**
+   * The number of rotated files to keep: "PATH.1" to "PATH.N".
+   */
+  static constexpr unsigned MAX_ROTATED_FILES = 4;
+
+  MPSCQueue<CloudEvent> queue;
+
+  /**
+   * The log file; nullptr means stdout.
+   */
+  const AllocatedPath path;
+
+  /**
+   * Rotate the file when it exceeds this size.
+   */
+  const uint64_t max_size;
+
+  UniqueFileDescriptor fd;
+
+  /**
+   * The size of the current log file.  Only accessed by the
+   * background thread.
+   */
+  uint64_t size = 0;
+
+  Mutex mutex;
+  Cond cond;
+
+  /**
+   * Protected by #mutex.
+   */
+  bool should_stop = false;
+
+  std::atomic<uint64_t> n_written{0}, n_dropped{0}, n_errors{0};
+
+public:
+  /**
+   * Throws on error.
+   *
+   * @param _path the log file; nullptr writes to stdout
+   * @param capacity the maximum number of queued events; must be a
+   * power of two
+   */
+  CloudEventLog(Path _path, uint64_t _max_size, std::size_t capacity);
+
+  ~CloudEventLog() noexcept {
+    Stop();
+  }
+
+  /**
+   * Throws on error.
+   */
+  void Start() {
+    Thread::Start();
+  }
+
+  /**
+   * Write all pending events and stop the background thread.
+   */
+  void Stop() noexcept;
+
+  /**
+   * Queue an event.  This method is thread-safe and never blocks.
+   */
+  void Push(const CloudEvent &event) noexcept {
+    if (!queue.TryPush(event))
+      n_dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  struct Stats {
+    /**
+     * The number of events written.
+     */
+    uint64_t written;
+
+    /**
+     * The number of events dropped because the queue was full.
+     */
+    uint64_t dropped;
+
+    /**
+     * The number of failed write() calls.
+     */
+    uint64_t errors;
+  };
+
+  [[gnu::pure]]
+  Stats GetStats() const noexcept {
+    return {
+      n_written.load(std::memory_order_relaxed),
+      n_dropped.load(std::memory_order_relaxed),
+      n_errors.load(std::memory_order_relaxed),
+    };
+  }
+
+private:
+  /**
+   * Throws on error.
+   */
+  void Open();
+
+  /**
+   * Throws on error.
+   */
+  void Rotate();
+
+  /**
+   * Write the buffer to the log file and clear it.  Errors are
+   * counted, not thrown.
+   */
+  void Flush(std::string &buffer) noexcept;
+
+  /**
+   * Move all queued events to the buffer.
+   */
+  void Drain(std::string &buffer) noexcept;
+
+  /* virtual methods from class Thread */
+  void Run() noexcept override;
+};
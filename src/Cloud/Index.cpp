@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Index.hpp"
+#include "Client.hpp"
+#include "Geo/Boost/RangeBox.hpp"
+
+#include <boost/geometry/algorithms/distance.hpp>
+#include <boost/geometry/algorithms/intersection.hpp>
+#include <boost/geometry/strategies/strategies.hpp>
+
+CloudIndexEntry::CloudIndexEntry(const CloudClient &client) noexcept
+  :key(client.key), id(client.id),
+   stamp(client.stamp),
+   wants_traffic(client.wants_traffic),
+   wants_thermals(client.wants_thermals),
+   location(client.location), altitude(client.altitude)
+{
+  address = client.address;
+}
+
+CloudIndexSnapshot::CloudIndexSnapshot(std::vector<CloudIndexEntry> &&entries)
+  :rtree(entries.begin(), entries.end())
+{
+}
+
+CloudIndexSnapshot::query_iterator_range
+CloudIndexSnapshot::QueryWithinRange(GeoPoint location, double range) const
+{
+  const auto q = boost::geometry::index::intersects(BoostRangeBox(location, range));
+  return {rtree.qbegin(q), rtree.qend()};
+}
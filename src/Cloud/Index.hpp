@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Geo/Boost/GeoPoint.hpp"
+#include "net/StaticSocketAddress.hxx"
+
+#include <boost/geometry/index/rtree.hpp>
+#include <boost/range/iterator_range_core.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct CloudClient;
+
+/**
+ * A copy of the attributes of a #CloudClient which are needed by
+ * range queries.
+ */
+struct CloudIndexEntry {
+  StaticSocketAddress address;
+
+  uint64_t key;
+
+  unsigned id;
+
+  std::chrono::steady_clock::time_point stamp;
+  std::chrono::steady_clock::time_point wants_traffic, wants_thermals;
+
+  GeoPoint location;
+
+  int altitude;
+
+  explicit CloudIndexEntry(const CloudClient &client) noexcept;
+};
+
+/**
+ * An immutable geospatial index of all clients.  It is built from the
+ * shards of #CloudData and published by #CloudIndex.
+ */
+class CloudIndexSnapshot {
+  struct Indexable {
+    typedef GeoPoint result_type;
+
+    [[gnu::pure]]
+    const GeoPoint &operator()(const CloudIndexEntry &entry) const noexcept {
+      return entry.location;
+    }
+  };
+
+  typedef boost::geometry::index::rtree<CloudIndexEntry,
+                                        boost::geometry::index::rstar<16>,
+                                        Indexable> Tree;
+
+  Tree rtree;
+
+public:
+  CloudIndexSnapshot() = default;
+
+  /**
+   * Build the index with the (faster) packing algorithm.
+   */
+  explicit CloudIndexSnapshot(std::vector<CloudIndexEntry> &&entries);
+
+  std::size_t size() const noexcept {
+    return rtree.size();
+  }
+
+  typedef Tree::const_query_iterator query_iterator;
+  typedef boost::iterator_range<query_iterator> query_iterator_range;
+
+  [[gnu::pure]]
+  query_iterator_range QueryWithinRange(GeoPoint location,
+                                        double range) const;
+};
+
+/**
+ * Publishes the most recent #CloudIndexSnapshot to all workers in the
+ * fashion of RCU: readers obtain a reference to the current snapshot
+ * without blocking the writer, and an old snapshot is freed when its
+ * last reader releases it.
+ *
+ * This class is thread-safe.
+ */
+class CloudIndex {
+  std::atomic<std::shared_ptr<const CloudIndexSnapshot>> current;
+
+public:
+  CloudIndex() noexcept
+    :current(std::make_shared<const CloudIndexSnapshot>()) {}
+
+  std::shared_ptr<const CloudIndexSnapshot> Get() const noexcept {
+    return current.load(std::memory_order_acquire);
+  }
+
+  void Publish(std::shared_ptr<const CloudIndexSnapshot> snapshot) noexcept {
+    current.store(std::move(snapshot), std::memory_order_release);
+  }
+};
@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Journal.hpp"
+#include "Data.hpp"
+#include "Serialiser.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/StringOutputStream.hxx"
+#include "system/FileUtil.hpp"
+#include "system/Error.hxx"
+
+#include <mutex>
+#include <utility>
+
+#include <fcntl.h>
+
+/**
+ * Write records to the journal in chunks of this many.
+ */
+static constexpr std::size_t MAX_CHUNK = 512;
+
+CloudJournal::CloudJournal(CloudData &_data, Path _db_path,
+                           uint64_t _max_size,
+                           std::size_t capacity)
+  :Thread("CloudJournal"),
+   data(_data), queue(capacity),
+   db_path(_db_path),
+   journal_path(GetJournalPath(_db_path)),
+   old_journal_path(GetOldJournalPath(_db_path)),
+   max_size(_max_size) {}
+
+void
+CloudJournal::Start()
+{
+  /* the loaded data may include an old journal left by an
+     interrupted compaction; it must not be deleted before this
+     snapshot is committed */
+  SaveSnapshot();
+  File::Delete(old_journal_path);
+  OpenJournal();
+
+  next_compact = std::chrono::steady_clock::now() + COMPACT_INTERVAL;
+
+  Thread::Start();
+}
+
+void
+CloudJournal::Stop() noexcept
+{
+  if (!IsDefined())
+    return;
+
+  {
+    const std::scoped_lock lock{mutex};
+    should_stop = true;
+  }
+
+  cond.notify_one();
+  Join();
+}
+
+void
+CloudJournal::Close()
+{
+  Stop();
+
+  SaveSnapshot();
+  fd.Close();
+  File::Delete(journal_path);
+}
+
+void
+CloudJournal::RequestCompact() noexcept
+{
+  {
+    const std::scoped_lock lock{mutex};
+    should_compact = true;
+  }
+
+  cond.notify_one();
+}
+
+void
+CloudJournal::OpenJournal()
+{
+  UniqueFileDescriptor new_fd;
+  if (!new_fd.Open(journal_path.c_str(), O_WRONLY|O_CREAT|O_TRUNC|O_APPEND))
+    throw FormatErrno("Failed to create %s", journal_path.c_str());
+
+  StringOutputStream sos;
+
+  {
+    Serialiser s(sos);
+    WriteJournalHeader(s);
+    s.Flush();
+  }
+
+  const auto &header = sos.GetValue();
+  new_fd.FullWrite(header.data(), header.size());
+
+  fd = std::move(new_fd);
+  size = header.size();
+}
+
+void
+CloudJournal::SaveSnapshot()
+{
+  FileOutputStream fos(db_path);
+
+  {
+    Serialiser s(fos);
+    data.Save(s);
+    s.Flush();
+  }
+
+  fos.Commit();
+}
+
+void
+CloudJournal::Compact()
+{
+  /* records queued from now on go to a new journal; the old one is
+     obsolete as soon as the new snapshot has been committed (which
+     may contain thermals from the new journal, too; they are skipped
+     by their serial) */
+  if (!File::Replace(journal_path, old_journal_path))
+    throw FormatErrno("Failed to rename %s", journal_path.c_str());
+
+  OpenJournal();
+  SaveSnapshot();
+  File::Delete(old_journal_path);
+
+  n_compactions.fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+CloudJournal::Drain() noexcept
+{
+  CloudJournalRecord record;
+  bool more = true;
+
+  while (more) {
+    StringOutputStream sos;
+    std::size_t n = 0;
+
+    {
+      Serialiser s(sos);
+      while ((more = queue.TryPop(record))) {
+        record.Save(s);
+        if (++n >= MAX_CHUNK)
+          break;
+      }
+
+      s.Flush();
+    }
+
+    if (n == 0)
+      break;
+
+    const auto &buffer = sos.GetValue();
+
+    try {
+      fd.FullWrite(buffer.data(), buffer.size());
+      size += buffer.size();
+      n_written.fetch_add(n, std::memory_order_relaxed);
+    } catch (...) {
+      n_errors.fetch_add(1, std::memory_order_relaxed);
+
+      /* a partially written record would hide all following records
+         from CloudData::Replay(); the next snapshot includes the
+         lost records, so start over */
+      RequestCompact();
+    }
+  }
+}
+
+void
+CloudJournal::Run() noexcept
+{
+  std::unique_lock lock{mutex};
+
+  while (true) {
+    const bool stop = should_stop;
+    const bool compact = std::exchange(should_compact, false);
+    lock.unlock();
+
+    Drain();
+
+    const auto now = std::chrono::steady_clock::now();
+    if (!stop && (compact || size >= max_size || now >= next_compact)) {
+      try {
+        Compact();
+      } catch (...) {
+        n_errors.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      next_compact = now + COMPACT_INTERVAL;
+    }
+
+    lock.lock();
+    if (stop)
+      break;
+
+    if (!should_stop && !should_compact)
+      cond.wait_for(lock, FLUSH_INTERVAL);
+  }
+}
@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "JournalRecord.hpp"
+#include "io/UniqueFileDescriptor.hxx"
+#include "system/Path.hpp"
+#include "thread/Cond.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/MPSCQueue.hpp"
+#include "thread/Thread.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+class CloudData;
+
+/**
+ * Persists #CloudData incrementally.  Every modification is appended
+ * to a journal file next to the database file; Push() copies the
+ * record into a lock-free queue and never blocks, and a background
+ * thread writes the queued records once per second.
+ *
+ * From time to time (and when the journal gets too large), the
+ * background thread compacts the journal: it moves the journal aside,
+ * starts a new one, writes a new database snapshot and then deletes
+ * the old journal.  CloudData::Load(Path) replays both journal files
+ * after loading the snapshot.  Records may be in the snapshot and in
+ * a journal at the same time; client records are complete states,
+ * and thermal records are skipped by their serial, so replaying them
+ * twice does no harm.
+ */
+class CloudJournal final : Thread {
+  /**
+   * How often does the background thread wake up to write queued
+   * records?
+   */
+  static constexpr std::chrono::seconds FLUSH_INTERVAL{1};
+
+  /**
+   * How often is the journal compacted?
+   */
+  static constexpr std::chrono::minutes COMPACT_INTERVAL{10};
+
+  CloudData &data;
+
+  MPSCQueue<CloudJournalRecord> queue;
+
+  const AllocatedPath db_path, journal_path, old_journal_path;
+
+  /**
+   * Compact the journal when it exceeds this size.
+   */
+  const uint64_t max_size;
+
+  /**
+   * The journal file.  Only accessed by the background thread.
+   */
+  UniqueFileDescriptor fd;
+
+  /**
+   * The size of the journal file.  Only accessed by the background
+   * thread.
+   */
+  uint64_t size = 0;
+
+  std::chrono::steady_clock::time_point next_compact;
+
+  Mutex mutex;
+  Cond cond;
+
+  /**
+   * Protected by #mutex.
+   */
+  bool should_stop = false, should_compact = false;
+
+  std::atomic<uint64_t> n_written{0}, n_dropped{0}, n_errors{0};
+  std::atomic<uint64_t> n_compactions{0};
+
+public:
+  /**
+   * @param capacity the maximum number of queued records; must be a
+   * power of two
+   */
+  CloudJournal(CloudData &_data, Path _db_path, uint64_t _max_size,
+               std::size_t capacity);
+
+  ~CloudJournal() noexcept {
+    Stop();
+  }
+
+  /**
+   * Write a snapshot of the (just loaded) #CloudData, start a new
+   * journal and start the background thread.  Must be called before
+   * other threads modify the #CloudData.
+   *
+   * Throws on error.
+   */
+  void Start();
+
+  /**
+   * Write all pending records and stop the background thread.
+   */
+  void Stop() noexcept;
+
+  /**
+   * Stop the background thread, write a final snapshot and delete
+   * the journal.  Must be called after all other threads have
+   * stopped modifying the #CloudData.
+   *
+   * Throws on error.
+   */
+  void Close();
+
+  /**
+   * Queue a record.  This method is thread-safe and never blocks.
+   */
+  void Push(const CloudJournalRecord &record) noexcept {
+    if (!queue.TryPush(record))
+      n_dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Ask the background thread to compact the journal as soon as
+   * possible.  This method is thread-safe.
+   */
+  void RequestCompact() noexcept;
+
+  struct Stats {
+    /**
+     * The number of records written.
+     */
+    uint64_t written;
+
+    /**
+     * The number of records dropped because the queue was full.
+     */
+    uint64_t dropped;
+
+    /**
+     * The number of failed writes and compactions.
+     */
+    uint64_t errors;
+
+    uint64_t compactions;
+  };
+
+  [[gnu::pure]]
+  Stats GetStats() const noexcept {
+    return {
+      n_written.load(std::memory_order_relaxed),
+      n_dropped.load(std::memory_order_relaxed),
+      n_errors.load(std::memory_order_relaxed),
+      n_compactions.load(std::memory_order_relaxed),
+    };
+  }
+
+private:
+  /**
+   * Create a new (empty) journal file, replacing #fd.
+   *
+   * Throws on error.
+   */
+  void OpenJournal();
+
+  /**
+   * Throws on error.
+   */
+  void SaveSnapshot();
+
+  /**
+   * Throws on error.
+   */
+  void Compact();
+
+  /**
+   * Write all queued records to the journal.  Errors are counted,
+   * not thrown.
+   */
+  void Drain() noexcept;
+
+  /* virtual methods from class Thread */
+  void Run() noexcept override;
+};
@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "JournalRecord.hpp"
+#include "Serialiser.hpp"
+
+#include <stdexcept>
+
+static constexpr uint32_t JOURNAL_MAGIC = 0x5753f610;
+static constexpr uint32_t JOURNAL_VERSION = 2;
+
+static void
+WriteGeoPoint(Serialiser &s, const AGeoPoint &p)
+{
+  s.WriteDouble(p.latitude.Degrees());
+  s.WriteDouble(p.longitude.Degrees());
+  s.Write32(int32_t(p.altitude));
+}
+
+static AGeoPoint
+ReadGeoPoint(Deserialiser &s)
+{
+  const auto latitude = Angle::Degrees(s.ReadDouble());
+  const auto longitude = Angle::Degrees(s.ReadDouble());
+  const int altitude = int32_t(s.Read32());
+  return AGeoPoint(GeoPoint(longitude, latitude), altitude);
+}
+
+/**
+ * Write the raw "sockaddr".  Unlike the #CloudClient serialisation,
+ * this avoids getnameinfo() and getaddrinfo(), but the file can only
+ * be read on the same kind of host.
+ */
+static void
+WriteAddress(Serialiser &s, SocketAddress address)
+{
+  s.Write8(address.GetSize());
+  s.Write(address.GetAddress(), address.GetSize());
+}
+
+static void
+ReadAddress(Deserialiser &s, StaticSocketAddress &address)
+{
+  const std::size_t size = s.Read8();
+  if (size == 0 || size > address.GetCapacity())
+    throw std::runtime_error("Malformed address");
+
+  s.ReadFull({(std::byte *)(struct sockaddr *)address, size});
+  address.SetSize(size);
+}
+
+void
+CloudJournalRecord::Save(Serialiser &s) const
+{
+  s.Write8(uint8_t(type));
+  s.Write64(key);
+  s << time;
+
+  switch (type) {
+  case Type::CLIENT:
+    s.Write32(id);
+    WriteAddress(s, address);
+    WriteGeoPoint(s, a);
+    break;
+
+  case Type::THERMAL:
+    WriteGeoPoint(s, a);
+    WriteGeoPoint(s, b);
+    s.WriteDouble(lift);
+    s.Write64(serial);
+    break;
+  }
+}
+
+CloudJournalRecord
+CloudJournalRecord::Load(Deserialiser &s)
+{
+  CloudJournalRecord r;
+  r.type = Type(s.Read8());
+  r.key = s.Read64();
+  s >> r.time;
+
+  switch (r.type) {
+  case Type::CLIENT:
+    r.id = s.Read32();
+    ReadAddress(s, r.address);
+    r.a = ReadGeoPoint(s);
+    return r;
+
+  case Type::THERMAL:
+    r.a = ReadGeoPoint(s);
+    r.b = ReadGeoPoint(s);
+    r.lift = s.ReadDouble();
+    r.serial = s.Read64();
+    return r;
+  }
+
+  throw std::runtime_error("Malformed journal record");
+}
+
+void
+WriteJournalHeader(Serialiser &s)
+{
+  s.Write32(JOURNAL_MAGIC);
+  s.Write32(JOURNAL_VERSION);
+}
+
+void
+ReadJournalHeader(Deserialiser &s)
+{
+  if (s.Read32() != JOURNAL_MAGIC)
+    throw std::runtime_error("Bad journal magic");
+
+  if (s.Read32() != JOURNAL_VERSION)
+    throw std::runtime_error("Bad journal version");
+}
+
+AllocatedPath
+GetJournalPath(Path db_path) noexcept
+{
+  return db_path + ".journal";
+}
+
+AllocatedPath
+GetOldJournalPath(Path db_path) noexcept
+{
+  return db_path + ".journal.old";
+}
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Geo/GeoPoint.hpp"
+#include "net/StaticSocketAddress.hxx"
+#include "system/Path.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+class Serialiser;
+class Deserialiser;
+
+/**
+ * A record in the #CloudJournal: the new state of one client or a new
+ * thermal.  Client records are not deltas but complete states, so
+ * replaying only the last record of each client is enough.
+ */
+struct CloudJournalRecord {
+  enum class Type : uint8_t {
+    CLIENT = 1,
+    THERMAL = 2,
+  } type;
+
+  uint64_t key;
+
+  /**
+   * CLIENT: #CloudClient::stamp; THERMAL: #CloudThermal::time.
+   */
+  std::chrono::steady_clock::time_point time;
+
+  /**
+   * CLIENT: the public client id.
+   */
+  unsigned id;
+
+  /**
+   * CLIENT: the last known IP address.
+   */
+  StaticSocketAddress address;
+
+  /**
+   * CLIENT: the location and altitude (in #a); THERMAL: the bottom
+   * and top location.
+   */
+  AGeoPoint a, b;
+
+  /**
+   * THERMAL: the lift [m/s].
+   */
+  double lift;
+
+  /**
+   * THERMAL: #CloudThermal::serial.
+   */
+  uint64_t serial;
+
+  void Save(Serialiser &s) const;
+
+  /**
+   * Throws on error.
+   */
+  static CloudJournalRecord Load(Deserialiser &s);
+};
+
+/**
+ * Write the header of a new journal file.
+ */
+void
+WriteJournalHeader(Serialiser &s);
+
+/**
+ * Throws on error.
+ */
+void
+ReadJournalHeader(Deserialiser &s);
+
+/**
+ * The journal file which belongs to the given database file.
+ */
+[[gnu::pure]]
+AllocatedPath
+GetJournalPath(Path db_path) noexcept;
+
+/**
+ * The journal file which is being compacted into the given database
+ * file.  It exists only while a compaction is in progress (or after
+ * one was interrupted).
+ */
+[[gnu::pure]]
+AllocatedPath
+GetOldJournalPath(Path db_path) noexcept;
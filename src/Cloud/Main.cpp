@@ -3,17 +3,19 @@
 
 #include "Data.hpp"
 #include "Dump.hpp"
+#include "EventLog.hpp"
+#include "Journal.hpp"
 #include "Sender.hpp"
-#include "Serialiser.hpp"
 #include "Tracking/SkyLines/Server.hpp"
 #include "Tracking/SkyLines/Protocol.hpp"
 #include "util/ByteOrder.hxx"
 #include "event/Loop.hxx"
 #include "event/CoarseTimerEvent.hxx"
+#include "event/FineTimerEvent.hxx"
 #include "event/SignalMonitor.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Thread.hpp"
 #include "net/IPv4Address.hxx"
-#include "io/FileOutputStream.hxx"
-#include "io/FileReader.hxx"
 #include "util/PrintException.hxx"
 #include "util/Exception.hxx"
 #include "util/Compiler.h"
@@ -22,8 +24,11 @@
 #include <array>
 #include <iostream>
 #include <iomanip>
+#include <list>
+#include <mutex>
 
 #include <signal.h>
+#include <stdlib.h>
 
 // TODO: review these settings
 static constexpr double TRAFFIC_RANGE = 50000;
@@ -34,58 +39,118 @@ static constexpr std::chrono::steady_clock::duration MAX_THERMAL_AGE = std::chro
 
 static constexpr std::chrono::steady_clock::duration REQUEST_EXPIRY = std::chrono::minutes(5);
 
+/**
+ * How often is the #CloudIndex updated?  This is the maximum delay
+ * until a new fix or request is seen by range queries.
+ */
+static constexpr std::chrono::steady_clock::duration INDEX_INTERVAL = std::chrono::milliseconds(250);
+
+static constexpr unsigned MAX_WORKERS = 64;
+
+/**
+ * The number of #CloudShard instances per worker thread.  More shards
+ * mean less lock contention.
+ */
+static constexpr unsigned SHARDS_PER_WORKER = 4;
+
+/**
+ * The maximum number of events waiting for the #CloudEventLog thread.
+ */
+static constexpr std::size_t EVENT_LOG_CAPACITY = 16384;
+
+static constexpr uint64_t EVENT_LOG_MAX_SIZE = 64 * 1024 * 1024;
+
+/**
+ * The maximum number of records waiting for the #CloudJournal
+ * thread.
+ */
+static constexpr std::size_t JOURNAL_CAPACITY = 65536;
+
+static constexpr uint64_t JOURNAL_MAX_SIZE = 64 * 1024 * 1024;
+
 using std::cout;
 using std::cerr;
 using std::endl;
 
+/**
+ * Serialises diagnostic output from all worker threads.
+ */
+static Mutex log_mutex;
+
+/**
+ * Handles the requests received by one socket.  With several
+ * workers, each one runs in its own thread with its own SO_REUSEPORT
+ * socket, and all of them share one #CloudData instance.
+ */
 class CloudServer final
-  : public SkyLinesTracking::Server, CloudData
+  : public SkyLinesTracking::Server
 {
-  const AllocatedPath db_path;
-
-  CoarseTimerEvent save_timer, expire_timer;
+  CloudData &data;
 
-public:
-  CloudServer(AllocatedPath &&_db_path, EventLoop &event_loop,
-              SocketAddress bind_address)
-    :SkyLinesTracking::Server(event_loop, bind_address),
-     db_path(std::move(_db_path)),
-     save_timer(event_loop, BIND_THIS_METHOD(OnSaveTimer)),
-     expire_timer(event_loop, BIND_THIS_METHOD(OnExpireTimer))
-  {
-#ifndef _WIN32
-    SignalMonitorRegister(SIGINT, BIND_THIS_METHOD(OnQuitSignal));
-    SignalMonitorRegister(SIGTERM, BIND_THIS_METHOD(OnQuitSignal));
-    SignalMonitorRegister(SIGQUIT, BIND_THIS_METHOD(OnQuitSignal));
+  CloudEventLog &event_log;
 
-    SignalMonitorRegister(SIGHUP, BIND_THIS_METHOD(OnReloadSignal));
-    SignalMonitorRegister(SIGUSR1, BIND_THIS_METHOD(OnDumpSignal));
-#endif
+  CloudJournal &journal;
 
-    ScheduleSave();
-  }
+  /**
+   * The #EventLoop of the main thread; it is stopped on fatal
+   * errors.
+   */
+  EventLoop &main_loop;
 
-  void Load();
-  void Save();
+public:
+  CloudServer(EventLoop &event_loop, SocketAddress bind_address,
+              bool reuse_port,
+              CloudData &_data, CloudEventLog &_event_log,
+              CloudJournal &_journal,
+              EventLoop &_main_loop)
+    :SkyLinesTracking::Server(event_loop, bind_address, reuse_port),
+     data(_data), event_log(_event_log), journal(_journal),
+     main_loop(_main_loop) {}
 
 private:
-  void OnSaveTimer() noexcept {
-    Save();
-    ScheduleSave();
-  }
-
-  void ScheduleSave() {
-    save_timer.Schedule(std::chrono::minutes(1));
+  /**
+   * Append the current state of the client to the journal.  The
+   * caller must hold the shard lock.
+   */
+  void JournalClient(const CloudClient &client) noexcept {
+    CloudJournalRecord r;
+    r.type = CloudJournalRecord::Type::CLIENT;
+    r.key = client.key;
+    r.time = client.stamp;
+    r.id = client.id;
+    r.address = client.address;
+    r.a = AGeoPoint(client.location, client.altitude);
+    journal.Push(r);
   }
 
-  void OnExpireTimer() noexcept {
-    clients.Expire(GetEventLoop().SteadyNow() - std::chrono::minutes(10));
-    if (!clients.empty())
-      ScheduleExpire();
+  void JournalThermal(const CloudThermal &thermal) noexcept {
+    CloudJournalRecord r;
+    r.type = CloudJournalRecord::Type::THERMAL;
+    r.key = thermal.client_key;
+    r.time = thermal.time;
+    r.a = thermal.bottom_location;
+    r.b = thermal.top_location;
+    r.lift = thermal.lift;
+    r.serial = thermal.serial;
+    journal.Push(r);
   }
 
-  void ScheduleExpire() {
-    expire_timer.Schedule(std::chrono::minutes(5));
+  void LogEvent(CloudEvent::Type type, const CloudClient &client,
+                GeoPoint a, GeoPoint b,
+                int bottom_altitude, int top_altitude,
+                double lift) noexcept {
+    CloudEvent e;
+    e.type = type;
+    e.time = std::chrono::system_clock::now();
+    e.address = client.address;
+    e.key = client.key;
+    e.id = client.id;
+    e.a = a;
+    e.b = b;
+    e.bottom_altitude = bottom_altitude;
+    e.top_altitude = top_altitude;
+    e.lift = lift;
+    event_log.Push(e);
   }
 
 protected:
@@ -116,14 +181,169 @@ protected:
 
   void OnSendError(SocketAddress address,
                    std::exception_ptr e) noexcept override {
+    const std::scoped_lock lock{log_mutex};
     cerr << "Failed to send to " << address
          << ": " << GetFullMessage(e)
          << endl;
   }
 
   void OnError(std::exception_ptr e) override {
-    cerr << GetFullMessage(e) << endl;
-    GetEventLoop().Break();
+    {
+      const std::scoped_lock lock{log_mutex};
+      cerr << GetFullMessage(e) << endl;
+    }
+
+    main_loop.InjectBreak();
+  }
+};
+
+/**
+ * An additional worker thread with its own #EventLoop and
+ * #CloudServer.
+ */
+class CloudWorker final : Thread {
+  EventLoop event_loop{ThreadId::Null()};
+
+  CloudServer server;
+
+public:
+  CloudWorker(SocketAddress bind_address,
+              CloudData &data, CloudEventLog &event_log,
+              CloudJournal &journal,
+              EventLoop &main_loop)
+    :Thread("CloudWorker"),
+     server(event_loop, bind_address, true,
+            data, event_log, journal, main_loop) {}
+
+  /**
+   * Throws on error.
+   */
+  void Start() {
+    event_loop.SetAlive(true);
+    Thread::Start();
+  }
+
+  void Stop() noexcept {
+    if (!IsDefined())
+      /* not started (Start() failed for this or an earlier
+         worker) */
+      return;
+
+    event_loop.InjectBreak();
+    Join();
+    event_loop.SetAlive(false);
+  }
+
+private:
+  /* virtual methods from class Thread */
+  void Run() noexcept override {
+    event_loop.Run();
+  }
+};
+
+/**
+ * Owns the #CloudData and the workers, and runs the periodic tasks in
+ * the main thread.  The first #CloudServer runs in the main thread,
+ * too.
+ */
+class CloudMain final {
+  const AllocatedPath db_path;
+
+  CloudData data;
+
+  CloudEventLog event_log;
+
+  CloudJournal journal;
+
+  CloudServer server;
+
+  std::list<CloudWorker> workers;
+
+  CoarseTimerEvent expire_timer;
+
+  FineTimerEvent index_timer;
+
+public:
+  CloudMain(AllocatedPath &&_db_path, EventLoop &event_loop,
+            SocketAddress bind_address, unsigned n_workers,
+            Path event_log_path)
+    :db_path(std::move(_db_path)),
+     data(n_workers * SHARDS_PER_WORKER),
+     event_log(event_log_path, EVENT_LOG_MAX_SIZE, EVENT_LOG_CAPACITY),
+     journal(data, db_path, JOURNAL_MAX_SIZE, JOURNAL_CAPACITY),
+     server(event_loop, bind_address, n_workers > 1,
+            data, event_log, journal, event_loop),
+     expire_timer(event_loop, BIND_THIS_METHOD(OnExpireTimer)),
+     index_timer(event_loop, BIND_THIS_METHOD(OnIndexTimer))
+  {
+    for (unsigned i = 1; i < n_workers; ++i)
+      workers.emplace_back(bind_address, data, event_log, journal,
+                           event_loop);
+
+#ifndef _WIN32
+    SignalMonitorRegister(SIGINT, BIND_THIS_METHOD(OnQuitSignal));
+    SignalMonitorRegister(SIGTERM, BIND_THIS_METHOD(OnQuitSignal));
+    SignalMonitorRegister(SIGQUIT, BIND_THIS_METHOD(OnQuitSignal));
+
+    SignalMonitorRegister(SIGHUP, BIND_THIS_METHOD(OnReloadSignal));
+    SignalMonitorRegister(SIGUSR1, BIND_THIS_METHOD(OnDumpSignal));
+#endif
+
+    ScheduleExpire();
+    ScheduleIndex();
+  }
+
+  ~CloudMain() noexcept {
+    StopWorkers();
+  }
+
+  auto &GetEventLoop() const noexcept {
+    return server.GetEventLoop();
+  }
+
+  /**
+   * Start the journal, the event log and the worker threads.
+   *
+   * Throws on error.
+   */
+  void Start() {
+    journal.Start();
+    event_log.Start();
+
+    for (auto &i : workers)
+      i.Start();
+  }
+
+  void StopWorkers() noexcept {
+    for (auto &i : workers)
+      i.Stop();
+    workers.clear();
+  }
+
+  void Load();
+
+  /**
+   * Write a final snapshot.  Call after StopWorkers().
+   */
+  void Save();
+
+private:
+  void OnExpireTimer() noexcept {
+    data.ExpireClients(GetEventLoop().SteadyNow() - std::chrono::minutes(10));
+    ScheduleExpire();
+  }
+
+  void ScheduleExpire() {
+    expire_timer.Schedule(std::chrono::minutes(5));
+  }
+
+  void OnIndexTimer() noexcept {
+    data.UpdateIndex();
+    ScheduleIndex();
+  }
+
+  void ScheduleIndex() {
+    index_timer.Schedule(INDEX_INTERVAL);
   }
 
 #ifndef _WIN32
@@ -132,11 +352,22 @@ protected:
   }
 
   void OnReloadSignal() noexcept {
-    Save();
+    journal.RequestCompact();
   }
 
   void OnDumpSignal() noexcept {
-    DumpClients();
+    data.DumpClients();
+
+    const auto stats = event_log.GetStats();
+    const auto journal_stats = journal.GetStats();
+    const std::scoped_lock lock{log_mutex};
+    cout << "Event log: " << stats.written << " written, "
+         << stats.dropped << " dropped, "
+         << stats.errors << " errors" << endl;
+    cout << "Journal: " << journal_stats.written << " written, "
+         << journal_stats.dropped << " dropped, "
+         << journal_stats.errors << " errors, "
+         << journal_stats.compactions << " compactions" << endl;
   }
 #endif
 };
@@ -148,44 +379,53 @@ CloudServer::OnFix(const Client &c,
 {
   (void)time_of_day; // TODO: use this parameter
 
-  CloudClient *client;
-  if (location.IsValid()) {
-    bool was_empty = clients.empty();
+  auto &shard = data.GetShard(c.key);
 
-    client = &clients.Make(c.address, c.key, location, altitude);
+  if (!location.IsValid()) {
+    const std::scoped_lock lock{shard.mutex};
+    auto *client = shard.clients.Find(c.key);
+    if (client != nullptr) {
+      shard.clients.Refresh(*client, c.address);
+      shard.modified = true;
+      JournalClient(*client);
+    }
 
-    cout << "FIX\t"
-         << client->address << '\t'
-         << std::hex << client->key << std::dec << '\t'
-         << client->id << '\t'
-         << client->location << '\t'
-         << client->altitude << 'm'
-         << endl;
+    return;
+  }
 
-    if (was_empty)
-      ScheduleExpire();
-  } else {
-    client = clients.Find(c.key);
-    if (client != nullptr)
-      clients.Refresh(*client, c.address);
+  unsigned id;
+
+  {
+    const std::scoped_lock lock{shard.mutex};
+    const auto &client = shard.clients.Make(c.address, c.key,
+                                            location, altitude);
+    shard.modified = true;
+    id = client.id;
+
+    JournalClient(client);
+
+    LogEvent(CloudEvent::Type::FIX, client,
+             client.location, GeoPoint::Invalid(),
+             0, client.altitude, 0);
   }
 
   /* send this new traffic location to all interested clients
      immediately */
   const auto now = std::chrono::steady_clock::now();
-  for (const auto &i : clients.QueryWithinRange(location, TRAFFIC_RANGE)) {
-    if (i->key == c.key)
+  const auto index = data.index.Get();
+  for (const auto &i : index->QueryWithinRange(location, TRAFFIC_RANGE)) {
+    if (i.key == c.key)
       /* ignore this client's own submissions - he knows them
          already */
       continue;
 
-    if (now > i->wants_traffic)
+    if (now > i.wants_traffic)
       /* not interested (anymore) */
       continue;
 
-    TrafficResponseSender s(*this, i->address, i->key);
-    s.Add(client->id, 0, //TODO: time?
-          client->location, client->altitude);
+    TrafficResponseSender s(*this, i.address, i.key);
+    s.Add(id, 0, //TODO: time?
+          location, altitude);
     s.Flush();
   }
 }
@@ -197,32 +437,41 @@ CloudServer::OnTrafficRequest(const Client &c, bool near)
     /* "near" is the only selection flag we know */
     return;
 
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't send our data to clients who didn't sent anything to
-       us yet */
-    return;
-
   const auto now = std::chrono::steady_clock::now();
 
-  client->wants_traffic = now + REQUEST_EXPIRY;
+  ::GeoPoint location;
+
+  {
+    auto &shard = data.GetShard(c.key);
+    const std::scoped_lock lock{shard.mutex};
+    auto *client = shard.clients.Find(c.key);
+    if (client == nullptr)
+      /* we don't send our data to clients who didn't sent anything to
+         us yet */
+      return;
+
+    client->wants_traffic = now + REQUEST_EXPIRY;
+    shard.modified = true;
+    location = client->location;
+  }
 
   const auto min_stamp = now - MAX_TRAFFIC_AGE;
 
   TrafficResponseSender s(*this, c.address, c.key);
 
   unsigned n = 0;
-  for (const auto &traffic : clients.QueryWithinRange(client->location,
-                                                      TRAFFIC_RANGE)) {
-    if (traffic.get() == client)
+  const auto index = data.index.Get();
+  for (const auto &traffic : index->QueryWithinRange(location,
+                                                     TRAFFIC_RANGE)) {
+    if (traffic.key == c.key)
       continue;
 
-    if (traffic->stamp < min_stamp)
+    if (traffic.stamp < min_stamp)
       /* don't send stale traffic, it's probably not there anymore */
       continue;
 
-    s.Add(traffic->id, 0, //TODO: time?
-          traffic->location, traffic->altitude);
+    s.Add(traffic.id, 0, //TODO: time?
+          traffic.location, traffic.altitude);
 
     if (++n > 64)
       break;
@@ -239,21 +488,16 @@ CloudServer::OnWaveSubmit(const Client &c,
                           int top_altitude,
                           double lift)
 {
-  auto *client = clients.Find(c.key);
+  auto &shard = data.GetShard(c.key);
+  const std::scoped_lock lock{shard.mutex};
+  auto *client = shard.clients.Find(c.key);
   if (client == nullptr)
     /* we don't trust the client if he didn't sent anything to us
        yet */
     return;
 
-  cout << "WAVE\t"
-       << client->address << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
-       << a << '\t'
-       << b << '\t'
-       << bottom_altitude << '-' << top_altitude << "m\t"
-       << lift << "m/s"
-       << endl;
+  LogEvent(CloudEvent::Type::WAVE, *client,
+           a, b, bottom_altitude, top_altitude, lift);
 }
 
 void
@@ -265,42 +509,49 @@ CloudServer::OnThermalSubmit(const Client &c,
                              int top_altitude,
                              double lift)
 {
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't trust the client if he didn't sent anything to us
-       yet */
-    return;
+  {
+    auto &shard = data.GetShard(c.key);
+    const std::scoped_lock lock{shard.mutex};
+    auto *client = shard.clients.Find(c.key);
+    if (client == nullptr)
+      /* we don't trust the client if he didn't sent anything to us
+         yet */
+      return;
+
+    LogEvent(CloudEvent::Type::THERMAL, *client,
+             top_location, GeoPoint::Invalid(),
+             bottom_altitude, top_altitude, lift);
+  }
 
-  cout << "THERMAL\t"
-       << client->address << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
-       << top_location << '\t'
-       << bottom_altitude << '-' << top_altitude << "m\t"
-       << lift << "m/s"
-       << endl;
-
-  const auto &thermal =
-    thermals.Make(c.key,
-                  AGeoPoint(bottom_location, bottom_altitude),
-                  AGeoPoint(top_location, top_altitude),
-                  lift);
+  SkyLinesTracking::Thermal packed;
+
+  {
+    const std::scoped_lock lock{data.thermal_mutex};
+    const auto &thermal =
+      data.thermals.Make(c.key,
+                         AGeoPoint(bottom_location, bottom_altitude),
+                         AGeoPoint(top_location, top_altitude),
+                         lift);
+    packed = thermal.Pack();
+    JournalThermal(thermal);
+  }
 
   /* send this new thermal to all interested clients immediately */
   const auto now = std::chrono::steady_clock::now();
-  for (const auto &i : clients.QueryWithinRange(bottom_location,
-                                                THERMAL_RANGE)) {
-    if (i->key == c.key)
+  const auto index = data.index.Get();
+  for (const auto &i : index->QueryWithinRange(bottom_location,
+                                               THERMAL_RANGE)) {
+    if (i.key == c.key)
       /* ignore this client's own submissions - he knows them
          already */
       continue;
 
-    if (now > i->wants_thermals)
+    if (now > i.wants_thermals)
       /* not interested (anymore) */
       continue;
 
-    ThermalResponseSender s(*this, i->address, i->key);
-    s.Add(thermal.Pack());
+    ThermalResponseSender s(*this, i.address, i.key);
+    s.Add(packed);
     s.Flush();
   }
 }
@@ -308,23 +559,33 @@ CloudServer::OnThermalSubmit(const Client &c,
 void
 CloudServer::OnThermalRequest(const Client &c)
 {
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't send our data to clients who didn't sent anything to
-       us yet */
-    return;
-
   const auto now = std::chrono::steady_clock::now();
 
-  client->wants_thermals = now + REQUEST_EXPIRY;
+  ::GeoPoint location;
+
+  {
+    auto &shard = data.GetShard(c.key);
+    const std::scoped_lock lock{shard.mutex};
+    auto *client = shard.clients.Find(c.key);
+    if (client == nullptr)
+      /* we don't send our data to clients who didn't sent anything to
+         us yet */
+      return;
+
+    client->wants_thermals = now + REQUEST_EXPIRY;
+    shard.modified = true;
+    location = client->location;
+  }
 
   const auto min_time = now - MAX_THERMAL_AGE;
 
   ThermalResponseSender s(*this, c.address, c.key);
 
   unsigned n = 0;
-  for (const auto &thermal : thermals.QueryWithinRange(client->location,
-                                                       THERMAL_RANGE)) {
+
+  const std::scoped_lock lock{data.thermal_mutex};
+  for (const auto &thermal : data.thermals.QueryWithinRange(location,
+                                                            THERMAL_RANGE)) {
     if (thermal->client_key == c.key)
       /* ignore this client's own submissions - he knows them
          already */
@@ -344,45 +605,53 @@ CloudServer::OnThermalRequest(const Client &c)
 }
 
 void
-CloudServer::Load()
+CloudMain::Load()
 {
-  FileReader fr(db_path);
-  Deserialiser s(fr);
-  CloudData::Load(s);
+  data.Load(db_path);
 }
 
 void
-CloudServer::Save()
+CloudMain::Save()
 {
-  cout << "Saving data to " << db_path.c_str() << endl;
-
-  FileOutputStream fos(db_path);
-
   {
-    Serialiser s(fos);
-    CloudData::Save(s);
-    s.Flush();
+    const std::scoped_lock lock{log_mutex};
+    cout << "Saving data to " << db_path.c_str() << endl;
   }
 
-  fos.Commit();
+  journal.Close();
 }
 
 int
 main(int argc, char **argv)
 try {
-  if (argc != 2) {
-    cerr << "Usage: " << argv[0] << " DBPATH" << endl;
+  if (argc < 2 || argc > 4) {
+    cerr << "Usage: " << argv[0] << " DBPATH [WORKERS [LOGPATH]]" << endl;
     return EXIT_FAILURE;
   }
 
   const Path db_path(argv[1]);
 
+  unsigned n_workers = 1;
+  if (argc >= 3) {
+    char *endptr;
+    n_workers = strtoul(argv[2], &endptr, 10);
+    if (endptr == argv[2] || *endptr != 0 ||
+        n_workers < 1 || n_workers > MAX_WORKERS) {
+      cerr << "Invalid number of workers" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   EventLoop event_loop;
   SignalMonitorInit(event_loop);
   AtScopeExit() { SignalMonitorFinish(); };
 
-  CloudServer server(db_path, event_loop,
-                     IPv4Address(CloudServer::GetDefaultPort()));
+  /* without LOGPATH, events are written to stdout */
+  const Path event_log_path = argc >= 4 ? Path(argv[3]) : nullptr;
+
+  CloudMain server(db_path, event_loop,
+                   IPv4Address(CloudServer::GetDefaultPort()),
+                   n_workers, event_log_path);
 
   try {
     server.Load();
@@ -391,8 +660,11 @@ try {
     PrintException(e);
   }
 
+  server.Start();
+
   event_loop.Run();
 
+  server.StopWorkers();
   server.Save();
 
   return EXIT_SUCCESS;
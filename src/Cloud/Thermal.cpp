@@ -12,6 +12,8 @@
 #include <boost/geometry/algorithms/intersection.hpp>
 #include <boost/geometry/strategies/strategies.hpp>
 
+#include <algorithm>
+
 CloudThermalContainer::CloudThermalContainer()
 {
 }
@@ -36,6 +38,7 @@ CloudThermalContainer::Make(uint64_t client_key,
 {
   auto thermal = std::make_shared<CloudThermal>(client_key, bottom_location,
                                                 top_location, lift);
+  thermal->serial = next_serial++;
   Insert(*thermal);
   return *thermal;
 }
@@ -47,6 +50,13 @@ CloudThermalContainer::Insert(CloudThermal &thermal)
   rtree.insert(thermal.shared_from_this());
 }
 
+void
+CloudThermalContainer::InsertReplayed(CloudThermal &thermal)
+{
+  Insert(thermal);
+  next_serial = std::max(next_serial, thermal.serial + 1);
+}
+
 void
 CloudThermalContainer::Remove(CloudThermal &thermal)
 {
@@ -82,16 +92,17 @@ CloudThermal::Pack() const
 void
 CloudThermal::Save(Serialiser &s) const
 {
-  s.Write8(1);
+  s.Write8(2);
   s.Write64(client_key);
   s << time;
   s.WriteT(Pack());
+  s.Write64(serial);
 }
 
 CloudThermal
 CloudThermal::Load(Deserialiser &s)
 {
-  s.Read8();
+  const unsigned version = s.Read8();
   const unsigned client_key = s.Read64();
 
   std::chrono::steady_clock::time_point time;
@@ -107,13 +118,18 @@ CloudThermal::Load(Deserialiser &s)
                                  FromBE16(t.top_altitude)),
                        FromBE16(t.lift) / 256.);
   thermal.time = time;
+
+  if (version >= 2)
+    thermal.serial = s.Read64();
+
   return thermal;
 }
 
 void
 CloudThermalContainer::Save(Serialiser &s) const
 {
-  s.Write8(1);
+  s.Write8(2);
+  s.Write64(next_serial);
 
   for (const auto &thermal : list) {
     s.Write8(1);
@@ -127,7 +143,8 @@ CloudThermalContainer::Save(Serialiser &s) const
 void
 CloudThermalContainer::Load(Deserialiser &s)
 {
-  s.Read8();
+  if (s.Read8() >= 2)
+    next_serial = s.Read64();
 
   while (s.Read8() != 0) {
     auto thermal = std::make_shared<CloudThermal>(CloudThermal::Load(s));
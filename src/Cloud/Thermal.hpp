@@ -24,6 +24,13 @@ struct CloudThermal
 {
   const uint64_t client_key;
 
+  /**
+   * A number assigned by CloudThermalContainer::Make(), increasing
+   * with each new thermal.  CloudData::Replay() uses it to skip
+   * journal records which are already in the snapshot.
+   */
+  uint64_t serial = 0;
+
   /**
    * Time when this thermal was measured or received.  (Montonic
    * server-side clock.)
@@ -83,6 +90,11 @@ class CloudThermalContainer {
    */
   List list;
 
+  /**
+   * The #CloudThermal::serial of the next Make() call.
+   */
+  uint64_t next_serial = 1;
+
 public:
   CloudThermalContainer();
   ~CloudThermalContainer();
@@ -115,6 +127,20 @@ public:
 
   void Insert(CloudThermal &client);
 
+  /**
+   * All thermals created so far (including expired ones) have a
+   * #CloudThermal::serial below this value.
+   */
+  uint64_t GetNextSerial() const noexcept {
+    return next_serial;
+  }
+
+  /**
+   * Insert a #CloudThermal which was loaded from a journal, and make
+   * sure that Make() will not reuse its serial.
+   */
+  void InsertReplayed(CloudThermal &thermal);
+
   /**
    * Remove a #CloudThermal and its data.  Be careful - the given reference
    * is invalidated, unless the caller holds another #CloudThermalPtr.
@@ -2,9 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "Data.hpp"
-#include "Serialiser.hpp"
 #include "io/FileOutputStream.hxx"
-#include "io/FileReader.hxx"
 #include "io/BufferedOutputStream.hxx"
 #include "util/PrintException.hxx"
 #include "util/Compiler.h"
@@ -50,7 +48,8 @@ ToKML(BufferedOutputStream &os, const CloudClient &client)
 }
 
 static void
-ToKML(BufferedOutputStream &os, const CloudClientContainer &clients)
+ToKML(BufferedOutputStream &os,
+      const std::vector<std::unique_ptr<CloudShard>> &shards)
 {
   os.Write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
            "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
@@ -63,9 +62,10 @@ ToKML(BufferedOutputStream &os, const CloudClientContainer &clients)
 
   const auto min_stamp = std::chrono::steady_clock::now() - MAX_TRAFFIC_AGE;
 
-  for (const auto &client : clients)
-    if (client.stamp >= min_stamp)
-      ToKML(os, client);
+  for (const auto &shard : shards)
+    for (const auto &client : shard->clients)
+      if (client.stamp >= min_stamp)
+        ToKML(os, client);
 
   os.Write("    </Folder>\n");
   os.Write("  </Document>\n"
@@ -123,7 +123,7 @@ ToKML(BufferedOutputStream &os, const CloudData &data)
            "    <Schema name=\"thermal\" id=\"thermal\">\n"
            "      <SimpleField name=\"id\" type=\"int\"/>\n"
            "    </Schema>\n");
-  ToKML(os, data.clients);
+  ToKML(os, data.GetShards());
   ToKML(os, data.thermals);
   os.Write("  </Document>\n"
            "</kml>");
@@ -143,13 +143,10 @@ try {
 
   CloudData data;
 
-  /* read the database saved by xcsoar-cloud-server */
+  /* read the database and the journal saved by
+     xcsoar-cloud-server */
 
-  {
-    FileReader fr(db_path);
-    Deserialiser s(fr);
-    data.Load(s);
-  }
+  data.Load(db_path);
 
   /* write the clients to KML */
 
@@ -158,7 +155,7 @@ try {
 
     {
       BufferedOutputStream bos(fos);
-      ToKML(bos, data.clients);
+      ToKML(bos, data.GetShards());
       bos.Flush();
     }
 
@@ -3,6 +3,7 @@
 
 #include "ContestComputer.hpp"
 #include "Engine/Contest/Settings.hpp"
+#include "thread/WorkerPool.hpp"
 
 ContestComputer::ContestComputer(const Trace &trace_full,
                                  const Trace &trace_triangle,
@@ -37,7 +38,15 @@ ContestComputer::SolveExhaustive(const ContestSettings &settings,
   contest_manager.SetHandicap(settings.handicap);
   contest_manager.SetContest(settings.contest);
 
-  bool result = contest_manager.SolveExhaustive();
+  /* this is called rarely (e.g. after landing), so the threads are
+     only started for this call; independent solvers run
+     concurrently, at most two at a time */
+  const auto pool = WorkerPool::CreateDefault(2);
+  const bool result = pool
+    ? contest_manager.SolveExhaustive([&pool](unsigned n, const auto &f){
+      pool->ForEach(n, [&f](unsigned i){ f(i); });
+    })
+    : contest_manager.SolveExhaustive();
 
   contest_stats = contest_manager.GetStats();
 
@@ -35,6 +35,7 @@ GlideComputer::ResetFlight(const bool full)
   GlideComputerBlackboard::ResetFlight(full);
   air_data_computer.ResetFlight(SetCalculated(), full);
   task_computer.ResetFlight(full);
+  waypoint_arrivals.Reset();
   stats_computer.ResetFlight(full);
   log_computer.Reset();
   retrospective.Reset();
@@ -152,6 +153,10 @@ GlideComputer::ProcessIdle(bool exhaustive)
   task_computer.ProcessIdle(basic, calculated, GetComputerSettings(),
                             exhaustive);
 
+  waypoint_arrivals.Update(waypoints, basic, calculated,
+                           GetComputerSettings(),
+                           GetProtectedRoutePlanner());
+
   warning_computer.Update(GetComputerSettings(), basic,
                           calculated, calculated.airspace_warnings);
 
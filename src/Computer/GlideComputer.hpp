@@ -12,6 +12,7 @@
 #include "LogComputer.hpp"
 #include "WarningComputer.hpp"
 #include "CuComputer.hpp"
+#include "WaypointArrivalCache.hpp"
 #include "Engine/Contest/Solvers/Retrospective.hpp"
 #include "ConditionMonitor/ConditionMonitors.hpp"
 #include "ConditionMonitor/MoreConditionMonitors.hpp"
@@ -39,6 +40,8 @@ class GlideComputer : public GlideComputerBlackboard
 
   const Waypoints &waypoints;
 
+  WaypointArrivalCache waypoint_arrivals;
+
   Retrospective retrospective;
   int team_code_ref_id;
   bool team_code_ref_found;
@@ -129,6 +132,10 @@ public:
     return task_computer.GetProtectedRoutePlanner();
   }
 
+  const WaypointArrivalCache &GetWaypointArrivals() const {
+    return waypoint_arrivals;
+  }
+
   void ClearAirspaces() {
     task_computer.ClearAirspaces();
   }
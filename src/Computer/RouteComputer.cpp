@@ -7,14 +7,23 @@
 #include "NMEA/Derived.hpp"
 #include "NMEA/Aircraft.hpp"
 #include "Navigation/Aircraft.hpp"
+#include "thread/WorkerPool.hpp"
 
 #include <algorithm>
 
 RouteComputer::RouteComputer(const Airspaces &airspace_database,
                              const ProtectedAirspaceWarningManager *warnings)
   :protected_route_planner(route_planner, airspace_database, warnings),
-   terrain(NULL)
-{}
+   terrain(NULL),
+   reach_pool(WorkerPool::CreateDefault(4))
+{
+  if (reach_pool)
+    reach_for_each = [this](unsigned n, const auto &f){
+      reach_pool->ForEach(n, [&f](unsigned i){ f(i); });
+    };
+}
+
+RouteComputer::~RouteComputer() noexcept = default;
 
 void
 RouteComputer::ResetFlight()
@@ -124,7 +133,8 @@ RouteComputer::Reach(const MoreData &basic, DerivedInfo &calculated,
                                (int)calculated.common_stats.height_max_working));
 
   if (reach_clock.CheckAdvance(basic.time, PERIOD)) {
-    protected_route_planner.SolveReach(start, config, h_ceiling, do_solve);
+    protected_route_planner.SolveReach(start, config, h_ceiling, do_solve,
+                                       reach_pool ? &reach_for_each : nullptr);
 
     if (do_solve) {
       calculated.terrain_base = protected_route_planner.GetTerrainBase();
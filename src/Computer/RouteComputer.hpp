@@ -8,6 +8,8 @@
 #include "Engine/Route/RoutePlanner.hpp"
 #include "time/GPSClock.hpp"
 
+#include <memory>
+
 struct MoreData;
 struct DerivedInfo;
 struct GlideSettings;
@@ -15,6 +17,7 @@ struct RoutePlannerConfig;
 class ProtectedAirspaceWarningManager;
 class RasterTerrain;
 class GlidePolar;
+class WorkerPool;
 
 class RouteComputer {
   static constexpr std::chrono::steady_clock::duration PERIOD = std::chrono::seconds(5);
@@ -27,12 +30,20 @@ class RouteComputer {
 
   const RasterTerrain *terrain;
 
+  /**
+   * Up to 3 threads which solve the reach fans concurrently (together
+   * with the calling thread); nullptr on a single core machine.
+   */
+  std::unique_ptr<WorkerPool> reach_pool;
+  ReachForEach reach_for_each;
+
   TaskType last_task_type;
   unsigned last_active_tp;
 
 public:
   RouteComputer(const Airspaces &airspace_database,
                 const ProtectedAirspaceWarningManager *warnings);
+  ~RouteComputer() noexcept;
 
   const ProtectedRoutePlanner &GetProtectedRoutePlanner() const {
     return protected_route_planner;
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "WaypointArrival.hpp"
+#include "Task/ProtectedRoutePlanner.hpp"
+#include "Computer/Settings.hpp"
+#include "NMEA/MoreData.hpp"
+#include "NMEA/Derived.hpp"
+#include "Engine/Waypoint/Waypoint.hpp"
+#include "Engine/GlideSolvers/GlideState.hpp"
+#include "Engine/GlideSolvers/GlideResult.hpp"
+#include "Geo/GeoVector.hpp"
+
+[[gnu::pure]]
+static const GlidePolar &
+GetReachPolar(const PolarSettings &polar_settings,
+              const TaskBehaviour &task_behaviour,
+              const DerivedInfo &calculated) noexcept
+{
+  return task_behaviour.route_planner.reach_polar_mode == RoutePlannerConfig::Polar::TASK
+    ? polar_settings.glide_polar_task
+    : calculated.glide_polar_safety;
+}
+
+WaypointArrivalCalculator::WaypointArrivalCalculator(const MoreData &basic,
+                                                     const DerivedInfo &calculated,
+                                                     const PolarSettings &polar_settings,
+                                                     const TaskBehaviour &task_behaviour,
+                                                     const ProtectedRoutePlanner *_route_planner) noexcept
+  :route_planner(_route_planner != nullptr &&
+                 !_route_planner->IsTerrainReachEmpty()
+                 ? _route_planner
+                 : nullptr),
+   location(basic.location), altitude(basic.nav_altitude),
+   wind(calculated.GetWindOrZero()),
+   safety_height(task_behaviour.safety_height_arrival),
+   mac_cready(task_behaviour.glide,
+              GetReachPolar(polar_settings, task_behaviour, calculated)),
+   straight_available(basic.location_available &&
+                      basic.NavAltitudeAvailable())
+{
+}
+
+WaypointArrival
+WaypointArrivalCalculator::Calculate(const Waypoint &waypoint) const noexcept
+{
+  WaypointArrival arrival;
+  arrival.reach.Clear();
+  arrival.method = WaypointArrival::Method::NONE;
+
+  const double elevation = waypoint.elevation + safety_height;
+
+  if (route_planner != nullptr) {
+    const AGeoPoint p_dest(waypoint.location, elevation);
+    auto reach = route_planner->FindPositiveArrival(p_dest);
+    if (!reach)
+      return arrival;
+
+    arrival.reach = *reach;
+    arrival.reach.Subtract(elevation);
+    arrival.method = WaypointArrival::Method::ROUTE;
+    return arrival;
+  }
+
+  if (!straight_available)
+    return arrival;
+
+  const GlideState state(GeoVector(location, waypoint.location),
+                         elevation, altitude, wind);
+
+  const GlideResult result = mac_cready.SolveStraight(state);
+  if (!result.IsOk())
+    return arrival;
+
+  arrival.reach.direct = result.pure_glide_altitude_difference;
+  arrival.method = WaypointArrival::Method::STRAIGHT;
+  return arrival;
+}
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Engine/Route/ReachResult.hpp"
+#include "Engine/GlideSolvers/MacCready.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Geo/SpeedVector.hpp"
+
+#include <cstdint>
+
+struct Waypoint;
+struct MoreData;
+struct DerivedInfo;
+struct PolarSettings;
+struct TaskBehaviour;
+class ProtectedRoutePlanner;
+
+/**
+ * The arrival altitude at a waypoint, relative to its elevation plus
+ * the arrival safety height.
+ */
+struct WaypointArrival {
+  enum class Method : uint8_t {
+    /**
+     * No arrival altitude is known; #reach is undefined.
+     */
+    NONE,
+
+    /**
+     * Straight glide, ignoring terrain; only ReachResult::direct is
+     * set.
+     */
+    STRAIGHT,
+
+    /**
+     * Looked up in the terrain reach of the route planner.
+     */
+    ROUTE,
+  };
+
+  ReachResult reach;
+
+  Method method;
+};
+
+/**
+ * Calculates the arrival altitudes at waypoints for one aircraft
+ * state.  It uses the terrain reach of the route planner if
+ * available, and falls back to a straight glide with the
+ * MacCready polar.
+ */
+class WaypointArrivalCalculator {
+  const ProtectedRoutePlanner *const route_planner;
+
+  const GeoPoint location;
+  const double altitude;
+  const SpeedVector wind;
+  const double safety_height;
+
+  const MacCready mac_cready;
+
+  /**
+   * Is the aircraft state known, i.e. can straight glides be
+   * calculated?
+   */
+  const bool straight_available;
+
+public:
+  /**
+   * @param route_planner the route planner; may be nullptr
+   */
+  WaypointArrivalCalculator(const MoreData &basic,
+                            const DerivedInfo &calculated,
+                            const PolarSettings &polar_settings,
+                            const TaskBehaviour &task_behaviour,
+                            const ProtectedRoutePlanner *route_planner) noexcept;
+
+  [[gnu::pure]]
+  WaypointArrival Calculate(const Waypoint &waypoint) const noexcept;
+};
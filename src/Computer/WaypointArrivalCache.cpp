@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "WaypointArrivalCache.hpp"
+#include "Computer/Settings.hpp"
+#include "Task/ProtectedRoutePlanner.hpp"
+#include "Engine/Waypoint/Waypoints.hpp"
+#include "NMEA/MoreData.hpp"
+#include "NMEA/Derived.hpp"
+
+#include <algorithm>
+
+#include <math.h>
+
+/**
+ * Recalculate when the aircraft has moved this far [m].
+ */
+static constexpr double MOVE_THRESHOLD = 100;
+
+/**
+ * Recalculate when the altitude has changed this much [m].
+ */
+static constexpr double ALTITUDE_THRESHOLD = 5;
+
+/**
+ * Recalculate when the wind vector has changed this much [m/s].
+ */
+static constexpr double WIND_THRESHOLD = 1;
+
+/**
+ * Waypoints are included up to this glide ratio from the current
+ * altitude; farther ones are calculated by the renderer on demand.
+ */
+static constexpr double RANGE_GLIDE_RATIO = 100;
+
+static constexpr double MIN_RANGE = 20000, MAX_RANGE = 300000;
+
+const WaypointArrival *
+WaypointArrivalCache::Table::Find(unsigned id) const noexcept
+{
+  auto i = std::lower_bound(items.begin(), items.end(), id,
+                            [](const Item &item, unsigned id){
+                              return item.id < id;
+                            });
+  return i != items.end() && i->id == id ? &i->arrival : nullptr;
+}
+
+[[gnu::const]]
+static double
+WindDifference(const SpeedVector a, const SpeedVector b) noexcept
+{
+  const auto [a_sin, a_cos] = a.bearing.SinCos();
+  const auto [b_sin, b_cos] = b.bearing.SinCos();
+  return hypot(a.norm * a_sin - b.norm * b_sin,
+               a.norm * a_cos - b.norm * b_cos);
+}
+
+bool
+WaypointArrivalCache::Inputs::IsClose(const Inputs &other) const noexcept
+{
+  return reach_serial == other.reach_serial &&
+    waypoints_serial == other.waypoints_serial &&
+    polar_mode == other.polar_mode &&
+    safety_height == other.safety_height &&
+    glide == other.glide &&
+    mc == other.mc && bugs == other.bugs && ballast == other.ballast &&
+    best_ld == other.best_ld &&
+    fabs(altitude - other.altitude) < ALTITUDE_THRESHOLD &&
+    WindDifference(wind, other.wind) < WIND_THRESHOLD &&
+    location.DistanceS(other.location) < MOVE_THRESHOLD;
+}
+
+void
+WaypointArrivalCache::Reset() noexcept
+{
+  last_inputs.reset();
+
+  const std::scoped_lock lock{mutex};
+  table.reset();
+}
+
+void
+WaypointArrivalCache::Update(const Waypoints &waypoints,
+                             const MoreData &basic,
+                             const DerivedInfo &calculated,
+                             const ComputerSettings &settings,
+                             const ProtectedRoutePlanner &route_planner) noexcept
+{
+  if (!basic.location_available || !basic.NavAltitudeAvailable()) {
+    if (last_inputs)
+      Reset();
+    return;
+  }
+
+  const TaskBehaviour &task_behaviour = settings.task;
+  const GlidePolar &polar =
+    task_behaviour.route_planner.reach_polar_mode == RoutePlannerConfig::Polar::TASK
+    ? settings.polar.glide_polar_task
+    : calculated.glide_polar_safety;
+
+  const Inputs inputs{
+    basic.location, basic.nav_altitude, calculated.GetWindOrZero(),
+    polar.GetMC(), polar.GetBugs(), polar.GetBallast(), polar.GetBestLD(),
+    task_behaviour.safety_height_arrival,
+    task_behaviour.glide,
+    task_behaviour.route_planner.reach_polar_mode,
+    route_planner.GetReachSerial(), waypoints.GetSerial(),
+  };
+
+  if (last_inputs && inputs.IsClose(*last_inputs))
+    return;
+
+  last_inputs = inputs;
+
+  const WaypointArrivalCalculator calculator(basic, calculated,
+                                             settings.polar, task_behaviour,
+                                             &route_planner);
+
+  auto new_table = std::make_shared<Table>();
+  new_table->waypoints_serial = inputs.waypoints_serial;
+
+  const double range = std::clamp(basic.nav_altitude * RANGE_GLIDE_RATIO,
+                                  MIN_RANGE, MAX_RANGE);
+  waypoints.VisitWithinRange(basic.location, range,
+                             [&calculator, &items=new_table->items](const WaypointPtr &wp){
+                               if (wp->IsLandable() || wp->flags.watched)
+                                 items.push_back({wp->id, calculator.Calculate(*wp)});
+                             });
+
+  std::sort(new_table->items.begin(), new_table->items.end(),
+            [](const Item &a, const Item &b){
+              return a.id < b.id;
+            });
+
+  const std::scoped_lock lock{mutex};
+  table = std::move(new_table);
+}
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "WaypointArrival.hpp"
+#include "Engine/Route/Config.hpp"
+#include "Engine/GlideSolvers/GlideSettings.hpp"
+#include "thread/Mutex.hxx"
+#include "util/Serial.hpp"
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+struct ComputerSettings;
+class Waypoints;
+
+/**
+ * The arrival altitudes at all landable and watched waypoints near
+ * the aircraft.  They are calculated by the #CalculationThread, and
+ * the #DrawThread only looks them up, instead of solving a glide for
+ * each visible waypoint on each frame.
+ *
+ * The table is only recalculated when the aircraft state, the polar,
+ * the wind or the terrain reach have changed noticeably.
+ */
+class WaypointArrivalCache {
+public:
+  struct Item {
+    unsigned id;
+    WaypointArrival arrival;
+  };
+
+  struct Table {
+    /**
+     * The Waypoints::GetSerial() value this table was calculated
+     * for.  The table must not be used if it does not match.
+     */
+    Serial waypoints_serial;
+
+    /**
+     * Sorted by #Item::id.
+     */
+    std::vector<Item> items;
+
+    /**
+     * @return the arrival at the given waypoint or nullptr if it
+     * was not calculated
+     */
+    [[gnu::pure]]
+    const WaypointArrival *Find(unsigned id) const noexcept;
+  };
+
+private:
+  /**
+   * The inputs of a calculation, used to decide whether to
+   * recalculate.
+   */
+  struct Inputs {
+    GeoPoint location;
+    double altitude;
+    SpeedVector wind;
+
+    double mc, bugs, ballast, best_ld;
+    double safety_height;
+    GlideSettings glide;
+    RoutePlannerConfig::Polar polar_mode;
+
+    Serial reach_serial, waypoints_serial;
+
+    [[gnu::pure]]
+    bool IsClose(const Inputs &other) const noexcept;
+  };
+
+  mutable Mutex mutex;
+
+  /**
+   * The most recently calculated table.  Protected by #mutex; the
+   * table itself is immutable.
+   */
+  std::shared_ptr<const Table> table;
+
+  /**
+   * The inputs of the current #table.  Only used by the
+   * #CalculationThread.
+   */
+  std::optional<Inputs> last_inputs;
+
+public:
+  void Reset() noexcept;
+
+  /**
+   * Recalculate the table if the inputs have changed noticeably.
+   * Called by the #CalculationThread.
+   */
+  void Update(const Waypoints &waypoints,
+              const MoreData &basic, const DerivedInfo &calculated,
+              const ComputerSettings &settings,
+              const ProtectedRoutePlanner &route_planner) noexcept;
+
+  /**
+   * Obtain a reference to the current table.  May be called from
+   * any thread.
+   *
+   * @return the table or nullptr if there is none
+   */
+  std::shared_ptr<const Table> Get() const noexcept {
+    const std::scoped_lock lock{mutex};
+    return table;
+  }
+};
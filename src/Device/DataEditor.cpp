@@ -5,12 +5,21 @@
 #include "Blackboard/DeviceBlackboard.hpp"
 
 DeviceDataEditor::DeviceDataEditor(DeviceBlackboard &_blackboard,
-                                   std::size_t idx) noexcept
-  :blackboard(_blackboard), lock(blackboard.mutex),
-   basic(blackboard.SetRealState(idx)) {}
+                                   std::size_t _idx) noexcept
+  :blackboard(_blackboard), idx(_idx),
+   lock(blackboard.per_device_data[idx].mutex),
+   basic(blackboard.per_device_data[idx].working) {}
 
 void
 DeviceDataEditor::Commit() const noexcept
 {
+  auto &device = blackboard.per_device_data[idx];
+
+  /* Merge() expires only the published copy; expire the working
+     copy as well, or stale FLARM traffic would never be purged from
+     it */
+  basic.Expire();
+  device.Publish();
+
   blackboard.ScheduleMerge();
 }
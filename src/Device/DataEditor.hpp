@@ -5,12 +5,21 @@
 
 #include "thread/Mutex.hxx"
 
+#include <cstddef>
+
 class DeviceBlackboard;
 struct NMEAInfo;
 
+/**
+ * Edit a device's data in #DeviceBlackboard.  This locks only the
+ * device's own mutex, not the blackboard; the modifications become
+ * visible to DeviceBlackboard::Merge() with Commit().
+ */
 class DeviceDataEditor {
   DeviceBlackboard &blackboard;
 
+  const std::size_t idx;
+
   const std::lock_guard<Mutex> lock;
 
   NMEAInfo &basic;
@@ -19,6 +28,11 @@ public:
   DeviceDataEditor(DeviceBlackboard &blackboard,
                    std::size_t idx) noexcept;
 
+  /**
+   * Publish the modifications and schedule the MergeThread.  The
+   * editor may be used for further modifications, which require
+   * another Commit() call.
+   */
   void Commit() const noexcept;
 
   NMEAInfo *operator->() const noexcept {
@@ -14,6 +14,7 @@
 #include "Port/ConfiguredPort.hpp"
 #include "Port/DumpPort.hpp"
 #include "NMEA/Info.hpp"
+#include "NMEA/Checksum.hpp"
 #include "thread/Mutex.hxx"
 #include "util/StringAPI.hxx"
 #include "util/ConvertString.hpp"
@@ -760,11 +761,15 @@ DeviceDescriptor::ParseNMEA(const char *line, NMEAInfo &info) noexcept
 {
   assert(line != nullptr);
 
+  /* verify the checksum only once for the driver and for
+     NMEAParser */
+  const char *const asterisk = FindVerifiedNMEAChecksum(line);
+
   /* restore the driver's ExternalSettings */
   const ExternalSettings old_settings = info.settings;
   info.settings = settings_received;
 
-  if (device != nullptr && device->ParseNMEA(line, info)) {
+  if (device != nullptr && device->ParseVerifiedNMEA(line, asterisk, info)) {
     info.alive.Update(info.clock);
 
     if (!config.sync_from_device)
@@ -784,7 +789,7 @@ DeviceDescriptor::ParseNMEA(const char *line, NMEAInfo &info) noexcept
   info.settings = old_settings;
 
   // Additional "if" to find GPS strings
-  if (parser.ParseLine(line, info)) {
+  if (parser.ParseLine(line, asterisk, info)) {
     info.alive.Update(info.clock);
     return true;
   }
@@ -54,6 +54,17 @@ public:
    */
   virtual bool ParseNMEA(const char *line, struct NMEAInfo &info) = 0;
 
+  /**
+   * Like ParseNMEA(), but the caller has already verified the
+   * checksum with FindVerifiedNMEAChecksum(), so drivers don't need
+   * to scan the line again.
+   *
+   * @param asterisk the first asterisk of the line if the checksum
+   * is correct, nullptr if it is missing or wrong
+   */
+  virtual bool ParseVerifiedNMEA(const char *line, const char *asterisk,
+                                 struct NMEAInfo &info) = 0;
+
   /**
    * Send the new MacCready value to the device.
    *
@@ -230,6 +241,13 @@ public:
 
   bool ParseNMEA(const char *line, struct NMEAInfo &info) override;
 
+  /**
+   * This default implementation ignores #asterisk and calls
+   * ParseNMEA().
+   */
+  bool ParseVerifiedNMEA(const char *line, const char *asterisk,
+                         struct NMEAInfo &info) override;
+
   bool PutMacCready(double MacCready, OperationEnvironment &env) override;
   bool PutBugs(double bugs, OperationEnvironment &env) override;
   bool PutBallast(double fraction, double overload,
@@ -12,6 +12,8 @@
 #include <atomic>
 #include <cstdint>
 
+class NMEAInputLine;
+
 class LXDevice: public AbstractDevice
 {
   enum class Mode : uint8_t {
@@ -239,12 +241,25 @@ protected:
 
   bool EnableCommandMode(OperationEnvironment &env);
 
+private:
+  /**
+   * Parse a LXWP1 sentence and identify the device.
+   */
+  void ParseLXWP1(NMEAInputLine &line, NMEAInfo &info) noexcept;
+
+  /**
+   * Parse a PLXVC sentence and identify the device.
+   */
+  void ParsePLXVC(NMEAInputLine &line, NMEAInfo &info) noexcept;
+
 public:
   /* virtual methods from class Device */
   void LinkTimeout() override;
   bool EnableNMEA(OperationEnvironment &env) override;
 
   bool ParseNMEA(const char *line, struct NMEAInfo &info) override;
+  bool ParseVerifiedNMEA(const char *line, const char *asterisk,
+                         struct NMEAInfo &info) override;
 
   bool PutBallast(double fraction, double overload,
                   OperationEnvironment &env) override;
@@ -44,6 +44,16 @@ public:
    */
   bool ParseLine(const char *line, NMEAInfo &info);
 
+  /**
+   * Like ParseLine(), but the checksum has already been verified by
+   * the caller.
+   *
+   * @param asterisk the first asterisk of the line as returned by
+   * FindVerifiedNMEAChecksum(); nullptr if the checksum is missing
+   * or wrong
+   */
+  bool ParseLine(const char *line, const char *asterisk, NMEAInfo &info);
+
 public:
   /**
    * Calculates the checksum of the provided NMEA string and
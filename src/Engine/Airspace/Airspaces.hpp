@@ -66,9 +66,22 @@ public:
    * Re-organise the internal airspace tree after inserting/deleting.
    * Should be called after inserting/deleting airspaces prior to performing
    * any searches, but can be done once after a batch insert/delete.
+   *
+   * If the whole tree needs to be built (the first call, or after
+   * the projection has changed), it is bulk-loaded, which is a lot
+   * faster and yields a better tree than inserting the airspaces
+   * one by one.
    */
   void Optimise() noexcept;
 
+  /**
+   * Returns the airspaces which were added since the last Optimise()
+   * call.
+   */
+  const std::deque<AirspacePtr> &GetPending() const noexcept {
+    return tmp_as;
+  }
+
   /**
    * Clear the airspace store, deleting airspace objects if m_owner is true
    */
@@ -26,6 +26,28 @@ ContestManager::ContestManager(const Contest _contest,
    charron_small(trace_triangle, false),
    charron_large(trace_triangle, true)
 {
+  /* the Dijkstra solvers operating on the same trace share one
+     distance matrix */
+  const auto full_matrix = std::make_shared<TraceDistanceMatrix>(trace_full);
+  olc_classic.SetDistanceMatrix(full_matrix);
+  dmst_quad.SetDistanceMatrix(full_matrix);
+  xcontest_free.SetDistanceMatrix(full_matrix);
+  dhv_xc_free.SetDistanceMatrix(full_matrix);
+  sis_at.SetDistanceMatrix(full_matrix);
+  net_coupe.SetDistanceMatrix(full_matrix);
+  weglide_distance.SetDistanceMatrix(full_matrix);
+  weglide_or.SetDistanceMatrix(full_matrix);
+
+  const auto triangle_matrix = &trace_triangle == &trace_full
+    ? full_matrix
+    : std::make_shared<TraceDistanceMatrix>(trace_triangle);
+  charron_small.SetDistanceMatrix(triangle_matrix);
+  charron_large.SetDistanceMatrix(triangle_matrix);
+
+  olc_sprint.SetDistanceMatrix(&trace_sprint == &trace_full
+                               ? full_matrix
+                               : std::make_shared<TraceDistanceMatrix>(trace_sprint));
+
   Reset();
 }
 
@@ -112,8 +134,39 @@ RunContest(AbstractContest &_contest,
   return true;
 }
 
+/**
+ * Invoke two independent functions, concurrently if a
+ * #ContestForEach is given.
+ *
+ * @return true if at least one of them returned true
+ */
+template<typename A, typename B>
+static bool
+RunBoth(const ContestForEach *for_each, A &&a, B &&b) noexcept
+{
+  if (for_each == nullptr) {
+    const bool result_a = a();
+    const bool result_b = b();
+    return result_a || result_b;
+  }
+
+  bool results[2];
+  (*for_each)(2, [&a, &b, &results](unsigned i){
+    results[i] = i == 0 ? a() : b();
+  });
+
+  return results[0] || results[1];
+}
+
 bool
 ContestManager::UpdateIdle(bool exhaustive) noexcept
+{
+  return Update(exhaustive, nullptr);
+}
+
+bool
+ContestManager::Update(bool exhaustive,
+                       const ContestForEach *for_each) noexcept
 {
   bool retval = false;
 
@@ -147,11 +200,13 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
     break;
 
   case Contest::OLC_PLUS:
-    retval = RunContest(olc_classic, stats.result[0],
+    retval = RunBoth(for_each, [&]{
+      return RunContest(olc_classic, stats.result[0],
                         stats.solution[0], exhaustive);
-
-    retval |= RunContest(olc_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
+    }, [&]{
+      return RunContest(olc_fai, stats.result[1],
+                        stats.solution[1], exhaustive);
+    });
 
     if (retval) {
       olc_plus.Feed(stats.result[0], stats.solution[0],
@@ -169,17 +224,23 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
     break;
 
   case Contest::XCONTEST:
-    retval = RunContest(xcontest_free, stats.result[0],
+    retval = RunBoth(for_each, [&]{
+      return RunContest(xcontest_free, stats.result[0],
                         stats.solution[0], exhaustive);
-    retval |= RunContest(xcontest_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+    }, [&]{
+      return RunContest(xcontest_triangle, stats.result[1],
+                        stats.solution[1], exhaustive);
+    });
     break;
 
   case Contest::DHV_XC:
-    retval = RunContest(dhv_xc_free, stats.result[0],
+    retval = RunBoth(for_each, [&]{
+      return RunContest(dhv_xc_free, stats.result[0],
                         stats.solution[0], exhaustive);
-    retval |= RunContest(dhv_xc_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+    }, [&]{
+      return RunContest(dhv_xc_triangle, stats.result[1],
+                        stats.solution[1], exhaustive);
+    });
     break;
 
   case Contest::SIS_AT:
@@ -193,14 +254,18 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
     break;
 
   case Contest::WEGLIDE_FREE:
-    retval = RunContest(weglide_distance, stats.result[0],
-                        stats.solution[0], exhaustive);
-
-    retval |= RunContest(weglide_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
-
-    retval |= RunContest(weglide_or, stats.result[2],
-                         stats.solution[2], exhaustive);
+    /* "distance" and "out and return" share a TraceDistanceMatrix,
+       which must not be updated concurrently */
+    retval = RunBoth(for_each, [&]{
+      const bool distance = RunContest(weglide_distance, stats.result[0],
+                                       stats.solution[0], exhaustive);
+      const bool out_and_return = RunContest(weglide_or, stats.result[2],
+                                             stats.solution[2], exhaustive);
+      return distance || out_and_return;
+    }, [&]{
+      return RunContest(weglide_fai, stats.result[1],
+                        stats.solution[1], exhaustive);
+    });
 
     if (retval) {
       weglide_free.Feed(stats.result[0], stats.solution[0],
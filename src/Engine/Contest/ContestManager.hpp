@@ -21,8 +21,18 @@
 #include "Solvers/Charron.hpp"
 #include "ContestStatistics.hpp"
 
+#include <functional>
+
 class Trace;
 
+/**
+ * Invokes the given function for each index in [0, n) and returns
+ * when all invocations have finished.  The invocations may run
+ * concurrently (e.g. via WorkerPool::ForEach()).
+ */
+using ContestForEach =
+  std::function<void(unsigned n, const std::function<void(unsigned)> &f)>;
+
 /**
  * Special task holder for Online Contest calculations
  */
@@ -101,6 +111,15 @@ public:
     return UpdateIdle(true);
   }
 
+  /**
+   * Like SolveExhaustive(), but contests which consist of several
+   * independent solvers (e.g. OLC-Plus) run them via the given
+   * #ContestForEach, which may distribute them among threads.
+   */
+  bool SolveExhaustive(const ContestForEach &for_each) noexcept {
+    return Update(true, &for_each);
+  }
+
   /**
    * Solve exhaustive with custom computational limits for the triangle solver.
    */
@@ -124,4 +143,11 @@ public:
   const ContestStatistics &GetStats() const noexcept {
     return stats;
   }
+
+private:
+  /**
+   * @param for_each if not nullptr, then independent solvers are run
+   * through it
+   */
+  bool Update(bool exhaustive, const ContestForEach *for_each) noexcept;
 };
@@ -8,6 +8,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <optional>
+#include <vector>
 
 // set size of reserved queue elements (may differ from Dijkstra default)
 static constexpr unsigned CONTEST_QUEUE_SIZE = 5000;
@@ -35,6 +37,10 @@ ContestDijkstra::UpdateTrace(bool force) noexcept
   if (IsMasterAppended()) return; /* unmodified */
 
   if (IsMasterUpdated(continuous)) {
+    if (finished && RemapIncremental())
+      /* the previous Dijkstra state was carried over */
+      return;
+
     UpdateTraceFull();
 
     trace_dirty = true;
@@ -277,30 +283,24 @@ ContestDijkstra::AddIncrementalEdges(unsigned first_point) noexcept
   finished = false;
   first_finish_candidate = first_point;
 
-  /* we need a copy of the current edge map, because the following
-     loop will modify it, invalidating the iterator */
-#if GCC_VERSION < 40800 || GCC_VERSION > 40802
-  const Dijkstra::EdgeMap edges = dijkstra.GetEdgeMap();
-#else
-  // workaround for http://gcc.gnu.org/bugzilla/show_bug.cgi?id=59548
-  Dijkstra::EdgeMap edges;
-  edges = dijkstra.GetEdgeMap();
-#endif
+  /* we need a copy of the current non-final nodes, because the
+     following loop will modify the edge map, invalidating the
+     iterator */
+  incremental_origins.clear();
+  for (const auto &i : dijkstra.GetEdgeMap())
+    if (!IsFinal(i.first))
+      incremental_origins.emplace_back(i.first, i.second.value);
 
   /* establish links between each old node and each new node, to
      initiate the follow-up search, hoping a better solution will be
      found here */
-  for (const auto &i : edges) {
-    if (IsFinal(i.first))
-      /* ignore final nodes */
-      continue;
-
+  for (const auto &[node, value] : incremental_origins) {
     /* "seek" the Dijkstra object to the current "old" node */
-    dijkstra.SetCurrentValue(i.second.value);
+    dijkstra.SetCurrentValue(value);
 
     /* add edges from the current "old" node to all "new" nodes
        (first_point .. n_points-1) */
-    AddEdges(i.first, first_point);
+    AddEdges(node, first_point);
   }
 
   /* see if new start points are possible now (due to relaxed start
@@ -309,6 +309,103 @@ ContestDijkstra::AddIncrementalEdges(unsigned first_point) noexcept
   AddStartEdges();
 }
 
+bool
+ContestDijkstra::RemapIncremental() noexcept
+{
+  assert(continuous);
+  assert(incremental);
+  assert(finished);
+
+  const unsigned old_size = n_points;
+  if (!UpdateTraceRemap(index_map))
+    return false;
+
+  const unsigned first_new_point = index_map[old_size - 1] + 1;
+
+  /* replace each removed point with the nearest preceding one which
+     still exists; thinning removes only insignificant points, so this
+     approximates the old paths closely */
+  unsigned previous = removed_index;
+  for (auto &i : index_map) {
+    if (i == removed_index)
+      i = previous;
+    else
+      previous = i;
+  }
+
+  const auto map_node = [this](ScanTaskPoint node) noexcept
+    -> std::optional<ScanTaskPoint> {
+    if (IsFinal(node) || index_map[node.GetPointIndex()] == removed_index)
+      return std::nullopt;
+
+    return ScanTaskPoint(node.GetStageNumber(),
+                         index_map[node.GetPointIndex()]);
+  };
+
+  const auto &old_edges = dijkstra.GetEdgeMap();
+
+  /* sorting by key sorts by stage number, so each parent gets
+     translated before its children; final nodes are omitted, they
+     will be re-linked by AddIncrementalEdges() */
+  std::vector<ScanTaskPoint> nodes;
+  nodes.reserve(old_edges.size());
+  for (const auto &i : old_edges)
+    if (!IsFinal(i.first))
+      nodes.push_back(i.first);
+
+  std::sort(nodes.begin(), nodes.end());
+
+  /* recalculate the value of each path along the translated points */
+  Dijkstra::EdgeMap new_edges;
+  for (const ScanTaskPoint old_node : nodes) {
+    const auto node = map_node(old_node);
+    if (!node)
+      continue;
+
+    const auto &old_edge = old_edges.find(old_node)->second;
+
+    value_type value = old_edge.value;
+    ScanTaskPoint parent = *node;
+
+    if (!old_node.IsFirst()) {
+      const auto old_parent = map_node(old_edge.parent);
+      if (!old_parent)
+        continue;
+
+      const auto i = new_edges.find(*old_parent);
+      if (i == new_edges.end())
+        continue;
+
+      parent = *old_parent;
+
+      const auto &parent_tp = GetPoint(parent);
+      const auto &node_tp = GetPoint(*node);
+      if (parent_tp.GetFlatLocation() != node_tp.GetFlatLocation() &&
+          !CheckMinDistance(parent_tp.GetLocation(), node_tp.GetLocation()))
+        continue;
+
+      const unsigned weight = GetStageWeight(parent.GetStageNumber());
+      value = i->second.value + DIJKSTRA_MINMAX_OFFSET -
+        weight * CalcEdgeDistance(parent, *node);
+    }
+
+    const auto [i, inserted] = new_edges.try_emplace(*node, parent, value);
+    if (!inserted && value < i->second.value)
+      i->second = Dijkstra::Edge(parent, value);
+  }
+
+  if (new_edges.empty())
+    /* nothing left to resume from */
+    return false;
+
+  dijkstra.ReplaceEdgeMap(std::move(new_edges), map_node);
+
+  if (first_new_point < n_points)
+    AddIncrementalEdges(first_new_point);
+
+  return true;
+}
+
 void
 ContestDijkstra::CopySolution(ContestTraceVector &result) const noexcept
 {
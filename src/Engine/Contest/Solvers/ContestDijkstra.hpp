@@ -6,8 +6,11 @@
 #include "AbstractContest.hpp"
 #include "PathSolvers/NavDijkstra.hpp"
 #include "TraceManager.hpp"
+#include "TraceDistanceMatrix.hpp"
 
 #include <cassert>
+#include <utility>
+#include <vector>
 
 class Trace;
 
@@ -29,6 +32,10 @@ class ContestDijkstra : public AbstractContest, protected NavDijkstra<>, public
    * Do an incremental analysis, attempting to improve the result in
    * each iteration?  If set, then only the last point is considered
    * as finish point, and start points are selected according to this.
+   *
+   * This is an approximation: the result may differ slightly from
+   * the one of a full (non-incremental) solve, see
+   * RemapIncremental().
    */
   bool incremental = false;
 
@@ -40,6 +47,19 @@ class ContestDijkstra : public AbstractContest, protected NavDijkstra<>, public
    */
   bool finished;
 
+  /**
+   * Maps the point indexes of the previous trace to the current one,
+   * see RemapIncremental().  This is a class member only to reuse
+   * its allocation.
+   */
+  std::vector<unsigned> index_map;
+
+  /**
+   * The non-final nodes which AddIncrementalEdges() links to the new
+   * points.  This is a class member only to reuse its allocation.
+   */
+  std::vector<std::pair<ScanTaskPoint, value_type>> incremental_origins;
+
   /**
    * The last solution.  Use only if Solve() has returned VALID.
    */
@@ -99,6 +119,22 @@ protected:
    */
   void AddIncrementalEdges(unsigned first_point) noexcept;
 
+  /**
+   * The master trace was modified (e.g. thinned).  Instead of
+   * restarting the incremental solver from scratch, translate the
+   * Dijkstra edge map to the new point indexes (replacing removed
+   * points with their nearest surviving predecessor) and continue
+   * with the points which were appended.
+   *
+   * The translated paths are not re-optimised; the solver may keep a
+   * path which the full solve on the thinned trace would not find
+   * (and vice versa), so the results differ slightly.
+   *
+   * @return false if the solver state could not be carried over; the
+   * caller must obtain a new trace and restart the solver
+   */
+  bool RemapIncremental() noexcept;
+
   /**
    * Retrieve weighting of specified leg
    * @param index Index of leg
@@ -123,6 +159,9 @@ protected:
   [[gnu::pure]]
   value_type CalcEdgeDistance(const ScanTaskPoint s1,
                               const ScanTaskPoint s2) const noexcept {
+    if (const auto *matrix = GetDistanceMatrix())
+      return matrix->Get(s1.GetPointIndex(), s2.GetPointIndex());
+
     return GetPoint(s1).FlatDistanceTo(GetPoint(s2));
   }
 
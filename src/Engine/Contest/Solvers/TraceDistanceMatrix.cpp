@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "TraceDistanceMatrix.hpp"
+#include "Trace/Trace.hpp"
+
+#include <algorithm>
+
+void
+TraceDistanceMatrix::Clear() noexcept
+{
+  valid = false;
+  points.clear();
+  distances.clear();
+}
+
+void
+TraceDistanceMatrix::CalculateRows(unsigned first) noexcept
+{
+  const unsigned n = points.size();
+  distances.resize(GetRowOffset(n));
+
+  for (unsigned j = std::max(first, 1u); j < n; ++j) {
+    const auto &tp = *points[j];
+    auto *row = distances.data() + GetRowOffset(j);
+    for (unsigned i = 0; i < j; ++i)
+      row[i] = tp.FlatDistanceTo(*points[i]);
+  }
+}
+
+void
+TraceDistanceMatrix::Update() noexcept
+{
+  if (valid && modify_serial == trace.GetModifySerial()) {
+    if (append_serial == trace.GetAppendSerial())
+      /* unmodified */
+      return;
+
+    const unsigned old_size = points.size();
+    if (trace.SyncPoints(points))
+      CalculateRows(old_size);
+  } else {
+    points.reserve(trace.GetMaxSize());
+    trace.GetPoints(points);
+
+    distances.reserve(GetRowOffset(trace.GetMaxSize()));
+    CalculateRows(0);
+  }
+
+  append_serial = trace.GetAppendSerial();
+  modify_serial = trace.GetModifySerial();
+  valid = true;
+}
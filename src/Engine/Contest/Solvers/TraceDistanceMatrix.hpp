@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "util/Serial.hpp"
+#include "Trace/Vector.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class Trace;
+
+/**
+ * The flat distances between all pairs of points of a #Trace.  One
+ * instance is shared by all solvers which operate on the same #Trace
+ * (see TraceManager::SetDistanceMatrix()), so the O(n^2) distance
+ * calculations are done only once per trace update instead of once
+ * per solver and stage.
+ *
+ * When points are appended to the #Trace, only the distances to the
+ * new points are calculated; after the #Trace was modified (e.g.
+ * thinned), the matrix is rebuilt.
+ */
+class TraceDistanceMatrix {
+  const Trace &trace;
+
+  Serial append_serial, modify_serial;
+
+  bool valid = false;
+
+  TracePointerVector points;
+
+  /**
+   * The lower triangle of the (symmetric) matrix, row by row: row j
+   * contains the distances between point j and the points 0..j-1.
+   * This layout allows appending new points without moving the
+   * existing rows.
+   */
+  std::vector<uint32_t> distances;
+
+public:
+  explicit TraceDistanceMatrix(const Trace &_trace) noexcept
+    :trace(_trace) {}
+
+  TraceDistanceMatrix(const TraceDistanceMatrix &) = delete;
+  TraceDistanceMatrix &operator=(const TraceDistanceMatrix &) = delete;
+
+  const Trace &GetTrace() const noexcept {
+    return trace;
+  }
+
+  /**
+   * Bring the matrix up to date with the #Trace.  This is cheap if
+   * nothing has changed.
+   */
+  void Update() noexcept;
+
+  void Clear() noexcept;
+
+  /**
+   * Can this matrix be used by a client whose copy of the #Trace has
+   * the given modify serial and the given number of points?
+   */
+  [[gnu::pure]]
+  bool IsValidFor(Serial _modify_serial, unsigned n_points) const noexcept {
+    return valid && modify_serial == _modify_serial &&
+      n_points <= points.size();
+  }
+
+  [[gnu::pure]]
+  unsigned Get(unsigned i, unsigned j) const noexcept {
+    if (i == j)
+      return 0;
+
+    if (i > j)
+      std::swap(i, j);
+
+    assert(j < points.size());
+
+    return distances[GetRowOffset(j) + i];
+  }
+
+private:
+  static constexpr std::size_t GetRowOffset(std::size_t j) noexcept {
+    return j * (j - 1) / 2;
+  }
+
+  /**
+   * Calculate the rows of all points starting at the given index.
+   */
+  void CalculateRows(unsigned first) noexcept;
+};
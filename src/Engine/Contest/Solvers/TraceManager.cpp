@@ -2,12 +2,15 @@
 // Copyright The XCSoar Project
 
 #include "TraceManager.hpp"
+#include "TraceDistanceMatrix.hpp"
 #include "Trace/Trace.hpp"
 
+#include <algorithm>
 #include <cassert>
 
 TraceManager::TraceManager(const Trace &_trace) noexcept
   :trace_master(_trace),
+   last_point(TracePoint::Invalid()),
    predicted(TracePoint::Invalid())
 {
 }
@@ -39,6 +42,23 @@ TraceManager::SetPredicted(const TracePoint &_predicted) noexcept
   return result;
 }
 
+void
+TraceManager::SetDistanceMatrix(std::shared_ptr<TraceDistanceMatrix> _matrix) noexcept
+{
+  assert(_matrix == nullptr || &_matrix->GetTrace() == &trace_master);
+
+  distance_matrix = std::move(_matrix);
+}
+
+const TraceDistanceMatrix *
+TraceManager::GetDistanceMatrix() const noexcept
+{
+  return distance_matrix != nullptr &&
+    distance_matrix->IsValidFor(modify_serial, n_points)
+    ? distance_matrix.get()
+    : nullptr;
+}
+
 bool
 TraceManager::IsMasterUpdated(bool continuous) const noexcept
 {
@@ -78,6 +98,7 @@ TraceManager::ClearTrace() noexcept
   trace_dirty = true;
   trace.clear();
   n_points = 0;
+  last_point = TracePoint::Invalid();
   predicted = TracePoint::Invalid();
 }
 
@@ -87,12 +108,16 @@ TraceManager::UpdateTraceFull() noexcept
   trace.reserve(trace_master.GetMaxSize());
   trace_master.GetPoints(trace);
   n_points = trace.size();
+  last_point = n_points > 0 ? *trace.back() : TracePoint::Invalid();
 
   if (n_points > 0 && predicted.IsDefined())
     predicted.Project(trace_master.GetProjection());
 
   append_serial = trace_master.GetAppendSerial();
   modify_serial = trace_master.GetModifySerial();
+
+  if (distance_matrix)
+    distance_matrix->Update();
 }
 
 bool
@@ -109,14 +134,77 @@ TraceManager::UpdateTraceTail() noexcept
     return false;
 
   n_points = trace.size();
+  last_point = *trace.back();
 
   if (n_points > 0 && predicted.IsDefined())
     predicted.Project(trace_master.GetProjection());
 
   append_serial = trace_master.GetAppendSerial();
+
+  if (distance_matrix)
+    distance_matrix->Update();
+
   return true;
 }
 
+bool
+TraceManager::UpdateTraceRemap(std::vector<unsigned> &index_map) noexcept
+{
+  if (trace.empty() || !last_point.IsDefined())
+    return false;
+
+  /* the old pointers must not be dereferenced, because the points
+     they refer to may have been deleted */
+  const TracePointerVector old_trace = std::move(trace);
+  const TracePoint *const old_last = old_trace.back();
+
+  trace.reserve(trace_master.GetMaxSize());
+  trace_master.GetPoints(trace);
+
+  index_map.assign(old_trace.size(), removed_index);
+
+  /* the master only appends at the end, so all points up to the old
+     last point existed before and appear in the same order; stop
+     there, because the memory of deleted points may have been reused
+     by new points which were appended after it */
+  auto o = old_trace.begin();
+  for (unsigned i = 0; i < trace.size(); ++i) {
+    const TracePoint *const p = trace[i];
+    o = std::find(o, old_trace.end(), p);
+    if (o == old_trace.end())
+      return false;
+
+    index_map[std::distance(old_trace.begin(), o)] = i;
+
+    if (p == old_last) {
+      if (p->GetTime() != last_point.GetTime() ||
+          p->GetFlatLocation() != last_point.GetFlatLocation())
+        /* the old last point was deleted and its memory was reused
+           by a new point */
+        return false;
+
+      n_points = trace.size();
+      last_point = *trace.back();
+
+      if (predicted.IsDefined())
+        predicted.Project(trace_master.GetProjection());
+
+      append_serial = trace_master.GetAppendSerial();
+      modify_serial = trace_master.GetModifySerial();
+
+      if (distance_matrix)
+        distance_matrix->Update();
+
+      return true;
+    }
+
+    ++o;
+  }
+
+  /* the old last point was deleted */
+  return false;
+}
+
 void
 TraceManager::UpdateTrace([[maybe_unused]] bool force) noexcept
 {
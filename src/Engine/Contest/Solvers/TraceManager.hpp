@@ -8,11 +8,29 @@
 #include "Trace/Vector.hpp"
 #include "Trace/Point.hpp"
 
+#include <memory>
+#include <vector>
+
+class TraceDistanceMatrix;
+
 class TraceManager {
 protected:
   const Trace &trace_master;
 
 private:
+  /**
+   * A copy of the last point in #trace.  It is used by
+   * UpdateTraceRemap() to verify that this point still exists in the
+   * master trace (its pointer may have been reused).
+   */
+  TracePoint last_point;
+
+  /**
+   * An optional distance matrix shared with other solvers operating
+   * on the same #Trace.
+   */
+  std::shared_ptr<TraceDistanceMatrix> distance_matrix;
+
   /**
    * This attribute tracks Trace::GetAppendSerial().  It is updated
    * when appnew copy of the master Trace is obtained, and is used to
@@ -42,6 +60,12 @@ protected:
 
   static constexpr unsigned predicted_index = 0xffff;
 
+  /**
+   * Marks a point which was removed from the master trace, see
+   * UpdateTraceRemap().
+   */
+  static constexpr unsigned removed_index = ~0u;
+
   bool trace_dirty;
 
 public:
@@ -62,6 +86,13 @@ public:
    */
   bool SetPredicted(const TracePoint &_predicted) noexcept;
 
+  /**
+   * Use the specified #TraceDistanceMatrix (which must refer to the
+   * same #Trace) instead of calculating distances on the fly.  It
+   * will be updated whenever this object obtains new points.
+   */
+  void SetDistanceMatrix(std::shared_ptr<TraceDistanceMatrix> _matrix) noexcept;
+
 protected:
   void ClearTrace() noexcept;
 
@@ -77,6 +108,20 @@ protected:
    */
   bool UpdateTraceTail() noexcept;
 
+  /**
+   * Obtain a new #Trace copy after the master was modified (e.g.
+   * thinned), and determine the new index of each point of the
+   * previous copy.  This is only possible if the master has removed
+   * points and appended new ones, but has not removed the last point
+   * of the previous copy.
+   *
+   * @param index_map receives the new index of each old point, or
+   * #removed_index if it was removed
+   * @return false if the indexes cannot be mapped; the working trace
+   * is undefined then and UpdateTraceFull() must be called
+   */
+  bool UpdateTraceRemap(std::vector<unsigned> &index_map) noexcept;
+
   [[gnu::pure]]
   const TracePoint &GetPoint(unsigned i) const noexcept {
     assert(i < n_points);
@@ -84,6 +129,14 @@ protected:
     return *trace[i];
   }
 
+  /**
+   * Returns the shared #TraceDistanceMatrix if it is consistent with
+   * the working trace, nullptr otherwise (e.g. if another solver has
+   * updated it after the master trace was thinned).
+   */
+  [[gnu::pure]]
+  const TraceDistanceMatrix *GetDistanceMatrix() const noexcept;
+
   [[gnu::pure]]
   bool IsMasterUpdated(bool continuous) const noexcept;
 
@@ -13,4 +13,6 @@ struct GlideSettings {
   bool predict_wind_drift;
 
   void SetDefaults();
+
+  bool operator==(const GlideSettings &) const noexcept = default;
 };
@@ -5,6 +5,9 @@
 
 #include "util/ReservablePriorityQueue.hpp"
 
+#include <optional>
+#include <vector>
+
 #define DIJKSTRA_MINMAX_OFFSET 134217727
 
 /**
@@ -202,6 +205,46 @@ public:
       q.emplace(i.second.value, i);
   }
 
+  /**
+   * Replace the edge map, e.g. after the underlying point list has
+   * been modified.  Pending queue entries are carried over for all
+   * nodes which exist in the new edge map.
+   *
+   * @param new_edges the new edge map; it may be prepared with
+   * GetEdgeMap() still referring to the old one
+   * @param f a function which translates an old node to a new one
+   * (returning std::optional<Node>); std::nullopt drops the queue
+   * entry
+   */
+  template<typename F>
+  void ReplaceEdgeMap(EdgeMap &&new_edges, F &&f) noexcept {
+    /* see the constructor: iterators in the queue must not be
+       invalidated by rehashing */
+    new_edges.max_load_factor(edges.max_load_factor());
+    new_edges.rehash(edges.bucket_count());
+
+    std::vector<Value> pending;
+    pending.reserve(q.size());
+    for (; !q.empty(); q.pop()) {
+      const Value &i = q.top();
+      if (i.iterator->second.value < i.edge_value)
+        /* obsolete entry */
+        continue;
+
+      if (const std::optional<Node> node = f(i.iterator->first)) {
+        const auto j = new_edges.find(*node);
+        if (j != new_edges.end())
+          pending.emplace_back(j->second.value, j);
+      }
+    }
+
+    /* swapping preserves the iterators in "pending" */
+    edges.swap(new_edges);
+
+    for (const auto &i : pending)
+      q.push(i);
+  }
+
 private:
   /**
    * Add node to search queue
@@ -3,9 +3,10 @@
 
 #pragma once
 
-#include "util/ReservablePriorityQueue.hpp"
+#include "util/FlatHashSet.hpp"
 
-#include <unordered_map>
+#include <algorithm>
+#include <vector>
 
 struct AStarPriorityValue
 {
@@ -47,58 +48,84 @@ struct AStarPriorityValue
  * AStar search algorithm, based on Dijkstra algorithm
  * Modifications by John Wharington to track optimal solution
  * @see http://en.giswiki.net/wiki/Dijkstra%27s_algorithm
+ *
+ * All nodes of a search live in one flat hash table; the open set is
+ * an indexed 4-ary heap of indexes into that table, which allows
+ * updating the value of a queued node in place.  Clear() keeps all
+ * allocated memory, so repeated searches do not allocate anything
+ * once the buffers have grown to the working set.
  */
 template <class Node, class Hash=std::hash<Node>,
           class KeyEqual=std::equal_to<Node>,
           bool m_min=true>
 class AStar
 {
-  typedef std::unordered_map<Node, AStarPriorityValue, Hash, KeyEqual> node_value_map;
+  static constexpr unsigned NOT_QUEUED = ~0u;
 
-  typedef typename node_value_map::iterator node_value_iterator;
-  typedef typename node_value_map::const_iterator node_value_const_iterator;
+  struct NodeEntry {
+    Node node;
 
-  typedef std::unordered_map<Node, Node, Hash, KeyEqual> node_parent_map;
+    /** the best predecessor found so far */
+    Node parent;
 
-  typedef typename node_parent_map::iterator node_parent_iterator;
-  typedef typename node_parent_map::const_iterator node_parent_const_iterator;
+    /** the best value found so far */
+    AStarPriorityValue value;
 
-  struct NodeValue {
-    AStarPriorityValue priority;
+    /** the position in #q or #NOT_QUEUED */
+    unsigned heap_index;
 
-    node_value_iterator iterator;
+    constexpr NodeEntry(const Node &_node, const Node &_parent,
+                        const AStarPriorityValue &_value) noexcept
+      :node(_node), parent(_parent), value(_value),
+       heap_index(NOT_QUEUED) {}
+  };
+
+  struct NodeEntryHash {
+    [[no_unique_address]] Hash hash;
+
+    [[gnu::pure]]
+    std::size_t operator()(const Node &node) const noexcept {
+      return hash(node);
+    }
 
-    constexpr
-    NodeValue(const AStarPriorityValue &_priority,
-              node_value_iterator _iterator) noexcept
-      :priority(_priority), iterator(_iterator) {}
+    [[gnu::pure]]
+    std::size_t operator()(const NodeEntry &entry) const noexcept {
+      return hash(entry.node);
+    }
   };
 
-  struct Rank {
-    constexpr
-    bool operator()(const NodeValue &x, const NodeValue &y) const noexcept {
-      return x.priority.f() > y.priority.f();
+  struct NodeEntryEqual {
+    [[no_unique_address]] KeyEqual equal;
+
+    [[gnu::pure]]
+    bool operator()(const NodeEntry &a, const Node &b) const noexcept {
+      return equal(a.node, b);
+    }
+
+    [[gnu::pure]]
+    bool operator()(const NodeEntry &a, const NodeEntry &b) const noexcept {
+      return equal(a.node, b.node);
     }
   };
 
   /**
-   * Stores the value of each node.  It is updated by push(), if a
-   * value lower than the current one is found.
+   * Stores the value and the predecessor of each node.  It is
+   * updated by Push(), if a value lower than the current one is
+   * found.
    */
-  node_value_map node_values;
+  FlatHashSet<NodeEntry, NodeEntryHash, NodeEntryEqual> nodes;
 
   /**
-   * Stores the predecessor of each node.  It is maintained by
-   * set_predecessor().
+   * The open set: a 4-ary min-heap of indexes into #nodes, lowest
+   * f() first.
    */
-  node_parent_map node_parents;
+  std::vector<unsigned> q;
 
   /**
-   * A sorted list of all possible node paths, lowest distance first.
+   * The index of the node returned by the last Pop() call or
+   * #NOT_QUEUED.
    */
-  reservable_priority_queue<NodeValue, std::vector<NodeValue>, Rank> q;
-
-  node_value_iterator cur;
+  unsigned cur = NOT_QUEUED;
 
 public:
   static constexpr unsigned DEFAULT_QUEUE_SIZE = 1024;
@@ -136,15 +163,13 @@ public:
     Push(node, node, AStarPriorityValue(0));
   }
 
-  /** Clears the queues */
+  /**
+   * Clears the queues.  The memory is kept for the next search.
+   */
   void Clear() noexcept {
-    // Clear the search queue
     q.clear();
-
-    // Clear the node_parent_map
-    node_parents.clear();
-    // Clear the node_value_map
-    node_values.clear();
+    nodes.Clear();
+    cur = NOT_QUEUED;
   }
 
   /**
@@ -173,14 +198,18 @@ public:
    * @return Node for processing
    */
   const Node &Pop() noexcept {
-    cur = q.top().iterator;
-
-    do { // remove this item
-      q.pop();
-    } while (!q.empty() && (q.top().priority > q.top().iterator->second));
-    // and all lower rank than this
+    cur = q.front();
+    nodes[cur].heap_index = NOT_QUEUED;
+
+    const unsigned last = q.back();
+    q.pop_back();
+    if (!q.empty()) {
+      q.front() = last;
+      nodes[last].heap_index = 0;
+      SiftDown(0);
+    }
 
-    return cur->first;
+    return nodes[cur].node;
   }
 
   /**
@@ -205,9 +234,8 @@ public:
    */
   [[gnu::pure]]
   Node GetPredecessor(const Node &node) const noexcept {
-    // Try to find the given node in the node_parent_map
-    node_parent_const_iterator it = node_parents.find(node);
-    if (it == node_parents.end())
+    const std::size_t i = nodes.Find(node);
+    if (i == nodes.npos)
       // first entry
       // If the node wasn't found
       // -> Return the given node itself
@@ -215,12 +243,13 @@ public:
 
     // If the node was found
     // -> Return the parent node
-    return it->second;
+    return nodes[i].parent;
   }
 
   /** Reserve queue size (if available) */
   void Reserve(unsigned size) noexcept {
     q.reserve(size);
+    nodes.Reserve(size);
   }
 
   /**
@@ -229,14 +258,14 @@ public:
    */
   [[gnu::pure]]
   AStarPriorityValue GetNodeValue(const Node &node) const noexcept {
-    if (cur->first == node)
-      return cur->second;
+    if (cur != NOT_QUEUED && KeyEqual{}(nodes[cur].node, node))
+      return nodes[cur].value;
 
-    node_value_const_iterator it = node_values.find(node);
-    if (it == node_values.end())
+    const std::size_t i = nodes.Find(node);
+    if (i == nodes.npos)
       return AStarPriorityValue(0);
 
-    return it->second;
+    return nodes[i].value;
   }
 
 private:
@@ -249,37 +278,83 @@ private:
    */
   void Push(const Node &node, const Node &parent,
             const AStarPriorityValue &edge_value) noexcept {
-    // Try to find the given node n in the node_value_map
-    const auto [it, inserted] = node_values.try_emplace(node, edge_value);
+    const auto [i, inserted] = nodes.Emplace(node, node, parent, edge_value);
+    NodeEntry &entry = nodes[i];
     if (inserted) {
       // first entry
-      // If the node wasn't found
-      // -> Insert a new node into the node_value_map
-
-      // Remember the parent node
-      SetPredecessor(node, parent);
-    } else if (it->second > edge_value) {
+    } else if (entry.value > edge_value) {
       // If the node was found and the new value is smaller
-      // -> Replace the value with the new one
-      it->second = edge_value;
-      // replace, it's bigger
-
-      // Remember the new parent node
-      SetPredecessor(node, parent);
+      // -> Replace the value and the parent node with the new one
+      entry.value = edge_value;
+      entry.parent = parent;
     } else
       // If the node was found but the value is higher or equal
       // -> Don't use this new leg
       return;
 
-    q.push(NodeValue(edge_value, it));
+    if (entry.heap_index == NOT_QUEUED) {
+      entry.heap_index = q.size();
+      q.push_back(i);
+    } else
+      /* the f() value may have grown, too */
+      SiftDown(entry.heap_index);
+
+    SiftUp(nodes[i].heap_index);
+  }
+
+  [[gnu::pure]]
+  unsigned GetF(unsigned i) const noexcept {
+    return nodes[i].value.f();
+  }
+
+  void Place(unsigned i, unsigned position) noexcept {
+    q[position] = i;
+    nodes[i].heap_index = position;
   }
 
-  void SetPredecessor(const Node &node, const Node &parent) noexcept {
-    // Try to find the given node in the node_parent_map
-    auto result = node_parents.try_emplace(node, parent);
-    if (!result.second)
-      // If the node was found
-      // -> Replace the according parent node with the new one
-      result.first->second = parent;
+  void SiftUp(unsigned position) noexcept {
+    const unsigned i = q[position];
+    const unsigned f = GetF(i);
+
+    while (position > 0) {
+      const unsigned parent = (position - 1) / 4;
+      if (GetF(q[parent]) <= f)
+        break;
+
+      Place(q[parent], position);
+      position = parent;
+    }
+
+    Place(i, position);
+  }
+
+  void SiftDown(unsigned position) noexcept {
+    const unsigned i = q[position];
+    const unsigned f = GetF(i);
+    const unsigned n = q.size();
+
+    while (true) {
+      const unsigned first_child = position * 4 + 1;
+      if (first_child >= n)
+        break;
+
+      unsigned best = first_child, best_f = GetF(q[first_child]);
+      const unsigned end_child = std::min(first_child + 4, n);
+      for (unsigned child = first_child + 1; child < end_child; ++child) {
+        const unsigned child_f = GetF(q[child]);
+        if (child_f < best_f) {
+          best = child;
+          best_f = child_f;
+        }
+      }
+
+      if (best_f >= f)
+        break;
+
+      Place(q[best], position);
+      position = best;
+    }
+
+    Place(i, position);
   }
 };
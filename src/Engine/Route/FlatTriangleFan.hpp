@@ -50,6 +50,16 @@ public:
     vs.clear();
   }
 
+  /**
+   * Move all vertices and the origin height by the given offset.
+   * The bounding box must be recalculated afterwards.
+   */
+  void Translate(FlatGeoPoint delta, int delta_height) noexcept {
+    for (auto &v : vs)
+      v += delta;
+    height += delta_height;
+  }
+
   std::span<const FlatGeoPoint> GetVertices() const noexcept {
     return vs;
   }
@@ -11,6 +11,11 @@
 
 #define REACH_SWEEP (ROUTEPOLAR_Q1-BUFFER)
 
+struct FlatTriangleFanTree::Gap {
+  FlatTriangleFanTree *node;
+  RouteLink e_1, e_2;
+};
+
 static bool
 AlmostTheSame(const FlatGeoPoint p1, const FlatGeoPoint p2) noexcept
 {
@@ -27,6 +32,15 @@ TooClose(const FlatGeoPoint p1, const FlatGeoPoint p2) noexcept
   return dmax < FlatTriangleFanTree::MIN_STEP;
 }
 
+static bool
+IsNear(const FlatGeoPoint p1, const FlatGeoPoint p2,
+       const unsigned tolerance) noexcept
+{
+  const FlatGeoPoint k = p1 - p2;
+  const unsigned dmax = std::max<unsigned>(std::abs(k.x), std::abs(k.y));
+  return dmax <= tolerance;
+}
+
 const FlatBoundingBox &
 FlatTriangleFanTree::CalcBoundingBox() noexcept
 {
@@ -56,6 +70,60 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin,
   CalcBoundingBox();
 }
 
+void
+FlatTriangleFanTree::UpdateReach(const AFlatGeoPoint &origin,
+                                 const FlatGeoPoint delta,
+                                 const int delta_height,
+                                 const unsigned tolerance,
+                                 ReachFanParms &parms) noexcept
+{
+  assert(IsRoot());
+
+  LeafVector previous;
+  previous.swap(children);
+  for (auto &child : previous)
+    child.Translate(delta, delta_height);
+
+  fan.Clear();
+  FillReach(origin, 0, ROUTEPOLAR_POINTS, parms);
+
+  /* this replaces FillDepth() at depth 0 */
+  gaps_filled = true;
+  FillGaps(origin, parms, &previous, tolerance);
+
+  /* fill the gaps of the new children; the reused ones have been
+     filled already */
+  for (parms.set_depth = 1; parms.set_depth < MAX_DEPTH;
+      ++parms.set_depth)
+    if (!FillDepth(origin, parms))
+      break;
+
+  CalcBoundingBox();
+}
+
+void
+FlatTriangleFanTree::Translate(const FlatGeoPoint delta,
+                               const int delta_height) noexcept
+{
+  fan.Translate(delta, delta_height);
+
+  for (auto &i : gap)
+    i += delta;
+
+  for (auto &child : children)
+    child.Translate(delta, delta_height);
+}
+
+void
+FlatTriangleFanTree::CountChildren(ReachFanParms &parms) const noexcept
+{
+  for (const auto &child : children) {
+    parms.vertex_counter += child.fan.GetVertices().size();
+    parms.fan_counter++;
+    child.CountChildren(parms);
+  }
+}
+
 void
 FlatTriangleFanTree::DummyReach(const AFlatGeoPoint &ao) noexcept
 {
@@ -69,6 +137,9 @@ bool
 FlatTriangleFanTree::FillDepth(const AFlatGeoPoint &origin,
                                ReachFanParms &parms) noexcept
 {
+  if (IsRoot() && parms.for_each != nullptr)
+    return FillDepthParallel(origin, parms);
+
   if (depth == parms.set_depth) {
     if (gaps_filled)
       return true;
@@ -88,6 +159,77 @@ FlatTriangleFanTree::FillDepth(const AFlatGeoPoint &origin,
   return true;
 }
 
+bool
+FlatTriangleFanTree::FillDepthParallel(const AFlatGeoPoint &origin,
+                                       ReachFanParms &parms) noexcept
+{
+  assert(IsRoot());
+
+  std::vector<FlatTriangleFanTree *> nodes;
+  CollectDepth(parms.set_depth, nodes);
+
+  std::vector<Gap> gaps;
+  std::vector<std::size_t> gaps_end;
+  gaps_end.reserve(nodes.size());
+  for (auto *node : nodes) {
+    node->CollectGaps(origin, parms, gaps, nullptr, 0);
+    gaps_end.push_back(gaps.size());
+  }
+
+  std::vector<std::optional<FlatTriangleFanTree>> results(gaps.size());
+  SolveGaps(origin, gaps, results.data(), parms);
+
+  /* the limits are checked before each node just like FillDepth()
+     does; results beyond the limit are discarded */
+  std::size_t i = 0;
+  for (std::size_t n = 0; n < nodes.size(); ++n) {
+    auto &node = *nodes[n];
+    node.gaps_filled = true;
+
+    if (parms.vertex_counter > MAX_VERTICES)
+      return false;
+    if (parms.fan_counter > MAX_FANS)
+      return false;
+
+    for (; i < gaps_end[n]; ++i)
+      if (results[i])
+        node.AddChild(std::move(*results[i]), parms);
+  }
+
+  return true;
+}
+
+void
+FlatTriangleFanTree::CollectDepth(const unsigned set_depth,
+                                  std::vector<FlatTriangleFanTree *> &dest) noexcept
+{
+  if (depth == set_depth) {
+    if (!gaps_filled)
+      dest.push_back(this);
+  } else if (depth < set_depth) {
+    for (auto &child : children)
+      child.CollectDepth(set_depth, dest);
+  }
+}
+
+/**
+ * Find the end of a reach ray.
+ */
+static FlatGeoPoint
+ReachPoint(const ReachFanParms &parms, const int index,
+           const AFlatGeoPoint &origin, const GeoPoint &geo_origin) noexcept
+{
+  FlatGeoPoint x = parms.ReachIntercept(index, origin, geo_origin);
+  /* if ReachIntercept() did not find anything reasonable it returns
+     a FlatGeoPoint that is almost the same as origin, but differs
+     +/- 1 due to conversion errors. The resulting polygon can have
+     overlapping edges causing triangulation failures. */
+  if (AlmostTheSame(origin, x))
+    x = origin;
+
+  return x;
+}
+
 bool
 FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
                                const int index_high,
@@ -106,16 +248,21 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
   }
 
   fan.AddOrigin(origin, index_high - index_low);
-  for (int index = index_low; index < index_high; ++index) {
-    FlatGeoPoint x = parms.ReachIntercept(index, origin, geo_origin);
-    /* if ReachIntercept() did not find anything reasonable it returns
-       a FlatGeoPoint that is almost the same as origin, but differs
-       +/- 1 due to conversion errors. The resulting polygon can have
-       overlapping edges causing triangulation failures. */
-    if (AlmostTheSame(origin, x))
-      x = origin;
-
-    fan.AddPoint(x);
+
+  if (IsRoot() && parms.for_each != nullptr) {
+    /* the rays of the root fan are independent of each other */
+    std::array<FlatGeoPoint, ROUTEPOLAR_POINTS> points;
+    assert(index_high - index_low <= (int)points.size());
+
+    (*parms.for_each)(index_high - index_low, [&](unsigned i){
+      points[i] = ReachPoint(parms, index_low + i, origin, geo_origin);
+    });
+
+    for (int i = 0; i < index_high - index_low; ++i)
+      fan.AddPoint(points[i]);
+  } else {
+    for (int index = index_low; index < index_high; ++index)
+      fan.AddPoint(ReachPoint(parms, index, origin, geo_origin));
   }
 
   return fan.CommitPoints(IsRoot());
@@ -123,7 +270,29 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
 
 void
 FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin,
-                              ReachFanParms &parms) noexcept
+                              ReachFanParms &parms,
+                              LeafVector *previous,
+                              const unsigned tolerance) noexcept
+{
+  std::vector<Gap> gaps;
+  CollectGaps(origin, parms, gaps, previous, tolerance);
+  if (gaps.empty())
+    return;
+
+  std::vector<std::optional<FlatTriangleFanTree>> results(gaps.size());
+  SolveGaps(origin, gaps, results.data(), parms);
+
+  for (auto &i : results)
+    if (i)
+      AddChild(std::move(*i), parms);
+}
+
+void
+FlatTriangleFanTree::CollectGaps(const AFlatGeoPoint &origin,
+                                 ReachFanParms &parms,
+                                 std::vector<Gap> &dest,
+                                 LeafVector *previous,
+                                 const unsigned tolerance) noexcept
 {
   // worth checking for gaps?
   if (const auto vertices = fan.GetVertices();
@@ -139,13 +308,33 @@ FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin,
 
       const RouteLink e(RoutePoint(*x, 0), origin, parms.projection);
       // check if children need to be added
-      CheckGap(origin, e_last, e, parms);
+      if (previous == nullptr ||
+          !ReuseGap(*previous, e_last.first, e.first, tolerance, parms))
+        dest.push_back({this, e_last, e});
 
       e_last = e;
     }
   }
 }
 
+void
+FlatTriangleFanTree::SolveGaps(const AFlatGeoPoint &origin,
+                               std::span<const Gap> gaps,
+                               std::optional<FlatTriangleFanTree> *dest,
+                               const ReachFanParms &parms) noexcept
+{
+  const auto solve = [&](unsigned i){
+    const Gap &gap = gaps[i];
+    dest[i] = gap.node->SolveGap(origin, gap.e_1, gap.e_2, parms);
+  };
+
+  if (parms.for_each != nullptr)
+    (*parms.for_each)(gaps.size(), solve);
+  else
+    for (unsigned i = 0; i < gaps.size(); ++i)
+      solve(i);
+}
+
 void
 FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint o,
                                        ReachFanParms &parms) noexcept
@@ -155,17 +344,32 @@ FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint o,
     return;
   }
 
-  for (const auto &x : fan.GetVertices()) {
-    const FlatGeoPoint av = (o + x) * 0.5;
-    const GeoPoint p = parms.projection.Unproject(av);
-    const auto h = parms.terrain->GetHeight(p);
-
-    if (h.IsWater())
-      /* water: assume 0m MSL */
-      parms.terrain_counter++;
-    else if (!h.IsInvalid()) {
-      parms.terrain_counter++;
-      parms.terrain_base += h.GetValue();
+  /* look up the heights in chunks, which is faster than looking
+     them up one by one */
+  constexpr std::size_t CHUNK = 64;
+  GeoPoint points[CHUNK];
+  TerrainHeight heights[CHUNK];
+
+  auto vertices = fan.GetVertices();
+  while (!vertices.empty()) {
+    const auto chunk = vertices.first(std::min(vertices.size(), CHUNK));
+    vertices = vertices.subspan(chunk.size());
+
+    for (std::size_t i = 0; i < chunk.size(); ++i) {
+      const FlatGeoPoint av = (o + chunk[i]) * 0.5;
+      points[i] = parms.projection.Unproject(av);
+    }
+
+    parms.terrain->GetHeights({points, chunk.size()}, heights);
+
+    for (const auto h : std::span{heights, chunk.size()}) {
+      if (h.IsWater())
+        /* water: assume 0m MSL */
+        parms.terrain_counter++;
+      else if (!h.IsInvalid()) {
+        parms.terrain_counter++;
+        parms.terrain_base += h.GetValue();
+      }
     }
   }
 
@@ -174,21 +378,40 @@ FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint o,
 }
 
 bool
-FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
-                              const RouteLink &e_2,
+FlatTriangleFanTree::ReuseGap(LeafVector &previous,
+                              const FlatGeoPoint a, const FlatGeoPoint b,
+                              const unsigned tolerance,
                               ReachFanParms &parms) noexcept
+{
+  for (auto before = previous.before_begin(), i = std::next(before);
+       i != previous.end(); before = i++) {
+    if (!IsNear(i->gap[0], a, tolerance) || !IsNear(i->gap[1], b, tolerance))
+      continue;
+
+    parms.vertex_counter += i->fan.GetVertices().size();
+    parms.fan_counter++;
+    i->CountChildren(parms);
+
+    children.splice_after(children.before_begin(), previous, before);
+    return true;
+  }
+
+  return false;
+}
+
+std::optional<FlatTriangleFanTree>
+FlatTriangleFanTree::SolveGap(const AFlatGeoPoint &n, const RouteLink &e_1,
+                              const RouteLink &e_2,
+                              const ReachFanParms &parms) const noexcept
 {
   const bool side = (e_1.d > e_2.d);
   const RouteLink &e_long = (side ? e_1 : e_2);
   const RouteLink &e_short = (side ? e_2 : e_1);
   if (e_short.d >= e_long.d)
-    return false;
+    return std::nullopt;
 
   const FlatGeoPoint &p_long = e_long.first;
 
-  // return true if this gap was caught (applicable) whether or not it generated
-  // a change
-
   const auto f0 = e_short.d * e_long.inv_d;
   const int h_loss =
     parms.rpolars.CalcGlideArrival(n, p_long, parms.projection) - n.altitude;
@@ -215,15 +438,21 @@ FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
     const AFlatGeoPoint x(px, h);
 
     FlatTriangleFanTree child(depth + 1);
-    if (child.FillReach(x, index_left, index_right, parms)) {
-      parms.vertex_counter += child.fan.GetVertices().size();
-      parms.fan_counter++;
-      children.emplace_front(std::move(child));
-      return true;
-    }
+    child.gap = {e_1.first, e_2.first};
+    if (child.FillReach(x, index_left, index_right, parms))
+      return child;
   }
 
-  return false;
+  return std::nullopt;
+}
+
+void
+FlatTriangleFanTree::AddChild(FlatTriangleFanTree &&child,
+                              ReachFanParms &parms) noexcept
+{
+  parms.vertex_counter += child.fan.GetVertices().size();
+  parms.fan_counter++;
+  children.emplace_front(std::move(child));
 }
 
 int
@@ -7,8 +7,12 @@
 #include "util/SliceAllocator.hxx"
 #include "FlatTriangleFan.hpp"
 
+#include <array>
 #include <cstdint>
 #include <forward_list>
+#include <optional>
+#include <span>
+#include <vector>
 
 class FlatProjection;
 struct GeoPoint;
@@ -37,6 +41,19 @@ private:
 
   FlatBoundingBox bb_children;
   LeafVector children;
+
+  /**
+   * The two vertices of the parent fan whose gap this child fills
+   * (translated along with the tree).  Used by UpdateReach() to
+   * decide whether the child is still valid.
+   */
+  std::array<FlatGeoPoint, 2> gap;
+
+  /**
+   * A gap between two rays of a fan, to be filled by a child.
+   */
+  struct Gap;
+
   uint_least8_t depth;
   bool gaps_filled = false;
 
@@ -62,6 +79,19 @@ public:
   }
 
   void FillReach(const AFlatGeoPoint &origin, ReachFanParms &parms) noexcept;
+
+  /**
+   * Incremental version of FillReach() for a root which has been
+   * filled before, after the origin has moved by a short distance.
+   * The root fan is solved again; child trees whose gap in the new
+   * root fan is still within #tolerance of where it was (after
+   * translating by #delta) are translated, all others are solved
+   * again.
+   */
+  void UpdateReach(const AFlatGeoPoint &origin,
+                   FlatGeoPoint delta, int delta_height,
+                   unsigned tolerance, ReachFanParms &parms) noexcept;
+
   void DummyReach(const AFlatGeoPoint &origin) noexcept;
 
   /**
@@ -99,6 +129,14 @@ private:
 
   const FlatBoundingBox &CalcBoundingBox() noexcept;
 
+  void Translate(FlatGeoPoint delta, int delta_height) noexcept;
+
+  /**
+   * Add the number of fans and vertices of all children to the
+   * counters in #parms.
+   */
+  void CountChildren(ReachFanParms &parms) const noexcept;
+
   /**
    * @return true if a valid fan has been filled, false to discard
    * this object
@@ -108,8 +146,67 @@ private:
                  const ReachFanParms &parms) noexcept;
 
   bool FillDepth(const AFlatGeoPoint &origin, ReachFanParms &parms) noexcept;
-  void FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms) noexcept;
 
-  bool CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
-                const RouteLink &e_2, ReachFanParms &parms) noexcept;
+  /**
+   * Parallel version of FillDepth() for the root: the gaps of all
+   * fans at the current depth are solved via ReachFanParms::for_each
+   * and then merged in the order in which FillDepth() would have
+   * solved them.
+   */
+  bool FillDepthParallel(const AFlatGeoPoint &origin,
+                         ReachFanParms &parms) noexcept;
+
+  /**
+   * Collect all trees at the given depth whose gaps have not been
+   * filled yet, in the order visited by FillDepth().
+   */
+  void CollectDepth(unsigned set_depth,
+                    std::vector<FlatTriangleFanTree *> &dest) noexcept;
+
+  /**
+   * @param previous if not nullptr, then children from this list
+   * are reused (instead of calling SolveGap()) if their gap matches
+   * within #tolerance
+   */
+  void FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms,
+                LeafVector *previous=nullptr,
+                unsigned tolerance=0) noexcept;
+
+  /**
+   * Move a child matching the given gap from #previous to this
+   * object's children.
+   *
+   * @return true if a matching child was found
+   */
+  bool ReuseGap(LeafVector &previous, FlatGeoPoint a, FlatGeoPoint b,
+                unsigned tolerance, ReachFanParms &parms) noexcept;
+
+  /**
+   * Append the gaps of this fan which need to be filled to #dest.
+   *
+   * @param previous see FillGaps()
+   */
+  void CollectGaps(const AFlatGeoPoint &origin, ReachFanParms &parms,
+                   std::vector<Gap> &dest,
+                   LeafVector *previous, unsigned tolerance) noexcept;
+
+  /**
+   * Solve the given gaps, via ReachFanParms::for_each if set.
+   *
+   * @param dest an array with the same size as #gaps
+   */
+  static void SolveGaps(const AFlatGeoPoint &origin, std::span<const Gap> gaps,
+                        std::optional<FlatTriangleFanTree> *dest,
+                        const ReachFanParms &parms) noexcept;
+
+  /**
+   * Attempt to fill the gap between two rays with a child fan.  This
+   * does not modify this object, and may be called from any thread.
+   */
+  std::optional<FlatTriangleFanTree> SolveGap(const AFlatGeoPoint &n,
+                                              const RouteLink &e_1,
+                                              const RouteLink &e_2,
+                                              const ReachFanParms &parms) const noexcept;
+
+  void AddChild(FlatTriangleFanTree &&child, ReachFanParms &parms) noexcept;
 };
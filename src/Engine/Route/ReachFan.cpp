@@ -8,16 +8,68 @@
 
 static constexpr int MIN_FLOOR_CLEARANCE = 100;
 
+/**
+ * Update() falls back to Solve() when the origin is further than this
+ * from the last full solution (in flat projection units, i.e. about
+ * 1 km).  Translated children sample the terrain where they were
+ * solved, so this limits their error.
+ */
+static constexpr unsigned MAX_UPDATE_DRIFT = 10;
+
+/**
+ * Fans are reused by Update() only if their gap and the glide range
+ * moved by not more than this (in flat projection units).
+ */
+static constexpr unsigned UPDATE_TOLERANCE = 3;
+
+[[gnu::pure]]
+static unsigned
+MaxNormDistance(const FlatGeoPoint a, const FlatGeoPoint b) noexcept
+{
+  const FlatGeoPoint k = a - b;
+  return std::max<unsigned>(std::abs(k.x), std::abs(k.y));
+}
+
+/**
+ * The terrain-independent end of a reach ray, relative to its
+ * origin.
+ */
+[[gnu::pure]]
+static FlatGeoPoint
+GlideRange(const RoutePolars &rpolars, unsigned index,
+           const AFlatGeoPoint &ao, const GeoPoint &origin,
+           const FlatProjection &projection) noexcept
+{
+  return rpolars.ReachIntercept(index, ao, origin, nullptr, projection)
+    - (FlatGeoPoint)ao;
+}
+
+/**
+ * Immediate exit if starting below terrain, or starting below floor
+ * with some clearance (not worth scanning if too close).
+ */
+[[gnu::pure]]
+static bool
+IsTooLow(const AGeoPoint &origin, const TerrainHeight h,
+         const RoutePolars &rpolars) noexcept
+{
+  return (!h.IsInvalid() &&
+          (origin.altitude <= h.GetValueOr0() + rpolars.GetSafetyHeight()))
+    || (origin.altitude < MIN_FLOOR_CLEARANCE + rpolars.GetFloor() + rpolars.GetSafetyHeight());
+}
+
 void
 ReachFan::Reset() noexcept
 {
   root.Clear();
   terrain_base = 0;
+  updatable = false;
 }
 
 bool
 ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
-                const RasterMap* terrain, const bool do_solve) noexcept
+                const RasterMap* terrain, const bool do_solve,
+                const ReachForEach *for_each) noexcept
 {
   Reset();
 
@@ -30,23 +82,69 @@ ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
   const int h2 = h.GetValueOr0();
 
   ReachFanParms parms(rpolars, projection, terrain_base, terrain);
+  parms.for_each = for_each;
   const AFlatGeoPoint ao(projection.ProjectInteger(origin), origin.altitude);
 
-  // immediate exit if starting below terrain, or starting below floor
-  // with some clearance (not worth scanning if too close)
-  if ((!h.IsInvalid() &&
-      (origin.altitude <= h2 + rpolars.GetSafetyHeight()))
-      || (origin.altitude < MIN_FLOOR_CLEARANCE + rpolars.GetFloor() + rpolars.GetSafetyHeight())) {
+  if (IsTooLow(origin, h, rpolars)) {
     terrain_base = h2;
     root.DummyReach(ao);
     return false;
   }
 
-  if (do_solve)
+  if (do_solve) {
     root.FillReach(ao, parms);
-  else
+
+    flat_origin = ao;
+    for (unsigned i = 0; i < ROUTEPOLAR_POINTS; ++i)
+      glide_range[i] = GlideRange(rpolars, i, ao, origin, projection);
+    updatable = terrain != nullptr;
+  } else
     root.DummyReach(ao);
 
+  UpdateTerrainBase(ao, h, parms);
+  return true;
+}
+
+bool
+ReachFan::Update(const AGeoPoint origin, const RoutePolars &rpolars,
+                 const RasterMap *terrain, const bool do_solve,
+                 const ReachForEach *for_each) noexcept
+{
+  if (!updatable || !do_solve || terrain == nullptr)
+    return Solve(origin, rpolars, terrain, do_solve, for_each);
+
+  const AFlatGeoPoint ao(projection.ProjectInteger(origin), origin.altitude);
+
+  /* the projection is centered at the origin of the last full
+     solution */
+  if (MaxNormDistance(ao, FlatGeoPoint(0, 0)) > MAX_UPDATE_DRIFT)
+    return Solve(origin, rpolars, terrain, do_solve, for_each);
+
+  const auto h = terrain->GetHeight(origin);
+  if (IsTooLow(origin, h, rpolars))
+    return Solve(origin, rpolars, terrain, do_solve, for_each);
+
+  for (unsigned i = 0; i < ROUTEPOLAR_POINTS; ++i)
+    if (MaxNormDistance(GlideRange(rpolars, i, ao, origin, projection),
+                        glide_range[i]) > UPDATE_TOLERANCE)
+      return Solve(origin, rpolars, terrain, do_solve, for_each);
+
+  ReachFanParms parms(rpolars, projection, terrain_base, terrain);
+  parms.for_each = for_each;
+  const FlatGeoPoint delta = (FlatGeoPoint)ao - (FlatGeoPoint)flat_origin;
+  root.UpdateReach(ao, delta, ao.altitude - flat_origin.altitude,
+                   UPDATE_TOLERANCE, parms);
+  flat_origin = ao;
+
+  UpdateTerrainBase(ao, h, parms);
+  return true;
+}
+
+void
+ReachFan::UpdateTerrainBase(const AFlatGeoPoint &ao, const TerrainHeight h,
+                            ReachFanParms &parms) noexcept
+{
+  const int h2 = h.GetValueOr0();
   if (!h.IsInvalid()) {
     parms.terrain_base = h2;
     parms.terrain_counter = 1;
@@ -59,7 +157,6 @@ ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
     root.UpdateTerrainBase(ao, parms);
 
   terrain_base = parms.terrain_base;
-  return true;
 }
 
 std::optional<ReachResult>
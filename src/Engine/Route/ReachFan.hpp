@@ -5,13 +5,18 @@
 
 #include "Geo/Flat/FlatProjection.hpp"
 #include "FlatTriangleFanTree.hpp"
+#include "RoutePolar.hpp"
+#include "ReachForEach.hpp"
 
+#include <array>
 #include <optional>
 
 class RoutePolars;
 class RasterMap;
 class GeoBounds;
+class TerrainHeight;
 struct ReachResult;
+struct ReachFanParms;
 
 class ReachFan
 {
@@ -19,6 +24,24 @@ class ReachFan
   FlatTriangleFanTree root;
   int terrain_base = 0;
 
+  /**
+   * Can Update() build on the current solution?
+   */
+  bool updatable = false;
+
+  /**
+   * The origin of the current solution.
+   */
+  AFlatGeoPoint flat_origin;
+
+  /**
+   * The terrain-independent end of each ray of the last full
+   * Solve(), relative to its origin.  Update() compares this with
+   * the current one to detect changes of altitude, polar and wind
+   * which are too large for an incremental update.
+   */
+  std::array<FlatGeoPoint, ROUTEPOLAR_POINTS> glide_range;
+
 public:
   friend class PrintHelper;
 
@@ -32,8 +55,25 @@ public:
 
   void Reset() noexcept;
 
+  /**
+   * @param for_each if not nullptr, then independent parts of the
+   * calculation are run through it, possibly concurrently
+   */
   bool Solve(const AGeoPoint origin, const RoutePolars &rpolars,
-             const RasterMap *terrain, const bool do_solve = true) noexcept;
+             const RasterMap *terrain, const bool do_solve = true,
+             const ReachForEach *for_each = nullptr) noexcept;
+
+  /**
+   * Like Solve(), but if the origin is close to the one of the
+   * previous call, only the root fan is solved again, and the
+   * children of the previous solution are translated instead of
+   * being solved again, unless the root fan around them has changed.
+   * This is an approximation; falls back to Solve() when the origin
+   * has drifted too far from the last full solution.
+   */
+  bool Update(const AGeoPoint origin, const RoutePolars &rpolars,
+              const RasterMap *terrain, const bool do_solve = true,
+              const ReachForEach *for_each = nullptr) noexcept;
 
   /**
    * Find arrival height at destination.
@@ -57,4 +97,8 @@ public:
   int GetTerrainBase() const noexcept {
     return terrain_base;
   }
+
+private:
+  void UpdateTerrainBase(const AFlatGeoPoint &ao, TerrainHeight h,
+                         ReachFanParms &parms) noexcept;
 };
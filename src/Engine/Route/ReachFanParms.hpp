@@ -4,6 +4,7 @@
 #pragma once
 
 #include "Route/RoutePolars.hpp"
+#include "ReachForEach.hpp"
 
 class FlatProjection;
 class RasterMap;
@@ -18,6 +19,12 @@ struct ReachFanParms {
   unsigned vertex_counter = 0;
   unsigned char set_depth = 0;
 
+  /**
+   * If set, then independent rays and gaps are solved through it,
+   * possibly concurrently.  The result is the same as without it.
+   */
+  const ReachForEach *for_each = nullptr;
+
   ReachFanParms(const RoutePolars& _rpolars,
                 const FlatProjection &_projection,
                 const short _terrain_base,
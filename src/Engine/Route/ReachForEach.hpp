@@ -0,0 +1,16 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <functional>
+
+/**
+ * Invokes the given function for each index in [0, n) and returns
+ * when all invocations have finished.  The invocations may run
+ * concurrently (e.g. via WorkerPool::ForEach()); this allows the
+ * reach calculation to use several cores without depending on a
+ * thread library.
+ */
+using ReachForEach =
+  std::function<void(unsigned n, const std::function<void(unsigned)> &f)>;
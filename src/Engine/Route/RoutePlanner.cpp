@@ -18,7 +18,7 @@ RoutePlanner::Reset() noexcept
   dirty = true;
   solution_route.clear();
   planner.Clear();
-  unique_links.clear();
+  unique_links.Clear();
   h_min = -1;
   h_max = 0;
   search_hull.clear();
@@ -113,11 +113,15 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
     if (IsSetUnique(e))
       AddEdges(e);
 
-    while (!links.empty()) {
-      AddEdges(links.front());
-      links.pop();
+    while (links_head < links.size()) {
+      /* copy: AddEdges() may append to the vector */
+      const RouteLink link = links[links_head++];
+      AddEdges(link);
     }
 
+    links.clear();
+    links_head = 0;
+
   }
 
   count_unique = unique_links.size();
@@ -141,7 +145,7 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
   }
 
   planner.Clear();
-  unique_links.clear();
+  unique_links.Clear();
   // m_search_hull.clear();
   return retval;
 }
@@ -237,7 +241,7 @@ RoutePlanner::LinkCleared(const RouteLink &e) noexcept
 bool
 RoutePlanner::IsSetUnique(const RouteLinkBase &e) noexcept
 {
-  const bool inserted = unique_links.insert(e).second;
+  const bool inserted = unique_links.Insert(e).second;
   if (inserted)
     return true;
 
@@ -256,7 +260,7 @@ RoutePlanner::AddCandidate(const RouteLinkBase &e) noexcept
   const RouteLink c_link =
       rpolars_route.GenerateIntermediate(e.first, e.second, projection);
 
-  links.push(c_link);
+  links.push_back(c_link);
 }
 
 void
@@ -265,7 +269,7 @@ RoutePlanner::AddCandidate(const RouteLink &e) noexcept
   if (!IsSetUnique(e))
     return;
 
-  links.push(e);
+  links.push_back(e);
 }
 
 void
@@ -9,9 +9,10 @@
 #include "AStar.hpp"
 #include "Geo/Flat/FlatProjection.hpp"
 #include "Geo/SearchPointVector.hpp"
+#include "util/FlatHashSet.hpp"
 
 #include <utility>
-#include <unordered_set>
+#include <vector>
 
 #include <limits.h>
 
@@ -92,13 +93,20 @@ private:
    */
   SearchPointVector search_hull;
 
-  typedef std::unordered_set<RouteLinkBase, RouteLinkBaseHasher> RouteLinkSet;
+  typedef FlatHashSet<RouteLinkBase, RouteLinkBaseHasher> RouteLinkSet;
 
-  /** Links that have been visited during solution */
-  RouteLinkSet unique_links{50000};
-  typedef std::queue< RouteLink> RouteLinkQueue;
-  /** Link candidates to be processed for intersection tests */
-  RouteLinkQueue links;
+  /**
+   * Links that have been visited during solution.  Like #planner,
+   * it keeps its memory between solutions.
+   */
+  RouteLinkSet unique_links;
+
+  /**
+   * Link candidates to be processed for intersection tests; a FIFO
+   * which is consumed from #links_head and cleared when empty.
+   */
+  std::vector<RouteLink> links;
+  std::size_t links_head = 0;
 
   /** Result route found by solve() method */
   Route solution_route;
@@ -47,6 +47,20 @@ TerrainRoute::SolveReach(const AGeoPoint &origin,
   return reach;
 }
 
+void
+TerrainRoute::UpdateReach(ReachFan &reach, const AGeoPoint &origin,
+                          const RoutePlannerConfig &config,
+                          const int h_ceiling,
+                          const bool do_solve,
+                          const bool working,
+                          const ReachForEach *for_each) noexcept
+{
+  auto &rpolars = working ? rpolars_reach_working : rpolars_reach;
+  rpolars.SetConfig(config, origin.altitude, h_ceiling);
+
+  reach.Update(origin, rpolars, terrain, do_solve, for_each);
+}
+
 /*
   @todo:
   - check wind directions are correct
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "RoutePlanner.hpp"
+#include "ReachForEach.hpp"
 
 class ReachFan;
 
@@ -61,6 +62,16 @@ public:
                       int h_ceiling, bool do_solve,
                       bool working) noexcept;
 
+  /**
+   * Like SolveReach(), but update the given (previous) solution
+   * incrementally if possible (see ReachFan::Update()).
+   */
+  void UpdateReach(ReachFan &reach, const AGeoPoint &origin,
+                   const RoutePlannerConfig &config,
+                   int h_ceiling, bool do_solve,
+                   bool working,
+                   const ReachForEach *for_each=nullptr) noexcept;
+
   /**
    * Determine if intersection with terrain occurs in forwards direction from
    * origin to destination, with cruise-climb and glide segments.
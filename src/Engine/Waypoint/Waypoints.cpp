@@ -121,10 +121,8 @@ Waypoints::GetNearest(const GeoPoint &loc, double range) const noexcept
   if (IsEmpty())
     return nullptr;
 
-  const FlatGeoPoint flat_location = task_projection.ProjectInteger(loc);
-  const WaypointTree::Point point(flat_location.x, flat_location.y);
   const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
-  const auto found = waypoint_tree.FindNearest(point, mrange);
+  const auto found = waypoint_tree.FindNearest(Project(loc), mrange);
 
   if (found.first == waypoint_tree.end())
     return nullptr;
@@ -151,10 +149,8 @@ Waypoints::GetNearestIf(const GeoPoint &loc, double range,
   if (IsEmpty())
     return nullptr;
 
-  const FlatGeoPoint flat_location = task_projection.ProjectInteger(loc);
-  const WaypointTree::Point point(flat_location.x, flat_location.y);
   const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
-  const auto found = waypoint_tree.FindNearestIf(point, mrange,
+  const auto found = waypoint_tree.FindNearestIf(Project(loc), mrange,
                                                  [predicate](const WaypointPtr &ptr){
                                                    return predicate(*ptr);
                                                  });
@@ -222,20 +218,6 @@ Waypoints::LookupId(const unsigned id) const noexcept
   return nullptr;
 }
 
-void
-Waypoints::VisitWithinRange(const GeoPoint &loc, const double range,
-                            WaypointVisitor visitor) const
-{
-  if (IsEmpty())
-    return; // nothing to do
-
-  const FlatGeoPoint flat_location = task_projection.ProjectInteger(loc);
-  const WaypointTree::Point point(flat_location.x, flat_location.y);
-  const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
-
-  waypoint_tree.VisitWithinRange(point, mrange, visitor);
-}
-
 void
 Waypoints::VisitNamePrefix(tstring_view prefix,
                            WaypointVisitor visitor) const
@@ -12,6 +12,7 @@
 #include "util/tstring_view.hxx"
 
 #include <functional>
+#include <span>
 
 using WaypointVisitor = std::function<void(const WaypointPtr &)>;
 
@@ -66,6 +67,12 @@ class Waypoints {
 
   WaypointPtr home;
 
+  [[gnu::pure]]
+  WaypointTree::Point Project(const GeoPoint &loc) const noexcept {
+    const FlatGeoPoint flat_location = task_projection.ProjectInteger(loc);
+    return {flat_location.x, flat_location.y};
+  }
+
 public:
   using const_iterator = WaypointTree::const_iterator;
 
@@ -273,10 +280,18 @@ public:
    *
    * @param loc Location from which to search
    * @param range Distance in meters of search radius
-   * @param visitor Visitor to be called on waypoints within range
+   * @param visitor Visitor to be called on waypoints within range;
+   * any function object accepting a #WaypointPtr
    */
+  template<typename V>
   void VisitWithinRange(const GeoPoint &loc, double range,
-                        WaypointVisitor visitor) const;
+                        V &&visitor) const {
+    if (IsEmpty())
+      return; // nothing to do
+
+    const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
+    waypoint_tree.VisitWithinRange(Project(loc), mrange, visitor);
+  }
 
   /**
    * Call visitor function on waypoints with the specified name
@@ -306,6 +321,22 @@ public:
   [[gnu::pure]]
   WaypointPtr GetNearest(const GeoPoint &loc, double range) const noexcept;
 
+  /**
+   * Looks up the waypoints nearest to the search location, ordered
+   * by increasing distance.
+   *
+   * @param dest Buffer which receives the waypoints; its size is the
+   * maximum number of waypoints to be found
+   *
+   * @return the number of waypoints copied to the beginning of #dest
+   */
+  std::size_t GetNearest(const GeoPoint &loc, double range,
+                         std::span<WaypointPtr> dest) const noexcept {
+    return GetNearestIf(loc, range, dest, [](const Waypoint &){
+      return true;
+    });
+  }
+
   /**
    * Looks up nearest landable waypoint to the
    * search location within the given range.
@@ -335,6 +366,33 @@ public:
   WaypointPtr GetNearestIf(const GeoPoint &loc, double range,
                            bool (*predicate)(const Waypoint &)) const noexcept;
 
+  /**
+   * Looks up the waypoints nearest to the search location, ordered
+   * by increasing distance.  Performs search according to flat-earth
+   * internal representation, so is approximate.
+   *
+   * @param loc Location from which to search
+   * @param dest Buffer which receives the waypoints; its size is the
+   * maximum number of waypoints to be found
+   * @param predicate Callback that checks whether the waypoint
+   * is suitable for the request
+   *
+   * @return the number of waypoints copied to the beginning of #dest
+   */
+  template<typename P>
+  std::size_t GetNearestIf(const GeoPoint &loc, double range,
+                           std::span<WaypointPtr> dest,
+                           P &&predicate) const noexcept {
+    if (IsEmpty())
+      return 0;
+
+    const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
+    return waypoint_tree.FindNearestIf(Project(loc), mrange, dest,
+                                       [&predicate](const WaypointPtr &ptr){
+                                         return predicate(*ptr);
+                                       });
+  }
+
   /**
    * Access first waypoint in store, for use in iterators.
    *
@@ -15,6 +15,9 @@
 #include "NMEA/Info.hpp"
 #include "Terrain/RasterTerrain.hpp"
 
+#include <array>
+#include <span>
+
 void
 MapItemListBuilder::AddLocation(const NMEAInfo &basic,
                                 const RasterTerrain *terrain)
@@ -73,10 +76,14 @@ MapItemListBuilder::AddSelfIfNear(const GeoPoint &self, Angle bearing)
 void
 MapItemListBuilder::AddWaypoints(const Waypoints &waypoints)
 {
-  waypoints.VisitWithinRange(location, range, [&list=list](const auto &w){
-    if (!list.full())
-      list.append(new WaypointMapItem(w));
-  });
+  /* if there are more waypoints in range than fit into the list,
+     prefer the nearest ones */
+  std::array<WaypointPtr, MapItemList::capacity()> nearest;
+  const std::size_t n =
+    waypoints.GetNearest(location, range,
+                         std::span{nearest}.first(list.capacity() - list.size()));
+  for (std::size_t i = 0; i < n; ++i)
+    list.append(new WaypointMapItem(nearest[i]));
 }
 
 void
@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "MapWindow.hpp"
+#include "Computer/GlideComputer.hpp"
 
 void
 MapWindow::DrawWaypoints(Canvas &canvas)
@@ -11,5 +12,8 @@ MapWindow::DrawWaypoints(Canvas &canvas)
                            GetComputerSettings().polar,
                            GetComputerSettings().task,
                            Basic(), Calculated(),
-                           task, route_planner);
+                           task, route_planner,
+                           glide_computer != nullptr
+                           ? &glide_computer->GetWaypointArrivals()
+                           : nullptr);
 }
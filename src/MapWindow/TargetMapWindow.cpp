@@ -156,7 +156,10 @@ TargetMapWindow::DrawWaypoints(Canvas &canvas)
                             GetComputerSettings().polar,
                             GetComputerSettings().task,
                             Basic(), Calculated(),
-                            task, nullptr);
+                            task, nullptr,
+                            glide_computer != nullptr
+                            ? &glide_computer->GetWaypointArrivals()
+                            : nullptr);
 }
 
 inline void
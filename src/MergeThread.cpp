@@ -32,7 +32,7 @@ MergeThread::Process()
 {
   assert(!IsDefined() || IsInside());
 
-  device_blackboard.Merge();
+  const unsigned modified = device_blackboard.Merge();
 
   const MoreData &basic = device_blackboard.Basic();
   const ComputerSettings &settings_computer =
@@ -42,8 +42,15 @@ MergeThread::Process()
   computer.Compute(device_blackboard.SetMoreData(), last_any, last_fix,
                    device_blackboard.Calculated());
 
-  flarm_computer.Process(device_blackboard.SetBasic().flarm,
-                         last_fix.flarm, basic);
+  FlarmData &flarm = device_blackboard.SetBasic().flarm;
+  const FlarmComputerInput input(basic);
+  if ((modified & NMEAInfo::MERGE_FLARM) || input != flarm_input) {
+    flarm_computer.Process(flarm, last_fix.flarm, basic);
+    computed_flarm = flarm;
+    flarm_input = input;
+  } else
+    /* the same input would produce the same result */
+    flarm = computed_flarm;
 }
 
 void
@@ -32,6 +32,35 @@ class MergeThread final : public WorkerThread {
   BasicComputer computer;
   FlarmComputer flarm_computer;
 
+  /**
+   * The own position which was used by the last #flarm_computer run.
+   */
+  struct FlarmComputerInput {
+    TimeStamp time;
+    GeoPoint location;
+    double gps_altitude;
+    bool time_available, location_available, gps_altitude_available;
+
+    FlarmComputerInput() = default;
+
+    explicit FlarmComputerInput(const NMEAInfo &basic) noexcept
+      :time(basic.time), location(basic.location),
+       gps_altitude(basic.gps_altitude),
+       time_available(basic.time_available),
+       location_available(basic.location_available),
+       gps_altitude_available(basic.gps_altitude_available) {}
+
+    bool operator==(const FlarmComputerInput &) const noexcept = default;
+  };
+
+  FlarmComputerInput flarm_input;
+
+  /**
+   * The result of the last #flarm_computer run.  It is reused as
+   * long as neither the FLARM data nor #flarm_input was modified.
+   */
+  FlarmData computed_flarm;
+
 public:
   MergeThread(DeviceBlackboard &_device_blackboard);
 
@@ -11,23 +11,51 @@
 
 bool
 VerifyNMEAChecksum(const char *p)
+{
+  return FindVerifiedNMEAChecksum(p) != nullptr;
+}
+
+const char *
+FindVerifiedNMEAChecksum(const char *p) noexcept
 {
   assert(p != NULL);
 
-  const char *asterisk = strrchr(p, '*');
-  if (asterisk == NULL)
-    return false;
+  /* skip the dollar sign at the beginning (the exclamation mark is
+     used by CAI302 */
+  if (*p == '$' || *p == '!')
+    ++p;
+
+  /* calculate the checksum while looking for the first and the last
+     asterisk; the checksum follows the last one, but the first one
+     ends the line for NMEAInputLine */
+  const char *first_asterisk = nullptr, *asterisk = nullptr;
+  uint8_t checksum = 0, CalcCheckSum = 0;
+  for (; *p != 0; ++p) {
+    if (*p == '*') {
+      if (first_asterisk == nullptr)
+        first_asterisk = p;
+
+      asterisk = p;
+      CalcCheckSum = checksum;
+    }
+
+    checksum ^= *p;
+  }
+
+  if (asterisk == nullptr)
+    return nullptr;
 
   const char *checksum_string = asterisk + 1;
   char *endptr;
   unsigned long ReadCheckSum2 = strtoul(checksum_string, &endptr, 16);
   if (endptr == checksum_string || *endptr != 0 || ReadCheckSum2 >= 0x100)
-    return false;
+    return nullptr;
 
   uint8_t ReadCheckSum = (unsigned char)ReadCheckSum2;
-  uint8_t CalcCheckSum = NMEAChecksum(p, asterisk - p);
+  if (CalcCheckSum != ReadCheckSum)
+    return nullptr;
 
-  return CalcCheckSum == ReadCheckSum;
+  return first_asterisk;
 }
 
 void
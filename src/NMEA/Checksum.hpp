@@ -64,6 +64,19 @@ NMEAChecksum(const char *p, unsigned length)
 bool
 VerifyNMEAChecksum(const char *p);
 
+/**
+ * Like VerifyNMEAChecksum(), but returns the position of the first
+ * asterisk, which can be passed to #NMEAInputLine.  This scans the
+ * line only once.
+ *
+ * @return the first asterisk (which is not the one preceding the
+ * checksum if the line contains more than one) or nullptr if the
+ * checksum is missing or wrong
+ */
+[[gnu::pure]]
+const char *
+FindVerifiedNMEAChecksum(const char *p) noexcept;
+
 /**
  * Caclulates the checksum of the specified string, and appends it at
  * the end, preceded by an asterisk ('*').
@@ -5,6 +5,8 @@
 #include "Atmosphere/AirDensity.hpp"
 #include "time/Cast.hxx"
 
+#include <algorithm>
+
 void
 NMEAInfo::UpdateClock()
 {
@@ -85,8 +87,108 @@ NMEAInfo::ProvideIndicatedAirspeed(double ias)
     ProvideBothAirspeeds(ias, ias);
 }
 
+NMEAInfo::MergeStamps
+NMEAInfo::GetMergeStamps() const noexcept
+{
+  MergeStamps s;
+
+  s.airspeed = {
+    airspeed_available.ToInteger(),
+    external_wind_available.ToInteger(),
+    airspeed_real,
+  };
+
+  s.pressure = {
+    static_pressure_available.ToInteger(),
+    dyn_pressure_available.ToInteger(),
+    pitot_pressure_available.ToInteger(),
+    sensor_calibration_available.ToInteger(),
+    baro_altitude_available.ToInteger(),
+    pressure_altitude_available.ToInteger(),
+  };
+
+  s.vario = {
+    noncomp_vario_available.ToInteger(),
+    total_energy_vario_available.ToInteger(),
+    netto_vario_available.ToInteger(),
+  };
+
+  s.system = {
+    heart_rate_available.ToInteger(),
+    engine_noise_level_available.ToInteger(),
+    voltage_available.ToInteger(),
+    battery_level_available.ToInteger(),
+  };
+
+  s.flarm = {
+    flarm.traffic.modified.ToInteger(),
+    flarm.traffic.new_traffic.ToInteger(),
+    flarm.status.available.ToInteger(),
+    flarm.error.available.ToInteger(),
+    flarm.version.available.ToInteger(),
+    flarm.traffic.GetActiveTrafficCount(),
+  };
+
+  return s;
+}
+
+unsigned
+NMEAInfo::MergeStamps::Compare(const MergeStamps &other) const noexcept
+{
+  unsigned groups = 0;
+  if (airspeed != other.airspeed)
+    groups |= MERGE_AIRSPEED;
+  if (pressure != other.pressure)
+    groups |= MERGE_PRESSURE;
+  if (vario != other.vario)
+    groups |= MERGE_VARIO;
+  if (system != other.system)
+    groups |= MERGE_SYSTEM;
+  if (flarm != other.flarm)
+    groups |= MERGE_FLARM;
+  return groups;
+}
+
+template<std::size_t N>
+static constexpr bool
+Contains(const std::array<uint32_t, N> &stamps, uint32_t value) noexcept
+{
+  return std::find(stamps.begin(), stamps.end(), value) != stamps.end();
+}
+
+unsigned
+NMEAInfo::MergeStamps::Find(TimeStamp time) const noexcept
+{
+  /* the flags and counters mixed into the arrays are much smaller
+     than any valid stamp, and a false positive would only cause a
+     redundant merge anyway */
+  const auto value = Validity{time}.ToInteger();
+
+  unsigned groups = 0;
+  if (Contains(airspeed, value))
+    groups |= MERGE_AIRSPEED;
+  if (Contains(pressure, value))
+    groups |= MERGE_PRESSURE;
+  if (Contains(vario, value))
+    groups |= MERGE_VARIO;
+  if (Contains(system, value))
+    groups |= MERGE_SYSTEM;
+  if (Contains(flarm, value))
+    groups |= MERGE_FLARM;
+  return groups;
+}
+
 void
 NMEAInfo::Reset()
+{
+  ResetMerged(MERGE_ALL);
+
+  device.Clear();
+  secondary_device.Clear();
+}
+
+void
+NMEAInfo::ResetMerged(unsigned groups) noexcept
 {
   UpdateClock();
 
@@ -104,45 +206,55 @@ NMEAInfo::Reset()
   variation_available.Clear();
 
   ground_speed_available.Clear();
-  airspeed_available.Clear();
-  ground_speed = true_airspeed = indicated_airspeed = 0;
-  airspeed_real = false;
+  ground_speed = 0;
+
+  if (groups & MERGE_AIRSPEED) {
+    airspeed_available.Clear();
+    true_airspeed = indicated_airspeed = 0;
+    airspeed_real = false;
+
+    external_wind_available.Clear();
+  }
 
   gps_altitude_available.Clear();
 
-  static_pressure_available.Clear();
-  dyn_pressure_available.Clear();
-  pitot_pressure_available.Clear();
-  sensor_calibration_available.Clear();
+  if (groups & MERGE_PRESSURE) {
+    static_pressure_available.Clear();
+    dyn_pressure_available.Clear();
+    pitot_pressure_available.Clear();
+    sensor_calibration_available.Clear();
 
-  baro_altitude_available.Clear();
-  baro_altitude = 0;
+    baro_altitude_available.Clear();
+    baro_altitude = 0;
 
-  pressure_altitude_available.Clear();
-  pressure_altitude = 0;
+    pressure_altitude_available.Clear();
+    pressure_altitude = 0;
+  }
 
   time_available.Clear();
   time = {};
 
   date_time_utc = BrokenDateTime::Invalid();
 
-  noncomp_vario_available.Clear();
-  total_energy_vario_available.Clear();
-  netto_vario_available.Clear();
+  if (groups & MERGE_VARIO) {
+    noncomp_vario_available.Clear();
+    total_energy_vario_available.Clear();
+    netto_vario_available.Clear();
+  }
 
   settings.Clear();
 
-  external_wind_available.Clear();
-
   temperature_available = false;
   humidity_available = false;
 
-  heart_rate_available.Clear();
+  if (groups & MERGE_SYSTEM) {
+    heart_rate_available.Clear();
 
-  engine_noise_level_available.Clear();
+    engine_noise_level_available.Clear();
 
-  voltage_available.Clear();
-  battery_level_available.Clear();
+    voltage_available.Clear();
+    battery_level_available.Clear();
+  }
 
   switch_state.Reset();
 
@@ -150,9 +262,8 @@ NMEAInfo::Reset()
 
   // XXX StallRatio
 
-  device.Clear();
-  secondary_device.Clear();
-  flarm.Clear();
+  if (groups & MERGE_FLARM)
+    flarm.Clear();
 
 #ifdef ANDROID
   glink_data.Clear();
@@ -228,7 +339,7 @@ NMEAInfo::Expire()
 }
 
 void
-NMEAInfo::Complement(const NMEAInfo &add)
+NMEAInfo::Complement(const NMEAInfo &add, unsigned groups)
 {
   if (!add.alive)
     /* if there is no heartbeat on the other object, there cannot be
@@ -262,7 +373,8 @@ NMEAInfo::Complement(const NMEAInfo &add)
   if (ground_speed_available.Complement(add.ground_speed_available))
     ground_speed = add.ground_speed;
 
-  if ((add.airspeed_real || !airspeed_real) &&
+  if ((groups & MERGE_AIRSPEED) &&
+      (add.airspeed_real || !airspeed_real) &&
       airspeed_available.Complement(add.airspeed_available)) {
     true_airspeed = add.true_airspeed;
     indicated_airspeed = add.indicated_airspeed;
@@ -272,38 +384,43 @@ NMEAInfo::Complement(const NMEAInfo &add)
   if (gps_altitude_available.Complement(add.gps_altitude_available))
     gps_altitude = add.gps_altitude;
 
-  if (static_pressure_available.Complement(add.static_pressure_available))
-    static_pressure = add.static_pressure;
+  if (groups & MERGE_PRESSURE) {
+    if (static_pressure_available.Complement(add.static_pressure_available))
+      static_pressure = add.static_pressure;
 
-  if (dyn_pressure_available.Complement(add.dyn_pressure_available))
-    dyn_pressure = add.dyn_pressure;
+    if (dyn_pressure_available.Complement(add.dyn_pressure_available))
+      dyn_pressure = add.dyn_pressure;
 
-  if (pitot_pressure_available.Complement(add.pitot_pressure_available))
-    pitot_pressure = add.pitot_pressure;
+    if (pitot_pressure_available.Complement(add.pitot_pressure_available))
+      pitot_pressure = add.pitot_pressure;
 
-  if (sensor_calibration_available.Complement(add.sensor_calibration_available)) {
-     sensor_calibration_factor = add.sensor_calibration_factor;
-     sensor_calibration_offset = add.sensor_calibration_offset;
-  }
+    if (sensor_calibration_available.Complement(add.sensor_calibration_available)) {
+      sensor_calibration_factor = add.sensor_calibration_factor;
+      sensor_calibration_offset = add.sensor_calibration_offset;
+    }
 
-  if (baro_altitude_available.Complement(add.baro_altitude_available))
-    baro_altitude = add.baro_altitude;
+    if (baro_altitude_available.Complement(add.baro_altitude_available))
+      baro_altitude = add.baro_altitude;
 
-  if (pressure_altitude_available.Complement(add.pressure_altitude_available))
-    pressure_altitude = add.pressure_altitude;
+    if (pressure_altitude_available.Complement(add.pressure_altitude_available))
+      pressure_altitude = add.pressure_altitude;
+  }
 
-  if (noncomp_vario_available.Complement(add.noncomp_vario_available))
-    noncomp_vario = add.noncomp_vario;
+  if (groups & MERGE_VARIO) {
+    if (noncomp_vario_available.Complement(add.noncomp_vario_available))
+      noncomp_vario = add.noncomp_vario;
 
-  if (total_energy_vario_available.Complement(add.total_energy_vario_available))
-    total_energy_vario = add.total_energy_vario;
+    if (total_energy_vario_available.Complement(add.total_energy_vario_available))
+      total_energy_vario = add.total_energy_vario;
 
-  if (netto_vario_available.Complement(add.netto_vario_available))
-    netto_vario = add.netto_vario;
+    if (netto_vario_available.Complement(add.netto_vario_available))
+      netto_vario = add.netto_vario;
+  }
 
   settings.Complement(add.settings);
 
-  if (external_wind_available.Complement(add.external_wind_available))
+  if ((groups & MERGE_AIRSPEED) &&
+      external_wind_available.Complement(add.external_wind_available))
     external_wind = add.external_wind;
 
   if (!temperature_available && add.temperature_available) {
@@ -321,24 +438,27 @@ NMEAInfo::Complement(const NMEAInfo &add)
     humidity_available = add.humidity_available;
   }
 
-  if (heart_rate_available.Complement(add.heart_rate_available))
-    heart_rate = add.heart_rate;
+  if (groups & MERGE_SYSTEM) {
+    if (heart_rate_available.Complement(add.heart_rate_available))
+      heart_rate = add.heart_rate;
 
-  if (engine_noise_level_available.Complement(add.engine_noise_level_available))
-    engine_noise_level = add.engine_noise_level;
+    if (engine_noise_level_available.Complement(add.engine_noise_level_available))
+      engine_noise_level = add.engine_noise_level;
 
-  if (voltage_available.Complement(add.voltage_available))
-    voltage = add.voltage;
+    if (voltage_available.Complement(add.voltage_available))
+      voltage = add.voltage;
 
-  if (battery_level_available.Complement(add.battery_level_available))
-    battery_level = add.battery_level;
+    if (battery_level_available.Complement(add.battery_level_available))
+      battery_level = add.battery_level;
+  }
 
   switch_state.Complement(add.switch_state);
 
   if (!stall_ratio_available && add.stall_ratio_available)
     stall_ratio = add.stall_ratio;
 
-  flarm.Complement(add.flarm);
+  if (groups & MERGE_FLARM)
+    flarm.Complement(add.flarm);
 
 #ifdef ANDROID
   glink_data.Complement(add.glink_data);
@@ -22,6 +22,8 @@
 #include "GliderLink/GliderLinkData.hpp"
 #endif
 
+#include <array>
+#include <cstdint>
 #include <optional>
 #include <type_traits>
 
@@ -577,11 +579,85 @@ struct NMEAInfo {
     external_wind_available.Update(clock);
   }
 
+  /**
+   * Groups of attributes which are merged by Complement() as a unit.
+   * A bit mask of these allows merging only the groups which have
+   * been modified.  The attributes which are not part of any group
+   * (connection, GPS fix and time, attitude, settings, ...) are small
+   * and are always merged.
+   */
+  enum MergeGroup : unsigned {
+    /**
+     * Airspeed and external wind.
+     */
+    MERGE_AIRSPEED = 0x1,
+
+    /**
+     * Pressures, sensor calibration and pressure altitudes.
+     */
+    MERGE_PRESSURE = 0x2,
+
+    MERGE_VARIO = 0x4,
+
+    /**
+     * Heart rate, engine noise level, voltage, battery level.
+     */
+    MERGE_SYSTEM = 0x8,
+
+    MERGE_FLARM = 0x10,
+  };
+
+  static constexpr unsigned N_MERGE_GROUPS = 5;
+  static constexpr unsigned MERGE_ALL = (1u << N_MERGE_GROUPS) - 1;
+
+  /**
+   * The #Validity stamps of the attributes of each #MergeGroup, see
+   * GetMergeStamps().
+   */
+  struct MergeStamps {
+    std::array<uint32_t, 3> airspeed;
+    std::array<uint32_t, 6> pressure;
+    std::array<uint32_t, 3> vario;
+    std::array<uint32_t, 4> system;
+
+    /**
+     * The FLARM stamps, plus the number of traffic objects, which
+     * changes without a stamp update when one expires.
+     */
+    std::array<uint32_t, 6> flarm;
+
+    /**
+     * Returns the groups whose stamps differ.
+     */
+    [[gnu::pure]]
+    unsigned Compare(const MergeStamps &other) const noexcept;
+
+    /**
+     * Returns the groups with an attribute which was updated at the
+     * specified time.  Such attributes may have been modified again
+     * without changing their stamp.
+     */
+    [[gnu::pure]]
+    unsigned Find(TimeStamp time) const noexcept;
+  };
+
+  [[gnu::pure]]
+  MergeStamps GetMergeStamps() const noexcept;
+
   /**
    * Clears all information, start with tabula rasa.
    */
   void Reset();
 
+  /**
+   * Clear the specified groups and all attributes which are not part
+   * of a group, to be followed by Complement() calls with the same
+   * groups.  The other groups are left untouched.
+   *
+   * @param groups a bit mask of #MergeGroup values
+   */
+  void ResetMerged(unsigned groups) noexcept;
+
   /**
    * Check the expiry time of the device connection with the wall
    * clock time.  This should be called from a periodic timer.  The
@@ -603,8 +679,11 @@ struct NMEAInfo {
    *
    * Note that this does not copy calculated values which are managed
    * outside of the NMEA parser.
+   *
+   * @param groups a bit mask of #MergeGroup values to be merged; the
+   * attributes which are not part of a group are always merged
    */
-  void Complement(const NMEAInfo &add);
+  void Complement(const NMEAInfo &add, unsigned groups=MERGE_ALL);
 };
 
 static_assert(std::is_trivial<NMEAInfo>::value, "type is not trivial");
@@ -11,4 +11,11 @@
 class NMEAInputLine: public CSVLine {
 public:
   explicit NMEAInputLine(const char* line) noexcept;
+
+  /**
+   * Construct from a line whose asterisk has already been found,
+   * e.g. by FindVerifiedNMEAChecksum().
+   */
+  NMEAInputLine(const char *line, const char *asterisk) noexcept
+    :CSVLine(line, asterisk) {}
 };
@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * A perfect hash table which maps NMEA sentence types (e.g. "RMC" or
+ * "PFLAU") to their index in the array passed to the constructor.
+ * The hash seed is searched at compile time, so a lookup costs one
+ * hash over the (short) type and one string comparison, no matter
+ * how many types there are.
+ */
+template<std::size_t N>
+class NMEASentenceTable {
+  static_assert(N > 0 && N < 0x80);
+
+  static constexpr unsigned CalcBits() noexcept {
+    /* at least twice as many slots as types, to find a seed
+       quickly */
+    unsigned bits = 1;
+    while ((std::size_t(1) << bits) < 2 * N)
+      ++bits;
+    return bits;
+  }
+
+  static constexpr unsigned BITS = CalcBits();
+  static constexpr uint8_t EMPTY = 0xff;
+
+  std::array<std::string_view, N> types;
+  std::array<uint8_t, std::size_t(1) << BITS> slots{};
+  uint32_t seed = 0;
+
+public:
+  static constexpr int NOT_FOUND = -1;
+
+  consteval NMEASentenceTable(const std::array<std::string_view, N> &_types)
+    :types(_types) {
+    for (seed = 1; seed < 0x10000; ++seed)
+      if (TryFill())
+        return;
+
+    /* duplicate types (or really bad luck) */
+    throw "No perfect hash found";
+  }
+
+  /**
+   * @return the index of the type or #NOT_FOUND
+   */
+  [[gnu::pure]]
+  constexpr int Find(std::string_view type) const noexcept {
+    const unsigned i = slots[Hash(seed, type)];
+    return i != EMPTY && types[i] == type ? int(i) : NOT_FOUND;
+  }
+
+private:
+  static constexpr unsigned Hash(uint32_t h, std::string_view s) noexcept {
+    /* FNV-1a with the seed as offset basis */
+    for (const char ch : s)
+      h = (h ^ uint8_t(ch)) * 0x01000193u;
+
+    /* the types often differ only in the last character, which FNV
+       does not propagate to the upper bits; mix them */
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h >> (32 - BITS);
+  }
+
+  constexpr bool TryFill() noexcept {
+    slots.fill(EMPTY);
+
+    for (std::size_t i = 0; i < N; ++i) {
+      auto &slot = slots[Hash(seed, types[i])];
+      if (slot != EMPTY)
+        return false;
+
+      slot = i;
+    }
+
+    return true;
+  }
+};
+
+/**
+ * Maps NMEA sentence types to handler functions, see
+ * #NMEASentenceTable.  A parser defines a static constexpr instance
+ * and registers one handler per sentence type.
+ */
+template<typename Handler, std::size_t N>
+class NMEAHandlerTable {
+public:
+  struct Entry {
+    std::string_view type;
+    Handler handler;
+  };
+
+private:
+  NMEASentenceTable<N> sentences;
+  std::array<Handler, N> handlers;
+
+  static consteval std::array<std::string_view, N>
+  GetTypes(const std::array<Entry, N> &entries) noexcept {
+    std::array<std::string_view, N> result{};
+    for (std::size_t i = 0; i < N; ++i)
+      result[i] = entries[i].type;
+    return result;
+  }
+
+  static consteval std::array<Handler, N>
+  GetHandlers(const std::array<Entry, N> &entries) noexcept {
+    std::array<Handler, N> result{};
+    for (std::size_t i = 0; i < N; ++i)
+      result[i] = entries[i].handler;
+    return result;
+  }
+
+public:
+  consteval NMEAHandlerTable(const std::array<Entry, N> &entries)
+    :sentences(GetTypes(entries)), handlers(GetHandlers(entries)) {}
+
+  /**
+   * @return the handler for the given type or nullptr
+   */
+  [[gnu::pure]]
+  constexpr Handler Find(std::string_view type) const noexcept {
+    const int i = sentences.Find(type);
+    return i != sentences.NOT_FOUND ? handlers[i] : nullptr;
+  }
+};
@@ -11,9 +11,7 @@
 #include "Engine/Util/Gradient.hpp"
 #include "Engine/Waypoint/Waypoint.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
-#include "Engine/GlideSolvers/GlideState.hpp"
-#include "Engine/GlideSolvers/GlideResult.hpp"
-#include "Engine/GlideSolvers/MacCready.hpp"
+#include "Computer/WaypointArrivalCache.hpp"
 #include "Engine/Task/TaskManager.hpp"
 #include "Engine/Task/AbstractTask.hpp"
 #include "Engine/Task/Unordered/UnorderedTaskPoint.hpp"
@@ -30,7 +28,12 @@
 #include "Engine/Route/ReachResult.hpp"
 #include "Look/WaypointLook.hpp"
 
+#include <array>
 #include <cassert>
+#include <memory>
+#include <optional>
+#include <span>
+
 #include <stdio.h>
 
 /**
@@ -60,57 +63,31 @@ struct VisibleWaypoint {
     return ::IsReachable(reachable);
   }
 
-  void CalculateReachabilityDirect(const MoreData &basic,
-                                   const SpeedVector &wind,
-                                   const MacCready &mac_cready,
-                                   const TaskBehaviour &task_behaviour) noexcept {
-    assert(basic.location_available);
-    assert(basic.NavAltitudeAvailable());
-
-    const auto elevation = waypoint->elevation +
-      task_behaviour.safety_height_arrival;
-    const GlideState state(GeoVector(basic.location, waypoint->location),
-                           elevation, basic.nav_altitude, wind);
-
-    const GlideResult result = mac_cready.SolveStraight(state);
-    if (!result.IsOk())
+  void SetArrival(const WaypointArrival &arrival,
+                  const TaskBehaviour &task_behaviour) noexcept {
+    switch (arrival.method) {
+    case WaypointArrival::Method::NONE:
       return;
 
-    reach.direct = result.pure_glide_altitude_difference;
-    if (result.pure_glide_altitude_difference > 0)
-      reachable = WaypointReachability::TERRAIN;
-    else
-      reachable = WaypointReachability::UNREACHABLE;
-  }
-
-  bool CalculateRouteArrival(const ProtectedRoutePlanner &route_planner,
-                             const TaskBehaviour &task_behaviour) noexcept {
-    const double elevation = waypoint->elevation +
-      task_behaviour.safety_height_arrival;
-    const AGeoPoint p_dest (waypoint->location, elevation);
-
-    auto _reach = route_planner.FindPositiveArrival(p_dest);
-    if (!_reach)
-      return false;
-
-    reach = *_reach;
-    reach.Subtract(elevation);
-    return true;
-  }
-
-  void CalculateReachability(const ProtectedRoutePlanner &route_planner,
-                             const TaskBehaviour &task_behaviour) noexcept
-  {
-    if (!CalculateRouteArrival(route_planner, task_behaviour))
+    case WaypointArrival::Method::STRAIGHT:
+      reach = arrival.reach;
+      if (reach.direct > 0)
+        reachable = WaypointReachability::TERRAIN;
+      else
+        reachable = WaypointReachability::UNREACHABLE;
       return;
 
-    if (!reach.IsReachableDirect())
-      reachable = WaypointReachability::UNREACHABLE;
-    else if (task_behaviour.route_planner.IsReachEnabled() &&
-             !reach.IsReachableTerrain())
-      reachable = WaypointReachability::STRAIGHT;
-    else
-      reachable = WaypointReachability::TERRAIN;
+    case WaypointArrival::Method::ROUTE:
+      reach = arrival.reach;
+      if (!reach.IsReachableDirect())
+        reachable = WaypointReachability::UNREACHABLE;
+      else if (task_behaviour.route_planner.IsReachEnabled() &&
+               !reach.IsReachableTerrain())
+        reachable = WaypointReachability::STRAIGHT;
+      else
+        reachable = WaypointReachability::TERRAIN;
+      return;
+    }
   }
 
   void DrawSymbol(const struct WaypointRendererSettings &settings,
@@ -127,6 +104,10 @@ struct VisibleWaypoint {
 class WaypointVisitorMap final
   : public TaskPointConstVisitor
 {
+public:
+  static constexpr std::size_t MAX_WAYPOINTS = 256;
+
+private:
   const MapWindowProjection &projection;
   const WaypointRendererSettings &settings;
   const WaypointLook &look;
@@ -143,7 +124,7 @@ class WaypointVisitorMap final
    * should ensure that the drawing methods don't need to hold a
    * mutex.
    */
-  StaticArray<VisibleWaypoint, 256> waypoints;
+  StaticArray<VisibleWaypoint, MAX_WAYPOINTS> waypoints;
 
 public:
   WaypointLabelList labels;
@@ -367,6 +348,19 @@ protected:
   }
 
 public:
+  /**
+   * Would Add() accept this waypoint?
+   */
+  [[gnu::pure]]
+  bool IsVisible(const Waypoint &way_point) const noexcept {
+    return projection.WaypointInScaleFilter(way_point) &&
+      projection.GeoToScreenIfVisible(way_point.location);
+  }
+
+  std::size_t GetRemainingCapacity() const noexcept {
+    return waypoints.capacity() - waypoints.size();
+  }
+
   void Add(const WaypointPtr &way_point) noexcept {
     AddWaypoint(way_point, false);
   }
@@ -391,44 +385,43 @@ public:
     task_valid = true;
   }
 
-  void CalculateRoute(const ProtectedRoutePlanner &route_planner) noexcept {
-    for (VisibleWaypoint &vwp : waypoints) {
-      const Waypoint &way_point = *vwp.waypoint;
-
-      if (way_point.IsLandable() || way_point.flags.watched)
-        vwp.CalculateReachability(route_planner, task_behaviour);
+  /**
+   * Look up the arrival altitudes in the table calculated by the
+   * #CalculationThread, and calculate only the missing ones.
+   */
+  void Calculate(const WaypointArrivalCache *arrivals,
+                 Serial waypoints_serial,
+                 const ProtectedRoutePlanner *route_planner,
+                 const PolarSettings &polar_settings,
+                 const TaskBehaviour &task_behaviour,
+                 const DerivedInfo &calculated) noexcept {
+    std::shared_ptr<const WaypointArrivalCache::Table> table;
+    if (arrivals != nullptr) {
+      table = arrivals->Get();
+      if (table && table->waypoints_serial != waypoints_serial)
+        /* obsolete */
+        table.reset();
     }
-  }
 
-  void CalculateDirect(const PolarSettings &polar_settings,
-                       const TaskBehaviour &task_behaviour,
-                       const DerivedInfo &calculated) noexcept {
-    if (!basic.location_available || !basic.NavAltitudeAvailable())
-      return;
-
-    const GlidePolar &glide_polar =
-      task_behaviour.route_planner.reach_polar_mode == RoutePlannerConfig::Polar::TASK
-      ? polar_settings.glide_polar_task
-      : calculated.glide_polar_safety;
-    const MacCready mac_cready(task_behaviour.glide, glide_polar);
+    std::optional<WaypointArrivalCalculator> calculator;
 
     for (VisibleWaypoint &vwp : waypoints) {
       const Waypoint &way_point = *vwp.waypoint;
+      if (!way_point.IsLandable() && !way_point.flags.watched)
+        continue;
 
-      if (way_point.IsLandable() || way_point.flags.watched)
-        vwp.CalculateReachabilityDirect(basic, calculated.GetWindOrZero(),
-                                        mac_cready, task_behaviour);
-    }
-  }
+      if (const WaypointArrival *arrival =
+          table ? table->Find(way_point.id) : nullptr) {
+        vwp.SetArrival(*arrival, task_behaviour);
+        continue;
+      }
 
-  void Calculate(const ProtectedRoutePlanner *route_planner,
-                 const PolarSettings &polar_settings,
-                 const TaskBehaviour &task_behaviour,
-                 const DerivedInfo &calculated) noexcept {
-    if (route_planner != nullptr && !route_planner->IsTerrainReachEmpty())
-      CalculateRoute(*route_planner);
-    else
-      CalculateDirect(polar_settings, task_behaviour, calculated);
+      if (!calculator)
+        calculator.emplace(basic, calculated, polar_settings,
+                           task_behaviour, route_planner);
+
+      vwp.SetArrival(calculator->Calculate(way_point), task_behaviour);
+    }
   }
 
   void Draw(Canvas &canvas) noexcept {
@@ -460,7 +453,8 @@ WaypointRenderer::Render(Canvas &canvas, LabelBlock &label_block,
                          const TaskBehaviour &task_behaviour,
                          const MoreData &basic, const DerivedInfo &calculated,
                          const ProtectedTaskManager *task,
-                         const ProtectedRoutePlanner *route_planner) noexcept
+                         const ProtectedRoutePlanner *route_planner,
+                         const WaypointArrivalCache *arrivals) noexcept
 {
   if (way_points == nullptr || way_points->IsEmpty())
     return;
@@ -482,11 +476,21 @@ WaypointRenderer::Render(Canvas &canvas, LabelBlock &label_block,
       atask->AcceptTaskPointVisitor(v);
   }
 
-  way_points->VisitWithinRange(projection.GetGeoScreenCenter(),
-                               projection.GetScreenDistanceMeters(),
-                               [&v](const auto &w){ v.Add(w); });
-
-  v.Calculate(route_planner, polar_settings, task_behaviour, calculated);
+  /* if there are more visible waypoints than fit into the list,
+     prefer the ones nearest to the screen center */
+  std::array<WaypointPtr, WaypointVisitorMap::MAX_WAYPOINTS> nearest;
+  const std::size_t n_nearest =
+    way_points->GetNearestIf(projection.GetGeoScreenCenter(),
+                             projection.GetScreenDistanceMeters(),
+                             std::span{nearest}.first(v.GetRemainingCapacity()),
+                             [&v](const Waypoint &w){
+                               return v.IsVisible(w);
+                             });
+  for (std::size_t i = 0; i < n_nearest; ++i)
+    v.Add(nearest[i]);
+
+  v.Calculate(arrivals, way_points->GetSerial(), route_planner,
+              polar_settings, task_behaviour, calculated);
 
   v.Draw(canvas);
 
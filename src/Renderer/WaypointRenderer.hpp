@@ -17,6 +17,7 @@ struct MoreData;
 struct DerivedInfo;
 class ProtectedTaskManager;
 class ProtectedRoutePlanner;
+class WaypointArrivalCache;
 
 /**
  * Renders way point icons and labels into a #Canvas.
@@ -46,5 +47,6 @@ public:
               const TaskBehaviour &task_behaviour,
               const MoreData &basic, const DerivedInfo &calculated,
               const ProtectedTaskManager *task,
-              const ProtectedRoutePlanner *route_planner) noexcept;
+              const ProtectedRoutePlanner *route_planner,
+              const WaypointArrivalCache *arrivals) noexcept;
 };
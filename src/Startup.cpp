@@ -412,8 +412,8 @@ Startup(UI::Display &display)
   // Reads the airspace files
   {
     SubOperationEnvironment sub_env(operation, 768, 1024);
-    ReadAirspace(airspace_database, computer_settings.pressure,
-                 sub_env);
+    ReadAirspace(airspace_database, file_cache,
+                 computer_settings.pressure, sub_env);
   }
 
   if (terrain != nullptr)
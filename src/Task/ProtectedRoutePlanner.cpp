@@ -39,16 +39,27 @@ void
 ProtectedRoutePlanner::SolveReach(const AGeoPoint &origin,
                                   const RoutePlannerConfig &config,
                                   const int h_ceiling,
-                                  const bool do_solve) noexcept
+                                  const bool do_solve,
+                                  const ReachForEach *for_each) noexcept
 {
   /* these local variables help avoid locking both mutexes at the same
      time */
   ReachFan rt, rw;
 
+  {
+    /* start with a copy of the previous solutions, which may be
+       updated incrementally */
+    const std::scoped_lock lock{reach_mutex};
+    rt = reach_terrain;
+    rw = reach_working;
+  }
+
   {
     const std::scoped_lock lock{route_mutex};
-    rt = route_planner.SolveReach(origin, config, h_ceiling, do_solve, false);
-    rw = route_planner.SolveReach(origin, config, h_ceiling, do_solve, true);
+    route_planner.UpdateReach(rt, origin, config, h_ceiling, do_solve, false,
+                              for_each);
+    route_planner.UpdateReach(rw, origin, config, h_ceiling, do_solve, true,
+                              for_each);
     rpolars_reach = route_planner.GetReachPolar();
   }
 
@@ -57,6 +68,7 @@ ProtectedRoutePlanner::SolveReach(const AGeoPoint &origin,
   const std::scoped_lock lock{reach_mutex};
   reach_terrain = std::move(rt);
   reach_working = std::move(rw);
+  ++reach_serial;
 }
 
 const FlatProjection
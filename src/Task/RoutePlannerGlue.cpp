@@ -59,6 +59,23 @@ RoutePlannerGlue::SolveReach(const AGeoPoint &origin,
   }
 }
 
+void
+RoutePlannerGlue::UpdateReach(ReachFan &reach, const AGeoPoint &origin,
+                              const RoutePlannerConfig &config,
+                              const int h_ceiling, const bool do_solve,
+                              const bool working,
+                              const ReachForEach *for_each) noexcept
+{
+  if (terrain) {
+    RasterTerrain::Lease lease(*terrain);
+    planner.UpdateReach(reach, origin, config, h_ceiling, do_solve, working,
+                        for_each);
+  } else {
+    planner.UpdateReach(reach, origin, config, h_ceiling, do_solve, working,
+                        for_each);
+  }
+}
+
 GeoPoint
 RoutePlannerGlue::Intersection(const AGeoPoint &origin,
                                const AGeoPoint &destination) const
@@ -47,6 +47,11 @@ public:
   ReachFan SolveReach(const AGeoPoint &origin, const RoutePlannerConfig &config,
                       int h_ceiling, bool do_solve, bool working) noexcept;
 
+  void UpdateReach(ReachFan &reach, const AGeoPoint &origin,
+                   const RoutePlannerConfig &config,
+                   int h_ceiling, bool do_solve, bool working,
+                   const ReachForEach *for_each=nullptr) noexcept;
+
   const auto &GetReachPolar() const noexcept {
     return planner.GetReachPolar();
   }
@@ -8,10 +8,42 @@
 #include "Geo/GeoBounds.hpp"
 #else
 #include "Projection/WindowProjection.hpp"
+#include "ShiftGrid.hpp"
 #endif
 
+#include "thread/WorkerPool.hpp"
+
+#include <algorithm>
 #include <cassert>
 
+/**
+ * Invoke f(y) for each row in [begin,end), split into bands among the
+ * #WorkerPool threads (if there is one).  The rows must be
+ * independent of each other.
+ */
+template<typename F>
+static void
+ForEachRow(WorkerPool *pool, unsigned begin, unsigned end, F &&f) noexcept
+{
+  /* don't bother the other threads with tiny jobs */
+  constexpr unsigned MIN_BAND_HEIGHT = 8;
+
+  const unsigned n_rows = end - begin;
+  if (pool == nullptr || n_rows < 2 * MIN_BAND_HEIGHT) {
+    for (unsigned y = begin; y < end; ++y)
+      f(y);
+    return;
+  }
+
+  /* more bands than threads, to balance the load */
+  const unsigned n_bands = std::min(pool->GetConcurrency() * 4,
+                                    n_rows / MIN_BAND_HEIGHT);
+  pool->ForEachBand(n_rows, n_bands, [begin, &f](unsigned a, unsigned b){
+    for (unsigned y = begin + a; y < begin + b; ++y)
+      f(y);
+  });
+}
+
 void
 HeightMatrix::SetSize(size_t _size)
 {
@@ -41,38 +73,67 @@ HeightMatrix::SetSize(unsigned width, unsigned height,
 
 void
 HeightMatrix::Fill(const RasterMap &map, const GeoBounds &bounds,
-                   unsigned width, unsigned height, bool interpolate)
+                   unsigned width, unsigned height, bool interpolate,
+                   WorkerPool *pool)
 {
   SetSize(width, height);
 
   const Angle delta_y = bounds.GetHeight() / height;
-  Angle latitude = bounds.GetNorth();
-  for (auto p = data.data(), end = p + width * height;
-       p != end; p += width, latitude -= delta_y) {
+  ForEachRow(pool, 0, height, [&](unsigned y){
+    const Angle latitude = bounds.GetNorth() - delta_y * y;
     map.ScanLine(GeoPoint(bounds.GetWest(), latitude),
                  GeoPoint(bounds.GetEast(), latitude),
-                 p, width, interpolate);
-  }
+                 data.data() + y * width, width, interpolate);
+  });
 }
 
 #else
 
 void
 HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
-                   unsigned quantisation_pixels, bool interpolate)
+                   unsigned quantisation_pixels, bool interpolate,
+                   WorkerPool *pool)
 {
   const auto screen_size = projection.GetScreenSize();
 
   SetSize((screen_size.width + quantisation_pixels - 1) / quantisation_pixels,
           (screen_size.height + quantisation_pixels - 1) / quantisation_pixels);
 
-  auto p = data.data();
-  for (unsigned y = 0; y < screen_size.height;
-       y += quantisation_pixels, p += width) {
-    map.ScanLine(projection.ScreenToGeo({0, (int)y}),
-                 projection.ScreenToGeo({(int)screen_size.width, (int)y}),
-                 p, width, interpolate);
-  }
+  Fill(map, projection, quantisation_pixels,
+       PixelRect{PixelSize{width, height}}, interpolate, pool);
+}
+
+void
+HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
+                   unsigned quantisation_pixels, const PixelRect &rc,
+                   bool interpolate, WorkerPool *pool)
+{
+  assert(rc.left >= 0 && rc.top >= 0);
+  assert(rc.right <= (int)width && rc.bottom <= (int)height);
+  assert(rc.left < rc.right && rc.top < rc.bottom);
+
+  /* RasterMap::ScanLine() needs at least two samples */
+  int left = rc.left;
+  if (rc.right - left < 2)
+    left = std::max(rc.right - 2, 0);
+  const int right = std::min(left + std::max(rc.right - left, 2),
+                             (int)width);
+
+  /* the cells are sampled at multiples of quantisation_pixels, both
+     horizontally and vertically */
+  const int q = quantisation_pixels;
+  ForEachRow(pool, rc.top, rc.bottom, [&](int y){
+    map.ScanLine(projection.ScreenToGeo({left * q, y * q}),
+                 projection.ScreenToGeo({(right - 1) * q, y * q}),
+                 data.data() + y * width + left, right - left, interpolate);
+  });
+}
+
+void
+HeightMatrix::Shift(int dx, int dy) noexcept
+{
+  ShiftGrid([this](unsigned y){ return data.data() + y * width; },
+            width, height, dx, dy);
 }
 
 #endif
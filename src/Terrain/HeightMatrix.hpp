@@ -7,11 +7,13 @@
 #include "util/AllocatedArray.hxx"
 
 class RasterMap;
+class WorkerPool;
 
 #ifdef ENABLE_OPENGL
 class GeoBounds;
 #else
 class WindowProjection;
+struct PixelRect;
 #endif
 
 class HeightMatrix {
@@ -35,13 +37,33 @@ public:
    * Copy values from the #RasterMap to the buffer, north-up only.
    */
   void Fill(const RasterMap &map, const GeoBounds &bounds,
-            unsigned _width, unsigned _height, bool interpolate);
+            unsigned _width, unsigned _height, bool interpolate,
+            WorkerPool *pool=nullptr);
 #else
   /**
    * @param interpolate true enables interpolation of sub-pixel values
+   * @param pool an optional #WorkerPool which splits the work among
+   * all CPU cores
    */
   void Fill(const RasterMap &map, const WindowProjection &map_projection,
-            unsigned quantisation_pixels, bool interpolate);
+            unsigned quantisation_pixels, bool interpolate,
+            WorkerPool *pool=nullptr);
+
+  /**
+   * Fill only the specified range of cells, keeping the size.  The
+   * cells are sampled at the same locations as in the other Fill()
+   * overload.
+   */
+  void Fill(const RasterMap &map, const WindowProjection &map_projection,
+            unsigned quantisation_pixels, const PixelRect &rc,
+            bool interpolate, WorkerPool *pool=nullptr);
+
+  /**
+   * Move the contents by the specified number of cells, i.e. cell
+   * (x,y) receives the value of cell (x+dx,y+dy).  The cells which
+   * have no source are left undefined and need to be filled.
+   */
+  void Shift(int dx, int dy) noexcept;
 #endif
 
   unsigned GetWidth() const {
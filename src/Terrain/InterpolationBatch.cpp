@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "InterpolationBatch.hpp"
+
+#ifdef __SSE2__
+#include "SSE2Interpolation.hpp"
+#elif defined(__ARM_NEON__)
+#include "NEONInterpolation.hpp"
+#endif
+
+#include <algorithm>
+
+void
+InterpolateHeightsPortable(const int16_t *gcc_restrict a,
+                           const int16_t *gcc_restrict b,
+                           const int16_t *gcc_restrict c,
+                           const int16_t *gcc_restrict d,
+                           const int16_t *gcc_restrict ix,
+                           const int16_t *gcc_restrict iy,
+                           int16_t *gcc_restrict result,
+                           unsigned n) noexcept
+{
+  for (unsigned i = 0; i < n; ++i) {
+    const int kx = 0x100 - ix[i];
+    const unsigned ky = 0x100 - iy[i];
+
+    /* this is the same formula as in RasterBuffer::GetInterpolated(),
+       reordered to calculate the horizontal pass first; the
+       (wrapping) unsigned arithmetic yields identical bits */
+    const int top = a[i] * kx + b[i] * ix[i];
+    const int bottom = c[i] * kx + d[i] * ix[i];
+    const unsigned sum = unsigned(top) * ky + unsigned(bottom) * unsigned(iy[i]);
+
+    result[i] = int16_t(sum >> 16);
+  }
+}
+
+HeightInterpolationBatch::HeightInterpolationBatch() noexcept
+{
+  /* the SIMD code may process a few more lanes than queued; make
+     sure they are initialized */
+  std::fill_n(a, CAPACITY, 0);
+  std::fill_n(b, CAPACITY, 0);
+  std::fill_n(c, CAPACITY, 0);
+  std::fill_n(d, CAPACITY, 0);
+  std::fill_n(ix, CAPACITY, 0);
+  std::fill_n(iy, CAPACITY, 0);
+}
+
+void
+HeightInterpolationBatch::Flush() noexcept
+{
+#if defined(__SSE2__) || defined(__ARM_NEON__)
+#ifdef __SSE2__
+  using Optimised = SSE2HeightInterpolation;
+#else
+  using Optimised = NEONHeightInterpolation;
+#endif
+
+  /* CAPACITY is a multiple of 8, so rounding up is safe */
+  static_assert(CAPACITY % 8 == 0);
+  for (unsigned i = 0; i < n; i += 8)
+    Optimised::Interpolate8(a + i, b + i, c + i, d + i, ix + i, iy + i,
+                            result + i);
+#else
+  InterpolateHeightsPortable(a, b, c, d, ix, iy, result, n);
+#endif
+
+  for (unsigned i = 0; i < n; ++i)
+    *dest[i] = TerrainHeight(result[i]);
+
+  n = 0;
+}
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Height.hpp"
+
+#include <cstdint>
+
+/**
+ * Collects bilinear height interpolations (see
+ * RasterBuffer::GetInterpolated()) in a structure-of-arrays layout,
+ * to calculate them in one go with SIMD instructions (SSE2 or NEON,
+ * if available).  The caller must call Flush() before using the
+ * results.
+ */
+class HeightInterpolationBatch {
+  static constexpr unsigned CAPACITY = 64;
+
+  /* the four corner heights: top-left, top-right, bottom-left,
+     bottom-right */
+  alignas(16) int16_t a[CAPACITY], b[CAPACITY], c[CAPACITY], d[CAPACITY];
+
+  /* the sub-pixel weights (0..255) */
+  alignas(16) int16_t ix[CAPACITY], iy[CAPACITY];
+
+  alignas(16) int16_t result[CAPACITY];
+
+  TerrainHeight *dest[CAPACITY];
+
+  unsigned n = 0;
+
+public:
+  HeightInterpolationBatch() noexcept;
+
+  HeightInterpolationBatch(const HeightInterpolationBatch &) = delete;
+  HeightInterpolationBatch &operator=(const HeightInterpolationBatch &) = delete;
+
+  /**
+   * Queue one interpolation.
+   *
+   * @param tm pointer to the top-left corner
+   * @param dx the offset of the right column (0 or 1)
+   * @param dy the offset of the bottom row (0 or the row pitch)
+   * @param _dest the location where the result will be stored by
+   * Flush()
+   */
+  void Add(const TerrainHeight *tm, unsigned dx, unsigned dy,
+           unsigned _ix, unsigned _iy, TerrainHeight &_dest) noexcept {
+    if (tm->IsSpecial() || tm[dx].IsSpecial() ||
+        tm[dy].IsSpecial() || tm[dx + dy].IsSpecial()) {
+      /* no interpolation, just like RasterBuffer::GetInterpolated() */
+      _dest = *tm;
+      return;
+    }
+
+    if (n == CAPACITY)
+      Flush();
+
+    a[n] = tm->GetValue();
+    b[n] = tm[dx].GetValue();
+    c[n] = tm[dy].GetValue();
+    d[n] = tm[dx + dy].GetValue();
+    ix[n] = _ix;
+    iy[n] = _iy;
+    dest[n] = &_dest;
+    ++n;
+  }
+
+  /**
+   * Calculate all queued interpolations and store the results.
+   */
+  void Flush() noexcept;
+};
+
+/**
+ * Calculate the bilinear interpolation for #n values, with the exact
+ * same results as RasterBuffer::GetInterpolated().  This portable
+ * implementation is used on targets without SSE2 or NEON.
+ */
+void
+InterpolateHeightsPortable(const int16_t *a, const int16_t *b,
+                           const int16_t *c, const int16_t *d,
+                           const int16_t *ix, const int16_t *iy,
+                           int16_t *result, unsigned n) noexcept;
@@ -6,12 +6,97 @@
 
 #include <stdlib.h>
 #include <algorithm>
+#include <cstdint>
 
 //#define DEBUG_TILE
 #ifdef DEBUG_TILE
 #include <stdio.h>
 #endif
 
+/**
+ * Finds blocks of the #MaxHeightPyramid which are entirely below the
+ * glide path while walking along a line with Bresenham's algorithm,
+ * where "t" is the number of steps from the origin (dx+dy at the
+ * destination).  The caller keeps walking step by step (so the
+ * samples and the result remain exactly the same), but doesn't need
+ * to look up the terrain height of samples inside such a block.
+ */
+class PyramidSkip {
+  const MaxHeightPyramid &pyramid;
+  const int dx, dy, sx, sy, total;
+
+public:
+  PyramidSkip(const MaxHeightPyramid &_pyramid,
+              SignedRasterLocation origin,
+              SignedRasterLocation destination) noexcept
+    :pyramid(_pyramid),
+     dx(abs(destination.x - origin.x)), dy(abs(destination.y - origin.y)),
+     sx(origin.x < destination.x ? 1 : -1),
+     sy(origin.y < destination.y ? 1 : -1),
+     total(dx + dy) {}
+
+  /**
+   * Find the largest number of steps from #location (which must be
+   * inside the map) which are known to be clear.
+   *
+   * @param max_skip the maximum number of steps to be returned
+   * @param is_clear a function (int block_max, int t_end) returning
+   * whether terrain up to #block_max is below the glide path
+   * between the current step and #t_end
+   * @return the number of steps or 0
+   */
+  template<typename F>
+  [[gnu::pure]]
+  int Find(RasterLocation location, int t, int max_skip,
+           F &&is_clear) const noexcept {
+    if (total == 0 || !pyramid.IsDefined())
+      return 0;
+
+    int result = 0;
+    for (unsigned level = 0; level < pyramid.GetLevels(); ++level) {
+      const int n = std::min(StepsInBlock(location, level), max_skip);
+      if (n <= result)
+        continue;
+
+      if (!is_clear(pyramid.GetMax(level, location), t + n))
+        break;
+
+      result = n;
+    }
+
+    return result;
+  }
+
+private:
+  /**
+   * Returns the number of steps from #location which are guaranteed
+   * to remain within the block of the given pyramid level.
+   */
+  [[gnu::pure]]
+  int StepsInBlock(RasterLocation location, unsigned level) const noexcept {
+    const unsigned mask =
+      (1u << (RasterTraits::OVERVIEW_BITS + level)) - 1;
+
+    int result = total;
+    result = std::min(result, AxisSteps(location.x, mask, sx, dx));
+    result = std::min(result, AxisSteps(location.y, mask, sy, dy));
+    return std::max(result, 0);
+  }
+
+  int AxisSteps(unsigned p, unsigned mask, int s, int d) const noexcept {
+    if (d == 0)
+      return total;
+
+    /* Bresenham deviates from the ideal line by up to one pixel;
+       keep a safety margin of two pixels */
+    const int remaining = (s > 0 ? mask - (p & mask) : p & mask) - 2;
+    if (remaining <= 0)
+      return 0;
+
+    return (int64_t)remaining * total / d;
+  }
+};
+
 std::optional<RasterTileCache::Intersection>
 RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
                                    const SignedRasterLocation destination,
@@ -84,9 +169,28 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
   RasterLocation last_clear_location = location;
   int last_clear_h = h_origin;
 
+  const PyramidSkip skip(max_pyramid, origin, destination);
+
+  // samples before this step are known to be clear
+  int clear_until = 0;
+
   while (true) {
 
-    if (!step_counter) {
+    if (!step_counter && total_steps < clear_until) {
+      // this sample is below the glide path and the ceiling, see PyramidSkip
+
+      if (!IsInside(location))
+        break; // outside bounds
+
+      step_counter = IsFineDirect(location) ? step_fine : step_coarse;
+
+      int h_int = ((total_steps * slope_fact) >> RASTER_SLOPE_FACT) + h_origin;
+      if (can_climb)
+        h_int = std::min(h_int, h_dest);
+
+      last_clear_location = location;
+      last_clear_h = h_int;
+    } else if (!step_counter) {
 
       if (!IsInside(location))
         break; // outside bounds
@@ -157,6 +261,18 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
         } else {
           last_clear_location = location;
           last_clear_h = h_int;
+
+          // look for blocks which are entirely below the glide path
+          clear_until = total_steps +
+            skip.Find(location, total_steps, max_steps - total_steps,
+                      [&](int block_max, int t_end){
+            int h_end = ((t_end * slope_fact) >> RASTER_SLOPE_FACT) + h_origin;
+            if (can_climb)
+              h_end = std::min(h_end, h_dest);
+
+            return std::min(h_int, h_end) >= block_max + h_safety &&
+              std::max(h_int, h_end) <= h_ceiling;
+          });
         }
       }
     }
@@ -267,9 +383,29 @@ RasterTileCache::GroundIntersection(const SignedRasterLocation origin,
   RasterLocation last_clear_location = location;
   int last_clear_h = h_origin;
 
+  const PyramidSkip skip(max_pyramid, origin, destination);
+
+  // samples before this step are known to be clear
+  int clear_until = 0;
+
   while (true) {
 
-    if (!step_counter) {
+    if (!step_counter && total_steps < clear_until) {
+      // this sample is above the terrain and the floor, see PyramidSkip
+
+      if (!IsInside(location))
+        break;
+
+      step_counter = IsFineDirect(location) ? step_fine : step_coarse;
+
+      const int h_int = h_origin -
+        ((total_steps * slope_fact) >> RASTER_SLOPE_FACT);
+      if (h_int <= 0)
+        break; // reached max range
+
+      last_clear_location = location;
+      last_clear_h = h_int;
+    } else if (!step_counter) {
 
       if (!IsInside(location))
         break;
@@ -301,6 +437,16 @@ RasterTileCache::GroundIntersection(const SignedRasterLocation origin,
 
       last_clear_location = location;
       last_clear_h = h_int;
+
+      // look for blocks which are entirely below the glide path
+      clear_until = total_steps +
+        skip.Find(location, total_steps, max_steps - total_steps,
+                  [&](int block_max, int t_end){
+                    const int h_end = h_origin -
+                      ((t_end * slope_fact) >> RASTER_SLOPE_FACT);
+                    return std::min(h_int, h_end) >=
+                      std::max(block_max, height_floor);
+                  });
     }
 
     if (total_steps > max_steps)
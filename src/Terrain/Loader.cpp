@@ -8,6 +8,8 @@
 #include "WorldFile.hpp"
 #include "Operation/Operation.hpp"
 #include "system/ConvertPathName.hpp"
+#include "io/BufferedOutputStream.hxx"
+#include "util/AllocatedArray.hxx"
 #include "util/ScopeExit.hxx"
 
 extern "C" {
@@ -309,6 +311,144 @@ TerrainLoader::UpdateTiles(struct zzip_dir *dir, const char *path,
   LoadJPG2000(dir, path);
 }
 
+static constexpr uint64_t
+AlignTileStore(uint64_t position) noexcept
+{
+  constexpr uint64_t alignment = RasterTileCache::TileStoreHeader::ALIGNMENT;
+  return (position + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * Write zero bytes up to the next tile store alignment boundary.
+ *
+ * @return the new position
+ */
+static uint64_t
+PadTileStore(BufferedOutputStream &os, uint64_t position)
+{
+  static constexpr std::byte zero[256]{};
+
+  const uint64_t end = AlignTileStore(position);
+  while (position < end) {
+    const std::size_t n = std::min<uint64_t>(end - position, sizeof(zero));
+    os.Write(zero, n);
+    position += n;
+  }
+
+  return position;
+}
+
+inline void
+TerrainLoader::SaveTileStore(struct zzip_dir *dir, const char *path,
+                             BufferedOutputStream &os, uint64_t position)
+{
+  assert(!scan_overview);
+  assert(scan_tiles);
+
+  using Header = RasterTileCache::TileStoreHeader;
+  auto &tiles = raster_tile_cache.tiles;
+  const unsigned n = tiles.GetSize();
+
+  /* the header begins at the first alignment boundary, after the
+     caller's prefix */
+  position = PadTileStore(os, position);
+  if (position != Header::ALIGNMENT)
+    throw std::runtime_error("Tile store prefix too large");
+
+  Header header;
+
+  /* zero-fill all implicit padding bytes (to make valgrind happy) */
+  memset(&header, 0, sizeof(header));
+
+  header.version = Header::VERSION;
+  header.size = raster_tile_cache.size;
+  header.tile_size = raster_tile_cache.tile_size;
+  header.n_tiles = {tiles.GetWidth(), tiles.GetHeight()};
+
+  os.Write(&header, sizeof(header));
+  position += sizeof(header);
+
+  /* calculate the layout */
+
+  AllocatedArray<uint64_t> offsets(n);
+  uint64_t end = position + sizeof(uint64_t) * n;
+  for (unsigned i = 0; i < n; ++i) {
+    const auto &tile = tiles.GetLinear(i);
+    if (tile.IsDefined()) {
+      end = AlignTileStore(end);
+      offsets[i] = end;
+      end += uint64_t(tile.size.Area()) * sizeof(TerrainHeight);
+    } else
+      offsets[i] = 0;
+  }
+
+  os.Write(std::as_bytes(std::span{offsets}));
+  position += sizeof(uint64_t) * n;
+
+  /* decode the tiles in batches, just like PollTiles() limits the
+     number of tiles in memory */
+
+  env.SetProgressRange(n);
+
+  for (unsigned first = 0; first < n;) {
+    unsigned last = first, n_requested = 0;
+
+    {
+      const std::lock_guard lock{mutex};
+
+      for (; last < n && n_requested < RasterTileCache::MAX_ACTIVE_TILES;
+           ++last) {
+        auto &tile = tiles.GetLinear(last);
+        if (tile.IsDefined()) {
+          tile.SetRequest();
+          ++n_requested;
+        }
+      }
+    }
+
+    if (n_requested > 0)
+      LoadJPG2000(dir, path);
+
+    for (unsigned i = first; i < last; ++i) {
+      auto &tile = tiles.GetLinear(i);
+      if (!tile.IsDefined())
+        continue;
+
+      if (!tile.IsLoaded())
+        throw std::runtime_error("Failed to decode terrain tile");
+
+      position = PadTileStore(os, position);
+      assert(position == offsets[i]);
+
+      const std::size_t size = tile.size.Area() * sizeof(TerrainHeight);
+      os.Write(tile.buffer.GetData(), size);
+      position += size;
+
+      const std::lock_guard lock{mutex};
+      tile.Unload();
+      tile.ClearRequest();
+    }
+
+    first = last;
+    env.SetProgressPosition(first);
+  }
+
+  assert(position == end);
+}
+
+void
+SaveTerrainTileStore(struct zzip_dir *dir, const char *path,
+                     RasterTileCache &raster_tile_cache,
+                     BufferedOutputStream &os, uint64_t position,
+                     OperationEnvironment &env)
+{
+  /* fake a mutex - the RasterTileCache is not yet shared */
+  SharedMutex mutex;
+
+  TerrainLoader loader(mutex, raster_tile_cache, false, true, env);
+  loader.SaveTileStore(dir, path, os, position);
+}
+
 void
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
@@ -10,6 +10,7 @@
 
 struct zzip_dir;
 struct GeoPoint;
+class BufferedOutputStream;
 class RasterTileCache;
 class RasterProjection;
 class OperationEnvironment;
@@ -49,6 +50,12 @@ public:
   void UpdateTiles(struct zzip_dir *dir, const char *path,
                    SignedRasterLocation p, unsigned radius);
 
+  /**
+   * Throws on error.
+   */
+  void SaveTileStore(struct zzip_dir *dir, const char *path,
+                     BufferedOutputStream &os, uint64_t position);
+
   /* callback methods for libjasper (via jas_rtc.cpp) */
 
   long SkipMarkerSegment(long file_offset) const;
@@ -98,6 +105,30 @@ LoadTerrainOverview(struct zzip_dir *dir,
                       tile_cache, false, env);
 }
 
+/**
+ * Decode all tiles and write them to a tile store (see
+ * RasterTileCache::TileStoreHeader).  Tiles are decoded in batches,
+ * so this needs no more memory than regular tile loading.
+ *
+ * Throws on error.
+ *
+ * @param position the absolute file position of the stream
+ */
+void
+SaveTerrainTileStore(struct zzip_dir *dir, const char *path,
+                     RasterTileCache &raster_tile_cache,
+                     BufferedOutputStream &os, uint64_t position,
+                     OperationEnvironment &env);
+
+static inline void
+SaveTerrainTileStore(struct zzip_dir *dir,
+                     RasterTileCache &tile_cache,
+                     BufferedOutputStream &os, uint64_t position,
+                     OperationEnvironment &env)
+{
+  SaveTerrainTileStore(dir, "terrain.jp2", tile_cache, os, position, env);
+}
+
 /**
  * Throws on error.
  */
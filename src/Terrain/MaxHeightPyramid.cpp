@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "MaxHeightPyramid.hpp"
+#include "RasterBuffer.hpp"
+
+#include <algorithm>
+
+/**
+ * Convert a raster value to a pyramid value.
+ */
+static constexpr int16_t
+ToPyramid(TerrainHeight h) noexcept
+{
+  /* the intersection code stops at invalid terrain, so it must
+     never be skipped */
+  return h.IsInvalid()
+    ? MaxHeightPyramid::UNKNOWN
+    : h.GetValueOr0();
+}
+
+/**
+ * Raise the cell to the given value.  #UNKNOWN is the largest
+ * possible value, so it sticks.
+ */
+static constexpr void
+Merge(int16_t &cell, int16_t value) noexcept
+{
+  cell = std::max(cell, value);
+}
+
+void
+MaxHeightPyramid::Reset() noexcept
+{
+  for (auto &i : levels)
+    i.Reset();
+  n_levels = 0;
+}
+
+void
+MaxHeightPyramid::Resize(RasterLocation size) noexcept
+{
+  Reset();
+
+  if (size.x == 0 || size.y == 0)
+    return;
+
+  while (n_levels < MAX_LEVELS) {
+    auto &level = levels[n_levels++];
+    level.GrowDiscard(size.x, size.y);
+    std::fill(level.begin(), level.end(), EMPTY);
+
+    if (size.x == 1 && size.y == 1)
+      break;
+
+    size = {(size.x + 1) / 2, (size.y + 1) / 2};
+  }
+}
+
+void
+MaxHeightPyramid::PutOverview(const RasterBuffer &overview,
+                              RasterLocation start,
+                              RasterLocation end) noexcept
+{
+  if (!IsDefined())
+    return;
+
+  auto &level = levels[0];
+  end.x = std::min({end.x, level.GetWidth(), overview.GetSize().x});
+  end.y = std::min({end.y, level.GetHeight(), overview.GetSize().y});
+  if (start.x >= end.x || start.y >= end.y)
+    return;
+
+  for (unsigned y = start.y; y < end.y; ++y)
+    for (unsigned x = start.x; x < end.x; ++x)
+      Merge(level.Get(x, y), ToPyramid(overview.Get({x, y})));
+
+  Propagate(start.x, start.y, end.x, end.y);
+}
+
+void
+MaxHeightPyramid::PutTile(const RasterBuffer &buffer,
+                          const RasterLocation start) noexcept
+{
+  if (!IsDefined() || !buffer.IsDefined())
+    return;
+
+  auto &level = levels[0];
+  const RasterLocation size = buffer.GetSize();
+
+  for (unsigned y = 0; y < size.y; ++y) {
+    const unsigned cy = (start.y + y) >> RasterTraits::OVERVIEW_BITS;
+    if (cy >= level.GetHeight())
+      break;
+
+    const TerrainHeight *src = buffer.GetDataAt({0, y});
+    for (unsigned x = 0; x < size.x; ++x) {
+      const unsigned cx = (start.x + x) >> RasterTraits::OVERVIEW_BITS;
+      if (cx >= level.GetWidth())
+        break;
+
+      Merge(level.Get(cx, cy), ToPyramid(src[x]));
+    }
+  }
+
+  Propagate(start.x >> RasterTraits::OVERVIEW_BITS,
+            start.y >> RasterTraits::OVERVIEW_BITS,
+            RasterTraits::ToOverviewCeil(start.x + size.x),
+            RasterTraits::ToOverviewCeil(start.y + size.y));
+}
+
+void
+MaxHeightPyramid::Propagate(unsigned x0, unsigned y0,
+                            unsigned x1, unsigned y1) noexcept
+{
+  for (unsigned l = 1; l < n_levels; ++l) {
+    const auto &below = levels[l - 1];
+    auto &level = levels[l];
+
+    x0 /= 2;
+    y0 /= 2;
+    x1 = std::min((x1 + 1) / 2, level.GetWidth());
+    y1 = std::min((y1 + 1) / 2, level.GetHeight());
+
+    for (unsigned y = y0; y < y1; ++y) {
+      for (unsigned x = x0; x < x1; ++x) {
+        int16_t value = EMPTY;
+        for (unsigned by = 2 * y; by < std::min(2 * y + 2, below.GetHeight()); ++by) {
+          for (unsigned bx = 2 * x; bx < std::min(2 * x + 2, below.GetWidth()); ++bx) {
+            const int16_t b = below.Get(bx, by);
+            /* a block containing an empty cell can't be skipped */
+            Merge(value, b == EMPTY ? UNKNOWN : b);
+          }
+        }
+
+        level.Get(x, y) = value;
+      }
+    }
+  }
+}
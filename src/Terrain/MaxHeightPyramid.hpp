@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "RasterTraits.hpp"
+#include "RasterLocation.hpp"
+#include "util/AllocatedGrid.hxx"
+
+#include <array>
+#include <cstdint>
+
+class RasterBuffer;
+
+/**
+ * A "max-height mipmap" of the terrain.  Level 0 has one cell per
+ * overview pixel (i.e. per 2^OVERVIEW_BITS x 2^OVERVIEW_BITS raster
+ * pixels), containing an upper bound of all heights which
+ * #RasterTileCache may return for a raster pixel inside it; each
+ * further level combines 2x2 cells of the level below.
+ *
+ * This allows intersection tests to skip whole blocks which are
+ * entirely below the glide path, instead of sampling them.
+ *
+ * Cells only ever grow (until Resize() or Reset()), so they remain
+ * valid when tiles get unloaded.
+ */
+class MaxHeightPyramid {
+public:
+  static constexpr unsigned MAX_LEVELS = 8;
+
+  /**
+   * The value of cells which may contain pixels without valid
+   * terrain, or which have not been loaded yet; these are never
+   * skipped.
+   */
+  static constexpr int16_t UNKNOWN = INT16_MAX;
+
+  /**
+   * The value of level 0 cells which have not been loaded yet.
+   */
+  static constexpr int16_t EMPTY = INT16_MIN;
+
+private:
+  std::array<AllocatedGrid<int16_t>, MAX_LEVELS> levels;
+  unsigned n_levels = 0;
+
+public:
+  void Reset() noexcept;
+
+  /**
+   * Allocate all levels for the given overview size.  All cells are
+   * initialised with #EMPTY.
+   */
+  void Resize(RasterLocation overview_size) noexcept;
+
+  bool IsDefined() const noexcept {
+    return n_levels > 0;
+  }
+
+  unsigned GetLevels() const noexcept {
+    return n_levels;
+  }
+
+  /**
+   * Load level 0 cells from the given overview.
+   *
+   * @param start the first overview pixel
+   * @param end the end of the overview pixel range (exclusive)
+   */
+  void PutOverview(const RasterBuffer &overview,
+                   RasterLocation start, RasterLocation end) noexcept;
+
+  /**
+   * Merge the heights of a (loaded) tile into level 0.
+   *
+   * @param start the raster pixel location of the tile's top left
+   * corner
+   */
+  void PutTile(const RasterBuffer &buffer, RasterLocation start) noexcept;
+
+  /**
+   * Returns the maximum height of the given level's block which
+   * contains the raster pixel location #p.
+   */
+  [[gnu::pure]]
+  int GetMax(unsigned level, RasterLocation p) const noexcept {
+    const auto cell = p >> (RasterTraits::OVERVIEW_BITS + level);
+    const int value = levels[level].Get(cell.x, cell.y);
+    return value == EMPTY ? UNKNOWN : value;
+  }
+
+private:
+  /**
+   * Update the cells of all levels above the given range of level 0
+   * cells.
+   */
+  void Propagate(unsigned x0, unsigned y0,
+                 unsigned x1, unsigned y1) noexcept;
+};
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "util/Compiler.h"
+
+#ifndef __ARM_NEON__
+#error ARM NEON required
+#endif
+
+#include <arm_neon.h>
+
+#include <cstdint>
+
+/**
+ * Bilinear height interpolation using ARM NEON instructions, see
+ * HeightInterpolationBatch.
+ */
+class NEONHeightInterpolation {
+  /**
+   * Calculate 4 interpolations.
+   */
+  gcc_always_inline
+  static int16x4_t Interpolate4(int16x4_t a, int16x4_t b,
+                                int16x4_t c, int16x4_t d,
+                                int16x4_t kx, int16x4_t ix,
+                                int16x4_t ky, int16x4_t iy) noexcept {
+    /* horizontal pass: a*kx + b*ix; this fits into 32 bits easily */
+    int32x4_t top = vmull_s16(a, kx);
+    top = vmlal_s16(top, b, ix);
+
+    int32x4_t bottom = vmull_s16(c, kx);
+    bottom = vmlal_s16(bottom, d, ix);
+
+    /* vertical pass: the portable code calculates this with
+       wrapping unsigned arithmetic, and so do we */
+    int32x4_t sum = vmulq_s32(top, vmovl_s16(ky));
+    sum = vmlaq_s32(sum, bottom, vmovl_s16(iy));
+
+    /* bits 16..31 are the result */
+    return vshrn_n_s32(sum, 16);
+  }
+
+public:
+  /**
+   * Calculate 8 interpolations.
+   */
+  gcc_always_inline
+  static void Interpolate8(const int16_t *gcc_restrict a,
+                           const int16_t *gcc_restrict b,
+                           const int16_t *gcc_restrict c,
+                           const int16_t *gcc_restrict d,
+                           const int16_t *gcc_restrict ix,
+                           const int16_t *gcc_restrict iy,
+                           int16_t *gcc_restrict result) noexcept {
+    const int16x8_t av = vld1q_s16(a);
+    const int16x8_t bv = vld1q_s16(b);
+    const int16x8_t cv = vld1q_s16(c);
+    const int16x8_t dv = vld1q_s16(d);
+    const int16x8_t ixv = vld1q_s16(ix);
+    const int16x8_t iyv = vld1q_s16(iy);
+
+    const int16x8_t k256 = vdupq_n_s16(0x100);
+    const int16x8_t kxv = vsubq_s16(k256, ixv);
+    const int16x8_t kyv = vsubq_s16(k256, iyv);
+
+    const int16x4_t lo =
+      Interpolate4(vget_low_s16(av), vget_low_s16(bv),
+                   vget_low_s16(cv), vget_low_s16(dv),
+                   vget_low_s16(kxv), vget_low_s16(ixv),
+                   vget_low_s16(kyv), vget_low_s16(iyv));
+    const int16x4_t hi =
+      Interpolate4(vget_high_s16(av), vget_high_s16(bv),
+                   vget_high_s16(cv), vget_high_s16(dv),
+                   vget_high_s16(kxv), vget_high_s16(ixv),
+                   vget_high_s16(kyv), vget_high_s16(iyv));
+
+    vst1q_s16(result, vcombine_s16(lo, hi));
+  }
+};
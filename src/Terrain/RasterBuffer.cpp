@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "Terrain/RasterBuffer.hpp"
+#include "Terrain/InterpolationBatch.hpp"
 
 #include <algorithm>
 #include <cassert>
@@ -14,6 +15,21 @@ RasterBuffer::Resize(RasterLocation _size) noexcept
   assert(_size.y > 0);
 
   data.GrowDiscard(_size.x, _size.y);
+  view = data.begin();
+  view_size = _size;
+}
+
+void
+RasterBuffer::SetExternal(const TerrainHeight *_data,
+                          RasterLocation _size) noexcept
+{
+  assert(_data != nullptr);
+  assert(_size.x > 0);
+  assert(_size.y > 0);
+
+  data.Reset();
+  view = _data;
+  view_size = _size;
 }
 
 TerrainHeight
@@ -60,6 +76,39 @@ RasterBuffer::GetInterpolated(RasterLocation p) const noexcept
   return GetInterpolated(px, py, ix, iy);
 }
 
+void
+RasterBuffer::GetInterpolated(unsigned lx, unsigned ly,
+                              unsigned ix, unsigned iy,
+                              HeightInterpolationBatch &batch,
+                              TerrainHeight &dest) const noexcept
+{
+  assert(IsDefined());
+  assert(lx < GetSize().x);
+  assert(ly < GetSize().y);
+  assert(ix < 0x100);
+  assert(iy < 0x100);
+
+  const unsigned int dx = (lx == GetSize().x - 1) ? 0 : 1;
+  const unsigned int dy = (ly == GetSize().y - 1) ? 0 : GetSize().x;
+
+  batch.Add(GetDataAt({lx, ly}), dx, dy, ix, iy, dest);
+}
+
+void
+RasterBuffer::GetInterpolated(RasterLocation p,
+                              HeightInterpolationBatch &batch,
+                              TerrainHeight &dest) const noexcept
+{
+  const auto [px, ix] = RasterTraits::CalcSubpixel(p.x);
+  const auto [py, iy] = RasterTraits::CalcSubpixel(p.y);
+  if (px >= GetSize().x || py >= GetSize().y) {
+    dest = TerrainHeight::Invalid();
+    return;
+  }
+
+  GetInterpolated(px, py, ix, iy, batch, dest);
+}
+
 /**
  * This class implements an algorithm to traverse pixels quickly with
  * only integer addition, no multiplication and division.
@@ -243,7 +292,7 @@ TerrainHeight
 RasterBuffer::GetMaximum() const noexcept
 {
   return IsDefined()
-    ? *std::max_element(data.begin(), data.end(),
+    ? *std::max_element(view, view + view_size.Area(),
                         [](TerrainHeight a, TerrainHeight b) {
                           return a.GetValue() < b.GetValue();
                         })
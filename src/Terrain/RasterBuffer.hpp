@@ -9,23 +9,43 @@
 #include "util/AllocatedGrid.hxx"
 #include "util/Compiler.h"
 
+#include <cassert>
+
+class HeightInterpolationBatch;
+
 class RasterBuffer {
   AllocatedGrid<TerrainHeight> data;
 
+  /**
+   * The memory all read accessors operate on.  This points either
+   * to #data or to read-only memory owned by somebody else (see
+   * SetExternal()).
+   */
+  const TerrainHeight *view = nullptr;
+  RasterLocation view_size{0, 0};
+
 public:
   RasterBuffer() noexcept = default;
   RasterBuffer(unsigned _width, unsigned _height) noexcept
-    :data(_width, _height) {}
+    :data(_width, _height),
+     view(data.begin()), view_size(_width, _height) {}
 
   RasterBuffer(const RasterBuffer &) = delete;
   RasterBuffer &operator=(const RasterBuffer &) = delete;
 
   bool IsDefined() const noexcept {
-    return data.IsDefined();
+    return view != nullptr;
+  }
+
+  /**
+   * Does this buffer refer to memory owned by somebody else?
+   */
+  bool IsExternal() const noexcept {
+    return view != nullptr && !data.IsDefined();
   }
 
   RasterLocation GetSize() const noexcept {
-    return {data.GetWidth(), data.GetHeight()};
+    return view_size;
   }
 
   RasterLocation GetFineSize() const noexcept {
@@ -33,23 +53,37 @@ public:
   }
 
   TerrainHeight *GetData() noexcept {
+    assert(!IsExternal());
+
     return data.begin();
   }
 
   const TerrainHeight *GetData() const noexcept {
-    return data.begin();
+    return view;
   }
 
   const TerrainHeight *GetDataAt(RasterLocation p) const noexcept {
-    return data.GetPointerAt(p.x, p.y);
+    assert(p.x < view_size.x);
+    assert(p.y < view_size.y);
+
+    return view + p.y * view_size.x + p.x;
   }
 
   void Reset() noexcept {
     data.Reset();
+    view = nullptr;
+    view_size = {0, 0};
   }
 
   void Resize(RasterLocation _size) noexcept;
 
+  /**
+   * Let this buffer refer to read-only memory owned by the caller,
+   * e.g. a memory-mapped file.  The memory must remain valid until
+   * Reset() or Resize() is called.
+   */
+  void SetExternal(const TerrainHeight *_data, RasterLocation _size) noexcept;
+
   [[gnu::pure]]
   TerrainHeight GetInterpolated(unsigned lx, unsigned ly,
                                 unsigned ix, unsigned iy) const noexcept;
@@ -57,6 +91,20 @@ public:
   [[gnu::pure]]
   TerrainHeight GetInterpolated(RasterLocation p) const noexcept;
 
+  /**
+   * Like GetInterpolated(), but queue the calculation in the
+   * #HeightInterpolationBatch.  The result will be stored in #dest
+   * when the batch is flushed.
+   */
+  void GetInterpolated(unsigned lx, unsigned ly,
+                       unsigned ix, unsigned iy,
+                       HeightInterpolationBatch &batch,
+                       TerrainHeight &dest) const noexcept;
+
+  void GetInterpolated(RasterLocation p,
+                       HeightInterpolationBatch &batch,
+                       TerrainHeight &dest) const noexcept;
+
   [[gnu::pure]]
   TerrainHeight Get(RasterLocation p) const noexcept {
     return *GetDataAt(p);
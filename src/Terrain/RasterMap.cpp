@@ -35,6 +35,54 @@ RasterMap::GetInterpolatedHeight(const GeoPoint &location) const noexcept
   return raster_tile_cache.GetInterpolatedHeight(pt);
 }
 
+/**
+ * The number of locations projected at a time by the batch lookups.
+ */
+static constexpr std::size_t PROJECT_CHUNK = 64;
+
+void
+RasterMap::GetHeights(std::span<const GeoPoint> locations,
+                      TerrainHeight *dest) const noexcept
+{
+  SignedRasterLocation fine[PROJECT_CHUNK];
+  RasterLocation coarse[PROJECT_CHUNK];
+
+  while (!locations.empty()) {
+    const auto chunk = locations.first(std::min(locations.size(),
+                                                PROJECT_CHUNK));
+    projection.ProjectFine(chunk, fine);
+
+    for (std::size_t i = 0; i < chunk.size(); ++i)
+      coarse[i] = fine[i] >> RasterTraits::SUBPIXEL_BITS;
+
+    raster_tile_cache.GetHeights({coarse, chunk.size()}, dest);
+
+    locations = locations.subspan(chunk.size());
+    dest += chunk.size();
+  }
+}
+
+void
+RasterMap::GetInterpolatedHeights(std::span<const GeoPoint> locations,
+                                  TerrainHeight *dest) const noexcept
+{
+  SignedRasterLocation fine[PROJECT_CHUNK];
+  RasterLocation unsigned_fine[PROJECT_CHUNK];
+
+  while (!locations.empty()) {
+    const auto chunk = locations.first(std::min(locations.size(),
+                                                PROJECT_CHUNK));
+    projection.ProjectFine(chunk, fine);
+    std::copy_n(fine, chunk.size(), unsigned_fine);
+
+    raster_tile_cache.GetInterpolatedHeights({unsigned_fine, chunk.size()},
+                                             dest);
+
+    locations = locations.subspan(chunk.size());
+    dest += chunk.size();
+  }
+}
+
 void
 RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
                     TerrainHeight *buffer, unsigned size,
@@ -95,6 +95,23 @@ public:
   [[gnu::pure]]
   TerrainHeight GetInterpolatedHeight(const GeoPoint &location) const noexcept;
 
+  /**
+   * Batch version of GetHeight().  This is faster than calling
+   * GetHeight() for each location.
+   *
+   * @param dest an array with the same size as #locations
+   */
+  void GetHeights(std::span<const GeoPoint> locations,
+                  TerrainHeight *dest) const noexcept;
+
+  /**
+   * Batch version of GetInterpolatedHeight().
+   *
+   * @param dest an array with the same size as #locations
+   */
+  void GetInterpolatedHeights(std::span<const GeoPoint> locations,
+                              TerrainHeight *dest) const noexcept;
+
   /**
    * Scan a straight line and fill the buffer with the specified
    * number of samples along the line.
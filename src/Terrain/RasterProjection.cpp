@@ -5,6 +5,10 @@
 #include "Geo/GeoBounds.hpp"
 #include "Geo/FAISphere.hpp"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include <algorithm>
 #include <cassert>
 
@@ -19,6 +23,34 @@ RasterProjection::Set(const GeoBounds &bounds,
   top = AngleToHeight(bounds.GetNorth());
 }
 
+void
+RasterProjection::ProjectFine(std::span<const GeoPoint> src,
+                              SignedRasterLocation *dest) const noexcept
+{
+  auto i = src.begin();
+
+#ifdef __SSE2__
+  static_assert(sizeof(GeoPoint) == 2 * sizeof(double));
+  static_assert(sizeof(SignedRasterLocation) == 2 * sizeof(int));
+
+  /* the latitude is multiplied with the negative scale; this is
+     equivalent because the conversion truncates towards zero */
+  const __m128d scale = _mm_set_pd(-y_scale, x_scale);
+  const __m128i offset = _mm_set_epi32(top, -left, top, -left);
+
+  for (; src.end() - i >= 2; i += 2, dest += 2) {
+    const double *p = (const double *)(const void *)&*i;
+    const __m128i a = _mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(p), scale));
+    const __m128i b = _mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(p + 2), scale));
+    _mm_storeu_si128((__m128i *)(void *)dest,
+                     _mm_add_epi32(_mm_unpacklo_epi64(a, b), offset));
+  }
+#endif
+
+  for (; i != src.end(); ++i)
+    *dest++ = ProjectFine(*i);
+}
+
 double
 RasterProjection::FinePixelDistance(const GeoPoint &location,
                                     unsigned pixels) const noexcept
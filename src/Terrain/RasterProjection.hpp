@@ -7,6 +7,8 @@
 #include "RasterLocation.hpp"
 #include "Geo/GeoPoint.hpp"
 
+#include <span>
+
 class GeoBounds;
 
 /**
@@ -48,6 +50,15 @@ public:
                                 top - AngleToHeight(location.latitude));
   }
 
+  /**
+   * Batch version of ProjectFine(), using SIMD instructions if
+   * available.
+   *
+   * @param dest an array with the same size as #src
+   */
+  void ProjectFine(std::span<const GeoPoint> src,
+                   SignedRasterLocation *dest) const noexcept;
+
   constexpr GeoPoint UnprojectFine(SignedRasterLocation coords) const noexcept {
     return GeoPoint(WidthToAngle((int)coords.x + left),
                     HeightToAngle(top - (int)coords.y));
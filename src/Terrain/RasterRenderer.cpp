@@ -3,6 +3,7 @@
 
 #include "Terrain/RasterRenderer.hpp"
 #include "Terrain/RasterMap.hpp"
+#include "Terrain/ShiftGrid.hpp"
 #include "Math/Constants.hpp"
 #include "util/Clamp.hpp"
 #include "Screen/Layout.hpp"
@@ -13,6 +14,10 @@
 #include "Projection/WindowProjection.hpp"
 #include "Asset.hpp"
 #include "ui/event/Idle.hpp"
+#include "thread/WorkerPool.hpp"
+
+#include <algorithm>
+#include <type_traits>
 
 #include <cassert>
 #include <cstdint>
@@ -80,6 +85,7 @@ ContourInterval(const TerrainHeight h, const unsigned contour_height_scale)
 }
 
 RasterRenderer::RasterRenderer()
+  :pool(WorkerPool::CreateDefault(4))
 {
   // scale quantisation_pixels so resolution is not too high on old hardware
   // with large displays
@@ -170,14 +176,71 @@ RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection
   height_matrix.Fill(map, bounds,
                      projection.GetScreenSize().width / quantisation_pixels,
                      projection.GetScreenSize().height / quantisation_pixels,
-                     true);
+                     true, pool.get());
 
   last_quantisation_pixels = quantisation_pixels;
 #else
-  height_matrix.Fill(map, projection, quantisation_pixels, true);
+  height_matrix.Fill(map, projection, quantisation_pixels, true,
+                     pool.get());
+  dirty_rects.clear();
 #endif
 }
 
+#ifndef ENABLE_OPENGL
+
+void
+RasterRenderer::ScrollMap(const RasterMap &map,
+                          const WindowProjection &projection,
+                          PixelPoint shift)
+{
+  assert(image != nullptr);
+
+  const PixelRect all{PixelSize{height_matrix.GetWidth(),
+                                height_matrix.GetHeight()}};
+  assert(unsigned(std::abs(shift.x)) < all.GetWidth());
+  assert(unsigned(std::abs(shift.y)) < all.GetHeight());
+
+  height_matrix.Shift(shift.x, shift.y);
+  ShiftGrid([this](unsigned y){ return image->GetRow(y); },
+            all.GetWidth(), all.GetHeight(), shift.x, shift.y);
+
+  /* the newly exposed rows (full width) and columns (the remaining
+     height) */
+  PixelRect rows = all, columns = all;
+  if (shift.y > 0)
+    columns.bottom = rows.top = all.bottom - shift.y;
+  else
+    columns.top = rows.bottom = -shift.y;
+
+  if (shift.x > 0)
+    columns.left = all.right - shift.x;
+  else
+    columns.right = -shift.x;
+
+  /* the slope shading looks at neighbours up to
+     #quantisation_effective cells away, and contour lines depend on
+     the previous cell */
+  const int margin = quantisation_effective + 1;
+
+  dirty_rects.clear();
+  for (PixelRect rc : {rows, columns}) {
+    if (rc.IsEmpty())
+      continue;
+
+    height_matrix.Fill(map, projection, quantisation_pixels, rc, true,
+                       pool.get());
+
+    rc.Grow(margin);
+    rc.left = std::max(rc.left, all.left);
+    rc.top = std::max(rc.top, all.top);
+    rc.right = std::min(rc.right, all.right);
+    rc.bottom = std::min(rc.bottom, all.bottom);
+    dirty_rects.push_back(rc);
+  }
+}
+
+#endif
+
 void
 RasterRenderer::GenerateImage(bool do_shading,
                               unsigned height_scale,
@@ -193,6 +256,11 @@ RasterRenderer::GenerateImage(bool do_shading,
 
     delete[] contour_column_base;
     contour_column_base = new unsigned char[height_matrix.GetWidth()];
+
+#ifndef ENABLE_OPENGL
+    /* the old image is gone */
+    dirty_rects.clear();
+#endif
   }
 
   if (quantisation_effective == 0) {
@@ -202,33 +270,119 @@ RasterRenderer::GenerateImage(bool do_shading,
 
   const unsigned contour_height_scale = do_contour? height_scale * 2 : 16;
 
-  ContourStart(contour_height_scale);
+#ifndef ENABLE_OPENGL
+  if (!dirty_rects.empty()) {
+    /* after ScrollMap(): only the new parts need to be generated */
+    for (const auto &rc : dirty_rects)
+      GenerateImage(rc, do_shading, height_scale, contrast, brightness,
+                    sunazimuth, contour_height_scale);
+    dirty_rects.clear();
+  } else
+#endif
+    GenerateImage(PixelRect{PixelSize{height_matrix.GetWidth(),
+                                      height_matrix.GetHeight()}},
+                  do_shading, height_scale, contrast, brightness,
+                  sunazimuth, contour_height_scale);
+
+  image->SetDirty();
+}
+
+void
+RasterRenderer::GenerateImage(const PixelRect &rc, bool do_shading,
+                              unsigned height_scale,
+                              int contrast, int brightness,
+                              const Angle sunazimuth,
+                              const unsigned contour_height_scale)
+{
+  ContourStart(rc, contour_height_scale);
 
   if (do_shading)
-    GenerateSlopeImage(height_scale, contrast, brightness,
+    GenerateSlopeImage(rc, height_scale, contrast, brightness,
                        sunazimuth, contour_height_scale);
   else
-    GenerateUnshadedImage(height_scale, contour_height_scale);
+    GenerateUnshadedImage(rc, height_scale, contour_height_scale);
+}
 
-  image->SetDirty();
+template<typename F>
+void
+RasterRenderer::GenerateRows(const PixelRect &rc,
+                             const unsigned contour_height_scale,
+                             F &&row) noexcept
+{
+  constexpr unsigned MIN_BAND_HEIGHT = 16;
+
+  const unsigned n_rows = rc.GetHeight();
+  if (pool == nullptr || n_rows < 2 * MIN_BAND_HEIGHT) {
+    for (unsigned y = rc.top; y < (unsigned)rc.bottom; ++y)
+      row(y, contour_column_base, std::true_type{});
+    return;
+  }
+
+  const unsigned n_bands =
+    std::min(pool->GetConcurrency(), n_rows / MIN_BAND_HEIGHT);
+  const unsigned width = height_matrix.GetWidth();
+  contour_snapshots.GrowDiscard(n_bands * width);
+
+  const auto GetBandStart = [n_rows, n_bands](unsigned band){
+    return WorkerPool::GetBandStart(n_rows, n_bands, band);
+  };
+
+  /* a contour line is drawn where the interval differs from the cell
+     above, i.e. each row depends on the contour state left behind by
+     all previous rows; replay that state quickly (without colors and
+     slope shading) to obtain the start state of each band, so the
+     result is exactly the same as with a single thread */
+  const bool have_contours = contour_height_scale < 16;
+  for (unsigned band = 0; band < n_bands; ++band) {
+    std::copy_n(contour_column_base, width,
+                contour_snapshots.data() + band * width);
+
+    if (have_contours && band + 1 < n_bands) {
+      const unsigned end = rc.top + GetBandStart(band + 1);
+      for (unsigned y = rc.top + GetBandStart(band); y < end; ++y)
+        row(y, contour_column_base, std::false_type{});
+    }
+  }
+
+  pool->ForEach(n_bands, [&](unsigned band){
+    unsigned char *column_base = contour_snapshots.data() + band * width;
+    const unsigned end = rc.top + GetBandStart(band + 1);
+    for (unsigned y = rc.top + GetBandStart(band); y < end; ++y)
+      row(y, column_base, std::true_type{});
+  });
+}
+
+/**
+ * Determine the initial contour interval of a row segment starting at
+ * the given cell.  Inside the matrix, this is the cell to the left,
+ * to avoid a seam when generating only a part of the image.
+ */
+[[gnu::pure]]
+static unsigned
+ContourRowStart(const TerrainHeight *src, unsigned x,
+                const unsigned contour_height_scale)
+{
+  return ContourInterval(x > 0 ? src[-1] : *src, contour_height_scale);
 }
 
 void
-RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
+RasterRenderer::GenerateUnshadedImage(const PixelRect &rc,
+                                      unsigned height_scale,
                                       const unsigned contour_height_scale)
 {
-  const auto *src = height_matrix.GetData();
   const RawColor *oColorBuf = color_table + 64 * 256;
-  RawColor *dest = image->GetTopRow();
 
-  for (unsigned y = height_matrix.GetHeight(); y > 0; --y) {
-    RawColor *p = dest;
-    dest = image->GetNextRow(dest);
+  GenerateRows(rc, contour_height_scale, [&](unsigned y,
+                                             unsigned char *column_base,
+                                             auto colorize){
+    const auto *src = height_matrix.GetRow(y) + rc.left;
+    RawColor *p = image->GetRow(y) + rc.left;
 
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    unsigned contour_row_base =
+      ContourRowStart(src, rc.left, contour_height_scale);
+    unsigned char *contour_this_column_base = column_base + rc.left;
 
-    for (unsigned x = height_matrix.GetWidth(); x > 0; --x) {
+    for (unsigned x = rc.GetWidth(); x > 0; --x) {
       const auto e = *src++;
       if (gcc_likely(!e.IsSpecial())) {
         unsigned h = std::max(0, (int)e.GetValue());
@@ -240,22 +394,26 @@ RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
         if (gcc_unlikely((contour_interval != contour_row_base)
                          || (contour_interval != *contour_this_column_base))) {
 
-          *p++ = oColorBuf[(int)h - 64 * 256];
+          if constexpr (colorize)
+            *p = oColorBuf[(int)h - 64 * 256];
           *contour_this_column_base = contour_row_base = contour_interval;
+        } else if constexpr (colorize) {
+          *p = oColorBuf[h];
+        }
+      } else if constexpr (colorize) {
+        if (e.IsWater()) {
+          // we're in the water, so look up the color for water
+          *p = oColorBuf[255];
         } else {
-          *p++ = oColorBuf[h];
+          /* outside the terrain file bounds: white background */
+          *p = RawColor(0xff, 0xff, 0xff);
         }
-      } else if (e.IsWater()) {
-        // we're in the water, so look up the color for water
-        *p++ = oColorBuf[255];
-      } else {
-        /* outside the terrain file bounds: white background */
-        *p++ = RawColor(0xff, 0xff, 0xff);
       }
+      ++p;
       contour_this_column_base++;
 
     }
-  }
+  });
 }
 
 /**
@@ -284,7 +442,8 @@ ClipHeightDelta(TerrainHeight a, TerrainHeight b)
 // (gridding of display) This is why quantisation_effective is used instead of 1
 // previously.  for large zoom levels, quantisation_effective=1
 void
-RasterRenderer::GenerateSlopeImage(unsigned height_scale,
+RasterRenderer::GenerateSlopeImage(const PixelRect &rc,
+                                   unsigned height_scale,
                                    int contrast,
                                    const int sx, const int sy, const int sz,
                                    const unsigned contour_height_scale)
@@ -304,12 +463,11 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
              square will not overflow */
           8192u / (quantisation_effective * quantisation_effective));
 
-  const auto *src = height_matrix.GetData();
   const RawColor *oColorBuf = color_table + 64 * 256;
 
-  RawColor *dest = image->GetTopRow();
-
-  for (unsigned y = 0; y < height_matrix.GetHeight(); ++y) {
+  GenerateRows(rc, contour_height_scale, [&](unsigned y,
+                                             unsigned char *column_base,
+                                             auto colorize){
     const unsigned row_plus_index = y < (unsigned)border.bottom
       ? quantisation_effective
       : height_matrix.GetHeight() - 1 - y;
@@ -321,13 +479,14 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
 
     const unsigned p31 = row_plus_index + row_minus_index;
 
-    RawColor *p = dest;
-    dest = image->GetNextRow(dest);
+    const auto *src = height_matrix.GetRow(y) + rc.left;
+    RawColor *p = image->GetRow(y) + rc.left;
 
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    unsigned contour_row_base =
+      ContourRowStart(src, rc.left, contour_height_scale);
+    unsigned char *contour_this_column_base = column_base + rc.left;
 
-    for (unsigned x = 0; x < height_matrix.GetWidth(); ++x, ++src) {
+    for (unsigned x = rc.left; x < (unsigned)rc.right; ++x, ++src, ++p) {
       const auto e = *src;
       if (gcc_likely(!e.IsSpecial())) {
         unsigned h = std::max(0, (int)e.GetValue());
@@ -369,7 +528,8 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
                          h_right.IsSpecial())) {
           /* some "special" terrain value surrounding us (water or
              invalid), skip slope calculation */
-          *p++ = oColorBuf[h];
+          if constexpr (colorize)
+            *p = oColorBuf[h];
           contour_this_column_base++;
           continue;
         }
@@ -378,7 +538,14 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
                          || (contour_interval != *contour_this_column_base))) {
 
           *contour_this_column_base++ = contour_row_base = contour_interval;
-          *p++ = oColorBuf[int(h) - 64 * 256];
+          if constexpr (colorize)
+            *p = oColorBuf[int(h) - 64 * 256];
+          continue;
+        }
+
+        if constexpr (!colorize) {
+          /* the rest doesn't affect the contour state */
+          contour_this_column_base++;
           continue;
         }
 
@@ -400,22 +567,25 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
         /* TODO: debug this problem and replace this workaround */
         const int sval = num / int(mag|1);
         const int sindex = (sval - sz) * contrast / 128;
-        *p++ = oColorBuf[int(h) + 256 * Clamp(sindex, -63, 63)];
-      } else if (e.IsWater()) {
-        // we're in the water, so look up the color for water
-        *p++ = oColorBuf[255];
-      } else {
-        /* outside the terrain file bounds: white background */
-        *p++ = RawColor(0xff, 0xff, 0xff);
+        *p = oColorBuf[int(h) + 256 * Clamp(sindex, -63, 63)];
+      } else if constexpr (colorize) {
+        if (e.IsWater()) {
+          // we're in the water, so look up the color for water
+          *p = oColorBuf[255];
+        } else {
+          /* outside the terrain file bounds: white background */
+          *p = RawColor(0xff, 0xff, 0xff);
+        }
       }
       contour_this_column_base++;
 
     }
-  }
+  });
 }
 
 void
-RasterRenderer::GenerateSlopeImage(unsigned height_scale,
+RasterRenderer::GenerateSlopeImage(const PixelRect &rc,
+                                   unsigned height_scale,
                                    int contrast, int brightness,
                                    const Angle sunazimuth,
                                    const unsigned contour_height_scale)
@@ -427,7 +597,7 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
   const int sy = (int)(255 * fudgeelevation.fastcosine() * -sunazimuth.fastcosine());
   const int sz = (int)(255 * fudgeelevation.fastsine());
 
-  GenerateSlopeImage(height_scale, contrast,
+  GenerateSlopeImage(rc, height_scale, contrast,
                      sx, sy, sz, contour_height_scale);
 }
 
@@ -466,12 +636,14 @@ RasterRenderer::PrepareColorTable(const ColorRamp *color_ramp, bool do_water,
 }
 
 void
-RasterRenderer::ContourStart(const unsigned contour_height_scale)
+RasterRenderer::ContourStart(const PixelRect &rc,
+                             const unsigned contour_height_scale)
 {
-  // initialise column to first row
-  const auto *src = height_matrix.GetData();
-  unsigned char *col_base = contour_column_base;
-  for (unsigned x = height_matrix.GetWidth(); x > 0; --x)
+  // initialise column to first row (or the row above, if there is one)
+  const auto *src = height_matrix.GetRow(rc.top > 0 ? rc.top - 1 : 0)
+    + rc.left;
+  unsigned char *col_base = contour_column_base + rc.left;
+  for (unsigned x = rc.GetWidth(); x > 0; --x)
     *col_base++ = ContourInterval(*src++, contour_height_scale);
 }
 
@@ -4,9 +4,15 @@
 #pragma once
 
 #include "Terrain/HeightMatrix.hpp"
+#include "ui/dim/Rect.hpp"
+#include "util/AllocatedArray.hxx"
+
+#include <memory>
 
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
+#else
+#include "util/StaticArray.hxx"
 #endif
 
 static constexpr unsigned NUM_COLOR_RAMP_LEVELS = 13;
@@ -16,6 +22,7 @@ class Canvas;
 class RasterMap;
 class WindowProjection;
 class RawBitmap;
+class WorkerPool;
 struct RawColor;
 struct ColorRamp;
 
@@ -53,8 +60,29 @@ class RasterRenderer {
   HeightMatrix height_matrix;
   RawBitmap *image = nullptr;
 
+#ifndef ENABLE_OPENGL
+  /**
+   * The parts of the image which have to be regenerated by the next
+   * GenerateImage() call, after ScrollMap().  If this is empty, the
+   * whole image is generated.
+   */
+  StaticArray<PixelRect, 2> dirty_rects;
+#endif
+
   unsigned char *contour_column_base = nullptr;
 
+  /**
+   * Copies of #contour_column_base at the start of each band
+   * rendered by a #pool thread.
+   */
+  AllocatedArray<unsigned char> contour_snapshots;
+
+  /**
+   * Helper threads which fill the #height_matrix and generate the
+   * image.  This is nullptr on single-core machines.
+   */
+  std::unique_ptr<WorkerPool> pool;
+
   double pixel_size;
 
   RawColor *color_table = nullptr;
@@ -78,6 +106,10 @@ public:
     return height_matrix.GetHeight();
   }
 
+  unsigned GetQuantisation() const {
+    return quantisation_pixels;
+  }
+
 #ifdef ENABLE_OPENGL
   void Invalidate() {
     bounds.SetInvalid();
@@ -111,6 +143,20 @@ public:
    */
   void ScanMap(const RasterMap &map, const WindowProjection &projection);
 
+#ifndef ENABLE_OPENGL
+  /**
+   * Shift the height matrix and the image by the specified number of
+   * cells (see HeightMatrix::Shift()) and scan only the newly exposed
+   * parts of the map.  The following GenerateImage() call regenerates
+   * only these parts (with a margin for the slope shading); its
+   * parameters must be the same as in the previous call.
+   *
+   * @param projection the projection of the shifted cells
+   */
+  void ScrollMap(const RasterMap &map, const WindowProjection &projection,
+                 PixelPoint shift);
+#endif
+
   /**
    * Convert the height matrix into the image.
    */
@@ -127,28 +173,47 @@ public:
             bool transparent_white=false) const;
 
 protected:
+  /**
+   * Convert the specified part of the height matrix into the image.
+   */
+  void GenerateImage(const PixelRect &rc, bool do_shading,
+                     unsigned height_scale, int contrast, int brightness,
+                     const Angle sunazimuth,
+                     const unsigned contour_height_scale);
+
   /**
    * Convert the height matrix into the image, without shading.
    */
-  void GenerateUnshadedImage(unsigned height_scale,
+  void GenerateUnshadedImage(const PixelRect &rc, unsigned height_scale,
                              const unsigned contour_height_scale);
 
   /**
    * Convert the height matrix into the image, with slope shading.
    */
-  void GenerateSlopeImage(unsigned height_scale, int contrast,
+  void GenerateSlopeImage(const PixelRect &rc,
+                          unsigned height_scale, int contrast,
                           const int sx, const int sy, const int sz,
                           const unsigned contour_height_scale);
 
   /**
    * Convert the height matrix into the image, with slope shading.
    */
-  void GenerateSlopeImage(unsigned height_scale,
+  void GenerateSlopeImage(const PixelRect &rc, unsigned height_scale,
                           int contrast, int brightness,
                           const Angle sunazimuth,
                           const unsigned contour_height_scale);
 
 private:
+  /**
+   * Invoke row(y, column_base, colorize) for each row of the
+   * rectangle, possibly in several threads.  "column_base" is the
+   * #contour_column_base buffer to be used, and "colorize" is
+   * std::false_type if only the contour state shall be updated.
+   */
+  template<typename F>
+  void GenerateRows(const PixelRect &rc, unsigned contour_height_scale,
+                    F &&row) noexcept;
 
-  void ContourStart(const unsigned contour_height_scale);
+  void ContourStart(const PixelRect &rc,
+                    const unsigned contour_height_scale);
 };
@@ -11,11 +11,24 @@
 #include "io/Reader.hxx"
 #include "io/BufferedReader.hxx"
 #include "system/ConvertPathName.hpp"
+#include "system/FileMapping.hpp"
 #include "Operation/Operation.hpp"
 #include "util/ConvertString.hpp"
 #include "LogFile.hpp"
 
 static const TCHAR *const terrain_cache_name = _T("terrain");
+static const TCHAR *const terrain_tiles_cache_name = _T("terrain-tiles");
+
+/**
+ * Don't generate tile stores larger than this; class FileMapping
+ * refuses to map them.
+ */
+static constexpr uint64_t MAX_TILE_STORE_SIZE = 1024 * 1024 * 1024;
+
+RasterTerrain::RasterTerrain(ZipArchive &&_archive) noexcept
+  :Guard<RasterMap>(map), archive(std::move(_archive)) {}
+
+RasterTerrain::~RasterTerrain() noexcept = default;
 
 inline bool
 RasterTerrain::LoadCache(FileCache &cache, Path path)
@@ -45,26 +58,74 @@ RasterTerrain::SaveCache(FileCache &cache, Path path) const
   os->Commit();
 }
 
+inline void
+RasterTerrain::LoadTileStore(FileCache &cache, Path path,
+                             OperationEnvironment &operation)
+{
+  auto &tile_cache = map.GetTileCache();
+
+  auto store_path = cache.LoadPath(terrain_tiles_cache_name, path);
+  if (store_path == nullptr) {
+    if (tile_cache.GetDecodedSize() > MAX_TILE_STORE_SIZE)
+      return;
+
+    LogFormat("Generating terrain tile store");
+
+    auto os = cache.Save(terrain_tiles_cache_name, path);
+    const uint64_t position = os->Tell();
+    BufferedOutputStream bos(*os);
+    SaveTerrainTileStore(archive.get(), tile_cache, bos, position,
+                         operation);
+    bos.Flush();
+    os->Commit();
+
+    store_path = cache.LoadPath(terrain_tiles_cache_name, path);
+    if (store_path == nullptr)
+      return;
+  }
+
+  try {
+    auto mapping = std::make_unique<FileMapping>(store_path);
+    tile_cache.MapTileStore(*mapping);
+    tile_store = std::move(mapping);
+  } catch (...) {
+    /* discard the broken file, to generate a new one next time */
+    cache.Flush(terrain_tiles_cache_name);
+    throw;
+  }
+}
+
 inline void
 RasterTerrain::Load(Path path, FileCache *cache,
                     OperationEnvironment &operation)
 {
+  bool cached = false;
+
   try {
-    if (LoadCache(cache, path))
-      return;
+    cached = LoadCache(cache, path);
   } catch (...) {
     LogError(std::current_exception(), "Failed to load terrain cache");
   }
 
-  LoadTerrainOverview(archive.get(), map.GetTileCache(), operation);
+  if (!cached) {
+    LoadTerrainOverview(archive.get(), map.GetTileCache(), operation);
 
-  map.UpdateProjection();
+    map.UpdateProjection();
+
+    if (cache != nullptr) {
+      try {
+        SaveCache(*cache, path);
+      } catch (...) {
+        LogError(std::current_exception(), "Failed to save terrain cache");
+      }
+    }
+  }
 
   if (cache != nullptr) {
     try {
-      SaveCache(*cache, path);
+      LoadTileStore(*cache, path, operation);
     } catch (...) {
-      LogError(std::current_exception(), "Failed to save terrain cache");
+      LogError(std::current_exception(), "Failed to load terrain tile store");
     }
   }
 }
@@ -12,6 +12,7 @@
 
 class Path;
 class FileCache;
+class FileMapping;
 class OperationEnvironment;
 
 /**
@@ -27,14 +28,22 @@ public:
 private:
   ZipArchive archive;
 
+  /**
+   * The memory-mapped tile store, see
+   * RasterTileCache::MapTileStore().  This must be declared before
+   * #map, because the #map refers to it until it is destructed.
+   */
+  std::unique_ptr<FileMapping> tile_store;
+
   RasterMap map;
 
 public:
   /**
    * Constructor.  Returns uninitialised object.
    */
-  explicit RasterTerrain(ZipArchive &&_archive) noexcept
-    :Guard<RasterMap>(map), archive(std::move(_archive)) {}
+  explicit RasterTerrain(ZipArchive &&_archive) noexcept;
+
+  ~RasterTerrain() noexcept;
 
   const Serial &GetSerial() const noexcept {
     return map.GetSerial();
@@ -84,6 +93,15 @@ private:
    */
   void SaveCache(FileCache &cache, Path path) const;
 
+  /**
+   * Map the tile store (see RasterTileCache::MapTileStore()) from
+   * the cache, generating it first if it does not exist yet.
+   *
+   * Throws on error.
+   */
+  void LoadTileStore(FileCache &cache, Path path,
+                     OperationEnvironment &operation);
+
   /**
    * Throws on error.
    */
@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "RasterTileCache.hpp"
+#include "InterpolationBatch.hpp"
 #include "Math/Angle.hpp"
 #include "io/BufferedOutputStream.hxx"
 #include "io/BufferedReader.hxx"
@@ -54,6 +55,9 @@ RasterTileCache::PutOverviewTile(unsigned index,
   /* note: this loop rounds up */
   for (unsigned i = 0, y = 0; i < height; ++i, y += skip, dest += dest_pitch)
     CopyOverviewRow(dest, m.rows_[y], width, skip);
+
+  max_pyramid.PutOverview(overview, start,
+                          {start.x + width, start.y + height});
 }
 
 void
@@ -65,6 +69,7 @@ RasterTileCache::PutTileData(unsigned index,
     return;
 
   tile.CopyFrom(m);
+  max_pyramid.PutTile(tile.buffer, tile.start);
 }
 
 struct RTDistanceSort {
@@ -90,6 +95,12 @@ RasterTileCache::PollTiles(SignedRasterLocation p, unsigned radius) noexcept
      the screen will be loaded in advance */
   radius += 256;
 
+  if (HasTileStore()) {
+    /* all tiles are mapped permanently */
+    dirty = false;
+    return false;
+  }
+
   /**
    * Maximum number of tiles loaded at a time, to reduce system load
    * peaks.
@@ -176,6 +187,101 @@ RasterTileCache::GetInterpolatedHeight(RasterLocation l) const noexcept
   return overview.GetInterpolated({RasterTraits::ToOverview(l.x), RasterTraits::ToOverview(l.y)});
 }
 
+/**
+ * Finds the tile containing a pixel location, remembering the most
+ * recent one, because the locations passed to the batch lookups are
+ * usually close to each other.
+ */
+class RasterTileCache::TileFinder {
+  const RasterTileCache &cache;
+
+  const RasterTile *tile = nullptr;
+
+  /**
+   * The pixel range covered by #tile (which may be smaller than the
+   * tile's own size at the map edges, but that doesn't matter here).
+   */
+  RasterLocation start, end;
+
+public:
+  explicit TileFinder(const RasterTileCache &_cache) noexcept
+    :cache(_cache) {}
+
+  const RasterTile &Find(RasterLocation p) noexcept {
+    if (tile == nullptr ||
+        p.x < start.x || p.x >= end.x || p.y < start.y || p.y >= end.y) {
+      const unsigned tx = p.x / cache.tile_size.x;
+      const unsigned ty = p.y / cache.tile_size.y;
+      tile = &cache.tiles.Get(tx, ty);
+      start = {tx * cache.tile_size.x, ty * cache.tile_size.y};
+      end = {start.x + cache.tile_size.x, start.y + cache.tile_size.y};
+    }
+
+    return *tile;
+  }
+};
+
+void
+RasterTileCache::GetHeights(std::span<const RasterLocation> p,
+                            TerrainHeight *dest) const noexcept
+{
+  HeightInterpolationBatch batch;
+  TileFinder finder(*this);
+
+  for (const auto i : p) {
+    if (i.x >= size.x || i.y >= size.y) {
+      // outside overall bounds
+      *dest++ = TerrainHeight::Invalid();
+      continue;
+    }
+
+    const RasterTile &tile = finder.Find(i);
+    if (tile.IsLoaded())
+      *dest = tile.GetHeight(i);
+    else
+      overview.GetInterpolated(i << (RasterTraits::SUBPIXEL_BITS - RasterTraits::OVERVIEW_BITS),
+                               batch, *dest);
+
+    ++dest;
+  }
+
+  batch.Flush();
+}
+
+void
+RasterTileCache::GetInterpolatedHeights(std::span<const RasterLocation> p,
+                                        TerrainHeight *dest) const noexcept
+{
+  HeightInterpolationBatch batch;
+  TileFinder finder(*this);
+
+  for (const auto l : p) {
+    if (l.x >= overview_size_fine.x || l.y >= overview_size_fine.y) {
+      // outside overall bounds
+      *dest++ = TerrainHeight::Invalid();
+      continue;
+    }
+
+    const auto [px, ix] = RasterTraits::CalcSubpixel(l.x);
+    const auto [py, iy] = RasterTraits::CalcSubpixel(l.y);
+
+    const RasterTile &tile = finder.Find({px, py});
+    if (tile.IsLoaded()) {
+      const unsigned lx = px - tile.start.x, ly = py - tile.start.y;
+      if (lx < tile.size.x && ly < tile.size.y)
+        tile.buffer.GetInterpolated(lx, ly, ix, iy, batch, *dest);
+      else
+        *dest = TerrainHeight::Invalid();
+    } else
+      overview.GetInterpolated({RasterTraits::ToOverview(l.x), RasterTraits::ToOverview(l.y)},
+                               batch, *dest);
+
+    ++dest;
+  }
+
+  batch.Flush();
+}
+
 void
 RasterTileCache::SetSize(UnsignedPoint2D _size,
                          Point2D<uint_least16_t> _tile_size,
@@ -188,6 +294,7 @@ RasterTileCache::SetSize(UnsignedPoint2D _size,
      same */
   overview.Resize({RasterTraits::ToOverviewCeil(size.x), RasterTraits::ToOverviewCeil(size.y)});
   overview_size_fine = size << RasterTraits::SUBPIXEL_BITS;
+  max_pyramid.Resize(overview.GetSize());
 
   tiles.GrowDiscard(_n_tiles.x, _n_tiles.y);
 }
@@ -215,9 +322,12 @@ RasterTileCache::Reset() noexcept
   segments.clear();
 
   overview.Reset();
+  max_pyramid.Reset();
 
   for (auto &i : tiles)
     i.Unload();
+
+  tile_store = {};
 }
 
 const RasterTileCache::MarkerSegmentInfo *
@@ -336,4 +446,72 @@ RasterTileCache::LoadCache(BufferedReader &r)
         overview.GetData(),
         overview_size,
       }));
+
+  max_pyramid.PutOverview(overview, {0, 0}, overview.GetSize());
+}
+
+uint64_t
+RasterTileCache::GetDecodedSize() const noexcept
+{
+  uint64_t result = 0;
+  for (const auto &tile : tiles)
+    if (tile.IsDefined())
+      result += uint64_t(tile.size.Area()) * sizeof(TerrainHeight);
+  return result;
+}
+
+void
+RasterTileCache::MapTileStore(std::span<const std::byte> data)
+{
+  if (!IsValid())
+    throw std::runtime_error("Terrain invalid");
+
+  constexpr std::size_t header_offset = TileStoreHeader::ALIGNMENT;
+  const std::size_t n = tiles.GetSize();
+  const std::size_t table_end = header_offset + sizeof(TileStoreHeader)
+    + sizeof(uint64_t) * n;
+
+  if (data.size() < table_end)
+    throw std::runtime_error("Terrain tile store too small");
+
+  TileStoreHeader header;
+  memcpy(&header, data.data() + header_offset, sizeof(header));
+
+  if (header.version != TileStoreHeader::VERSION ||
+      header.size != size ||
+      header.tile_size != tile_size ||
+      header.n_tiles != UnsignedPoint2D{tiles.GetWidth(), tiles.GetHeight()})
+    throw std::runtime_error("Malformed terrain tile store header");
+
+  const auto *offsets = (const uint64_t *)(const void *)
+    (data.data() + header_offset + sizeof(header));
+
+  /* verify the whole table before modifying any tile */
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto &tile = tiles.GetLinear(i);
+    if (!tile.IsDefined())
+      continue;
+
+    const uint64_t offset = offsets[i];
+    const uint64_t tile_bytes =
+      uint64_t(tile.size.Area()) * sizeof(TerrainHeight);
+    if (offset < table_end || offset % TileStoreHeader::ALIGNMENT != 0 ||
+        offset + tile_bytes > data.size())
+      throw std::runtime_error("Malformed terrain tile store offset");
+  }
+
+  for (std::size_t i = 0; i < n; ++i) {
+    auto &tile = tiles.GetLinear(i);
+    tile.Unload();
+    if (tile.IsDefined()) {
+      tile.buffer.SetExternal((const TerrainHeight *)(const void *)
+                              (data.data() + offsets[i]),
+                              tile.size);
+      max_pyramid.PutTile(tile.buffer, tile.start);
+    }
+  }
+
+  tile_store = data;
+  dirty = false;
+  ++serial;
 }
@@ -5,6 +5,7 @@
 
 #include "RasterTraits.hpp"
 #include "RasterTile.hpp"
+#include "MaxHeightPyramid.hpp"
 #include "RasterLocation.hpp"
 #include "Geo/GeoBounds.hpp"
 #include "util/StaticArray.hxx"
@@ -13,6 +14,7 @@
 #include <cassert>
 #include <cstdint>
 #include <optional>
+#include <span>
 
 static constexpr unsigned  RASTER_SLOPE_FACT = 12;
 
@@ -86,6 +88,27 @@ protected:
     GeoBounds bounds;
   };
 
+public:
+  /**
+   * The header of a "tile store" file, which contains all tiles in
+   * decoded form, to be memory-mapped by MapTileStore().  It begins
+   * at the first #ALIGNMENT boundary of the file and is followed by
+   * a table of 64 bit file offsets (one per tile, zero for
+   * undefined tiles).  The data of each tile begins at an #ALIGNMENT
+   * boundary, so the kernel can page each tile in and out
+   * independently.
+   */
+  struct TileStoreHeader {
+    static constexpr unsigned VERSION = 1;
+    static constexpr std::size_t ALIGNMENT = 4096;
+
+    unsigned version;
+    UnsignedPoint2D size;
+    Point2D<uint_least16_t> tile_size;
+    UnsignedPoint2D n_tiles;
+  };
+
+protected:
   bool dirty;
 
   /**
@@ -98,6 +121,14 @@ protected:
   Point2D<uint_least16_t> tile_size;
 
   RasterBuffer overview;
+
+  /**
+   * Upper bounds of the terrain heights, which allow
+   * FirstIntersection() and GroundIntersection() to skip blocks
+   * which are entirely below the glide path.
+   */
+  MaxHeightPyramid max_pyramid;
+
   RasterLocation size;
   RasterLocation overview_size_fine;
 
@@ -112,6 +143,13 @@ protected:
    */
   StaticArray<uint16_t, MAX_RTC_TILES> request_tiles;
 
+  /**
+   * The memory-mapped tile store (see MapTileStore()).  If set, all
+   * tiles refer to it permanently, and PollTiles() has nothing to
+   * do.
+   */
+  std::span<const std::byte> tile_store;
+
 public:
   RasterTileCache() noexcept {
     Reset();
@@ -150,6 +188,22 @@ public:
   [[gnu::pure]]
   TerrainHeight GetInterpolatedHeight(RasterLocation p) const noexcept;
 
+  /**
+   * Batch version of GetHeight().  Consecutive locations within the
+   * same tile are cheaper than independent lookups, and the overview
+   * interpolations are calculated with SIMD instructions.
+   *
+   * @param dest an array with the same size as #p
+   */
+  void GetHeights(std::span<const RasterLocation> p,
+                  TerrainHeight *dest) const noexcept;
+
+  /**
+   * Batch version of GetInterpolatedHeight(), see GetHeights().
+   */
+  void GetInterpolatedHeights(std::span<const RasterLocation> p,
+                              TerrainHeight *dest) const noexcept;
+
   /**
    * Scan a straight line and fill the buffer with the specified
    * number of samples along the line.
@@ -185,6 +239,8 @@ public:
                      int height_floor) const noexcept;
 
 private:
+  class TileFinder;
+
   /**
    * Get field (not interpolated) directly, without bringing tiles to front.
    * @param p position/256
@@ -195,6 +251,16 @@ private:
   [[gnu::pure]]
   std::pair<TerrainHeight, bool> GetFieldDirect(RasterLocation p) const noexcept;
 
+  /**
+   * Is the given position covered by a loaded ("fine") tile?  This
+   * is the second value returned by GetFieldDirect(), without
+   * looking up the height.
+   */
+  [[gnu::pure]]
+  bool IsFineDirect(RasterLocation p) const noexcept {
+    return tiles.Get(p.x / tile_size.x, p.y / tile_size.y).IsLoaded();
+  }
+
 public:
   /**
    * Throws on error.
@@ -206,6 +272,32 @@ public:
    */
   void LoadCache(BufferedReader &r);
 
+  /**
+   * Let all tiles refer to a tile store (see #TileStoreHeader)
+   * which was written by SaveTerrainTileStore() for the currently
+   * loaded map.  The data may begin with a prefix (e.g. the header
+   * of class #FileCache) which is smaller than
+   * TileStoreHeader::ALIGNMENT.
+   *
+   * Throws on error.
+   *
+   * @param data the memory-mapped file; the caller is responsible
+   * for keeping it mapped until Reset() is called or this object is
+   * destructed
+   */
+  void MapTileStore(std::span<const std::byte> data);
+
+  bool HasTileStore() const noexcept {
+    return tile_store.data() != nullptr;
+  }
+
+  /**
+   * Calculate the size of all tiles in decoded form, i.e. the
+   * approximate size of the tile store.
+   */
+  [[gnu::pure]]
+  uint64_t GetDecodedSize() const noexcept;
+
   /**
    * Determines if there are still tiles scheduled to be loaded.  Call
    * this after UpdateTiles() to determine if UpdateTiles() should be
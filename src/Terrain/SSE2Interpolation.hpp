@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "util/Compiler.h"
+
+#ifndef __SSE2__
+#error SSE2 required
+#endif
+
+#include <emmintrin.h>
+
+#include <cstdint>
+
+/**
+ * Bilinear height interpolation using SSE2 instructions, see
+ * HeightInterpolationBatch.
+ */
+class SSE2HeightInterpolation {
+  /**
+   * Multiply 32 bit integers, keeping only the lower 32 bits of
+   * each product (SSE2 lacks the SSE4.1 instruction "pmulld").
+   */
+  gcc_always_inline
+  static __m128i MultiplyLow32(__m128i x, __m128i y) noexcept {
+    const __m128i even = _mm_mul_epu32(x, y);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32),
+                                      _mm_srli_epi64(y, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+  }
+
+  /**
+   * Calculate 4 interpolations, given the interleaved corner pairs
+   * and the interleaved horizontal weights.
+   */
+  gcc_always_inline
+  static __m128i Interpolate4(__m128i ab, __m128i cd, __m128i wx,
+                              __m128i ky, __m128i iy) noexcept {
+    /* horizontal pass: a*kx + b*ix; this fits into 32 bits easily */
+    const __m128i top = _mm_madd_epi16(ab, wx);
+    const __m128i bottom = _mm_madd_epi16(cd, wx);
+
+    /* vertical pass: the portable code calculates this with
+       wrapping unsigned arithmetic, and so do we */
+    const __m128i sum = _mm_add_epi32(MultiplyLow32(top, ky),
+                                      MultiplyLow32(bottom, iy));
+
+    /* bits 16..31 are the result; the arithmetic shift allows
+       packing with signed saturation without altering them */
+    return _mm_srai_epi32(sum, 16);
+  }
+
+public:
+  /**
+   * Calculate 8 interpolations.
+   */
+  gcc_always_inline
+  static void Interpolate8(const int16_t *gcc_restrict a,
+                           const int16_t *gcc_restrict b,
+                           const int16_t *gcc_restrict c,
+                           const int16_t *gcc_restrict d,
+                           const int16_t *gcc_restrict ix,
+                           const int16_t *gcc_restrict iy,
+                           int16_t *gcc_restrict result) noexcept {
+    const __m128i av = _mm_loadu_si128((const __m128i *)a);
+    const __m128i bv = _mm_loadu_si128((const __m128i *)b);
+    const __m128i cv = _mm_loadu_si128((const __m128i *)c);
+    const __m128i dv = _mm_loadu_si128((const __m128i *)d);
+    const __m128i ixv = _mm_loadu_si128((const __m128i *)ix);
+    const __m128i iyv = _mm_loadu_si128((const __m128i *)iy);
+
+    const __m128i k256 = _mm_set1_epi16(0x100);
+    const __m128i kxv = _mm_sub_epi16(k256, ixv);
+    const __m128i kyv = _mm_sub_epi16(k256, iyv);
+
+    const __m128i zero = _mm_setzero_si128();
+
+    const __m128i lo =
+      Interpolate4(_mm_unpacklo_epi16(av, bv), _mm_unpacklo_epi16(cv, dv),
+                   _mm_unpacklo_epi16(kxv, ixv),
+                   _mm_unpacklo_epi16(kyv, zero),
+                   _mm_unpacklo_epi16(iyv, zero));
+    const __m128i hi =
+      Interpolate4(_mm_unpackhi_epi16(av, bv), _mm_unpackhi_epi16(cv, dv),
+                   _mm_unpackhi_epi16(kxv, ixv),
+                   _mm_unpackhi_epi16(kyv, zero),
+                   _mm_unpackhi_epi16(iyv, zero));
+
+    _mm_storeu_si128((__m128i *)result, _mm_packs_epi32(lo, hi));
+  }
+};
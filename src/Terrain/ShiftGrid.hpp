@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Move the contents of a two-dimensional array by the specified
+ * number of cells, i.e. cell (x,y) receives the value of cell
+ * (x+dx,y+dy).  Cells which have no source are left unmodified.
+ *
+ * @param get_row a function returning a pointer to the given row
+ */
+template<typename GetRow>
+void
+ShiftGrid(GetRow get_row, unsigned width, unsigned height,
+          int dx, int dy) noexcept
+{
+  using T = std::remove_pointer_t<decltype(get_row(0u))>;
+  static_assert(std::is_trivially_copyable_v<T>);
+
+  assert(unsigned(std::abs(dx)) < width);
+  assert(unsigned(std::abs(dy)) < height);
+
+  const unsigned n = width - std::abs(dx);
+  const unsigned src_x = dx > 0 ? dx : 0;
+  const unsigned dest_x = dx < 0 ? -dx : 0;
+
+  const auto Move = [&](unsigned y) {
+    const unsigned src_y = int(y) + dy;
+    std::memmove(get_row(y) + dest_x, get_row(src_y) + src_x,
+                 n * sizeof(T));
+  };
+
+  if (dy > 0) {
+    for (unsigned y = 0; y + unsigned(dy) < height; ++y)
+      Move(y);
+  } else {
+    for (unsigned y = height; y-- > unsigned(-dy);)
+      Move(y);
+  }
+}
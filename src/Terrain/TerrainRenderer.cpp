@@ -243,6 +243,11 @@ static constexpr ColorRamp terrain_colors[][NUM_COLOR_RAMP_LEVELS] = {
 static_assert(ARRAY_SIZE(terrain_colors) == TerrainRendererSettings::NUM_RAMPS,
               "mismatched size");
 
+static constexpr bool do_water = true;
+static constexpr unsigned height_scale = 4;
+static constexpr int interp_levels = 2;
+static constexpr bool is_terrain = true;
+
 // map scale is approximately 2 points on the grid
 // therefore, want one to one mapping if mapscale is 0.5
 // there are approx 30 pixels in mapscale
@@ -277,6 +282,49 @@ IsLargeSizeDifference(const GeoBounds &a, const GeoBounds &b)
 }
 #endif
 
+#ifndef ENABLE_OPENGL
+
+/**
+ * Divide and round to the nearest integer.
+ */
+static constexpr int
+RoundingDivide(int a, int b) noexcept
+{
+  return a >= 0 ? (a + b / 2) / b : -((-a + b / 2) / b);
+}
+
+std::optional<PixelPoint>
+TerrainRenderer::CalcScroll(const WindowProjection &map_projection,
+                            const Angle sunazimuth) const
+{
+  if (!scroll_settings || *scroll_settings != settings ||
+      terrain_serial != terrain.GetSerial() ||
+      !sunazimuth.CompareRoughly(last_sun_azimuth) ||
+      map_projection.GetScreenSize() != grid_projection.GetScreenSize() ||
+      map_projection.GetScreenOrigin() != grid_projection.GetScreenOrigin() ||
+      map_projection.GetScale() != grid_projection.GetScale() ||
+      map_projection.GetScreenAngle() != grid_projection.GetScreenAngle())
+    return std::nullopt;
+
+  /* the new map location in the old grid */
+  const PixelPoint delta =
+    grid_projection.GeoToScreen(map_projection.GetGeoLocation()) -
+    map_projection.GetScreenOrigin();
+
+  const int q = raster_renderer.GetQuantisation();
+  const PixelPoint shift{RoundingDivide(delta.x, q),
+                         RoundingDivide(delta.y, q)};
+
+  /* scrolling by more than half of the screen is not worth it */
+  if (2 * unsigned(std::abs(shift.x)) >= raster_renderer.GetWidth() ||
+      2 * unsigned(std::abs(shift.y)) >= raster_renderer.GetHeight())
+    return std::nullopt;
+
+  return shift;
+}
+
+#endif
+
 bool
 TerrainRenderer::Generate(const WindowProjection &map_projection,
                           const Angle sunazimuth)
@@ -309,21 +357,19 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
     return true;
 
   compare_projection = CompareProjection(map_projection);
+
+  if (const auto shift = CalcScroll(map_projection, sunazimuth)) {
+    /* the map was only moved: reuse most of the previous image */
+    if (*shift != PixelPoint{0, 0})
+      Scroll(*shift);
+    return true;
+  }
 #endif
 
   terrain_serial = terrain.GetSerial();
 
   last_sun_azimuth = sunazimuth;
 
-  const bool do_water = true;
-  const unsigned height_scale = 4;
-  const int interp_levels = 2;
-  const bool is_terrain = true;
-  const bool do_shading = is_terrain &&
-                          settings.slope_shading != SlopeShading::OFF;
-  const bool do_contour = is_terrain &&
-                          settings.contours != Contours::OFF;
-
   const ColorRamp *const color_ramp = &terrain_colors[settings.ramp][0];
   if (color_ramp != last_color_ramp) {
     raster_renderer.PrepareColorTable(color_ramp, do_water,
@@ -336,9 +382,48 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
     raster_renderer.ScanMap(map, map_projection);
   }
 
+#ifndef ENABLE_OPENGL
+  grid_projection = map_projection;
+  scroll_settings = settings;
+#endif
+
+  GenerateImage();
+  return true;
+}
+
+void
+TerrainRenderer::GenerateImage()
+{
+  const bool do_shading = is_terrain &&
+                          settings.slope_shading != SlopeShading::OFF;
+  const bool do_contour = is_terrain &&
+                          settings.contours != Contours::OFF;
+
   raster_renderer.GenerateImage(do_shading, height_scale,
                                 settings.contrast, settings.brightness,
-                                sunazimuth,
+                                last_sun_azimuth,
                                 do_contour);
-  return true;
 }
+
+#ifndef ENABLE_OPENGL
+
+void
+TerrainRenderer::Scroll(PixelPoint shift)
+{
+  /* move the grid by whole cells, so the new strips fit seamlessly
+     to the old ones */
+  const int q = raster_renderer.GetQuantisation();
+  const PixelPoint origin = grid_projection.GetScreenOrigin();
+  grid_projection.SetGeoLocation(grid_projection.ScreenToGeo(origin + shift * q));
+
+  {
+    RasterTerrain::Lease map(terrain);
+    raster_renderer.ScrollMap(map, grid_projection, shift);
+  }
+
+  /* the sun azimuth of the previous image is used, because only
+     parts of it are regenerated */
+  GenerateImage();
+}
+
+#endif
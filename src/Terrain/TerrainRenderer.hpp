@@ -9,6 +9,9 @@
 
 #ifndef ENABLE_OPENGL
 #include "Projection/CompareProjection.hpp"
+#include "Projection/WindowProjection.hpp"
+
+#include <optional>
 #endif
 
 class Canvas;
@@ -26,6 +29,19 @@ protected:
 
 #ifndef ENABLE_OPENGL
   CompareProjection compare_projection;
+
+  /**
+   * The projection of the cells in the #RasterRenderer.  After
+   * scrolling, this differs from the map projection by less than one
+   * cell.  Only valid if #scroll_settings is set.
+   */
+  WindowProjection grid_projection;
+
+  /**
+   * The settings of the current image.  They must not change when
+   * scrolling it.  If this is empty, the image cannot be scrolled.
+   */
+  std::optional<TerrainRendererSettings> scroll_settings;
 #endif
 
   Angle last_sun_azimuth = Angle::Zero();
@@ -49,6 +65,7 @@ public:
     raster_renderer.Invalidate();
 #else
     compare_projection.Clear();
+    scroll_settings.reset();
 #endif
   }
 
@@ -68,6 +85,32 @@ public:
   bool Generate(const WindowProjection &map_projection,
                 const Angle sunazimuth);
 
+private:
+  /**
+   * Convert the height matrix to the image, using the current
+   * settings and #last_sun_azimuth.
+   */
+  void GenerateImage();
+
+#ifndef ENABLE_OPENGL
+  /**
+   * Check whether the previous image can be scrolled to match the
+   * new map projection, i.e. the map was only moved.
+   *
+   * @return the number of cells to shift (see HeightMatrix::Shift())
+   */
+  [[gnu::pure]]
+  std::optional<PixelPoint> CalcScroll(const WindowProjection &map_projection,
+                                       Angle sunazimuth) const;
+
+  /**
+   * Scroll the previous image by the specified number of cells and
+   * regenerate only the newly exposed parts.
+   */
+  void Scroll(PixelPoint shift);
+#endif
+
+public:
   void Draw(Canvas &canvas, const WindowProjection &projection) const {
     raster_renderer.Draw(canvas, projection);
   }
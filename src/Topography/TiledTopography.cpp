@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Topography/TiledTopography.hpp"
+#include "system/FileMapping.hpp"
+#include "system/Path.hpp"
+#include "shapelib/mapserver.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+#include <string.h>
+
+using namespace TiledTopography;
+
+static constexpr std::size_t
+Align(std::size_t size, std::size_t alignment) noexcept
+{
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * Cast a section of the buffer to an array of #T after verifying its
+ * bounds.  Advances #position to the end of the section.
+ */
+template<typename T>
+static const T *
+GetArray(std::span<const std::byte> data, std::size_t &position,
+         std::size_t n)
+{
+  if (position % alignof(T) != 0 ||
+      position > data.size() ||
+      n > (data.size() - position) / sizeof(T))
+    throw std::runtime_error{"Malformed tiled topography"};
+
+  const T *result = (const T *)(const void *)(data.data() + position);
+  position += n * sizeof(T);
+  return result;
+}
+
+TiledTopography::Grid::Range
+TiledTopography::Grid::GetRange(const GeoBounds &other) const noexcept
+{
+  if (n_x == 1 && n_y == 1)
+    return {0, 0, 0, 0};
+
+  const double west = bounds.GetWest().Native();
+  const double south = bounds.GetSouth().Native();
+  const double tile_width = (bounds.GetEast().Native() - west) / n_x;
+  const double tile_height = (bounds.GetNorth().Native() - south) / n_y;
+
+  /* clamp before converting, because the conversion of a value
+     which is out of range (or NaN) is undefined */
+  const auto Clip = [](double value, unsigned n){
+    if (!(value > 0))
+      return 0u;
+
+    if (value >= n - 1)
+      return n - 1;
+
+    return unsigned(value);
+  };
+
+  return {
+    Clip((other.GetWest().Native() - west) / tile_width, n_x),
+    Clip((other.GetSouth().Native() - south) / tile_height, n_y),
+    Clip((other.GetEast().Native() - west) / tile_width, n_x),
+    Clip((other.GetNorth().Native() - south) / tile_height, n_y),
+  };
+}
+
+static constexpr GeoBounds
+ToGeoBounds(double west, double south, double east, double north) noexcept
+{
+  return {
+    GeoPoint{Angle::Native(west), Angle::Native(north)},
+    GeoPoint{Angle::Native(east), Angle::Native(south)},
+  };
+}
+
+TiledTopographyLayer::TiledTopographyLayer(std::span<const std::byte> _data)
+  :data(_data)
+{
+  std::size_t position = 0;
+  header = GetArray<LayerHeader>(data, position, 1);
+
+  const std::size_t n_shapes = header->n_shapes;
+  const std::size_t n_tiles = std::size_t(header->n_tiles_x) *
+    header->n_tiles_y;
+  if (n_tiles == 0)
+    throw std::runtime_error{"Malformed tiled topography layer"};
+
+  grid.bounds = ToGeoBounds(header->west, header->south,
+                            header->east, header->north);
+  grid.n_x = header->n_tiles_x;
+  grid.n_y = header->n_tiles_y;
+  if (!grid.bounds.Check() ||
+      (grid.n_x > 1 && grid.bounds.GetWest() >= grid.bounds.GetEast()) ||
+      (grid.n_y > 1 && grid.bounds.GetNorth() <= grid.bounds.GetSouth()))
+    throw std::runtime_error{"Malformed tiled topography bounds"};
+
+  shape_bounds = GetArray<ShapeBounds>(data, position, n_shapes);
+  shape_offsets = GetArray<uint64_t>(data, position, n_shapes);
+  tile_start = GetArray<uint32_t>(data, position, n_tiles + 1);
+
+  const std::size_t n_tile_shapes = tile_start[n_tiles];
+  tile_shapes = GetArray<uint32_t>(data, position, n_tile_shapes);
+
+  /* verify the tables now, so VisitShapes() doesn't need to */
+  for (std::size_t i = 0; i < n_tiles; ++i)
+    if (tile_start[i] > tile_start[i + 1])
+      throw std::runtime_error{"Malformed tiled topography tile table"};
+
+  if (std::any_of(tile_shapes, tile_shapes + n_tile_shapes,
+                  [n_shapes](uint32_t i){ return i >= n_shapes; }))
+    throw std::runtime_error{"Malformed tiled topography tile table"};
+
+  if (std::any_of(shape_offsets, shape_offsets + n_shapes,
+                  [this](uint64_t offset){
+                    return offset % 8 != 0 || offset >= data.size();
+                  }))
+    throw std::runtime_error{"Malformed tiled topography shape table"};
+}
+
+GeoBounds
+TiledTopographyLayer::GetShapeBounds(std::size_t i) const noexcept
+{
+  const auto &b = shape_bounds[i];
+  return ToGeoBounds(b.west, b.south, b.east, b.north);
+}
+
+/**
+ * Verify the indices of one thinning level (see
+ * XShape::BuildIndices()).
+ */
+static bool
+CheckIndices(const TiledTopographyShape &shape,
+             std::span<const uint16_t> indices) noexcept
+{
+  if (indices.empty())
+    return true;
+
+  const std::size_t n_counts = shape.type == MS_SHAPE_LINE
+    ? shape.lines.size()
+    : 1;
+  if (indices.size() < n_counts)
+    return false;
+
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < n_counts; ++i)
+    total += indices[i];
+
+  if (total != indices.size() - n_counts)
+    return false;
+
+  return std::all_of(indices.begin() + n_counts, indices.end(),
+                     [n = shape.points.size()](uint16_t i){
+                       return i < n;
+                     });
+}
+
+TiledTopographyShape
+TiledTopographyLayer::GetShape(std::size_t i) const
+{
+  assert(i < size());
+
+  std::size_t position = shape_offsets[i];
+  const auto &h = *GetArray<ShapeHeader>(data, position, 1);
+
+  TiledTopographyShape shape;
+  shape.bounds = GetShapeBounds(i);
+  shape.type = h.type;
+  shape.lines = {GetArray<uint16_t>(data, position, h.num_lines),
+                 h.num_lines};
+
+  position = Align(position, 4);
+  shape.points = {GetArray<ShapePoint>(data, position, h.num_points),
+                  h.num_points};
+
+  std::size_t num_points = 0;
+  for (const auto n : shape.lines)
+    num_points += n;
+
+  if (num_points != h.num_points || h.num_lines > 32 ||
+      (h.type != MS_SHAPE_POINT && h.type != MS_SHAPE_LINE &&
+       h.type != MS_SHAPE_POLYGON))
+    throw std::runtime_error{"Malformed tiled topography shape"};
+
+  for (std::size_t level = 0; level < THINNING_LEVELS; ++level) {
+    shape.indices[level] = {
+      GetArray<uint16_t>(data, position, h.index_size[level]),
+      h.index_size[level],
+    };
+
+    if (!CheckIndices(shape, shape.indices[level]))
+      throw std::runtime_error{"Malformed tiled topography indices"};
+  }
+
+  if (h.label_size > 0) {
+    const char *label = GetArray<char>(data, position, h.label_size);
+    if (label[h.label_size - 1] != 0)
+      throw std::runtime_error{"Malformed tiled topography label"};
+
+    shape.label = label;
+  } else
+    shape.label = nullptr;
+
+  return shape;
+}
+
+TiledTopographyFile::TiledTopographyFile(Path path)
+  :mapping(std::make_unique<FileMapping>(path))
+{
+  Open(*mapping);
+}
+
+TiledTopographyFile::TiledTopographyFile(std::span<const std::byte> data)
+{
+  Open(data);
+}
+
+TiledTopographyFile::~TiledTopographyFile() noexcept = default;
+
+void
+TiledTopographyFile::Open(std::span<const std::byte> data)
+{
+  std::size_t position = 0;
+  const auto &header = *GetArray<FileHeader>(data, position, 1);
+  if (header.magic != MAGIC)
+    throw std::runtime_error{"Not a tiled topography file"};
+
+  if (header.version != VERSION)
+    throw std::runtime_error{"Unsupported tiled topography version"};
+
+  const auto *entries = GetArray<LayerEntry>(data, position,
+                                             header.n_layers);
+
+  layers.reserve(header.n_layers);
+  for (const auto &entry : std::span{entries, header.n_layers}) {
+    const std::size_t name_length = strnlen(entry.name, MAX_NAME);
+    if (name_length == MAX_NAME || entry.offset % 8 != 0 ||
+        entry.offset > data.size() ||
+        entry.size > data.size() - entry.offset)
+      throw std::runtime_error{"Malformed tiled topography layer table"};
+
+    layers.push_back({
+        {entry.name, name_length},
+        entry.source_size,
+        TiledTopographyLayer{data.subspan(entry.offset, entry.size)},
+      });
+  }
+}
+
+const TiledTopographyLayer *
+TiledTopographyFile::FindLayer(std::string_view name,
+                               uint64_t source_size) const noexcept
+{
+  for (const auto &i : layers)
+    if (i.name == name)
+      return i.source_size == source_size ? &i.layer : nullptr;
+
+  return nullptr;
+}
@@ -0,0 +1,293 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Geo/GeoBounds.hpp"
+#include "Topography/XShapePoint.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+class Path;
+class FileMapping;
+
+/**
+ * A topography file format which can be memory-mapped (see
+ * #TiledTopographyFile), generated offline from the shapefiles of a
+ * map file by #TiledTopographyWriter.
+ *
+ * Each layer (i.e. each shapefile listed in "topology.tpl") contains
+ * a grid of tiles referring to the shapes overlapping them, so
+ * TopographyFile::Update() does not need to query the shapefile's
+ * quadtree.  The shape records contain the points already converted
+ * to #ShapePoint (relative to the layer center) and, if the converter
+ * was built with OpenGL, the thinned line indices and triangle strips
+ * of all thinning levels.
+ *
+ * The file is written in host byte order; all sections are aligned
+ * to 8 bytes.
+ */
+namespace TiledTopography {
+
+static constexpr uint32_t MAGIC = 0x31545458; // "XTT1"
+static constexpr uint32_t VERSION = 1;
+
+static constexpr std::size_t THINNING_LEVELS = 4;
+
+static constexpr std::size_t MAX_NAME = 64;
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t n_layers;
+  uint32_t reserved;
+};
+
+/**
+ * The file header is followed by one of these per layer.
+ */
+struct LayerEntry {
+  /**
+   * The shapefile name without the ".shp" suffix, null-terminated.
+   */
+  char name[MAX_NAME];
+
+  /**
+   * The size of the ".shp" file this layer was converted from.  If
+   * it differs, the layer is outdated and will be ignored.
+   */
+  uint64_t source_size;
+
+  /**
+   * The position and size of the layer in the file.
+   */
+  uint64_t offset, size;
+};
+
+/**
+ * The beginning of each layer.  It is followed by:
+ *
+ * - #ShapeBounds[n_shapes]
+ * - uint64_t[n_shapes]: the offset of each #ShapeHeader relative to
+ *   the layer
+ * - uint32_t[n_tiles_x * n_tiles_y + 1]: the index of each tile's
+ *   first shape number in the following array
+ * - uint32_t[]: shape numbers, grouped by tile (row by row)
+ * - the shape records
+ */
+struct LayerHeader {
+  /**
+   * The bounds of the tile grid (native angles).
+   */
+  double west, south, east, north;
+
+  /**
+   * The reference point of all #ShapePoint coordinates (native
+   * angles).
+   */
+  double center_longitude, center_latitude;
+
+  uint32_t n_shapes;
+  uint16_t n_tiles_x, n_tiles_y;
+
+  /**
+   * The value of TopographyFile::GetMinimumPointDistance() the
+   * indices of each thinning level were built with.  Zero means the
+   * converter did not generate indices.
+   */
+  uint32_t min_distance[THINNING_LEVELS];
+};
+
+struct ShapeBounds {
+  double west, south, east, north;
+};
+
+/**
+ * The beginning of each shape record.  It is followed by:
+ *
+ * - uint16_t[num_lines]: the number of points of each line
+ * - padding to 4 bytes
+ * - #ShapePoint[num_points]
+ * - uint16_t[index_size[i]] for each thinning level, the same layout
+ *   as built by XShape::BuildIndices()
+ * - char[label_size]: the null-terminated UTF-8 label
+ * - padding to 8 bytes
+ */
+struct ShapeHeader {
+  uint8_t type;
+  uint8_t num_lines;
+  uint16_t label_size;
+  uint32_t num_points;
+  uint32_t index_size[THINNING_LEVELS];
+};
+
+/**
+ * Determines which tiles of a layer overlap the given bounds.
+ */
+struct Grid {
+  GeoBounds bounds;
+  unsigned n_x, n_y;
+
+  struct Range {
+    unsigned x0, y0, x1, y1;
+  };
+
+  /**
+   * @return the (inclusive) range of tiles overlapping #other; only
+   * valid if #other overlaps #bounds
+   */
+  [[gnu::pure]]
+  Range GetRange(const GeoBounds &other) const noexcept;
+};
+
+} // namespace TiledTopography
+
+/**
+ * A shape record inside a #TiledTopographyFile.  It refers to the
+ * mapped memory.
+ */
+struct TiledTopographyShape {
+  GeoBounds bounds;
+
+  uint8_t type;
+
+  std::span<const uint16_t> lines;
+
+  std::span<const ShapePoint> points;
+
+  /**
+   * The indices of each thinning level; empty if they were not
+   * generated.
+   */
+  std::array<std::span<const uint16_t>,
+             TiledTopography::THINNING_LEVELS> indices;
+
+  /**
+   * The null-terminated UTF-8 label or nullptr.
+   */
+  const char *label;
+};
+
+/**
+ * A layer inside a #TiledTopographyFile.
+ */
+class TiledTopographyLayer {
+  std::span<const std::byte> data;
+
+  const TiledTopography::LayerHeader *header;
+  const TiledTopography::ShapeBounds *shape_bounds;
+  const uint64_t *shape_offsets;
+  const uint32_t *tile_start, *tile_shapes;
+
+  TiledTopography::Grid grid;
+
+public:
+  /**
+   * Throws on error.
+   */
+  explicit TiledTopographyLayer(std::span<const std::byte> _data);
+
+  std::size_t size() const noexcept {
+    return header->n_shapes;
+  }
+
+  const GeoBounds &GetBounds() const noexcept {
+    return grid.bounds;
+  }
+
+  GeoPoint GetCenter() const noexcept {
+    return {
+      Angle::Native(header->center_longitude),
+      Angle::Native(header->center_latitude),
+    };
+  }
+
+  [[gnu::pure]]
+  GeoBounds GetShapeBounds(std::size_t i) const noexcept;
+
+  unsigned GetMinimumPointDistance(unsigned level) const noexcept {
+    return header->min_distance[level];
+  }
+
+  /**
+   * Invoke #f with the number of each shape whose bounds overlap the
+   * given bounds.  Shapes which span several tiles may be visited
+   * more than once.
+   */
+  template<typename F>
+  void VisitShapes(const GeoBounds &bounds, F &&f) const {
+    if (!grid.bounds.Overlaps(bounds))
+      return;
+
+    const auto range = grid.GetRange(bounds);
+    for (unsigned y = range.y0; y <= range.y1; ++y) {
+      for (unsigned x = range.x0; x <= range.x1; ++x) {
+        const unsigned tile = y * grid.n_x + x;
+        for (uint32_t j = tile_start[tile]; j < tile_start[tile + 1]; ++j) {
+          const uint32_t i = tile_shapes[j];
+          if (GetShapeBounds(i).Overlaps(bounds))
+            f(i);
+        }
+      }
+    }
+  }
+
+  /**
+   * Throws on error.
+   */
+  TiledTopographyShape GetShape(std::size_t i) const;
+};
+
+/**
+ * A memory-mapped file in the #TiledTopography format.
+ */
+class TiledTopographyFile {
+  std::unique_ptr<FileMapping> mapping;
+
+  struct Layer {
+    std::string_view name;
+    uint64_t source_size;
+    TiledTopographyLayer layer;
+  };
+
+  std::vector<Layer> layers;
+
+public:
+  /**
+   * Map the given file.
+   *
+   * Throws on error.
+   */
+  explicit TiledTopographyFile(Path path);
+
+  /**
+   * Use a buffer which is owned by the caller.
+   *
+   * Throws on error.
+   */
+  explicit TiledTopographyFile(std::span<const std::byte> data);
+
+  ~TiledTopographyFile() noexcept;
+
+  TiledTopographyFile(const TiledTopographyFile &) = delete;
+  TiledTopographyFile &operator=(const TiledTopographyFile &) = delete;
+
+  /**
+   * Look up a layer by its shapefile name (without suffix).
+   *
+   * @param source_size the size of the ".shp" file; if it does not
+   * match the converted one, nullptr is returned
+   */
+  [[gnu::pure]]
+  const TiledTopographyLayer *FindLayer(std::string_view name,
+                                        uint64_t source_size) const noexcept;
+
+private:
+  void Open(std::span<const std::byte> data);
+};
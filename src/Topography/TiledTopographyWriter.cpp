@@ -0,0 +1,268 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Topography/TiledTopographyWriter.hpp"
+#include "Topography/TiledTopography.hpp"
+#include "Topography/TopographyFile.hpp"
+#include "Topography/XShape.hpp"
+#include "io/OutputStream.hxx"
+#include "util/ConvertString.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <string.h>
+
+using namespace TiledTopography;
+
+/**
+ * The average number of shapes per tile the grid is sized for.
+ */
+static constexpr std::size_t SHAPES_PER_TILE = 16;
+
+static constexpr unsigned MAX_TILES_PER_AXIS = 256;
+
+template<typename T>
+static void
+Append(std::vector<std::byte> &dest, const T *src, std::size_t n) noexcept
+{
+  const auto *p = (const std::byte *)src;
+  dest.insert(dest.end(), p, p + n * sizeof(T));
+}
+
+template<typename T>
+static void
+Append(std::vector<std::byte> &dest, const T &src) noexcept
+{
+  Append(dest, &src, 1);
+}
+
+static void
+Pad(std::vector<std::byte> &dest, std::size_t alignment) noexcept
+{
+  dest.resize((dest.size() + alignment - 1) & ~(alignment - 1));
+}
+
+static ShapeBounds
+ToShapeBounds(const GeoBounds &b) noexcept
+{
+  return {
+    b.GetWest().Native(), b.GetSouth().Native(),
+    b.GetEast().Native(), b.GetNorth().Native(),
+  };
+}
+
+/**
+ * Choose a grid with approximately square tiles.
+ */
+static Grid
+MakeGrid(const GeoBounds &bounds, std::size_t n_shapes) noexcept
+{
+  const double width = bounds.GetEast().Native() - bounds.GetWest().Native();
+  const double height = bounds.GetNorth().Native() - bounds.GetSouth().Native();
+  if (width <= 0 || height <= 0)
+    /* crosses the 180th meridian, or a single point */
+    return {bounds, 1, 1};
+
+  const double n_tiles = std::max<double>(n_shapes / SHAPES_PER_TILE, 1);
+  const double tile_size = std::sqrt(width * height / n_tiles);
+
+  const auto Clip = [](double n){
+    return std::clamp(unsigned(std::ceil(n)), 1u, MAX_TILES_PER_AXIS);
+  };
+
+  return {bounds, Clip(width / tile_size), Clip(height / tile_size)};
+}
+
+static void
+AppendShape(std::vector<std::byte> &dest, const XShape &shape,
+            [[maybe_unused]] const TopographyFile &file)
+{
+  const auto lines = shape.GetLines();
+
+  std::size_t num_points = 0;
+  for (const auto n : lines)
+    num_points += n;
+
+  ShapeHeader header{};
+  header.type = shape.get_type();
+  header.num_lines = lines.size();
+  header.num_points = num_points;
+
+#ifdef ENABLE_OPENGL
+  std::array<std::span<const uint16_t>, THINNING_LEVELS> indices;
+  if (header.type != MS_SHAPE_POINT) {
+    for (unsigned level = 0; level < THINNING_LEVELS; ++level) {
+      const auto i = shape.GetIndices(level,
+                                      file.GetMinimumPointDistance(level));
+      if (i.indices == nullptr)
+        continue;
+
+      /* see XShape::BuildIndices() for the layout */
+      const std::size_t n_counts = header.type == MS_SHAPE_LINE
+        ? lines.size()
+        : 1;
+      std::size_t size = n_counts;
+      for (std::size_t j = 0; j < n_counts; ++j)
+        size += i.count[j];
+
+      indices[level] = {i.count, size};
+      header.index_size[level] = size;
+    }
+  }
+#endif
+
+  std::string utf8_label;
+  if (const TCHAR *label = shape.GetLabel(); label != nullptr) {
+    const WideToUTF8Converter utf8{label};
+    if (utf8.IsValid())
+      utf8_label = utf8.c_str();
+  }
+
+  if (!utf8_label.empty()) {
+    if (utf8_label.size() >= 0xffff)
+      throw std::runtime_error{"Label too long"};
+
+    header.label_size = utf8_label.size() + 1;
+  }
+
+  Append(dest, header);
+  Append(dest, lines.data(), lines.size());
+  Pad(dest, 4);
+
+#ifdef ENABLE_OPENGL
+  Append(dest, shape.GetPoints(), num_points);
+
+  for (const auto &i : indices)
+    Append(dest, i.data(), i.size());
+#else
+  const GeoPoint center = file.GetCenter();
+  for (const GeoPoint &p : std::span{shape.GetPoints(), num_points})
+    Append(dest, ShapePoint{
+        ShapeScalar((p.longitude - center.longitude).Native()),
+        ShapeScalar((p.latitude - center.latitude).Native()),
+      });
+#endif
+
+  if (header.label_size > 0)
+    Append(dest, utf8_label.c_str(), header.label_size);
+
+  Pad(dest, 8);
+}
+
+void
+TiledTopographyWriter::AddLayer(std::string_view name, uint64_t source_size,
+                                const TopographyFile &file)
+{
+  if (name.size() >= MAX_NAME)
+    throw std::runtime_error{"Shapefile name too long"};
+
+  /* unsupported shape types were imported as empty shapes; they are
+     not worth a record */
+  std::vector<const XShape *> shapes;
+  for (const XShape &shape : file)
+    if (!shape.GetLines().empty())
+      shapes.push_back(&shape);
+
+  if (shapes.empty())
+    throw std::runtime_error{"Empty topography layer"};
+
+  GeoBounds bounds = shapes.front()->get_bounds();
+  for (const XShape *shape : shapes) {
+    bounds.Extend(shape->get_bounds().GetNorthWest());
+    bounds.Extend(shape->get_bounds().GetSouthEast());
+  }
+
+  const Grid grid = MakeGrid(bounds, shapes.size());
+
+  std::vector<std::vector<uint32_t>> tiles(grid.n_x * grid.n_y);
+  for (uint32_t i = 0; i < shapes.size(); ++i) {
+    const auto range = grid.GetRange(shapes[i]->get_bounds());
+    for (unsigned y = range.y0; y <= range.y1; ++y)
+      for (unsigned x = range.x0; x <= range.x1; ++x)
+        tiles[y * grid.n_x + x].push_back(i);
+  }
+
+  LayerHeader header{};
+  header.west = bounds.GetWest().Native();
+  header.south = bounds.GetSouth().Native();
+  header.east = bounds.GetEast().Native();
+  header.north = bounds.GetNorth().Native();
+  header.center_longitude = file.GetCenter().longitude.Native();
+  header.center_latitude = file.GetCenter().latitude.Native();
+  header.n_shapes = shapes.size();
+  header.n_tiles_x = grid.n_x;
+  header.n_tiles_y = grid.n_y;
+#ifdef ENABLE_OPENGL
+  for (unsigned level = 0; level < THINNING_LEVELS; ++level)
+    header.min_distance[level] = file.GetMinimumPointDistance(level);
+#endif
+
+  std::vector<std::byte> data;
+  Append(data, header);
+
+  for (const XShape *shape : shapes)
+    Append(data, ToShapeBounds(shape->get_bounds()));
+
+  /* reserve the offset table, it will be filled below */
+  const std::size_t offsets_position = data.size();
+  data.resize(data.size() + shapes.size() * sizeof(uint64_t));
+
+  uint32_t tile_start = 0;
+  for (const auto &tile : tiles) {
+    Append(data, tile_start);
+    tile_start += tile.size();
+  }
+  Append(data, tile_start);
+
+  for (const auto &tile : tiles)
+    Append(data, tile.data(), tile.size());
+
+  Pad(data, 8);
+
+  std::vector<uint64_t> offsets;
+  offsets.reserve(shapes.size());
+  for (const XShape *shape : shapes) {
+    offsets.push_back(data.size());
+    AppendShape(data, *shape, file);
+  }
+
+  memcpy(data.data() + offsets_position, offsets.data(),
+         offsets.size() * sizeof(offsets.front()));
+
+  layers.push_back({std::string{name}, source_size, std::move(data)});
+}
+
+void
+TiledTopographyWriter::Write(OutputStream &os) const
+{
+  FileHeader header{};
+  header.magic = MAGIC;
+  header.version = VERSION;
+  header.n_layers = layers.size();
+  os.Write(&header, sizeof(header));
+
+  uint64_t offset = sizeof(header) + layers.size() * sizeof(LayerEntry);
+  for (const auto &layer : layers) {
+    offset = (offset + 7) & ~uint64_t(7);
+
+    LayerEntry entry{};
+    std::copy(layer.name.begin(), layer.name.end(), entry.name);
+    entry.source_size = layer.source_size;
+    entry.offset = offset;
+    entry.size = layer.data.size();
+    os.Write(&entry, sizeof(entry));
+
+    offset += layer.data.size();
+  }
+
+  uint64_t position = sizeof(header) + layers.size() * sizeof(LayerEntry);
+  for (const auto &layer : layers) {
+    static constexpr std::byte zero[8]{};
+    const uint64_t padding = (8 - position % 8) % 8;
+    os.Write(zero, padding);
+    os.Write(layer.data.data(), layer.data.size());
+    position += padding + layer.data.size();
+  }
+}
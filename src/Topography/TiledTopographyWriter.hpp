@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class TopographyFile;
+class OutputStream;
+
+/**
+ * Converts topography layers to the #TiledTopography format.
+ */
+class TiledTopographyWriter {
+  struct Layer {
+    std::string name;
+    uint64_t source_size;
+    std::vector<std::byte> data;
+  };
+
+  std::vector<Layer> layers;
+
+public:
+  /**
+   * Convert the shapes of a #TopographyFile.  All shapes must have
+   * been loaded with TopographyFile::LoadAll().
+   *
+   * Throws on error.
+   *
+   * @param name the shapefile name without the ".shp" suffix
+   * @param source_size the size of the ".shp" file
+   */
+  void AddLayer(std::string_view name, uint64_t source_size,
+                const TopographyFile &file);
+
+  /**
+   * Throws on error.
+   */
+  void Write(OutputStream &os) const;
+};
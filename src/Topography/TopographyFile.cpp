@@ -3,6 +3,7 @@
 
 #include "Topography/TopographyFile.hpp"
 #include "Topography/XShape.hpp"
+#include "Topography/TiledTopography.hpp"
 #include "Convert.hpp"
 #include "Projection/WindowProjection.hpp"
 #include "util/ScopeExit.hxx"
@@ -21,14 +22,14 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
                                ResourceId _icon, ResourceId _big_icon,
                                unsigned _pen_width)
   :dir(_dir),
-   file(dir, filename),
+   file(std::in_place, dir, filename),
    label_field(_label_field), icon(_icon), big_icon(_big_icon),
    pen_width(_pen_width),
    color(_color), scale_threshold(_threshold),
    label_threshold(_label_threshold),
    important_label_threshold(_important_label_threshold)
 {
-  const std::size_t n_shapes = file.size();
+  const std::size_t n_shapes = file->size();
   constexpr std::size_t MAX_SHAPES = 16 * 1024 * 1024;
   if (n_shapes == 0)
     throw std::runtime_error{"Empty shapefile"};
@@ -36,7 +37,7 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
   if (n_shapes > MAX_SHAPES)
     throw std::runtime_error{"Too many shapes in shapefile"};
 
-  const auto file_bounds = ImportRect(file.GetBounds());
+  const auto file_bounds = ImportRect(file->GetBounds());
   if (!file_bounds.Check())
     throw std::runtime_error{"Malformed shapefile bounds"};
 
@@ -50,6 +51,29 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
   ++serial;
 }
 
+TopographyFile::TopographyFile(const TiledTopographyLayer &_tiled,
+                               double _threshold,
+                               double _label_threshold,
+                               double _important_label_threshold,
+                               const BGRA8Color _color,
+                               ResourceId _icon, ResourceId _big_icon,
+                               unsigned _pen_width)
+  :dir(nullptr), tiled(&_tiled),
+   center(tiled->GetCenter()),
+   label_field(-1), icon(_icon), big_icon(_big_icon),
+   pen_width(_pen_width),
+   color(_color), scale_threshold(_threshold),
+   label_threshold(_label_threshold),
+   important_label_threshold(_important_label_threshold)
+{
+  if (tiled->size() == 0)
+    throw std::runtime_error{"Empty topography layer"};
+
+  shapes.ResizeDiscard(tiled->size());
+
+  ++serial;
+}
+
 TopographyFile::~TopographyFile() noexcept
 {
   if (dir != nullptr) {
@@ -67,59 +91,45 @@ TopographyFile::ClearCache() noexcept
   list.clear();
 }
 
-static std::unique_ptr<XShape>
-LoadShape(ShapeFile &file, GeoPoint &center, std::size_t i, int label_field)
+std::unique_ptr<XShape>
+TopographyFile::LoadShape(std::size_t i)
 {
+  if (tiled != nullptr) {
+    auto shape = tiled->GetShape(i);
+
+#ifdef ENABLE_OPENGL
+    /* indices which were built for different thresholds are
+       useless; XShape::GetIndices() will build new ones */
+    for (unsigned level = 0; level < shape.indices.size(); ++level)
+      if (tiled->GetMinimumPointDistance(level) !=
+          GetMinimumPointDistance(level))
+        shape.indices[level] = {};
+#endif
+
+    return std::make_unique<XShape>(shape, center);
+  }
+
   shapeObj shape;
   msInitShape(&shape);
   AtScopeExit(&shape) { msFreeShape(&shape); };
-  file.ReadShape(shape, i);
+  file->ReadShape(shape, i);
 
   const char *label = label_field >= 0
-    ? file.ReadLabel(i, label_field)
+    ? file->ReadLabel(i, label_field)
     : nullptr;
 
   return std::make_unique<XShape>(shape, center, label);
 }
 
-bool
-TopographyFile::Update(const WindowProjection &map_projection)
+template<typename P>
+inline void
+TopographyFile::UpdateCache(P &&is_inside)
 {
-  if (map_projection.GetMapScale() > scale_threshold)
-    /* not visible, don't update cache now */
-    return false;
-
-  const GeoBounds screenRect =
-    map_projection.GetScreenBounds();
-  if (cache_bounds.IsValid() && cache_bounds.IsInside(screenRect))
-    /* the cache is still fresh */
-    return false;
-
-  cache_bounds = screenRect.Scale(2);
-
-  // Test which shapes are inside the given bounds and save the
-  // status to file.status
-  switch (file.WhichShapes(dir, ConvertRect(cache_bounds))) {
-  case MS_FAILURE:
-    ClearCache();
-    throw std::runtime_error{"Failed to update shapefile"};
-
-  case MS_DONE:
-    /* screen is outside of map bounds */
-    return false;
-
-  case MS_SUCCESS:
-    break;
-  }
-
-  const auto status = file.GetStatus();
-  assert(status != nullptr);
-
   // Iterate through the shapefile entries
   auto prev = list.before_begin();
   auto it = shapes.begin();
-  for (std::size_t i = 0; i < file.size(); ++i, ++it) {
-    if (!msGetBit(status, i)) {
+  for (std::size_t i = 0; i < shapes.size(); ++i, ++it) {
+    if (!is_inside(i)) {
       // If the shape is outside the bounds
       // delete the shape from the cache
       if (it->shape != nullptr) {
@@ -142,7 +152,7 @@ TopographyFile::Update(const WindowProjection &map_projection)
         assert(&*std::next(prev) != &*it);
 
         // shape isn't cached yet -> cache the shape
-        it->shape = LoadShape(file, center, i, label_field);
+        it->shape = LoadShape(i);
 
         /* insert into linked list (protected) */
         {
@@ -158,6 +168,64 @@ TopographyFile::Update(const WindowProjection &map_projection)
   }
 
   assert(std::next(prev) == list.end());
+}
+
+bool
+TopographyFile::Update(const WindowProjection &map_projection)
+{
+  if (map_projection.GetMapScale() > scale_threshold)
+    /* not visible, don't update cache now */
+    return false;
+
+  const GeoBounds screenRect =
+    map_projection.GetScreenBounds();
+  if (cache_bounds.IsValid() && cache_bounds.IsInside(screenRect))
+    /* the cache is still fresh */
+    return false;
+
+  cache_bounds = screenRect.Scale(2);
+
+  if (tiled != nullptr) {
+    if (!tiled->GetBounds().Overlaps(cache_bounds))
+      /* screen is outside of map bounds */
+      return false;
+
+    /* the tile grid replaces the shapefile's quadtree */
+    for (auto &i : shapes)
+      i.selected = false;
+
+    tiled->VisitShapes(cache_bounds, [this](std::size_t i){
+      shapes[i].selected = true;
+    });
+
+    UpdateCache([this](std::size_t i){
+      return shapes[i].selected;
+    });
+
+    return true;
+  }
+
+  // Test which shapes are inside the given bounds and save the
+  // status to file.status
+  switch (file->WhichShapes(dir, ConvertRect(cache_bounds))) {
+  case MS_FAILURE:
+    ClearCache();
+    throw std::runtime_error{"Failed to update shapefile"};
+
+  case MS_DONE:
+    /* screen is outside of map bounds */
+    return false;
+
+  case MS_SUCCESS:
+    break;
+  }
+
+  const auto status = file->GetStatus();
+  assert(status != nullptr);
+
+  UpdateCache([status](std::size_t i){
+    return msGetBit(status, i);
+  });
 
   return true;
 }
@@ -168,11 +236,11 @@ TopographyFile::LoadAll()
   // Iterate through the shapefile entries
   auto prev = list.before_begin();
   auto it = shapes.begin();
-  for (std::size_t i = 0; i < file.size(); ++i, ++it) {
+  for (std::size_t i = 0; i < shapes.size(); ++i, ++it) {
     if (it->shape == nullptr) {
       assert(&*std::next(prev) != &*it);
       // shape isn't cached yet -> cache the shape
-      it->shape = LoadShape(file, center, i, label_field);
+      it->shape = LoadShape(i);
       // update list pointer
       prev = list.insert_after(prev, *it);
     } else {
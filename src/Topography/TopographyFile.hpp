@@ -18,14 +18,22 @@
 
 #include <cassert>
 #include <memory>
+#include <optional>
 
 class WindowProjection;
 class XShape;
+class TiledTopographyLayer;
 struct zzip_dir;
 
 class TopographyFile {
   struct ShapeEnvelope final : IntrusiveForwardListHook {
     std::unique_ptr<const XShape> shape;
+
+    /**
+     * Used by Update() to mark the shapes of a #TiledTopographyLayer
+     * inside the cache bounds.
+     */
+    bool selected;
   };
 
   /**
@@ -35,7 +43,13 @@ class TopographyFile {
 
   zzip_dir *const dir;
 
-  ShapeFile file;
+  /**
+   * The shapefile; unset if this object was constructed from a
+   * #TiledTopographyLayer.
+   */
+  std::optional<ShapeFile> file;
+
+  const TiledTopographyLayer *const tiled = nullptr;
 
   /**
    * The center of shapefileObj::bounds.
@@ -143,6 +157,22 @@ public:
                  ResourceId big_icon=ResourceId::Null(),
                  unsigned pen_width=1);
 
+  /**
+   * Load the shapes from a #TiledTopographyLayer instead of a
+   * shapefile.  The layer must remain valid as long as this object
+   * exists.  The parameters are the same as above, except that the
+   * labels were imported already by the converter.
+   *
+   * Throws on error.
+   */
+  TopographyFile(const TiledTopographyLayer &tiled,
+                 double threshold, double label_threshold,
+                 double important_label_threshold,
+                 const BGRA8Color color,
+                 ResourceId icon=ResourceId::Null(),
+                 ResourceId big_icon=ResourceId::Null(),
+                 unsigned pen_width=1);
+
   TopographyFile(const TopographyFile &) = delete;
 
   /**
@@ -158,6 +188,10 @@ public:
     return center;
   }
 
+  bool IsTiled() const noexcept {
+    return tiled != nullptr;
+  }
+
   bool IsVisible(double map_scale) const noexcept {
     return map_scale <= scale_threshold;
   }
@@ -255,4 +289,19 @@ public:
 
 protected:
   void ClearCache() noexcept;
+
+private:
+  /**
+   * Throws on error.
+   */
+  std::unique_ptr<XShape> LoadShape(std::size_t i);
+
+  /**
+   * Load the shapes for which #is_inside returns true, and discard
+   * all others.
+   *
+   * Throws on error.
+   */
+  template<typename P>
+  void UpdateCache(P &&is_inside);
 };
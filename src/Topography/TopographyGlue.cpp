@@ -3,6 +3,7 @@
 
 #include "Topography/TopographyGlue.hpp"
 #include "Topography/TopographyStore.hpp"
+#include "Topography/TiledTopography.hpp"
 #include "Language/Language.hpp"
 #include "Profile/Profile.hpp"
 #include "LogFile.hpp"
@@ -10,8 +11,33 @@
 #include "io/MapFile.hpp"
 #include "io/ZipArchive.hpp"
 #include "io/ZipLineReader.hpp"
+#include "system/FileUtil.hpp"
 #include "system/Path.hpp"
 
+/**
+ * Open the converted topography (see #TiledTopography) which belongs
+ * to the configured map file, i.e. the file next to it with the
+ * suffix ".xtt".
+ *
+ * @return nullptr if there is none
+ */
+static std::unique_ptr<TiledTopographyFile>
+OpenTiledTopography() noexcept
+try {
+  const auto map_path = Profile::GetPath(ProfileKeys::MapFile);
+  if (map_path == nullptr)
+    return nullptr;
+
+  const auto path = map_path.WithSuffix(_T(".xtt"));
+  if (!File::Exists(path))
+    return nullptr;
+
+  return std::make_unique<TiledTopographyFile>(path);
+} catch (...) {
+  LogError(std::current_exception(), "Failed to open tiled topography");
+  return nullptr;
+}
+
 /**
  * Load topography from the map file (ZIP), load the other files from
  * the same ZIP file.
@@ -25,7 +51,8 @@ try {
     return false;
 
   ZipLineReaderA reader(archive->get(), "topology.tpl");
-  store.Load(operation, reader, nullptr, archive->get());
+  store.Load(operation, reader, nullptr, archive->get(),
+             OpenTiledTopography());
   return true;
 } catch (...) {
   LogError(std::current_exception(), "No topography in map file");
@@ -2,16 +2,20 @@
 // Copyright The XCSoar Project
 
 #include "Topography/TopographyStore.hpp"
+#include "Topography/TiledTopography.hpp"
 #include "Index.hpp"
 #include "util/StringAPI.hxx"
 #include "util/StringCompare.hxx"
 #include "io/LineReader.hpp"
 #include "system/ConvertPathName.hpp"
+#include "system/FileUtil.hpp"
 #include "system/Path.hpp"
 #include "Operation/Operation.hpp"
 #include "Compatibility/path.h"
 #include "LogFile.hpp"
 
+#include <zzip/zzip.h>
+
 #include <cstdint>
 
 #include <windef.h> // for MAX_PATH
@@ -65,12 +69,38 @@ TopographyStore::LoadAll() noexcept
     i.LoadAll();
 }
 
+/**
+ * Returns the size of the given shapefile, or 0 on error.
+ */
+static uint64_t
+GetShapeFileSize(struct zzip_dir *zdir, const char *path) noexcept
+{
+  if (zdir != nullptr) {
+    ZZIP_STAT st;
+    return zzip_dir_stat(zdir, path, &st, 0) == 0
+      ? uint64_t(st.st_size)
+      : 0;
+  }
+
+  return File::GetSize(PathName(path));
+}
+
 void
 TopographyStore::Load(OperationEnvironment &operation, NLineReader &reader,
                       Path directory, struct zzip_dir *zdir) noexcept
+{
+  Load(operation, reader, directory, zdir, nullptr);
+}
+
+void
+TopographyStore::Load(OperationEnvironment &operation, NLineReader &reader,
+                      Path directory, struct zzip_dir *zdir,
+                      std::unique_ptr<TiledTopographyFile> _tiled) noexcept
 {
   Reset();
 
+  tiled = std::move(_tiled);
+
   // Create buffer for the shape filenames
   // (shape_filename will be modified with the shape_filename_end pointer)
   char shape_filename[MAX_PATH];
@@ -104,17 +134,31 @@ TopographyStore::Load(OperationEnvironment &operation, NLineReader &reader,
     // Append ".shp" file extension to the shape_filename buffer
     strcpy(shape_filename_end + entry->name.size(), ".shp");
 
+    const TiledTopographyLayer *layer = tiled != nullptr
+      ? tiled->FindLayer(entry->name,
+                         GetShapeFileSize(zdir, shape_filename))
+      : nullptr;
+
     // Create TopographyFile instance from parsed line
     try {
-      i = files.emplace_after(i,
-                              zdir, shape_filename,
-                              entry->shape_range,
-                              entry->label_range,
-                              entry->important_label_range,
-                              entry->color,
-                              entry->shape_field,
-                              entry->icon, entry->big_icon,
-                              entry->pen_width);
+      if (layer != nullptr)
+        i = files.emplace_after(i, *layer,
+                                entry->shape_range,
+                                entry->label_range,
+                                entry->important_label_range,
+                                entry->color,
+                                entry->icon, entry->big_icon,
+                                entry->pen_width);
+      else
+        i = files.emplace_after(i,
+                                zdir, shape_filename,
+                                entry->shape_range,
+                                entry->label_range,
+                                entry->important_label_range,
+                                entry->color,
+                                entry->shape_field,
+                                entry->icon, entry->big_icon,
+                                entry->pen_width);
     } catch (...) {
       LogError(std::current_exception());
     }
@@ -128,4 +172,5 @@ void
 TopographyStore::Reset() noexcept
 {
   files.clear();
+  tiled.reset();
 }
@@ -6,18 +6,27 @@
 #include "TopographyFile.hpp"
 #include "util/NonCopyable.hpp"
 
+#include <cstdint>
 #include <forward_list>
+#include <memory>
 
 class Path;
 class WindowProjection;
 class NLineReader;
 class OperationEnvironment;
+class TiledTopographyFile;
 struct zzip_dir;
 
 /**
  * Class used to manage and render vector topography layers
  */
 class TopographyStore : private NonCopyable {
+  /**
+   * The converted topography which is used instead of shapefiles
+   * where possible (see Load()).
+   */
+  std::unique_ptr<TiledTopographyFile> tiled;
+
   std::forward_list<TopographyFile> files;
 
   /**
@@ -67,5 +76,15 @@ public:
 
   void Load(OperationEnvironment &operation, NLineReader &reader,
             Path directory, struct zzip_dir *zdir = nullptr) noexcept;
+
+  /**
+   * Like above, but load each layer which was converted to the
+   * #TiledTopography format from the given file instead of the
+   * shapefile.  Layers which are missing or outdated in #tiled are
+   * loaded from the shapefile.
+   */
+  void Load(OperationEnvironment &operation, NLineReader &reader,
+            Path directory, struct zzip_dir *zdir,
+            std::unique_ptr<TiledTopographyFile> tiled) noexcept;
   void Reset() noexcept;
 };
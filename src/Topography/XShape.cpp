@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "Topography/XShape.hpp"
+#include "Topography/TiledTopography.hpp"
 #include "Convert.hpp"
 #include "util/Compiler.h"
 #include "util/StringAPI.hxx"
@@ -19,6 +20,7 @@
 #endif
 
 #include <algorithm>
+#include <cassert>
 #include <stdexcept>
 
 #include <tchar.h>
@@ -129,8 +131,9 @@ XShape::XShape(const shapeObj &shape, const GeoPoint &file_center,
     ++num_lines;
   }
 
-  points = std::make_unique<Point[]>(num_points);
-  auto *p = points.get();
+  points_buffer = std::make_unique<Point[]>(num_points);
+  points = points_buffer.get();
+  auto *p = points_buffer.get();
   for (std::size_t l = 0; l < num_lines; ++l) {
     const pointObj *src = shape.line[l].point;
     p = std::transform(src, src + lines[l], p,
@@ -140,6 +143,40 @@ XShape::XShape(const shapeObj &shape, const GeoPoint &file_center,
   }
 }
 
+XShape::XShape(const TiledTopographyShape &shape,
+               [[maybe_unused]] const GeoPoint &file_center)
+  :bounds(shape.bounds), type(shape.type),
+   num_lines(shape.lines.size()),
+   label(ImportLabel(shape.label))
+{
+  assert(shape.lines.size() <= lines.size());
+
+  std::copy(shape.lines.begin(), shape.lines.end(), lines.begin());
+
+#ifdef ENABLE_OPENGL
+  static_assert(THINNING_LEVELS == TiledTopography::THINNING_LEVELS);
+
+  points = shape.points.data();
+
+  for (std::size_t level = 0; level < THINNING_LEVELS; ++level) {
+    const auto &src = shape.indices[level];
+    if (src.empty())
+      continue;
+
+    index_count[level] = src.data();
+    indices[level] = src.data() + (type == MS_SHAPE_LINE ? num_lines : 1);
+  }
+#else
+  points_buffer = std::make_unique<Point[]>(shape.points.size());
+  points = points_buffer.get();
+  std::transform(shape.points.begin(), shape.points.end(),
+                 points_buffer.get(), [&](const ShapePoint &p){
+                   return GeoPoint(file_center.longitude + Angle::Native(p.x),
+                                   file_center.latitude + Angle::Native(p.y));
+                 });
+#endif
+}
+
 XShape::~XShape() noexcept = default;
 
 #ifdef ENABLE_OPENGL
@@ -158,12 +195,12 @@ XShape::BuildIndices(unsigned thinning_level, ShapeScalar min_distance) noexcept
   if (type == MS_SHAPE_LINE) {
     if (num_points <= 2)
       return false;  // line cannot be simplified, so don't create indices
-    index_count[thinning_level] = std::make_unique<GLushort[]>(num_lines + num_points);
-    idx_count = index_count[thinning_level].get();
+    index_buffers[thinning_level] = std::make_unique<GLushort[]>(num_lines + num_points);
+    index_count[thinning_level] = idx_count = index_buffers[thinning_level].get();
     indices[thinning_level] = idx = idx_count + num_lines;
 
     const auto end_l = std::next(lines.begin(), num_lines);
-    const ShapePoint *p = points.get();
+    const ShapePoint *p = points;
     unsigned i = 0;
     for (auto l = lines.begin(); l != end_l; ++l) {
       assert(*l >= 2);
@@ -188,17 +225,17 @@ XShape::BuildIndices(unsigned thinning_level, ShapeScalar min_distance) noexcept
     // TODO: free memory saved by thinning (use malloc/realloc or some class?)
     return true;
   } else if (type == MS_SHAPE_POLYGON) {
-    index_count[thinning_level] = std::make_unique<GLushort[]>(1 + 3 * (num_points - 2) + 2 * (num_lines - 1));
-    idx_count = index_count[thinning_level].get();
+    index_buffers[thinning_level] = std::make_unique<GLushort[]>(1 + 3 * (num_points - 2) + 2 * (num_lines - 1));
+    index_count[thinning_level] = idx_count = index_buffers[thinning_level].get();
     indices[thinning_level] = idx = idx_count + 1;
 
     *idx_count = 0;
-    const ShapePoint *pt = points.get();
+    const ShapePoint *pt = points;
     for (std::size_t i=0; i < num_lines; i++) {
       std::size_t count = PolygonToTriangles(pt, lines[i], idx + *idx_count,
                                              min_distance);
       if (i > 0) {
-        const GLushort offset = pt - points.get();
+        const GLushort offset = pt - points;
         const std::size_t max_idx_count = *idx_count + count;
         for (std::size_t j = *idx_count; j < max_idx_count; j++)
           idx[j] += offset;
@@ -223,7 +260,7 @@ XShape::GetIndices(int thinning_level, ShapeScalar min_distance) const noexcept
       return {};
   }
 
-  return {indices[thinning_level], index_count[thinning_level].get()};
+  return {indices[thinning_level], index_count[thinning_level]};
 }
 
 #endif // ENABLE_OPENGL
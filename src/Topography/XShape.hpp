@@ -20,6 +20,7 @@
 #include <tchar.h>
 
 struct GeoPoint;
+struct TiledTopographyShape;
 
 class XShape {
   static constexpr std::size_t MAX_LINES = 32;
@@ -50,15 +51,18 @@ class XShape {
 #endif
 
   /**
-   * All points of all lines.
+   * All points of all lines.  This points either to #points_buffer
+   * or into a memory-mapped #TiledTopographyFile.
    */
-  std::unique_ptr<Point[]> points;
+  const Point *points = nullptr;
+
+  std::unique_ptr<Point[]> points_buffer;
 
 #ifdef ENABLE_OPENGL
   /**
    * Indices of polygon triangles or lines with reduced number of vertices.
    */
-  std::array<uint16_t *, THINNING_LEVELS> indices{};
+  std::array<const uint16_t *, THINNING_LEVELS> indices{};
 
   /**
    * For polygons this will contain the total number of triangle vertices
@@ -66,7 +70,13 @@ class XShape {
    * For lines there will be an array of size num_lines for each thinning
    * level, which contains the number of points for each line.
    */
-  std::array<std::unique_ptr<uint16_t[]>, THINNING_LEVELS> index_count;
+  std::array<const uint16_t *, THINNING_LEVELS> index_count{};
+
+  /**
+   * The memory allocated by BuildIndices() for #index_count and
+   * #indices.
+   */
+  std::array<std::unique_ptr<uint16_t[]>, THINNING_LEVELS> index_buffers;
 
   /**
    * The start offset in the #GLArrayBuffer (vertex buffer object).
@@ -84,6 +94,15 @@ public:
   XShape(const shapeObj &shape, const GeoPoint &file_center,
          const char *label);
 
+  /**
+   * Construct from a shape record of a #TiledTopographyFile.  Points
+   * and indices refer to the mapped memory (with OpenGL), which must
+   * remain mapped as long as this object exists.
+   *
+   * @param file_center the center of the #TiledTopographyLayer
+   */
+  XShape(const TiledTopographyShape &shape, const GeoPoint &file_center);
+
   ~XShape() noexcept;
 
   XShape(const XShape &) = delete;
@@ -126,7 +145,7 @@ public:
   }
 
   const Point *GetPoints() const noexcept {
-    return points.get();
+    return points;
   }
 
   const TCHAR *GetLabel() const noexcept {
@@ -10,13 +10,31 @@
 #include "net/UniqueSocketDescriptor.hxx"
 #include "util/CRC.hpp"
 
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
 static UniqueSocketDescriptor
-CreateBindUDP(SocketAddress address)
+CreateBindUDP(SocketAddress address, bool reuse_port)
 {
   UniqueSocketDescriptor s;
   if (!s.Create(address.GetFamily(), SOCK_DGRAM, 0))
     throw MakeSocketError("Failed to create socket");
 
+  if (reuse_port) {
+#ifdef __linux__
+    if (!s.SetReusePort())
+      throw MakeSocketError("Failed to set SO_REUSEPORT");
+#else
+    throw std::runtime_error{"SO_REUSEPORT not supported"};
+#endif
+  }
+
   if (!s.Bind(address))
     throw MakeSocketError("Failed to connect socket");
 
@@ -25,25 +43,69 @@ CreateBindUDP(SocketAddress address)
 
 namespace SkyLinesTracking {
 
+struct Server::Buffers {
+  /**
+   * The maximum number of datagrams received per OnSocketReady() call
+   * and sent per FlushSendQueue() call.
+   */
+  static constexpr std::size_t MAX_BATCH = 64;
+
+  static constexpr std::size_t MAX_RECEIVE_SIZE = 4096;
+
+  /**
+   * Larger datagrams are not queued but sent right away.  This is
+   * enough for the largest TRAFFIC_RESPONSE and THERMAL_RESPONSE
+   * packets generated by the cloud server.
+   */
+  static constexpr std::size_t MAX_SEND_SIZE = 2048;
+
+  struct Datagram {
+    StaticSocketAddress address;
+    std::size_t size;
+  };
+
+  struct ReceiveDatagram : Datagram {
+    alignas(8) std::array<std::byte, MAX_RECEIVE_SIZE> data;
+  };
+
+  struct SendDatagram : Datagram {
+    std::array<std::byte, MAX_SEND_SIZE> data;
+  };
+
+  std::array<ReceiveDatagram, MAX_BATCH> receive;
+
+  std::array<SendDatagram, MAX_BATCH> send;
+  std::size_t n_send = 0;
+
+#ifdef __linux__
+  std::array<struct iovec, MAX_BATCH> receive_iov, send_iov;
+  std::array<struct mmsghdr, MAX_BATCH> receive_msgs, send_msgs;
+#endif
+};
+
 Server::Server(EventLoop &event_loop,
-               SocketAddress server_address)
+               SocketAddress server_address, bool reuse_port)
   :socket(event_loop, BIND_THIS_METHOD(OnSocketReady),
-          CreateBindUDP(server_address).Release())
+          CreateBindUDP(server_address, reuse_port).Release()),
+   buffers(std::make_unique<Buffers>()),
+   flush_event(event_loop, BIND_THIS_METHOD(FlushSendQueue))
 {
   socket.ScheduleRead();
 }
 
 Server::~Server()
 {
+  FlushSendQueue();
   socket.Close();
 }
 
 void
-Server::SendBuffer(SocketAddress address,
-                   std::span<const std::byte> buffer) noexcept
+Server::SendNow(SocketAddress address,
+                std::span<const std::byte> buffer) noexcept
 {
   try {
-    ssize_t nbytes = socket.GetSocket().Write(buffer.data(), buffer.size());
+    ssize_t nbytes = socket.GetSocket().Write(buffer.data(), buffer.size(),
+                                              address);
     if (nbytes < 0)
       throw MakeSocketError("Failed to send");
   } catch (...) {
@@ -51,6 +113,146 @@ Server::SendBuffer(SocketAddress address,
   }
 }
 
+void
+Server::SendBuffer(SocketAddress address,
+                   std::span<const std::byte> buffer) noexcept
+{
+  auto &b = *buffers;
+
+  if (b.n_send == b.MAX_BATCH || buffer.size() > b.MAX_SEND_SIZE)
+    /* flush first to preserve the order of datagrams */
+    FlushSendQueue();
+
+  if (buffer.size() > b.MAX_SEND_SIZE) {
+    SendNow(address, buffer);
+    return;
+  }
+
+  auto &d = b.send[b.n_send++];
+  d.address = address;
+  d.size = buffer.size();
+  std::copy(buffer.begin(), buffer.end(), d.data.begin());
+
+  flush_event.ScheduleIdle();
+}
+
+#ifdef __linux__
+
+void
+Server::FlushSendQueue() noexcept
+{
+  auto &b = *buffers;
+  const std::size_t n = std::exchange(b.n_send, 0);
+  if (n == 0 || !socket.IsDefined())
+    return;
+
+  for (std::size_t i = 0; i < n; ++i) {
+    auto &d = b.send[i];
+    b.send_iov[i] = {d.data.data(), d.size};
+
+    auto &h = b.send_msgs[i].msg_hdr;
+    h = {};
+    h.msg_name = (struct sockaddr *)d.address;
+    h.msg_namelen = d.address.GetSize();
+    h.msg_iov = &b.send_iov[i];
+    h.msg_iovlen = 1;
+  }
+
+  for (std::size_t i = 0; i < n;) {
+    const int result = sendmmsg(socket.GetSocket().Get(),
+                                &b.send_msgs[i], n - i,
+                                MSG_DONTWAIT|MSG_NOSIGNAL);
+    if (result <= 0) {
+      /* the first datagram has failed; skip it and continue with
+         the rest */
+      OnSendError(b.send[i].address,
+                  std::make_exception_ptr(MakeSocketError("Failed to send")));
+      ++i;
+    } else
+      i += result;
+  }
+}
+
+std::size_t
+Server::ReceiveBatch()
+{
+  auto &b = *buffers;
+
+  for (std::size_t i = 0; i < b.MAX_BATCH; ++i) {
+    auto &d = b.receive[i];
+    b.receive_iov[i] = {d.data.data(), d.data.size()};
+
+    auto &h = b.receive_msgs[i].msg_hdr;
+    h = {};
+    h.msg_name = (struct sockaddr *)d.address;
+    h.msg_namelen = d.address.GetCapacity();
+    h.msg_iov = &b.receive_iov[i];
+    h.msg_iovlen = 1;
+  }
+
+  const int n = recvmmsg(socket.GetSocket().Get(),
+                         b.receive_msgs.data(), b.MAX_BATCH,
+                         MSG_DONTWAIT, nullptr);
+  if (n < 0) {
+    const auto e = GetSocketError();
+    if (IsSocketErrorReceiveWouldBlock(e))
+      return 0;
+
+    throw MakeSocketError(e, "Failed to receive");
+  }
+
+  for (int i = 0; i < n; ++i) {
+    auto &d = b.receive[i];
+    d.address.SetSize(b.receive_msgs[i].msg_hdr.msg_namelen);
+    d.size = b.receive_msgs[i].msg_len;
+  }
+
+  return n;
+}
+
+#else
+
+void
+Server::FlushSendQueue() noexcept
+{
+  auto &b = *buffers;
+  const std::size_t n = std::exchange(b.n_send, 0);
+  if (!socket.IsDefined())
+    return;
+
+  for (std::size_t i = 0; i < n; ++i)
+    SendNow(b.send[i].address, {b.send[i].data.data(), b.send[i].size});
+}
+
+std::size_t
+Server::ReceiveBatch()
+{
+  auto &b = *buffers;
+
+  std::size_t n = 0;
+  while (n < b.MAX_BATCH) {
+    auto &d = b.receive[n];
+    d.address.SetMaxSize();
+    const ssize_t nbytes = socket.GetSocket().Read(d.data.data(),
+                                                   d.data.size(),
+                                                   d.address);
+    if (nbytes < 0) {
+      const auto e = GetSocketError();
+      if (IsSocketErrorReceiveWouldBlock(e))
+        break;
+
+      throw MakeSocketError(e, "Failed to receive");
+    }
+
+    d.size = nbytes;
+    ++n;
+  }
+
+  return n;
+}
+
+#endif
+
 void
 Server::OnPing(const Client &client, unsigned id)
 {
@@ -165,22 +367,14 @@ Server::OnDatagramReceived(Client &&client,
 void
 Server::OnSocketReady(unsigned) noexcept
 try {
-  // TODO: use recvmmsg() on Linux
+  const std::size_t n = ReceiveBatch();
+  for (std::size_t i = 0; i < n; ++i) {
+    auto &d = buffers->receive[i];
 
-  Client client;
-  socklen_t address_size = sizeof(client.address);
-  char buffer[4096];
-
-  ssize_t nbytes = recvfrom(socket.GetSocket().Get(), buffer, sizeof(buffer),
-                            MSG_DONTWAIT,
-                            client.address, &address_size);
-  if (nbytes < 0)
-    throw MakeSocketError("Failed to receive");
-
-  client.address.SetSize(address_size);
-  // TODO: set client.key
-
-  OnDatagramReceived(std::move(client), buffer, nbytes);
+    Client client;
+    client.address = d.address;
+    OnDatagramReceived(std::move(client), d.data.data(), d.size);
+  }
 } catch (...) {
   socket.Close();
   OnError(std::current_exception());
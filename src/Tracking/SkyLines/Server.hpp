@@ -4,11 +4,13 @@
 #pragma once
 
 #include "event/SocketEvent.hxx"
+#include "event/DeferEvent.hxx"
 #include "net/StaticSocketAddress.hxx"
 
 #include <chrono>
 #include <cstdint>
 #include <exception>
+#include <memory>
 #include <span>
 
 struct GeoPoint;
@@ -24,6 +26,19 @@ namespace SkyLinesTracking {
 class Server {
   SocketEvent socket;
 
+  /**
+   * Buffers for receiving and sending batches of datagrams (with
+   * recvmmsg() and sendmmsg() on Linux).
+   */
+  struct Buffers;
+  const std::unique_ptr<Buffers> buffers;
+
+  /**
+   * Sends all queued datagrams before the #EventLoop goes to sleep,
+   * i.e. once per event loop iteration.
+   */
+  DeferEvent flush_event;
+
 public:
   struct Client {
     StaticSocketAddress address;
@@ -31,7 +46,15 @@ public:
   };
 
 public:
-  Server(EventLoop &event_loop, SocketAddress server_address);
+  /**
+   * Throws on error.
+   *
+   * @param reuse_port enable SO_REUSEPORT, allowing several instances
+   * (in different threads) to bind to the same address; the kernel
+   * distributes incoming datagrams among them
+   */
+  Server(EventLoop &event_loop, SocketAddress server_address,
+         bool reuse_port=false);
 
   ~Server();
 
@@ -49,6 +72,10 @@ public:
     return socket.GetEventLoop();
   }
 
+  /**
+   * Queue a datagram.  It will be sent together with all other
+   * datagrams queued during this event loop iteration.
+   */
   void SendBuffer(SocketAddress address,
                   std::span<const std::byte> buffer) noexcept;
 
@@ -58,6 +85,24 @@ public:
   }
 
 private:
+  void SendNow(SocketAddress address,
+               std::span<const std::byte> buffer) noexcept;
+
+  /**
+   * Send all datagrams queued by SendBuffer().
+   */
+  void FlushSendQueue() noexcept;
+
+  /**
+   * Receive up to Buffers::MAX_BATCH datagrams into
+   * Buffers::receive.
+   *
+   * Throws on error.
+   *
+   * @return the number of datagrams received
+   */
+  std::size_t ReceiveBatch();
+
   void OnDatagramReceived(Client &&client, void *data, size_t length);
   void OnSocketReady(unsigned events) noexcept;
 
@@ -139,7 +139,7 @@ SettingsLeave(const UISettings &old_ui_settings)
       glide_computer->ClearAirspaces();
 
     airspace_database.Clear();
-    ReadAirspace(airspace_database,
+    ReadAirspace(airspace_database, file_cache,
                  CommonInterface::GetComputerSettings().pressure,
                  operation);
 
@@ -16,6 +16,13 @@ protected:
 public:
   explicit CSVLine(const char *line) noexcept;
 
+  /**
+   * @param _end the end of the line (exclusive); the columns are
+   * separated with strchr(), so the line must still be null-terminated
+   */
+  constexpr CSVLine(const char *line, const char *_end) noexcept
+    :data(line), end(_end) {}
+
   std::string_view Rest() const noexcept {
     return {data, std::size_t(end - data)};
   }
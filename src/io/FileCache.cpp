@@ -119,6 +119,15 @@ FileCache::Load(const TCHAR *name, Path original_path) noexcept
   return nullptr;
 }
 
+AllocatedPath
+FileCache::LoadPath(const TCHAR *name, Path original_path) noexcept
+{
+  if (!Load(name, original_path))
+    return nullptr;
+
+  return MakeCachePath(name);
+}
+
 std::unique_ptr<FileOutputStream>
 FileCache::Save(const TCHAR *name, Path original_path)
 {
@@ -32,6 +32,13 @@ public:
    */
   std::unique_ptr<Reader> Load(const TCHAR *name, Path original_path) noexcept;
 
+  /**
+   * Like Load(), but return the path of the cache file instead of
+   * opening it, e.g. to map it into memory.  The file begins with
+   * the header written by Save().  Returns nullptr on error.
+   */
+  AllocatedPath LoadPath(const TCHAR *name, Path original_path) noexcept;
+
   /**
    * Throws on error.
    */
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * A bounded lock-free multi-producer/single-consumer queue (after
+ * Dmitry Vyukov's bounded MPMC queue).  Each slot carries a sequence
+ * number which tells producers and the consumer whether it is free or
+ * filled, so neither side ever waits for the other: TryPush() fails
+ * if the queue is full, TryPop() fails if it is empty.
+ *
+ * #T must be default-constructible and copy-assignable.
+ */
+template<typename T>
+class MPSCQueue {
+  struct Slot {
+    std::atomic<std::size_t> sequence;
+    T value;
+  };
+
+  const std::size_t mask;
+
+  const std::unique_ptr<Slot[]> slots;
+
+  /**
+   * The position of the next TryPush() call.  It is kept in a cache
+   * line of its own, because all producers modify it.
+   */
+  alignas(64) std::atomic<std::size_t> head{0};
+
+  /**
+   * The position of the next TryPop() call; owned by the consumer.
+   */
+  alignas(64) std::size_t tail = 0;
+
+public:
+  /**
+   * @param capacity the maximum number of items; must be a power of
+   * two
+   */
+  explicit MPSCQueue(std::size_t capacity)
+    :mask(capacity - 1), slots(new Slot[capacity]) {
+    assert(capacity > 0);
+    assert((capacity & mask) == 0);
+
+    for (std::size_t i = 0; i < capacity; ++i)
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  MPSCQueue(const MPSCQueue &) = delete;
+  MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+  std::size_t capacity() const noexcept {
+    return mask + 1;
+  }
+
+  /**
+   * Append an item.  This method is thread-safe.
+   *
+   * @return false if the queue is full
+   */
+  bool TryPush(const T &value) noexcept {
+    std::size_t position = head.load(std::memory_order_relaxed);
+
+    while (true) {
+      Slot &slot = slots[position & mask];
+      const std::size_t sequence =
+        slot.sequence.load(std::memory_order_acquire);
+      const auto diff = intptr_t(sequence) - intptr_t(position);
+
+      if (diff == 0) {
+        /* the slot is free; try to claim it */
+        if (head.compare_exchange_weak(position, position + 1,
+                                       std::memory_order_relaxed)) {
+          slot.value = value;
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        /* the consumer has not yet released this slot */
+        return false;
+      } else
+        /* another producer has claimed this slot */
+        position = head.load(std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Remove the oldest item.  Only the consumer thread may call this
+   * method.
+   *
+   * @return false if the queue is empty (or the oldest item is still
+   * being written by a producer)
+   */
+  bool TryPop(T &value) noexcept {
+    Slot &slot = slots[tail & mask];
+    const std::size_t sequence =
+      slot.sequence.load(std::memory_order_acquire);
+    if (sequence != tail + 1)
+      return false;
+
+    value = slot.value;
+    slot.sequence.store(tail + mask + 1, std::memory_order_release);
+    ++tail;
+    return true;
+  }
+};
@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * A wait-free single-producer/single-consumer "triple buffer": the
+ * producer fills the back buffer and publishes it, the consumer
+ * acquires the most recently published buffer.  Neither side ever
+ * waits for the other, and intermediate values which were not
+ * acquired in time are silently dropped.
+ *
+ * Publish() and Acquire() only swap buffer indexes, they never copy
+ * #T.
+ */
+template<typename T>
+class TripleBuffer {
+  static constexpr uint_least8_t INDEX_MASK = 0x3;
+
+  /**
+   * This flag in #middle means that the middle buffer has been
+   * published, but was not yet acquired by the consumer.
+   */
+  static constexpr uint_least8_t FRESH = 0x4;
+
+  std::array<T, 3> buffers;
+
+  /**
+   * The buffer owned by the producer.
+   */
+  uint_least8_t back = 0;
+
+  /**
+   * The buffer owned by the consumer.
+   */
+  uint_least8_t front = 1;
+
+  /**
+   * The buffer in transit, plus the #FRESH flag.
+   */
+  std::atomic<uint_least8_t> middle{2};
+
+public:
+  TripleBuffer() = default;
+
+  explicit TripleBuffer(const T &initial) noexcept
+    :buffers{initial, initial, initial} {}
+
+  TripleBuffer(const TripleBuffer &) = delete;
+  TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+  /**
+   * Overwrite all buffers.  Neither the producer nor the consumer
+   * may run concurrently.
+   */
+  void Fill(const T &value) noexcept {
+    buffers.fill(value);
+  }
+
+  /**
+   * Producer: returns the buffer to be filled before Publish().  Its
+   * contents are undefined (one of the older values).
+   */
+  T &GetBack() noexcept {
+    return buffers[back];
+  }
+
+  /**
+   * Producer: make the back buffer available to the consumer.
+   */
+  void Publish() noexcept {
+    /* "release" makes our writes visible to the consumer, "acquire"
+       makes sure it has stopped reading the buffer it hands back */
+    back = middle.exchange(back | FRESH, std::memory_order_acq_rel)
+      & INDEX_MASK;
+  }
+
+  /**
+   * Consumer: switch to the most recently published buffer, if
+   * there is one.
+   *
+   * @return true if a new buffer was acquired, false if the front
+   * buffer is still current
+   */
+  bool Acquire() noexcept {
+    if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+      return false;
+
+    front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+    return true;
+  }
+
+  /**
+   * Consumer: returns the buffer which was acquired last.  It is
+   * owned by the consumer until the next Acquire() call and may be
+   * modified.
+   */
+  T &GetFront() noexcept {
+    return buffers[front];
+  }
+
+  const T &GetFront() const noexcept {
+    return buffers[front];
+  }
+};
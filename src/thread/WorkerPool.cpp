@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+WorkerPool::WorkerPool(unsigned n_threads)
+{
+  try {
+    for (unsigned i = 0; i < n_threads; ++i) {
+      auto &worker = workers.emplace_front(*this);
+
+      try {
+        worker.Start();
+      } catch (...) {
+        /* this Worker was not started; all others are joined by
+           StopThreads() */
+        workers.pop_front();
+        throw;
+      }
+
+      ++n_workers;
+    }
+  } catch (...) {
+    StopThreads();
+    throw;
+  }
+}
+
+WorkerPool::~WorkerPool() noexcept
+{
+  StopThreads();
+}
+
+void
+WorkerPool::StopThreads() noexcept
+{
+  {
+    const std::lock_guard lock{mutex};
+    stop = true;
+    work_cond.notify_all();
+  }
+
+  for (auto &i : workers)
+    i.Join();
+
+  workers.clear();
+  n_workers = 0;
+}
+
+void
+WorkerPool::Work([[maybe_unused]] std::unique_lock<Mutex> &lock) noexcept
+{
+  assert(lock.owns_lock());
+
+  while (next < n) {
+    const unsigned i = next++;
+
+    {
+      const ScopeUnlock unlock(mutex);
+      function(ctx, i);
+    }
+
+    if (--remaining == 0)
+      done_cond.notify_one();
+  }
+}
+
+void
+WorkerPool::Run(unsigned _n, Function _function, void *_ctx) noexcept
+{
+  std::unique_lock lock{mutex};
+  assert(remaining == 0);
+
+  if (_n == 0)
+    return;
+
+  function = _function;
+  ctx = _ctx;
+  n = _n;
+  next = 0;
+  remaining = _n;
+
+  if (_n > 1)
+    work_cond.notify_all();
+
+  Work(lock);
+
+  done_cond.wait(lock, [this]{ return remaining == 0; });
+}
+
+void
+WorkerPool::Worker::Run() noexcept
+{
+  std::unique_lock lock{pool.mutex};
+
+  while (true) {
+    pool.work_cond.wait(lock, [this]{
+      return pool.stop || pool.next < pool.n;
+    });
+
+    if (pool.stop)
+      break;
+
+    pool.Work(lock);
+  }
+}
+
+unsigned
+WorkerPool::GetDefaultThreads(unsigned max) noexcept
+{
+  const unsigned n = std::thread::hardware_concurrency();
+  if (n <= 1)
+    return 0;
+
+  return std::min(n, max) - 1;
+}
+
+std::unique_ptr<WorkerPool>
+WorkerPool::CreateDefault(unsigned max) noexcept
+{
+  const unsigned n = GetDefaultThreads(max);
+  if (n == 0)
+    return nullptr;
+
+  try {
+    return std::make_unique<WorkerPool>(n);
+  } catch (...) {
+    /* single-threaded fallback */
+    return nullptr;
+  }
+}
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "thread/Thread.hpp"
+#include "thread/Mutex.hxx"
+#include "Cond.hxx"
+
+#include <forward_list>
+#include <memory>
+#include <type_traits>
+
+/**
+ * A small fixed set of threads which split CPU-bound work (e.g. the
+ * rows of a bitmap) among all cores.  ForEach() blocks the calling
+ * thread, which participates in the work.
+ *
+ * The methods may only be called from one thread.
+ */
+class WorkerPool {
+  class Worker final : public Thread {
+    WorkerPool &pool;
+
+  public:
+    explicit Worker(WorkerPool &_pool) noexcept
+      :Thread("WorkerPool"), pool(_pool) {}
+
+  protected:
+    void Run() noexcept override;
+  };
+
+  std::forward_list<Worker> workers;
+  unsigned n_workers = 0;
+
+  Mutex mutex;
+
+  /**
+   * Signalled when a new job was submitted or when the pool shall
+   * be stopped.
+   */
+  Cond work_cond;
+
+  /**
+   * Signalled when the last item of the current job is finished.
+   */
+  Cond done_cond;
+
+  using Function = void (*)(void *ctx, unsigned i) noexcept;
+
+  /* the current job */
+  Function function;
+  void *ctx;
+  unsigned n = 0, next = 0, remaining = 0;
+
+  bool stop = false;
+
+public:
+  /**
+   * Start the specified number of threads.
+   *
+   * Throws on error.
+   */
+  explicit WorkerPool(unsigned n_threads);
+
+  ~WorkerPool() noexcept;
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  /**
+   * How many threads work on a job, including the calling thread?
+   */
+  unsigned GetConcurrency() const noexcept {
+    return n_workers + 1;
+  }
+
+  /**
+   * Invoke f(i) for each i in [0,n), distributed over all threads,
+   * and return when all of them have finished.  The order is
+   * undefined.  The function must not throw.
+   */
+  template<typename F>
+  void ForEach(unsigned _n, F &&f) noexcept {
+    Run(_n, [](void *_ctx, unsigned i) noexcept {
+      (*(std::remove_reference_t<F> *)_ctx)(i);
+    }, &f);
+  }
+
+  /**
+   * Split [0,n) into #n_bands contiguous bands of (almost) equal size
+   * and invoke f(begin, end) for each of them, see ForEach().
+   */
+  template<typename F>
+  void ForEachBand(unsigned _n, unsigned n_bands, F &&f) noexcept {
+    ForEach(n_bands, [_n, n_bands, &f](unsigned band){
+      f(GetBandStart(_n, n_bands, band), GetBandStart(_n, n_bands, band + 1));
+    });
+  }
+
+  static constexpr unsigned GetBandStart(unsigned _n, unsigned n_bands,
+                                         unsigned band) noexcept {
+    return _n * band / n_bands;
+  }
+
+private:
+  void Run(unsigned _n, Function _function, void *_ctx) noexcept;
+
+  /**
+   * Ask all threads to stop and wait for them.
+   */
+  void StopThreads() noexcept;
+
+  /**
+   * Process items of the current job until there are none left.
+   * Caller must lock the mutex.
+   */
+  void Work(std::unique_lock<Mutex> &lock) noexcept;
+
+  /**
+   * Returns the number of threads which are useful for splitting work
+   * on this machine, not counting the calling thread.
+   *
+   * @param max the maximum number of threads
+   */
+  static unsigned GetDefaultThreads(unsigned max) noexcept;
+
+public:
+  /**
+   * Create a #WorkerPool with one thread per CPU core (but at most
+   * #max), or return nullptr on a single core machine or if the
+   * threads could not be started.
+   */
+  static std::unique_ptr<WorkerPool> CreateDefault(unsigned max) noexcept;
+};
@@ -164,6 +164,17 @@ public:
 #endif
   }
 
+  /**
+   * Returns a pointer to the specified row (0 is the top-most row).
+   */
+  RawColor *GetRow(unsigned y) noexcept {
+#ifndef USE_GDI
+    return GetBuffer() + y * size.width;
+#else
+    return GetTopRow() - y * corrected_width;
+#endif
+  }
+
   void SetDirty() noexcept {
 #ifdef ENABLE_OPENGL
     dirty = true;
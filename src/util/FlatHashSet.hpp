@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/**
+ * An open-addressing hash set (linear probing) which stores its
+ * items densely in insertion order.  Items cannot be removed
+ * individually, but Clear() is O(1) and keeps all allocated memory,
+ * which makes this container suitable for search algorithms which
+ * run over and over again and should not stress the allocator.
+ *
+ * Items are addressed by their insertion index, which remains valid
+ * until Clear().
+ *
+ * #Hash and #KeyEqual may accept other key types than #T (in
+ * addition to #T itself), which allows heterogeneous lookups with
+ * Find().
+ */
+template<typename T, typename Hash=std::hash<T>,
+         typename KeyEqual=std::equal_to<T>>
+class FlatHashSet {
+  struct Item {
+    T value;
+
+    /**
+     * The position of this item in #slots.
+     */
+    uint32_t slot;
+
+    template<typename... Args>
+    Item(uint32_t _slot, Args&&... args) noexcept
+      :value(std::forward<Args>(args)...), slot(_slot) {}
+  };
+
+  std::vector<Item> items;
+
+  /**
+   * Indexes into #items.  A slot is occupied only if the item it
+   * refers to points back to it; this way, Clear() does not need to
+   * touch this array.  Its size is zero or a power of two.
+   */
+  std::vector<uint32_t> slots;
+
+  unsigned shift = 64;
+
+  [[no_unique_address]] Hash hash;
+  [[no_unique_address]] KeyEqual equal;
+
+public:
+  static constexpr std::size_t npos = ~std::size_t(0);
+
+  explicit FlatHashSet(std::size_t reserve=0) noexcept {
+    Reserve(reserve);
+  }
+
+  std::size_t size() const noexcept {
+    return items.size();
+  }
+
+  bool empty() const noexcept {
+    return items.empty();
+  }
+
+  const T &operator[](std::size_t i) const noexcept {
+    return items[i].value;
+  }
+
+  T &operator[](std::size_t i) noexcept {
+    return items[i].value;
+  }
+
+  /**
+   * Remove all items, but keep the allocated memory.
+   */
+  void Clear() noexcept {
+    items.clear();
+  }
+
+  void Reserve(std::size_t n) noexcept {
+    items.reserve(n);
+    if (n * 2 > slots.size())
+      Rehash(n * 2);
+  }
+
+  /**
+   * @return the index of the item or #npos if it was not found
+   */
+  template<typename K>
+  [[gnu::pure]]
+  std::size_t Find(const K &key) const noexcept {
+    if (slots.empty())
+      return npos;
+
+    const std::size_t mask = slots.size() - 1;
+    for (std::size_t pos = GetHome(key);; pos = (pos + 1) & mask) {
+      const std::size_t i = slots[pos];
+      if (!IsOccupied(pos, i))
+        return npos;
+
+      if (equal(items[i].value, key))
+        return i;
+    }
+  }
+
+  /**
+   * Insert a new item unless an equal one exists already.
+   *
+   * @return the index of the (new or existing) item and whether it
+   * was inserted
+   */
+  template<typename K, typename... Args>
+  std::pair<std::size_t, bool> Emplace(const K &key, Args&&... args) noexcept {
+    if ((items.size() + 1) * 2 > slots.size())
+      Rehash(slots.size() * 2);
+
+    const std::size_t mask = slots.size() - 1;
+    std::size_t pos = GetHome(key);
+    for (;; pos = (pos + 1) & mask) {
+      const std::size_t i = slots[pos];
+      if (!IsOccupied(pos, i))
+        break;
+
+      if (equal(items[i].value, key))
+        return {i, false};
+    }
+
+    const std::size_t i = items.size();
+    items.emplace_back(pos, std::forward<Args>(args)...);
+    slots[pos] = i;
+    return {i, true};
+  }
+
+  std::pair<std::size_t, bool> Insert(const T &value) noexcept {
+    return Emplace(value, value);
+  }
+
+private:
+  template<typename K>
+  [[gnu::pure]]
+  std::size_t GetHome(const K &key) const noexcept {
+    /* Fibonacci hashing: spreads the low-quality hashes of
+       coordinates over all slots */
+    return (uint64_t(hash(key)) * 0x9e3779b97f4a7c15ULL) >> shift;
+  }
+
+  [[gnu::pure]]
+  bool IsOccupied(std::size_t pos, std::size_t i) const noexcept {
+    return i < items.size() && items[i].slot == pos;
+  }
+
+  void Rehash(std::size_t n) noexcept {
+    std::size_t size = 64;
+    unsigned bits = 6;
+    while (size < n) {
+      size <<= 1;
+      ++bits;
+    }
+
+    slots.assign(size, 0);
+    shift = 64 - bits;
+
+    for (auto &i : items)
+      i.slot = UINT32_MAX;
+
+    const std::size_t mask = size - 1;
+    for (std::size_t i = 0; i < items.size(); ++i) {
+      std::size_t pos = GetHome(items[i].value);
+      while (IsOccupied(pos, slots[pos]))
+        pos = (pos + 1) & mask;
+
+      slots[pos] = i;
+      items[i].slot = pos;
+    }
+  }
+};
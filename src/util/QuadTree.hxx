@@ -3,9 +3,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <utility>
 #include <limits>
 #include <memory>
+#include <span>
 
 #include <cassert>
 
@@ -240,6 +243,75 @@ public:
 	}
 
 protected:
+	/**
+	 * A bounded max-heap of the values nearest to a location, used by
+	 * the k-nearest search.  It lives in a caller-provided buffer.
+	 */
+	class NearestHeap {
+		const Point location;
+		const std::span<T> buffer;
+		std::size_t size = 0;
+
+		/**
+		 * Values farther away than this are not interesting: the
+		 * search range, or the distance of the farthest value once the
+		 * buffer is full.
+		 */
+		distance_type square_range;
+
+	public:
+		constexpr NearestHeap(Point _location, std::span<T> _buffer,
+				      distance_type _square_range) noexcept
+			:location(_location), buffer(_buffer),
+			 square_range(_square_range) {}
+
+		constexpr distance_type GetSquareRange() const noexcept {
+			return square_range;
+		}
+
+		void Push(const T &value, distance_type square_distance) noexcept {
+			assert(square_distance <= square_range);
+
+			if (size < buffer.size()) {
+				buffer[size++] = value;
+				std::push_heap(buffer.begin(), buffer.begin() + size,
+					       Compare(location));
+			} else {
+				if (square_distance == square_range)
+					return;
+
+				std::pop_heap(buffer.begin(), buffer.end(),
+					      Compare(location));
+				buffer.back() = value;
+				std::push_heap(buffer.begin(), buffer.end(),
+					       Compare(location));
+			}
+
+			if (size == buffer.size())
+				square_range = GetPosition(buffer.front())
+					.SquareDistanceTo(location);
+		}
+
+		/**
+		 * Sort the values by increasing distance.
+		 *
+		 * @return the number of values
+		 */
+		std::size_t Finish() noexcept {
+			std::sort_heap(buffer.begin(), buffer.begin() + size,
+				       Compare(location));
+			return size;
+		}
+
+	private:
+		static constexpr auto Compare(Point location) noexcept {
+			return [location](const T &a, const T &b) noexcept {
+				return GetPosition(a).SquareDistanceTo(location) <
+					GetPosition(b).SquareDistanceTo(location);
+			};
+		}
+	};
+
 	/**
 	 * An envelope for a value object.
 	 */
@@ -429,6 +501,18 @@ protected:
 			return std::make_pair(nearest, nearest_square_distance);
 		}
 
+		template<class P>
+		void FindNearestN(const Point location, NearestHeap &heap,
+				  const P &predicate) const noexcept {
+			for (const Leaf *i = head; i != nullptr; i = i->next) {
+				const distance_type square_distance =
+					i->SquareDistanceTo(location);
+				if (square_distance <= heap.GetSquareRange() &&
+				    predicate(i->value))
+					heap.Push(i->value, square_distance);
+			}
+		}
+
 		template<class V>
 		void VisitWithinRange(const Point location, distance_type square_range,
 				      V &visitor) const {
@@ -724,6 +808,20 @@ protected:
 			}
 		}
 
+		template<class P>
+		void FindNearestN(const Rectangle &bounds, const Point location,
+				  NearestHeap &heap,
+				  const P &predicate) const noexcept {
+			if (!bounds.IsWithinSquareRange(location,
+							heap.GetSquareRange()))
+				return;
+
+			if (IsSplitted())
+				children->FindNearestN(bounds, location, heap, predicate);
+			else
+				leaves.FindNearestN(location, heap, predicate);
+		}
+
 		template<class V>
 		void VisitWithinRange(const Rectangle &bounds,
 				      const Point location, distance_type square_range,
@@ -867,6 +965,36 @@ protected:
 			return result;
 		}
 
+		template<class P>
+		void FindNearestN(const Rectangle &bounds, const Point location,
+				  NearestHeap &heap,
+				  const P &predicate) const noexcept {
+			const Point middle = bounds.GetMiddle();
+			const Rectangle children_bounds[N] = {
+				GetTopLeft(bounds, middle),
+				GetTopRight(bounds, middle),
+				GetBottomLeft(bounds, middle),
+				GetBottomRight(bounds, middle),
+			};
+
+			/* descend into the nearest child first, so the heap fills
+			   up quickly and the range shrinks early */
+			distance_type distances[N];
+			unsigned order[N];
+			for (unsigned i = 0; i < N; ++i) {
+				distances[i] = children_bounds[i].SquareDistanceTo(location);
+				order[i] = i;
+			}
+
+			std::sort(order, order + N, [&distances](unsigned a, unsigned b){
+				return distances[a] < distances[b];
+			});
+
+			for (const unsigned i : order)
+				buckets[i].FindNearestN(children_bounds[i], location,
+							heap, predicate);
+		}
+
 		template<class V>
 		void VisitWithinRange(const Rectangle &bounds,
 				      const Point location, distance_type square_range,
@@ -1372,6 +1500,34 @@ public:
 		return FindNearest(GetPosition(value), range);
 	}
 
+	/**
+	 * Find the values nearest to the specified location which match
+	 * the predicate, ordered by increasing distance.  This does not
+	 * allocate memory: the search uses the destination buffer as a
+	 * bounded max-heap.
+	 *
+	 * @param dest the buffer which receives the values; its size is
+	 * the maximum number of values to be found
+	 * @return the number of values which were copied to the
+	 * beginning of #dest
+	 */
+	template<class P>
+	std::size_t FindNearestIf(const Point location, distance_type range,
+				  std::span<T> dest,
+				  const P &predicate) const noexcept {
+		if (dest.empty())
+			return 0;
+
+		NearestHeap heap(location, dest, Square(range));
+		root.FindNearestN(bounds, location, heap, predicate);
+		return heap.Finish();
+	}
+
+	std::size_t FindNearest(const Point location, distance_type range,
+				std::span<T> dest) const noexcept {
+		return FindNearestIf(location, range, dest, AlwaysTrue());
+	}
+
 	template<class V>
 	void VisitWithinRange(const Point location, distance_type range,
 			      V &visitor) const {
@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Compare the query latency of an #Airspaces tree which was built by
+ * inserting the airspaces one by one with a tree which was
+ * bulk-loaded by Optimise().
+ */
+
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AirspaceIntersectionVisitor.hpp"
+#include "Geo/GeoVector.hpp"
+
+#include <chrono>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr unsigned N_QUERIES = 20000;
+
+/* a region roughly the size of central Europe */
+static constexpr GeoPoint south_west{Angle::Degrees(0), Angle::Degrees(42)};
+static constexpr GeoPoint north_east{Angle::Degrees(20), Angle::Degrees(55)};
+
+using Random = std::mt19937;
+
+static GeoPoint
+RandomLocation(Random &random)
+{
+  std::uniform_real_distribution<double> lon(south_west.longitude.Degrees(),
+                                             north_east.longitude.Degrees());
+  std::uniform_real_distribution<double> lat(south_west.latitude.Degrees(),
+                                             north_east.latitude.Degrees());
+  return {Angle::Degrees(lon(random)), Angle::Degrees(lat(random))};
+}
+
+static AirspacePtr
+RandomAirspace(Random &random)
+{
+  const GeoPoint center = RandomLocation(random);
+
+  if (std::uniform_int_distribution<unsigned>(0, 3)(random) == 0) {
+    std::uniform_real_distribution<double> radius(2000, 20000);
+    return std::make_shared<AirspaceCircle>(center, radius(random));
+  }
+
+  /* a star-shaped polygon around the center */
+  std::uniform_real_distribution<double> radius(5000, 50000);
+  const unsigned n = std::uniform_int_distribution<unsigned>(5, 30)(random);
+
+  std::vector<GeoPoint> points;
+  points.reserve(n);
+  for (unsigned i = 0; i < n; ++i)
+    points.push_back(GeoVector(radius(random),
+                               Angle::FullCircle() * i / n)
+                     .EndPoint(center));
+
+  return std::make_shared<AirspacePolygon>(points);
+}
+
+class CountingVisitor final : public AirspaceIntersectionVisitor {
+public:
+  unsigned count = 0;
+
+  void Visit(ConstAirspacePtr) noexcept override {
+    ++count;
+  }
+};
+
+template<typename F>
+static void
+Measure(const char *name, const Airspaces &incremental,
+        const Airspaces &packed, const std::vector<GeoPoint> &locations,
+        F &&f)
+{
+  unsigned long result[2] = {0, 0};
+  double duration[2];
+
+  const Airspaces *const trees[2] = {&incremental, &packed};
+  for (unsigned i = 0; i < 2; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto &location : locations)
+      result[i] += f(*trees[i], location);
+    const std::chrono::duration<double, std::micro> d =
+      std::chrono::steady_clock::now() - start;
+    duration[i] = d.count() / locations.size();
+  }
+
+  printf("%-18s incremental=%.2fus packed=%.2fus speedup=%.2f%s\n",
+         name, duration[0], duration[1], duration[0] / duration[1],
+         result[0] == result[1] ? "" : " MISMATCH");
+
+  if (result[0] != result[1])
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+  const unsigned n_airspaces = argc > 1 ? strtoul(argv[1], nullptr, 10)
+    : 10000;
+
+  Random random;
+
+  std::vector<AirspacePtr> airspaces;
+  airspaces.reserve(n_airspaces + 2);
+
+  /* the reference locations of these two airspaces span the whole
+     region (plus the polygon radius), so the projection doesn't
+     change while the others are added to the incremental tree (which
+     would rebuild it) */
+  const Angle margin = Angle::Degrees(1);
+  airspaces.push_back(std::make_shared<AirspaceCircle>(GeoPoint{
+        south_west.longitude - margin,
+        south_west.latitude - margin,
+      }, 1000));
+  airspaces.push_back(std::make_shared<AirspaceCircle>(GeoPoint{
+        north_east.longitude + margin,
+        north_east.latitude + margin,
+      }, 1000));
+
+  for (unsigned i = 0; i < n_airspaces; ++i)
+    airspaces.push_back(RandomAirspace(random));
+
+  Airspaces incremental, packed;
+
+  auto start = std::chrono::steady_clock::now();
+  incremental.Add(airspaces[0]);
+  incremental.Add(airspaces[1]);
+  incremental.Optimise();
+  for (auto i = std::next(airspaces.begin(), 2); i != airspaces.end(); ++i)
+    incremental.Add(*i);
+  incremental.Optimise();
+  const std::chrono::duration<double, std::milli> incremental_build =
+    std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (const auto &i : airspaces)
+    packed.Add(i);
+  packed.Optimise();
+  const std::chrono::duration<double, std::milli> packed_build =
+    std::chrono::steady_clock::now() - start;
+
+  printf("%-18s incremental=%.1fms packed=%.1fms (%u airspaces)\n",
+         "build", incremental_build.count(), packed_build.count(),
+         packed.GetSize());
+
+  std::vector<GeoPoint> locations;
+  locations.reserve(N_QUERIES);
+  for (unsigned i = 0; i < N_QUERIES; ++i)
+    locations.push_back(RandomLocation(random));
+
+  Measure("QueryWithinRange", incremental, packed, locations,
+          [](const Airspaces &airspaces, const GeoPoint &location){
+            const auto r = airspaces.QueryWithinRange(location, 20000);
+            return std::distance(r.begin(), r.end());
+          });
+
+  Measure("QueryInside", incremental, packed, locations,
+          [](const Airspaces &airspaces, const GeoPoint &location){
+            const auto r = airspaces.QueryInside(location);
+            return std::distance(r.begin(), r.end());
+          });
+
+  Measure("VisitIntersecting", incremental, packed, locations,
+          [](const Airspaces &airspaces, const GeoPoint &location){
+            CountingVisitor visitor;
+            airspaces.VisitIntersecting(location,
+                                        GeoVector(20000, Angle::Degrees(45))
+                                        .EndPoint(location),
+                                        visitor);
+            return visitor.count;
+          });
+
+  return EXIT_SUCCESS;
+}
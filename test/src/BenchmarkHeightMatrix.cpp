@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Measure how HeightMatrix::Fill() scales with the number of
+ * WorkerPool threads, and verify that all thread counts produce
+ * exactly the same matrix.
+ */
+
+#include "Terrain/RasterMap.hpp"
+#include "Terrain/HeightMatrix.hpp"
+#include "Terrain/Loader.hpp"
+#include "Operation/ConsoleOperationEnvironment.hpp"
+#include "Projection/WindowProjection.hpp"
+#include "Screen/Layout.hpp"
+#include "system/Args.hpp"
+#include "io/ZipArchive.hpp"
+#include "thread/WorkerPool.hpp"
+#include "util/PrintException.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <stdio.h>
+#include <string.h>
+
+unsigned Layout::scale_1024 = 1024;
+
+static constexpr unsigned ITERATIONS = 20;
+
+static void
+Fill(HeightMatrix &matrix, const RasterMap &map,
+     const WindowProjection &projection, WorkerPool *pool)
+{
+#ifdef ENABLE_OPENGL
+  matrix.Fill(map, projection.GetScreenBounds(),
+              projection.GetScreenSize().width,
+              projection.GetScreenSize().height,
+              true, pool);
+#else
+  matrix.Fill(map, projection, 1, true, pool);
+#endif
+}
+
+static bool
+IsEqual(const HeightMatrix &a, const HeightMatrix &b)
+{
+  return a.GetWidth() == b.GetWidth() && a.GetHeight() == b.GetHeight() &&
+    std::equal(a.GetData(), a.GetDataEnd(), b.GetData(),
+               [](TerrainHeight x, TerrainHeight y){
+                 return x.GetValue() == y.GetValue();
+               });
+}
+
+/**
+ * @return the duration of one Fill() call in microseconds
+ */
+static double
+Measure(HeightMatrix &matrix, const RasterMap &map,
+        const WindowProjection &projection, WorkerPool *pool)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < ITERATIONS; ++i)
+    Fill(matrix, map, projection, pool);
+  const std::chrono::duration<double, std::micro> duration =
+    std::chrono::steady_clock::now() - start;
+  return duration.count() / ITERATIONS;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH");
+  const auto map_path = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  ZipArchive archive(map_path);
+
+  RasterMap map;
+
+  {
+    ConsoleOperationEnvironment operation;
+    LoadTerrainOverview(archive.get(), map.GetTileCache(), operation);
+  }
+
+  map.UpdateProjection();
+
+  SharedMutex mutex;
+  do {
+    UpdateTerrainTiles(archive.get(), map.GetTileCache(), mutex,
+                       map.GetProjection(),
+                       map.GetMapCenter(), 50000);
+  } while (map.IsDirty());
+
+  double radius = 50000;
+  WindowProjection projection;
+  projection.SetScreenSize({640, 480});
+  projection.SetScaleFromRadius(radius);
+  projection.SetGeoLocation(map.GetMapCenter());
+  projection.SetScreenOrigin(320, 240);
+  projection.UpdateScreenBounds();
+
+  HeightMatrix reference;
+  const double serial = Measure(reference, map, projection, nullptr);
+  printf("threads=1 time=%.0fus speedup=1.00\n", serial);
+
+  /* at least 4, to verify the results even on a single-core machine */
+  const unsigned n_cores = std::max(std::thread::hardware_concurrency(), 4u);
+  bool success = true;
+  for (unsigned n_threads = 1; n_threads < n_cores; ++n_threads) {
+    WorkerPool pool(n_threads);
+
+    HeightMatrix matrix;
+    const double parallel = Measure(matrix, map, projection, &pool);
+    const bool equal = IsEqual(matrix, reference);
+    printf("threads=%u time=%.0fus speedup=%.2f%s\n",
+           pool.GetConcurrency(), parallel, serial / parallel,
+           equal ? "" : " MISMATCH");
+    success = success && equal;
+  }
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
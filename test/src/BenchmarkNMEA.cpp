@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Measures how fast NMEA lines are dispatched by a device driver and
+ * #NMEAParser, the way DeviceDescriptor::ParseNMEA() does it.
+ */
+
+#include "NMEA/Info.hpp"
+#include "NMEA/Checksum.hpp"
+#include "Device/Port/NullPort.hpp"
+#include "Device/Driver.hpp"
+#include "Device/Register.hpp"
+#include "Device/Parser.hpp"
+#include "Device/Config.hpp"
+#include "io/FileLineReader.hpp"
+#include "system/Args.hpp"
+#include "system/Path.hpp"
+#include "util/PrintException.hxx"
+#include "util/StringStrip.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static std::vector<std::string>
+LoadLines(Path path)
+{
+  std::vector<std::string> lines;
+
+  FileLineReaderA reader(path);
+  char *line;
+  while ((line = reader.ReadLine()) != nullptr) {
+    StripRight(line);
+    if (*line != 0)
+      lines.emplace_back(line);
+  }
+
+  return lines;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "FILE [DRIVER]");
+  const auto path = args.ExpectNextPath();
+  const char *driver_name = args.IsEmpty() ? nullptr : args.ExpectNext();
+  args.ExpectEnd();
+
+  const auto lines = LoadLines(path);
+  if (lines.empty()) {
+    fprintf(stderr, "No lines\n");
+    return EXIT_FAILURE;
+  }
+
+  DeviceConfig config;
+  config.Clear();
+
+  NullPort port;
+  std::unique_ptr<Device> device;
+  if (driver_name != nullptr) {
+    const DeviceRegister *driver = FindDriverByName(driver_name);
+    if (driver == nullptr) {
+      fprintf(stderr, "No such driver: %s\n", driver_name);
+      return EXIT_FAILURE;
+    }
+
+    if (driver->CreateOnPort != nullptr)
+      device.reset(driver->CreateOnPort(config, port));
+  }
+
+  NMEAParser parser;
+
+  NMEAInfo data;
+  data.Reset();
+
+  constexpr unsigned PASSES = 2000;
+  unsigned parsed = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for (unsigned pass = 0; pass < PASSES; ++pass) {
+    for (const auto &line : lines) {
+      /* the parsers may modify the line, work on a copy */
+      char buffer[256];
+      const std::size_t length = std::min(line.size(), sizeof(buffer) - 1);
+      std::copy_n(line.data(), length, buffer);
+      buffer[length] = 0;
+
+      const char *const asterisk = FindVerifiedNMEAChecksum(buffer);
+      if ((device != nullptr &&
+           device->ParseVerifiedNMEA(buffer, asterisk, data)) ||
+          parser.ParseLine(buffer, asterisk, data))
+        ++parsed;
+    }
+  }
+
+  const std::chrono::duration<double, std::nano> duration =
+    std::chrono::steady_clock::now() - start;
+  const std::size_t n = lines.size() * PASSES;
+
+  printf("lines=%zu parsed=%u time=%.0fms per_line=%.0fns\n",
+         n, parsed, duration.count() / 1e6, duration.count() / n);
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
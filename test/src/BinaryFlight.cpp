@@ -0,0 +1,304 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "BinaryFlight.hpp"
+#include "IGC/IGCParser.hpp"
+#include "IGC/IGCExtensions.hpp"
+#include "IGC/IGCFix.hpp"
+#include "io/LineReader.hpp"
+#include "io/OutputStream.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <string.h>
+
+using namespace BinaryFlight;
+
+static constexpr bool
+IsMidnightRollOver(int32_t previous, int32_t current) noexcept
+{
+  /* same rule as DebugReplayIGC::CopyFromFix() */
+  return previous >= 23 * 3600 && current < 3600;
+}
+
+static int32_t
+ToIGCUnits(Angle angle) noexcept
+{
+  return (int32_t)std::lround(angle.Degrees() * 60000);
+}
+
+/**
+ * Convert back exactly the way IGCParseLocation() does it, to get
+ * bit-identical results.
+ */
+static Angle
+FromIGCUnits(int32_t value) noexcept
+{
+  const uint32_t a = value < 0 ? -value : value;
+  Angle angle = Angle::Degrees(a / 60000 + (a % 60000) / 60000.);
+  if (value < 0)
+    angle.Flip();
+  return angle;
+}
+
+static void
+WriteDelta(std::vector<uint8_t> &dest, int32_t delta) noexcept
+{
+  /* zig-zag encoding: small negative values become small unsigned
+     values */
+  uint32_t u = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+
+  while (u >= 0x80) {
+    dest.push_back(uint8_t(u) | 0x80);
+    u >>= 7;
+  }
+
+  dest.push_back(uint8_t(u));
+}
+
+static int32_t
+ReadDelta(const uint8_t *&p, const uint8_t *end)
+{
+  uint32_t u = 0;
+  for (unsigned shift = 0;; shift += 7) {
+    if (p == end || shift > 28)
+      throw std::runtime_error("Malformed binary flight column");
+
+    const uint8_t b = *p++;
+    u |= uint32_t(b & 0x7f) << shift;
+    if ((b & 0x80) == 0)
+      break;
+  }
+
+  return int32_t(u >> 1) ^ -int32_t(u & 1);
+}
+
+void
+BinaryFlightWriter::Append(const IGCFix &fix) noexcept
+{
+  const std::array<int32_t, N_COLUMNS> row{
+    (int32_t)fix.time.GetSecondOfDay(),
+    ToIGCUnits(fix.location.latitude),
+    ToIGCUnits(fix.location.longitude),
+    fix.gps_valid,
+    fix.gps_altitude,
+    fix.pressure_altitude,
+    fix.enl,
+    fix.rpm,
+    fix.hdm,
+    fix.hdt,
+    fix.trm,
+    fix.trt,
+    fix.gsp,
+    fix.ias,
+    fix.tas,
+    fix.siu,
+  };
+
+  if (n_fixes > 0 && IsMidnightRollOver(value[TIME], row[TIME]))
+    ++days;
+
+  if (n_fixes % INDEX_INTERVAL == 0) {
+    IndexEntry &entry = index.emplace_back();
+    entry.fix = n_fixes;
+    entry.time = days * 24 * 3600 + row[TIME];
+    /* the roll-over (if any) is repeated by the reader */
+    entry.days = n_fixes > 0 && IsMidnightRollOver(value[TIME], row[TIME])
+      ? days - 1
+      : days;
+    for (unsigned i = 0; i < N_COLUMNS; ++i)
+      entry.position[i] = columns[i].size();
+    entry.value = value;
+  }
+
+  for (unsigned i = 0; i < N_COLUMNS; ++i) {
+    WriteDelta(columns[i], row[i] - value[i]);
+    if (i >= ENL && row[i] >= 0)
+      column_mask |= 1u << i;
+  }
+
+  value = row;
+  ++n_fixes;
+}
+
+void
+BinaryFlightWriter::AppendIGC(NLineReader &reader)
+{
+  IGCExtensions extensions;
+  extensions.clear();
+
+  char *line;
+  while ((line = reader.ReadLine()) != nullptr) {
+    if (line[0] == 'B') {
+      IGCFix fix;
+      if (IGCParseFix(line, extensions, fix))
+        Append(fix);
+    } else if (line[0] == 'H') {
+      BrokenDate _date;
+      if (memcmp(line, "HFDTE", 5) == 0 &&
+          IGCParseDateRecord(line, _date))
+        SetDate(_date);
+    } else if (line[0] == 'I') {
+      IGCParseExtensions(line, extensions);
+    }
+  }
+}
+
+void
+BinaryFlightWriter::Write(OutputStream &os) const
+{
+  Header header{};
+  header.magic = MAGIC;
+  header.version = VERSION;
+  header.columns = column_mask;
+  if (date.IsPlausible()) {
+    header.year = date.year;
+    header.month = date.month;
+    header.day = date.day;
+  }
+
+  header.n_fixes = n_fixes;
+  header.n_index = index.size();
+
+  for (unsigned i = 0; i < N_COLUMNS; ++i)
+    if (column_mask & (1u << i))
+      header.column_size[i] = columns[i].size();
+
+  os.Write(&header, sizeof(header));
+  os.Write(index.data(), index.size() * sizeof(index.front()));
+
+  for (unsigned i = 0; i < N_COLUMNS; ++i)
+    if (column_mask & (1u << i))
+      os.Write(columns[i].data(), columns[i].size());
+}
+
+static const Header &
+CheckHeader(std::span<const std::byte> data)
+{
+  if (data.size() < sizeof(Header) ||
+      (uintptr_t)data.data() % alignof(Header) != 0)
+    throw std::runtime_error("Not a binary flight file");
+
+  const Header &header = *(const Header *)data.data();
+  if (header.magic != MAGIC)
+    throw std::runtime_error("Not a binary flight file");
+
+  if (header.version != VERSION)
+    throw std::runtime_error("Unsupported binary flight version");
+
+  if ((header.columns & REQUIRED_COLUMNS) != REQUIRED_COLUMNS)
+    throw std::runtime_error("Malformed binary flight file");
+
+  return header;
+}
+
+BinaryFlightReader::BinaryFlightReader(std::span<const std::byte> data)
+  :header(CheckHeader(data))
+{
+  data = data.subspan(sizeof(header));
+
+  if (header.n_index != (header.n_fixes + INDEX_INTERVAL - 1) / INDEX_INTERVAL ||
+      data.size() < header.n_index * sizeof(IndexEntry))
+    throw std::runtime_error("Malformed binary flight file");
+
+  index = {(const IndexEntry *)data.data(), header.n_index};
+  data = data.subspan(index.size_bytes());
+
+  for (unsigned i = 0; i < N_COLUMNS; ++i) {
+    const std::size_t size = header.column_size[i];
+    if (data.size() < size)
+      throw std::runtime_error("Malformed binary flight file");
+
+    begin[i] = (const uint8_t *)data.data();
+    end[i] = begin[i] + size;
+    data = data.subspan(size);
+
+    for (const auto &entry : index)
+      if ((header.columns & (1u << i)) && entry.position[i] > size)
+        throw std::runtime_error("Malformed binary flight index");
+  }
+
+  cursor.fix = cursor.days = 0;
+  cursor.position = begin;
+  cursor.value.fill(0);
+}
+
+void
+BinaryFlightReader::Load(const IndexEntry &entry) noexcept
+{
+  cursor.fix = entry.fix;
+  cursor.days = entry.days;
+  for (unsigned i = 0; i < N_COLUMNS; ++i)
+    cursor.position[i] = begin[i] + entry.position[i];
+  cursor.value = entry.value;
+}
+
+bool
+BinaryFlightReader::Read(IGCFix &fix)
+{
+  if (cursor.fix >= header.n_fixes)
+    return false;
+
+  const int32_t previous_time = cursor.value[TIME];
+
+  for (unsigned i = 0; i < N_COLUMNS; ++i) {
+    if (header.columns & (1u << i))
+      cursor.value[i] += ReadDelta(cursor.position[i], end[i]);
+    else
+      cursor.value[i] = -1;
+  }
+
+  if (cursor.fix > 0 && IsMidnightRollOver(previous_time, cursor.value[TIME]))
+    ++cursor.days;
+
+  ++cursor.fix;
+
+  const auto &v = cursor.value;
+  fix.time = BrokenTime::FromSecondOfDayChecked(v[TIME]);
+  fix.location = GeoPoint(FromIGCUnits(v[LONGITUDE]),
+                          FromIGCUnits(v[LATITUDE]));
+  fix.gps_valid = v[GPS_VALID] != 0;
+  fix.gps_altitude = v[GPS_ALTITUDE];
+  fix.pressure_altitude = v[PRESSURE_ALTITUDE];
+  fix.enl = v[ENL];
+  fix.rpm = v[RPM];
+  fix.hdm = v[HDM];
+  fix.hdt = v[HDT];
+  fix.trm = v[TRM];
+  fix.trt = v[TRT];
+  fix.gsp = v[GSP];
+  fix.ias = v[IAS];
+  fix.tas = v[TAS];
+  fix.siu = v[SIU];
+  return true;
+}
+
+void
+BinaryFlightReader::Seek(std::chrono::seconds time)
+{
+  /* find the last index entry not later than the given time */
+  const auto i = std::upper_bound(index.begin(), index.end(), time,
+                                  [](std::chrono::seconds t,
+                                     const IndexEntry &entry){
+                                    return t.count() < (long)entry.time;
+                                  });
+  if (i == index.begin()) {
+    cursor.fix = cursor.days = 0;
+    cursor.position = begin;
+    cursor.value.fill(0);
+    return;
+  }
+
+  Load(*std::prev(i));
+
+  /* decode up to the requested fix */
+  IGCFix fix;
+  for (Cursor saved = cursor; Read(fix); saved = cursor) {
+    if (cursor.days * 24 * 3600 + cursor.value[TIME] >= time.count()) {
+      cursor = saved;
+      break;
+    }
+  }
+}
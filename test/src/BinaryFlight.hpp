@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "time/BrokenDate.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct IGCFix;
+class NLineReader;
+class OutputStream;
+
+/**
+ * A compact columnar flight recording format for fast replays
+ * (see #DebugReplayBinary).
+ *
+ * Each IGC fix attribute is stored in its own column as a stream of
+ * zig-zag/LEB128 encoded deltas to the previous fix.  Extension
+ * columns which are undefined for all fixes are omitted.  An index
+ * with the decoder state of every #INDEX_INTERVAL fixes allows
+ * seeking by time without decoding the whole file.
+ *
+ * The file is written in host byte order; it is meant to be a
+ * local cache, not an exchange format.
+ */
+namespace BinaryFlight {
+
+static constexpr uint32_t MAGIC = 0x31464258; // "XBF1"
+static constexpr uint16_t VERSION = 1;
+
+static constexpr unsigned INDEX_INTERVAL = 256;
+
+enum Column : unsigned {
+  /**
+   * Second of day, as found in the IGC file.
+   */
+  TIME,
+
+  /**
+   * Latitude/longitude in 1/60000 degrees (i.e. the IGC resolution
+   * of 1/1000 minutes).
+   */
+  LATITUDE,
+  LONGITUDE,
+
+  GPS_VALID,
+  GPS_ALTITUDE,
+  PRESSURE_ALTITUDE,
+
+  /* IGC extensions; -1 means undefined */
+  ENL,
+  RPM,
+  HDM,
+  HDT,
+  TRM,
+  TRT,
+  GSP,
+  IAS,
+  TAS,
+  SIU,
+
+  N_COLUMNS
+};
+
+static constexpr uint16_t REQUIRED_COLUMNS = (1u << ENL) - 1;
+
+struct Header {
+  uint32_t magic;
+  uint16_t version;
+
+  /**
+   * A bit mask of the columns present in this file.
+   */
+  uint16_t columns;
+
+  /**
+   * The date from the first "HFDTE" record; all zero if there was
+   * none.
+   */
+  uint16_t year;
+  uint8_t month, day;
+
+  uint32_t n_fixes;
+  uint32_t n_index;
+
+  /**
+   * The size of each column in bytes (zero for absent columns).
+   * The columns follow the index in this order.
+   */
+  std::array<uint32_t, N_COLUMNS> column_size;
+};
+
+/**
+ * The decoder state before decoding fix number #fix.
+ */
+struct IndexEntry {
+  uint32_t fix;
+
+  /**
+   * The time of fix #fix in seconds since midnight of the first
+   * day (i.e. including midnight roll-overs).
+   */
+  uint32_t time;
+
+  /**
+   * The number of midnight roll-overs before fix #fix.
+   */
+  uint32_t days;
+
+  /**
+   * Byte positions relative to the start of each column.
+   */
+  std::array<uint32_t, N_COLUMNS> position;
+
+  /**
+   * The value of the previous fix (the base of the next delta).
+   */
+  std::array<int32_t, N_COLUMNS> value;
+};
+
+} // namespace BinaryFlight
+
+/**
+ * Builds a #BinaryFlight file in memory.
+ */
+class BinaryFlightWriter {
+  BrokenDate date = BrokenDate::Invalid();
+
+  std::array<std::vector<uint8_t>, BinaryFlight::N_COLUMNS> columns;
+  std::array<int32_t, BinaryFlight::N_COLUMNS> value{};
+
+  std::vector<BinaryFlight::IndexEntry> index;
+
+  unsigned n_fixes = 0, days = 0;
+
+  uint16_t column_mask = BinaryFlight::REQUIRED_COLUMNS;
+
+public:
+  /**
+   * Set the date of the first fix.  Only the first call has an
+   * effect.
+   */
+  void SetDate(const BrokenDate &_date) noexcept {
+    if (!date.IsPlausible())
+      date = _date;
+  }
+
+  void Append(const IGCFix &fix) noexcept;
+
+  /**
+   * Parse all fixes from an IGC file.
+   */
+  void AppendIGC(NLineReader &reader);
+
+  /**
+   * Throws on error.
+   */
+  void Write(OutputStream &os) const;
+};
+
+/**
+ * Decodes a #BinaryFlight file, e.g. from a #FileMapping.  The
+ * caller is responsible for keeping the memory alive.
+ */
+class BinaryFlightReader {
+  const BinaryFlight::Header &header;
+  std::span<const BinaryFlight::IndexEntry> index;
+
+  std::array<const uint8_t *, BinaryFlight::N_COLUMNS> begin, end;
+
+  struct Cursor {
+    unsigned fix, days;
+    std::array<const uint8_t *, BinaryFlight::N_COLUMNS> position;
+    std::array<int32_t, BinaryFlight::N_COLUMNS> value;
+  } cursor;
+
+public:
+  /**
+   * Throws on error.
+   */
+  explicit BinaryFlightReader(std::span<const std::byte> data);
+
+  BrokenDate GetDate() const noexcept {
+    return header.year > 0
+      ? BrokenDate(header.year, header.month, header.day)
+      : BrokenDate::Invalid();
+  }
+
+  unsigned GetSize() const noexcept {
+    return header.n_fixes;
+  }
+
+  /**
+   * The number of the fix which will be returned by the next Read()
+   * call.
+   */
+  unsigned Tell() const noexcept {
+    return cursor.fix;
+  }
+
+  /**
+   * The number of midnight roll-overs before the next fix.
+   */
+  unsigned GetDays() const noexcept {
+    return cursor.days;
+  }
+
+  /**
+   * Decode the next fix.
+   *
+   * Throws on error.
+   *
+   * @return false at the end of the file
+   */
+  bool Read(IGCFix &fix);
+
+  /**
+   * Position the reader at the first fix whose time (including
+   * midnight roll-overs, see IndexEntry::time) is not earlier than
+   * the given one, or at the end of the file.
+   *
+   * Throws on error.
+   */
+  void Seek(std::chrono::seconds time);
+
+private:
+  void Load(const BinaryFlight::IndexEntry &entry) noexcept;
+};
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Converts the topography of a map file to the #TiledTopography
+ * format.  XCSoar uses the output file instead of the shapefiles if
+ * it is placed next to the map file with the suffix ".xtt".
+ *
+ * Build this program with OpenGL to include the thinned lines and
+ * triangulated polygons.
+ */
+
+#include "Topography/TiledTopographyWriter.hpp"
+#include "Topography/TopographyFile.hpp"
+#include "Topography/Index.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/ZipArchive.hpp"
+#include "io/ZipLineReader.hpp"
+#include "system/Args.hpp"
+#include "util/PrintException.hxx"
+
+#include <zzip/zzip.h>
+
+#include <stdexcept>
+#include <string>
+
+#include <stdlib.h>
+
+static void
+AddLayers(TiledTopographyWriter &writer, ZipArchive &archive)
+{
+  ZipLineReaderA reader(archive.get(), "topology.tpl");
+  while (char *line = reader.ReadLine()) {
+    const auto entry = ParseTopographyIndexLine(line);
+    if (!entry)
+      continue;
+
+    const std::string shape_filename = std::string{entry->name} + ".shp";
+
+    ZZIP_STAT st;
+    if (zzip_dir_stat(archive.get(), shape_filename.c_str(), &st, 0) != 0)
+      throw std::runtime_error{"Shapefile not found: " + shape_filename};
+
+    TopographyFile file(archive.get(), shape_filename.c_str(),
+                        entry->shape_range,
+                        entry->label_range,
+                        entry->important_label_range,
+                        entry->color,
+                        entry->shape_field,
+                        entry->icon, entry->big_icon,
+                        entry->pen_width);
+    file.LoadAll();
+
+    writer.AddLayer(entry->name, st.st_size, file);
+  }
+}
+
+int
+main(int argc, char **argv) noexcept
+try {
+  Args args(argc, argv, "FILE.xcm OUTFILE.xtt");
+  const auto map_file = args.ExpectNextPath();
+  const auto output_file = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  TiledTopographyWriter writer;
+
+  {
+    ZipArchive archive(map_file);
+    AddLayers(writer, archive);
+  }
+
+  FileOutputStream fos{output_file};
+  writer.Write(fos);
+  fos.Commit();
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -4,6 +4,7 @@
 #include "DebugReplay.hpp"
 #include "DebugReplayIGC.hpp"
 #include "DebugReplayNMEA.hpp"
+#include "DebugReplayBinary.hpp"
 #include "system/Args.hpp"
 #include "system/PathName.hpp"
 #include "Computer/Settings.hpp"
@@ -51,6 +52,9 @@ CreateDebugReplay(Args &args)
 
   if (!args.IsEmpty() && StringEndsWithIgnoreCase(args.PeekNext(), ".igc")) {
     replay = DebugReplayIGC::Create(args.ExpectNextPath());
+  } else if (!args.IsEmpty() &&
+             StringEndsWithIgnoreCase(args.PeekNext(), ".xbf")) {
+    replay = DebugReplayBinary::Create(args.ExpectNextPath());
   } else {
     const auto driver_name = args.ExpectNextT();
     const auto input_file = args.ExpectNextPath();
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "DebugReplayBinary.hpp"
+#include "DebugReplayIGC.hpp"
+#include "IGC/IGCFix.hpp"
+#include "system/FileMapping.hpp"
+#include "system/Path.hpp"
+
+DebugReplayBinary::DebugReplayBinary(std::unique_ptr<FileMapping> &&_mapping)
+  :mapping(std::move(_mapping)), reader(*mapping)
+{
+  ResetDate();
+}
+
+DebugReplayBinary::~DebugReplayBinary() = default;
+
+DebugReplay *
+DebugReplayBinary::Create(Path input_file)
+{
+  return new DebugReplayBinary(std::make_unique<FileMapping>(input_file));
+}
+
+void
+DebugReplayBinary::ResetDate() noexcept
+{
+  BrokenDate date = reader.GetDate();
+  if (date.IsPlausible())
+    for (unsigned i = reader.GetDays(); i > 0; --i)
+      date.IncrementDay();
+
+  (BrokenDate &)raw_basic.date_time_utc = date;
+  raw_basic.time_available.Clear();
+}
+
+bool
+DebugReplayBinary::Next()
+{
+  last_basic = computed_basic;
+
+  IGCFix fix;
+  if (!reader.Read(fix)) {
+    if (computed_basic.time_available)
+      flying_computer.Finish(calculated.flight, computed_basic.time);
+
+    return false;
+  }
+
+  DebugReplayIGC::CopyFromFix(raw_basic, fix);
+  Compute();
+  return true;
+}
+
+void
+DebugReplayBinary::Seek(TimeStamp time)
+{
+  reader.Seek(time.Cast<std::chrono::seconds>());
+
+  raw_basic.Reset();
+  computed_basic.Reset();
+  last_basic.Reset();
+  calculated.Reset();
+  flying_computer.Reset();
+  wrap_clock.Reset();
+
+  ResetDate();
+
+  /* let the #WrapClock see the midnight roll-overs before the new
+     position, so the normalised time stamps continue to count from
+     the first day */
+  const BrokenTime before_midnight(23, 59, 59), midnight(0, 0, 0);
+  BrokenDate date = reader.GetDate();
+  for (unsigned i = reader.GetDays(); i > 0; --i) {
+    wrap_clock.Normalise(TimeStamp{before_midnight.DurationSinceMidnight()},
+                         date, before_midnight);
+    wrap_clock.Normalise(TimeStamp{midnight.DurationSinceMidnight()},
+                         date, midnight);
+  }
+}
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "DebugReplay.hpp"
+#include "BinaryFlight.hpp"
+
+#include <memory>
+
+class FileMapping;
+class Path;
+
+/**
+ * Replays a #BinaryFlight file, which is mapped into memory.  This
+ * is a lot faster than parsing the IGC file again and again, and
+ * allows seeking.
+ */
+class DebugReplayBinary : public DebugReplay {
+  std::unique_ptr<FileMapping> mapping;
+
+  BinaryFlightReader reader;
+
+private:
+  explicit DebugReplayBinary(std::unique_ptr<FileMapping> &&_mapping);
+
+public:
+  ~DebugReplayBinary() override;
+
+  long Size() const override {
+    return reader.GetSize();
+  }
+
+  long Tell() const override {
+    return reader.Tell();
+  }
+
+  bool Next() override;
+
+  /**
+   * Skip to the first fix not earlier than the given (normalised)
+   * time.  The computer state is reset, just like at the start of
+   * a new replay.
+   */
+  void Seek(TimeStamp time);
+
+  /**
+   * Throws on error.
+   */
+  static DebugReplay *Create(Path input_file);
+
+private:
+  void ResetDate() noexcept;
+};
@@ -25,7 +25,7 @@ DebugReplayIGC::Next()
     if (line[0] == 'B') {
       IGCFix fix;
       if (IGCParseFix(line, extensions, fix)) {
-        CopyFromFix(fix);
+        CopyFromFix(raw_basic, fix);
 
         Compute();
         return true;
@@ -49,14 +49,12 @@ DebugReplayIGC::Next()
 }
 
 void
-DebugReplayIGC::CopyFromFix(const IGCFix &fix)
+DebugReplayIGC::CopyFromFix(NMEAInfo &basic, const IGCFix &fix) noexcept
 {
-  NMEAInfo &basic = raw_basic;
-
   if (basic.time_available && basic.date_time_utc.hour >= 23 &&
       fix.time.hour == 0) {
     /* midnight roll-over */
-    raw_basic.date_time_utc.IncrementDay();
+    basic.date_time_utc.IncrementDay();
   }
 
   basic.clock = basic.time = TimeStamp{fix.time.DurationSinceMidnight()};
@@ -23,6 +23,9 @@ public:
 
   static DebugReplay *Create(Path input_file);
 
-protected:
-  void CopyFromFix(const IGCFix &fix);
+  /**
+   * Copy the IGC fix into the #NMEAInfo, the way the IGC replay
+   * does it.
+   */
+  static void CopyFromFix(NMEAInfo &basic, const IGCFix &fix) noexcept;
 };
@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Converts an IGC file to the #BinaryFlight format, which can be
+ * replayed quickly by all programs using CreateDebugReplay().
+ */
+
+#include "BinaryFlight.hpp"
+#include "io/FileLineReader.hpp"
+#include "io/FileOutputStream.hxx"
+#include "system/Args.hpp"
+#include "util/PrintException.hxx"
+
+#include <stdlib.h>
+
+int
+main(int argc, char **argv) noexcept
+try {
+  Args args(argc, argv, "INFILE.igc OUTFILE.xbf");
+  const auto input_file = args.ExpectNextPath();
+  const auto output_file = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  BinaryFlightWriter writer;
+
+  {
+    FileLineReaderA reader(input_file);
+    writer.AppendIGC(reader);
+  }
+
+  FileOutputStream fos{output_file};
+  writer.Write(fos);
+  fos.Commit();
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
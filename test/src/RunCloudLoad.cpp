@@ -0,0 +1,551 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * A load generator for xcsoar-cloud-server.  It simulates many
+ * clients, each with its own UDP socket, which send fixes, traffic
+ * requests and thermal submissions at a fixed rate, and reports the
+ * throughput, the response latency and the number of lost packets.
+ *
+ * The latency is measured with #PING packets which are sent after
+ * the other packets of each tick: the #ACK is the only response which
+ * can be attributed to a request, because the server also pushes
+ * unsolicited #TRAFFIC_RESPONSE packets.  Since the server handles
+ * each client's packets in order, a #PING waits behind the requests
+ * sent before it.
+ */
+
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "Tracking/SkyLines/Assemble.hpp"
+#include "Tracking/SkyLines/Server.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "net/Resolver.hxx"
+#include "net/AddressInfo.hxx"
+#include "net/UniqueSocketDescriptor.hxx"
+#include "net/SocketError.hxx"
+#include "event/Loop.hxx"
+#include "event/SocketEvent.hxx"
+#include "event/FineTimerEvent.hxx"
+#include "system/Args.hpp"
+#include "util/ByteOrder.hxx"
+#include "util/NumberParser.hpp"
+#include "util/PrintException.hxx"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+
+using namespace std::chrono;
+
+/**
+ * Send a traffic request every this many ticks.
+ */
+static constexpr unsigned TRAFFIC_REQUEST_TICKS = 5;
+
+/**
+ * Submit a thermal every this many ticks.
+ */
+static constexpr unsigned THERMAL_SUBMIT_TICKS = 30;
+
+/**
+ * How long to wait for responses after the last packet was sent?
+ */
+static constexpr auto DRAIN_TIME = seconds(2);
+
+/**
+ * The clients are distributed randomly in a square of this size
+ * (in degrees) around #CENTER, so most of them are within the
+ * server's traffic range of each other.
+ */
+static constexpr double AREA_SIZE = 0.8;
+
+static constexpr GeoPoint CENTER{Angle::Degrees(11), Angle::Degrees(47)};
+
+struct LoadStats {
+  uint64_t sent_fixes = 0, sent_traffic_requests = 0;
+  uint64_t sent_thermals = 0, sent_pings = 0;
+  uint64_t send_errors = 0;
+
+  uint64_t received_acks = 0;
+  uint64_t received_traffic_responses = 0, received_traffic = 0;
+  uint64_t received_other = 0, received_malformed = 0;
+
+  /**
+   * The round-trip time of each acknowledged #PING [microseconds].
+   */
+  std::vector<uint32_t> latencies;
+
+  uint64_t GetSent() const noexcept {
+    return sent_fixes + sent_traffic_requests + sent_thermals + sent_pings;
+  }
+
+  uint64_t GetReceived() const noexcept {
+    return received_acks + received_traffic_responses +
+      received_other + received_malformed;
+  }
+};
+
+/**
+ * One simulated client with its own socket.
+ */
+class LoadClient {
+  const uint64_t key;
+
+  LoadStats &stats;
+
+  SocketEvent socket;
+
+  GeoPoint location;
+
+  int altitude;
+
+  unsigned tick = 0;
+
+  uint16_t next_ping_id = 0;
+
+  /**
+   * The #PING packets which have not yet been acknowledged, indexed
+   * by their id modulo the array size.  An #ACK which arrives after
+   * the slot was reused is ignored, i.e. the #PING counts as lost.
+   */
+  struct PendingPing {
+    steady_clock::time_point time;
+    uint16_t id;
+    bool pending = false;
+  };
+
+  std::array<PendingPing, 64> pings;
+
+public:
+  /**
+   * Throws on error.
+   */
+  LoadClient(EventLoop &event_loop, SocketAddress server_address,
+             uint64_t _key, GeoPoint _location, LoadStats &_stats)
+    :key(_key), stats(_stats),
+     socket(event_loop, BIND_THIS_METHOD(OnSocketReady)),
+     location(_location), altitude(1000 + int(_key % 1000))
+  {
+    UniqueSocketDescriptor fd;
+    if (!fd.CreateNonBlock(server_address.GetFamily(), SOCK_DGRAM, 0))
+      throw MakeSocketError("Failed to create socket");
+
+    if (!fd.Connect(server_address))
+      throw MakeSocketError("Failed to connect");
+
+    socket.Open(fd.Release());
+    socket.ScheduleRead();
+  }
+
+  ~LoadClient() noexcept {
+    socket.Close();
+  }
+
+  /**
+   * Send this tick's packets.
+   */
+  void Tick() noexcept;
+
+private:
+  template<typename P>
+  void Send(const P &packet, uint64_t &counter) noexcept {
+    if (socket.GetSocket().Write(&packet, sizeof(packet)) < 0)
+      ++stats.send_errors;
+    else
+      ++counter;
+  }
+
+  void SendPing() noexcept;
+
+  void OnAck(const SkyLinesTracking::ACKPacket &packet) noexcept;
+
+  void OnDatagram(const std::byte *data, std::size_t size) noexcept;
+
+  void OnSocketReady(unsigned events) noexcept;
+};
+
+void
+LoadClient::Tick() noexcept
+{
+  /* fly north at roughly 80 km/h */
+  location.latitude += Angle::Degrees(0.0002);
+
+  Send(SkyLinesTracking::MakeFix(key,
+                                 SkyLinesTracking::FixPacket::FLAG_LOCATION |
+                                 SkyLinesTracking::FixPacket::FLAG_ALTITUDE,
+                                 0, location, Angle::Zero(), 22, 22,
+                                 altitude, 1, 0),
+       stats.sent_fixes);
+
+  /* the first tick only registers the client */
+  if (tick % TRAFFIC_REQUEST_TICKS == TRAFFIC_REQUEST_TICKS - 1)
+    Send(SkyLinesTracking::MakeTrafficRequest(key, false, false, true),
+         stats.sent_traffic_requests);
+
+  if (tick % THERMAL_SUBMIT_TICKS == THERMAL_SUBMIT_TICKS - 1) {
+    const GeoPoint bottom(location.longitude,
+                          location.latitude - Angle::Degrees(0.005));
+    Send(SkyLinesTracking::MakeThermalSubmit(key, 0,
+                                             bottom, altitude - 500,
+                                             location, altitude,
+                                             2.5),
+         stats.sent_thermals);
+  }
+
+  SendPing();
+
+  ++tick;
+}
+
+void
+LoadClient::SendPing() noexcept
+{
+  const uint16_t id = next_ping_id++;
+  const auto packet = SkyLinesTracking::MakePing(key, id);
+  if (socket.GetSocket().Write(&packet, sizeof(packet)) < 0) {
+    ++stats.send_errors;
+    return;
+  }
+
+  ++stats.sent_pings;
+
+  auto &p = pings[id % pings.size()];
+  p.time = steady_clock::now();
+  p.id = id;
+  p.pending = true;
+}
+
+void
+LoadClient::OnAck(const SkyLinesTracking::ACKPacket &packet) noexcept
+{
+  const uint16_t id = FromBE16(packet.id);
+  auto &p = pings[id % pings.size()];
+  if (!p.pending || p.id != id)
+    /* too late, the slot was already reused */
+    return;
+
+  p.pending = false;
+  ++stats.received_acks;
+
+  const auto latency = steady_clock::now() - p.time;
+  stats.latencies.push_back(duration_cast<microseconds>(latency).count());
+}
+
+void
+LoadClient::OnDatagram(const std::byte *data, std::size_t size) noexcept
+{
+  using namespace SkyLinesTracking;
+
+  if (size < sizeof(Header)) {
+    ++stats.received_malformed;
+    return;
+  }
+
+  const auto &header = *(const Header *)data;
+  if (FromBE32(header.magic) != MAGIC) {
+    ++stats.received_malformed;
+    return;
+  }
+
+  switch (FromBE16(header.type)) {
+  case ACK:
+    if (size < sizeof(ACKPacket)) {
+      ++stats.received_malformed;
+      return;
+    }
+
+    OnAck(*(const ACKPacket *)data);
+    break;
+
+  case TRAFFIC_RESPONSE:
+    if (size < sizeof(TrafficResponsePacket)) {
+      ++stats.received_malformed;
+      return;
+    }
+
+    ++stats.received_traffic_responses;
+    stats.received_traffic +=
+      ((const TrafficResponsePacket *)data)->traffic_count;
+    break;
+
+  default:
+    ++stats.received_other;
+    break;
+  }
+}
+
+void
+LoadClient::OnSocketReady(unsigned) noexcept
+{
+  /* uint64_t for proper alignment of the packet structs */
+  uint64_t buffer[4096 / sizeof(uint64_t)];
+
+  while (true) {
+    const auto nbytes = socket.GetSocket().Read(buffer, sizeof(buffer));
+    if (nbytes <= 0)
+      break;
+
+    OnDatagram((const std::byte *)buffer, nbytes);
+  }
+}
+
+/**
+ * Calls LoadClient::Tick() for all clients, evenly spread over the
+ * interval.
+ */
+class LoadGenerator {
+  EventLoop &event_loop;
+
+  const std::vector<std::unique_ptr<LoadClient>> &clients;
+
+  const steady_clock::duration interval;
+
+  const steady_clock::time_point start_time, end_time;
+
+  /**
+   * The number of LoadClient::Tick() calls so far.
+   */
+  uint64_t n_ticks = 0;
+
+  FineTimerEvent send_timer{event_loop, BIND_THIS_METHOD(OnSendTimer)};
+  FineTimerEvent stop_timer{event_loop, BIND_THIS_METHOD(OnStopTimer)};
+
+public:
+  LoadGenerator(EventLoop &_event_loop,
+                const std::vector<std::unique_ptr<LoadClient>> &_clients,
+                steady_clock::duration _interval,
+                steady_clock::duration duration) noexcept
+    :event_loop(_event_loop), clients(_clients), interval(_interval),
+     start_time(steady_clock::now()), end_time(start_time + duration) {
+    send_timer.Schedule({});
+  }
+
+  steady_clock::duration GetSendDuration() const noexcept {
+    return end_time - start_time;
+  }
+
+private:
+  steady_clock::time_point GetTickTime(uint64_t i) const noexcept {
+    return start_time + duration_cast<steady_clock::duration>(interval * (double(i) / clients.size()));
+  }
+
+  void OnSendTimer() noexcept {
+    const auto now = steady_clock::now();
+
+    /* catch up if the timer was late */
+    steady_clock::time_point next;
+    while ((next = GetTickTime(n_ticks)) <= now && next < end_time)
+      clients[n_ticks++ % clients.size()]->Tick();
+
+    if (next >= end_time)
+      stop_timer.Schedule(DRAIN_TIME);
+    else
+      send_timer.Schedule(next - now);
+  }
+
+  void OnStopTimer() noexcept {
+    event_loop.Break();
+  }
+};
+
+/**
+ * The UDP counters of the kernel from /proc/net/snmp.  On loopback,
+ * these count the packets dropped by the server's (and our) sockets.
+ */
+struct UdpCounters {
+  uint64_t in_errors = 0, rcvbuf_errors = 0, sndbuf_errors = 0;
+
+  bool Read() noexcept {
+#ifdef __linux__
+    FILE *file = fopen("/proc/net/snmp", "r");
+    if (file == nullptr)
+      return false;
+
+    char names[1024], values[1024];
+    bool found = false;
+    while (fgets(names, sizeof(names), file) != nullptr) {
+      if (strncmp(names, "Udp: ", 5) != 0)
+        continue;
+
+      if (fgets(values, sizeof(values), file) == nullptr)
+        break;
+
+      char *names_r, *values_r;
+      for (char *name = strtok_r(names + 5, " \n", &names_r),
+             *value = strtok_r(values + 5, " \n", &values_r);
+           name != nullptr && value != nullptr;
+           name = strtok_r(nullptr, " \n", &names_r),
+             value = strtok_r(nullptr, " \n", &values_r)) {
+        const uint64_t n = ParseUint64(value);
+        if (strcmp(name, "InErrors") == 0)
+          in_errors = n;
+        else if (strcmp(name, "RcvbufErrors") == 0)
+          rcvbuf_errors = n;
+        else if (strcmp(name, "SndbufErrors") == 0)
+          sndbuf_errors = n;
+      }
+
+      found = true;
+      break;
+    }
+
+    fclose(file);
+    return found;
+#else
+    return false;
+#endif
+  }
+};
+
+static uint32_t
+Percentile(std::vector<uint32_t> &v, double p) noexcept
+{
+  if (v.empty())
+    return 0;
+
+  const auto i = std::min(v.size() - 1, std::size_t(v.size() * p));
+  std::nth_element(v.begin(), v.begin() + i, v.end());
+  return v[i];
+}
+
+static unsigned
+ParsePositive(Args &args)
+{
+  const char *p = args.GetNext();
+  char *endptr;
+  const unsigned value = ParseUnsigned(p, &endptr, 10);
+  if (endptr == p || *endptr != 0 || value == 0)
+    args.UsageError();
+
+  return value;
+}
+
+/**
+ * Allow as many sockets as possible.
+ */
+static void
+RaiseFileLimit() noexcept
+{
+  struct rlimit rl;
+  if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+  }
+}
+
+static void
+PrintReport(const LoadStats &_stats, unsigned n_clients, double send_seconds,
+            const UdpCounters &before, bool have_udp_counters,
+            const UdpCounters &after)
+{
+  auto stats = _stats;
+  const auto &l = stats.latencies;
+
+  printf("clients: %u, duration: %.1f s\n", n_clients, send_seconds);
+
+  printf("sent: %llu packets, %.0f/s "
+         "(%llu fixes, %llu traffic requests, %llu thermals, %llu pings)\n",
+         (unsigned long long)stats.GetSent(),
+         stats.GetSent() / send_seconds,
+         (unsigned long long)stats.sent_fixes,
+         (unsigned long long)stats.sent_traffic_requests,
+         (unsigned long long)stats.sent_thermals,
+         (unsigned long long)stats.sent_pings);
+
+  printf("received: %llu packets, %.0f/s "
+         "(%llu acks, %llu traffic responses with %llu records, "
+         "%llu other, %llu malformed)\n",
+         (unsigned long long)stats.GetReceived(),
+         stats.GetReceived() / send_seconds,
+         (unsigned long long)stats.received_acks,
+         (unsigned long long)stats.received_traffic_responses,
+         (unsigned long long)stats.received_traffic,
+         (unsigned long long)stats.received_other,
+         (unsigned long long)stats.received_malformed);
+
+  if (stats.send_errors > 0)
+    printf("send errors: %llu\n", (unsigned long long)stats.send_errors);
+
+  printf("latency: p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+         Percentile(stats.latencies, 0.5) / 1000.,
+         Percentile(stats.latencies, 0.9) / 1000.,
+         Percentile(stats.latencies, 0.99) / 1000.,
+         (l.empty() ? 0 : *std::max_element(l.begin(), l.end())) / 1000.);
+
+  const uint64_t n_lost = stats.sent_pings - stats.received_acks;
+  printf("lost pings: %llu (%.2f%%)\n", (unsigned long long)n_lost,
+         stats.sent_pings > 0 ? 100. * n_lost / stats.sent_pings : 0.);
+
+  if (have_udp_counters)
+    printf("kernel UDP drops: %llu receive buffer, %llu send buffer, "
+           "%llu input errors\n",
+           (unsigned long long)(after.rcvbuf_errors - before.rcvbuf_errors),
+           (unsigned long long)(after.sndbuf_errors - before.sndbuf_errors),
+           (unsigned long long)(after.in_errors - before.in_errors));
+}
+
+int
+main(int argc, char **argv)
+try {
+  Args args(argc, argv, "HOST [CLIENTS [SECONDS [INTERVAL_MS]]]");
+  const char *host = args.ExpectNext();
+  const unsigned n_clients = args.IsEmpty() ? 100 : ParsePositive(args);
+  const unsigned n_seconds = args.IsEmpty() ? 10 : ParsePositive(args);
+  const unsigned interval_ms = args.IsEmpty() ? 1000 : ParsePositive(args);
+  args.ExpectEnd();
+
+  const auto address_list =
+    Resolve(host, SkyLinesTracking::Server::GetDefaultPort(),
+            0, SOCK_DGRAM);
+
+  RaiseFileLimit();
+
+  EventLoop event_loop;
+
+  /* a fixed seed makes runs reproducible */
+  std::mt19937_64 random(42);
+  std::uniform_real_distribution<double> offset(-AREA_SIZE / 2,
+                                                AREA_SIZE / 2);
+
+  LoadStats stats;
+  stats.latencies.reserve(std::size_t(n_clients) * n_seconds * 1000 /
+                          interval_ms);
+
+  std::vector<std::unique_ptr<LoadClient>> clients;
+  clients.reserve(n_clients);
+  for (unsigned i = 0; i < n_clients; ++i) {
+    const GeoPoint location(CENTER.longitude + Angle::Degrees(offset(random)),
+                            CENTER.latitude + Angle::Degrees(offset(random)));
+    const uint64_t key = random() | 1;
+    clients.emplace_back(std::make_unique<LoadClient>(event_loop,
+                                                      address_list.GetBest(),
+                                                      key, location, stats));
+  }
+
+  UdpCounters udp_before, udp_after;
+  const bool have_udp_counters = udp_before.Read();
+
+  LoadGenerator generator(event_loop, clients,
+                          milliseconds(interval_ms), seconds(n_seconds));
+  event_loop.Run();
+
+  if (have_udp_counters)
+    udp_after.Read();
+
+  PrintReport(stats, n_clients,
+              duration<double>(generator.GetSendDuration()).count(),
+              udp_before, have_udp_counters, udp_after);
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
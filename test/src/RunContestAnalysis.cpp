@@ -6,8 +6,17 @@
 #include "Printing.hpp"
 #include "system/Args.hpp"
 #include "DebugReplay.hpp"
+#include "thread/WorkerPool.hpp"
+#include "util/Compiler.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <iterator>
+#include <list>
+#include <thread>
+#include <vector>
+
 #include <stdio.h>
 
 using namespace std::chrono;
@@ -48,11 +57,115 @@ static ContestManager weglide_free(Contest::WEGLIDE_FREE,
 static ContestManager charron(Contest::CHARRON,
                               full_trace, triangle_trace, sprint_trace);
 
+/**
+ * The contests which are solved exhaustively after the flight.
+ */
+static constexpr struct {
+  const char *name;
+  Contest contest;
+  ContestManager &manager;
+} exhaustive_contests[] = {
+  { "classic", Contest::OLC_CLASSIC, olc_classic },
+  { "fai", Contest::OLC_FAI, olc_fai },
+  { "league", Contest::OLC_LEAGUE, olc_league },
+  { "plus", Contest::OLC_PLUS, olc_plus },
+  { "dmst", Contest::DMST, dmst },
+  { "xcontest", Contest::XCONTEST, xcontest },
+  { "sis_at", Contest::SIS_AT, sis_at },
+  { "netcoupe", Contest::NET_COUPE, olc_netcoupe },
+  { "weglide", Contest::WEGLIDE_FREE, weglide_free },
+  { "charron", Contest::CHARRON, charron },
+};
+
+static constexpr unsigned N_EXHAUSTIVE_CONTESTS =
+  std::size(exhaustive_contests);
+
+using Clock = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+[[gnu::pure]]
+static bool
+IsSameResult(const ContestStatistics &a, const ContestStatistics &b) noexcept
+{
+  return std::equal(std::begin(a.result), std::end(a.result),
+                    std::begin(b.result),
+                    [](const ContestResult &x, const ContestResult &y){
+                      return x.score == y.score && x.distance == y.distance;
+                    });
+}
+
+/**
+ * A second set of #ContestManager instances which are solved in
+ * parallel to compare the results and the wall time.
+ */
+static std::list<ContestManager> parallel_managers;
+static std::vector<ContestManager *> parallel;
+
+static void
+CreateParallelManagers()
+{
+  for (const auto &i : exhaustive_contests) {
+    auto &manager = parallel_managers.emplace_back(i.contest, full_trace,
+                                                   triangle_trace,
+                                                   sprint_trace);
+    parallel.push_back(&manager);
+  }
+}
+
+[[gnu::pure]]
+static ContestManager &
+GetParallelManager(const ContestManager &manager) noexcept
+{
+  for (unsigned i = 0; i < N_EXHAUSTIVE_CONTESTS; ++i)
+    if (&exhaustive_contests[i].manager == &manager)
+      return *parallel[i];
+
+  assert(false);
+  gcc_unreachable();
+}
+
+/**
+ * Solve all contests again with the #parallel managers, distributed
+ * over a #WorkerPool, and compare the results with the serial run.
+ *
+ * @return false on mismatch
+ */
+static bool
+SolveParallel(Milliseconds serial_total)
+{
+  const unsigned n_threads =
+    std::max(std::thread::hardware_concurrency(), 2u);
+  WorkerPool pool(n_threads - 1);
+
+  const auto start = Clock::now();
+  pool.ForEach(N_EXHAUSTIVE_CONTESTS, [](unsigned i){
+    parallel[i]->SolveExhaustive();
+  });
+  const Milliseconds total = Clock::now() - start;
+
+  printf("# parallel total %.1f ms (%u threads, speedup %.2f)\n",
+         total.count(), pool.GetConcurrency(),
+         serial_total.count() / total.count());
+
+  bool success = true;
+  for (unsigned i = 0; i < N_EXHAUSTIVE_CONTESTS; ++i) {
+    if (!IsSameResult(parallel[i]->GetStats(),
+                      exhaustive_contests[i].manager.GetStats())) {
+      printf("# %s MISMATCH\n", exhaustive_contests[i].name);
+      success = false;
+    }
+  }
+
+  return success;
+}
+
 static int
 TestContest(DebugReplay &replay)
 {
   bool released = false;
 
+  CreateParallelManagers();
+
   for (int i = 1; replay.Next(); i++) {
     if (i % 500 == 0) {
       putchar('.');
@@ -79,18 +192,17 @@ TestContest(DebugReplay &replay)
 
     olc_sprint.UpdateIdle();
     olc_league.UpdateIdle();
+    GetParallelManager(olc_league).UpdateIdle();
   }
 
-  olc_classic.SolveExhaustive();
-  olc_fai.SolveExhaustive();
-  olc_league.SolveExhaustive();
-  olc_plus.SolveExhaustive();
-  dmst.SolveExhaustive();
-  xcontest.SolveExhaustive();
-  sis_at.SolveExhaustive();
-  olc_netcoupe.SolveExhaustive();
-  weglide_free.SolveExhaustive();
-  charron.SolveExhaustive();
+  Milliseconds durations[N_EXHAUSTIVE_CONTESTS];
+  Milliseconds serial_total{};
+  for (unsigned i = 0; i < N_EXHAUSTIVE_CONTESTS; ++i) {
+    const auto start = Clock::now();
+    exhaustive_contests[i].manager.SolveExhaustive();
+    durations[i] = Clock::now() - start;
+    serial_total += durations[i];
+  }
 
   putchar('\n');
 
@@ -142,6 +254,14 @@ TestContest(DebugReplay &replay)
   std::cout << "# free\n";
   PrintHelper::print(charron.GetStats().GetResult(0));
 
+  std::cout << "time\n";
+  for (unsigned i = 0; i < N_EXHAUSTIVE_CONTESTS; ++i)
+    printf("# %s %.1f ms\n", exhaustive_contests[i].name,
+           durations[i].count());
+  printf("# total %.1f ms\n", serial_total.count());
+
+  const bool success = SolveParallel(serial_total);
+
   olc_classic.Reset();
   olc_fai.Reset();
   olc_sprint.Reset();
@@ -154,7 +274,7 @@ TestContest(DebugReplay &replay)
   full_trace.clear();
   sprint_trace.clear();
 
-  return 0;
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 
@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Route/AStar.hpp"
+#include "util/FlatHashSet.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+static void
+TestFlatHashSet()
+{
+  FlatHashSet<unsigned> set;
+  std::set<unsigned> reference;
+
+  /* several rounds to verify that Clear() leaves no stale items
+     behind */
+  for (unsigned round = 0; round < 3; ++round) {
+    set.Clear();
+    reference.clear();
+
+    bool insert_ok = true;
+    unsigned value = round;
+    for (unsigned i = 0; i < 5000; ++i) {
+      value = (value * 1103515245 + 12345) % 3001;
+      const auto [index, inserted] = set.Insert(value);
+      if (inserted != reference.insert(value).second || set[index] != value)
+        insert_ok = false;
+    }
+
+    bool find_ok = set.size() == reference.size();
+    for (unsigned i = 0; i < 3001; ++i) {
+      const auto index = set.Find(i);
+      if ((index != set.npos) != (reference.count(i) > 0) ||
+          (index != set.npos && set[index] != i))
+        find_ok = false;
+    }
+
+    ok1(insert_ok);
+    ok1(find_ok);
+  }
+
+  set.Clear();
+  ok1(set.empty());
+  ok1(set.Find(42u) == set.npos);
+}
+
+/**
+ * Compare the costs found by #AStar (without heuristic, i.e. plain
+ * Dijkstra) on a pseudo-random graph with a naive implementation.
+ */
+static void
+TestAStar()
+{
+  constexpr unsigned N = 500, DEGREE = 4;
+
+  struct Edge {
+    unsigned to, weight;
+  };
+
+  std::vector<Edge> edges;
+  unsigned seed = 1;
+  for (unsigned i = 0; i < N * DEGREE; ++i) {
+    seed = seed * 1103515245 + 12345;
+    const unsigned to = (seed >> 8) % N;
+    seed = seed * 1103515245 + 12345;
+    edges.push_back({to, 1 + (seed >> 8) % 100});
+  }
+
+  std::vector<unsigned> expected(N, ~0u);
+  std::vector<bool> done(N, false);
+  expected[0] = 0;
+  for (unsigned n = 0; n < N; ++n) {
+    unsigned u = N;
+    for (unsigned i = 0; i < N; ++i)
+      if (!done[i] && expected[i] != ~0u &&
+          (u == N || expected[i] < expected[u]))
+        u = i;
+
+    if (u == N)
+      break;
+
+    done[u] = true;
+    for (unsigned j = 0; j < DEGREE; ++j) {
+      const Edge &e = edges[u * DEGREE + j];
+      expected[e.to] = std::min(expected[e.to], expected[u] + e.weight);
+    }
+  }
+
+  AStar<unsigned> astar;
+
+  /* run twice: the second search reuses the memory of the first */
+  for (unsigned round = 0; round < 2; ++round) {
+    astar.Restart(0);
+
+    std::vector<unsigned> found(N, ~0u);
+    while (!astar.IsEmpty()) {
+      const unsigned u = astar.Pop();
+      found[u] = std::min(found[u], astar.GetNodeValue(u).g);
+
+      for (unsigned j = 0; j < DEGREE; ++j) {
+        const Edge &e = edges[u * DEGREE + j];
+        astar.Link(e.to, u, AStarPriorityValue(e.weight));
+      }
+    }
+
+    ok1(found == expected);
+
+    /* the predecessor chain must add up to the cost */
+    bool chain_ok = true;
+    for (unsigned i = 1; i < N; ++i) {
+      if (expected[i] == ~0u)
+        continue;
+
+      unsigned length = 0, n = i;
+      for (unsigned p; (p = astar.GetPredecessor(n)) != n; n = p) {
+        unsigned weight = ~0u;
+        for (unsigned j = 0; j < DEGREE; ++j)
+          if (edges[p * DEGREE + j].to == n)
+            weight = std::min(weight, edges[p * DEGREE + j].weight);
+        length += weight;
+      }
+
+      if (n != 0 || length != expected[i])
+        chain_ok = false;
+    }
+
+    ok1(chain_ok);
+  }
+}
+
+int main()
+{
+  plan_tests(3 * 2 + 2 + 2 * 2);
+
+  TestFlatHashSet();
+  TestAStar();
+
+  return exit_status();
+}
@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Engine/Airspace/AbstractAirspace.hpp"
 #include "Engine/Airspace/AirspaceCircle.hpp"
 #include "Engine/Airspace/AirspacePolygon.hpp"
@@ -11,6 +12,10 @@
 #include "util/StringAPI.hxx"
 #include "util/PrintException.hxx"
 #include "io/FileLineReader.hpp"
+#include "io/BufferedOutputStream.hxx"
+#include "io/BufferedReader.hxx"
+#include "io/MemoryReader.hxx"
+#include "io/StringOutputStream.hxx"
 #include "Operation/Operation.hpp"
 #include "TestUtil.hpp"
 
@@ -284,13 +289,101 @@ TestOpenAirExtended()
   }
 }
 
+[[gnu::pure]]
+static bool
+IsEqual(const AbstractAirspace &a, const AbstractAirspace &b)
+{
+  if (a.GetShape() != b.GetShape() ||
+      !StringIsEqual(a.GetName(), b.GetName()) ||
+      !StringIsEqual(a.GetType(), b.GetType()) ||
+      a.GetClass() != b.GetClass() ||
+      a.GetRadioFrequency() != b.GetRadioFrequency() ||
+      !a.GetDays().equals(b.GetDays()) ||
+      a.GetBase().reference != b.GetBase().reference ||
+      a.GetBase().altitude != b.GetBase().altitude ||
+      a.GetBase().flight_level != b.GetBase().flight_level ||
+      a.GetBase().altitude_above_terrain != b.GetBase().altitude_above_terrain ||
+      a.GetTop().reference != b.GetTop().reference ||
+      a.GetTop().altitude != b.GetTop().altitude ||
+      a.GetTop().flight_level != b.GetTop().flight_level ||
+      a.GetTop().altitude_above_terrain != b.GetTop().altitude_above_terrain ||
+      a.GetPoints().size() != b.GetPoints().size())
+    return false;
+
+  for (std::size_t i = 0; i < a.GetPoints().size(); ++i)
+    if (a.GetPoints()[i].GetLocation() != b.GetPoints()[i].GetLocation())
+      return false;
+
+  return true;
+}
+
+static void
+TestCache()
+{
+  const Path path(_T("test/data/airspace/openair.txt"));
+
+  Airspaces airspaces;
+  {
+    FileLineReader reader(path, Charset::AUTO);
+    NullOperationEnvironment operation;
+    ParseAirspaceFile(airspaces, reader, operation);
+  }
+
+  const std::vector<AirspacePtr> parsed{airspaces.GetPending().begin(),
+                                        airspaces.GetPending().end()};
+
+  StringOutputStream sos;
+  {
+    BufferedOutputStream bos(sos);
+    SaveAirspaceCache(bos, path, parsed);
+    bos.Flush();
+  }
+
+  const auto &data = sos.GetValue();
+
+  {
+    MemoryReader mr(std::as_bytes(std::span{data}));
+    BufferedReader br(mr);
+    const auto loaded = LoadAirspaceCache(br, path);
+
+    if (ok1(loaded.size() == parsed.size()))
+      ok1(std::equal(loaded.begin(), loaded.end(), parsed.begin(),
+                     [](const AirspacePtr &a, const AirspacePtr &b){
+                       return IsEqual(*a, *b);
+                     }));
+    else
+      skip(1, 0, "Wrong number of airspaces");
+  }
+
+  /* the cache is bound to the original path */
+  try {
+    MemoryReader mr(std::as_bytes(std::span{data}));
+    BufferedReader br(mr);
+    LoadAirspaceCache(br, Path(_T("test/data/airspace/tnp.sua")));
+    ok1(false);
+  } catch (const std::runtime_error &) {
+    ok1(true);
+  }
+
+  /* truncated file */
+  try {
+    MemoryReader mr(std::as_bytes(std::span{data}.first(data.size() / 2)));
+    BufferedReader br(mr);
+    LoadAirspaceCache(br, path);
+    ok1(false);
+  } catch (...) {
+    ok1(true);
+  }
+}
+
 int main()
 try {
-  plan_tests(109);
+  plan_tests(113);
 
   TestOpenAir();
   TestTNP();
   TestOpenAirExtended();
+  TestCache();
 
   return exit_status();
 } catch (const std::runtime_error &e) {
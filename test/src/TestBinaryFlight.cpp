@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "BinaryFlight.hpp"
+#include "IGC/IGCParser.hpp"
+#include "IGC/IGCExtensions.hpp"
+#include "IGC/IGCFix.hpp"
+#include "io/FileLineReader.hpp"
+#include "io/StringOutputStream.hxx"
+#include "system/Path.hpp"
+#include "TestUtil.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+#include <string.h>
+
+static std::vector<IGCFix>
+ReadIGCFixes(Path path)
+{
+  std::vector<IGCFix> fixes;
+
+  IGCExtensions extensions;
+  extensions.clear();
+
+  FileLineReaderA reader(path);
+  char *line;
+  while ((line = reader.ReadLine()) != nullptr) {
+    IGCFix fix;
+    if (line[0] == 'B' && IGCParseFix(line, extensions, fix))
+      fixes.push_back(fix);
+    else if (line[0] == 'I')
+      IGCParseExtensions(line, extensions);
+  }
+
+  return fixes;
+}
+
+static bool
+operator==(const IGCFix &a, const IGCFix &b) noexcept
+{
+  /* exact comparison: the binary format must not lose precision */
+  return a.time == b.time &&
+    a.location.latitude.Native() == b.location.latitude.Native() &&
+    a.location.longitude.Native() == b.location.longitude.Native() &&
+    a.gps_valid == b.gps_valid &&
+    a.gps_altitude == b.gps_altitude &&
+    a.pressure_altitude == b.pressure_altitude &&
+    a.enl == b.enl && a.rpm == b.rpm &&
+    a.hdm == b.hdm && a.hdt == b.hdt &&
+    a.trm == b.trm && a.trt == b.trt &&
+    a.gsp == b.gsp && a.ias == b.ias && a.tas == b.tas &&
+    a.siu == b.siu;
+}
+
+static std::span<const std::byte>
+ToSpan(const std::string &s) noexcept
+{
+  return {(const std::byte *)s.data(), s.size()};
+}
+
+static std::string
+Encode(const std::vector<IGCFix> &fixes)
+{
+  BinaryFlightWriter writer;
+  for (const auto &fix : fixes)
+    writer.Append(fix);
+
+  StringOutputStream sos;
+  writer.Write(sos);
+  return std::move(sos).GetValue();
+}
+
+/**
+ * Returns the number of the first fix at or after the given time
+ * (the expected result of BinaryFlightReader::Seek()).
+ */
+static unsigned
+FindFix(const std::vector<IGCFix> &fixes, unsigned time)
+{
+  unsigned days = 0;
+  for (unsigned i = 0; i < fixes.size(); ++i) {
+    if (i > 0 && fixes[i - 1].time.hour >= 23 && fixes[i].time.hour == 0)
+      ++days;
+
+    if (days * 24 * 3600 + fixes[i].time.GetSecondOfDay() >= time)
+      return i;
+  }
+
+  return fixes.size();
+}
+
+static bool
+TestSeek(BinaryFlightReader &reader, const std::vector<IGCFix> &fixes,
+         unsigned time)
+{
+  reader.Seek(std::chrono::seconds{time});
+
+  const unsigned expected = FindFix(fixes, time);
+  if (reader.Tell() != expected)
+    return false;
+
+  IGCFix fix;
+  if (expected == fixes.size())
+    return !reader.Read(fix);
+
+  return reader.Read(fix) && fix == fixes[expected];
+}
+
+static void
+TestFile(const char *path)
+{
+  const auto fixes = ReadIGCFixes(Path(path));
+  const std::string data = Encode(fixes);
+
+  BinaryFlightReader reader(ToSpan(data));
+  ok1(reader.GetSize() == fixes.size());
+
+  bool equal = true;
+  IGCFix fix;
+  for (const auto &expected : fixes)
+    if (!reader.Read(fix) || !(fix == expected))
+      equal = false;
+  ok(equal && !reader.Read(fix), "%s: round trip", path);
+
+  const unsigned first = fixes.front().time.GetSecondOfDay();
+  const unsigned last = fixes.back().time.GetSecondOfDay();
+  ok1(TestSeek(reader, fixes, 0));
+  ok1(TestSeek(reader, fixes, first + (last - first) / 3));
+  ok1(TestSeek(reader, fixes, first + (last - first) * 2 / 3 + 1));
+  ok1(TestSeek(reader, fixes, last));
+  ok1(TestSeek(reader, fixes, last + 1));
+}
+
+static void
+TestMidnight()
+{
+  IGCFix fix;
+  fix.Clear();
+  fix.location = GeoPoint(Angle::Degrees(7.5), Angle::Degrees(-51.25));
+  fix.gps_valid = true;
+  fix.gps_altitude = fix.pressure_altitude = 1000;
+
+  std::vector<IGCFix> fixes;
+  for (unsigned t = 23 * 3600; t < 25 * 3600; t += 4) {
+    fix.time = BrokenTime::FromSecondOfDayChecked(t);
+    fix.gps_altitude = 1000 + t % 100;
+    fixes.push_back(fix);
+  }
+
+  const std::string data = Encode(fixes);
+  BinaryFlightReader reader(ToSpan(data));
+
+  ok1(TestSeek(reader, fixes, 23 * 3600 + 1800));
+  ok1(reader.GetDays() == 0);
+  ok1(TestSeek(reader, fixes, 24 * 3600));
+  ok1(reader.GetDays() == 1);
+  ok1(TestSeek(reader, fixes, 24 * 3600 + 1801));
+  ok1(reader.GetDays() == 1);
+}
+
+static bool
+IsRejected(std::string data)
+{
+  try {
+    BinaryFlightReader reader(ToSpan(data));
+    IGCFix fix;
+    while (reader.Read(fix)) {}
+    return false;
+  } catch (const std::runtime_error &) {
+    return true;
+  }
+}
+
+static void
+TestMalformed()
+{
+  const auto fixes = ReadIGCFixes(Path("test/data/9crx3101.igc"));
+  const std::string data = Encode(fixes);
+
+  ok1(IsRejected(""));
+  ok1(IsRejected(data.substr(0, data.size() / 2)));
+  ok1(IsRejected(std::string(data.size(), '\0')));
+}
+
+int main()
+{
+  plan_tests(3 * 7 + 6 + 3);
+
+  TestFile("test/data/0asljd01.igc");
+  TestFile("test/data/01lz1hq1.igc");
+  TestFile("test/data/apf-bug554.igc");
+  TestMidnight();
+  TestMalformed();
+
+  return exit_status();
+}
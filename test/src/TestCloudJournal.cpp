@@ -0,0 +1,284 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Cloud/Data.hpp"
+#include "Cloud/Journal.hpp"
+#include "Cloud/JournalRecord.hpp"
+#include "Cloud/Serialiser.hpp"
+#include "net/IPv4Address.hxx"
+#include "io/FileOutputStream.hxx"
+#include "io/StringOutputStream.hxx"
+#include "system/FileUtil.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+static constexpr Path db_path("output/TestCloudJournal.db");
+
+static void
+DeleteFiles()
+{
+  File::Delete(db_path);
+  File::Delete(GetJournalPath(db_path));
+  File::Delete(GetOldJournalPath(db_path));
+}
+
+static const CloudThermal &
+MakeThermal(CloudData &data, uint64_t client_key)
+{
+  const GeoPoint location(Angle::Degrees(7.7), Angle::Degrees(51.05));
+  return data.thermals.Make(client_key,
+                            AGeoPoint(location, 800),
+                            AGeoPoint(location, 1500 + client_key),
+                            2.5);
+}
+
+static CloudJournalRecord
+ThermalRecord(const CloudThermal &thermal)
+{
+  CloudJournalRecord r;
+  r.type = CloudJournalRecord::Type::THERMAL;
+  r.key = thermal.client_key;
+  r.time = thermal.time;
+  r.a = thermal.bottom_location;
+  r.b = thermal.top_location;
+  r.lift = thermal.lift;
+  r.serial = thermal.serial;
+  return r;
+}
+
+static CloudJournalRecord
+ClientRecord(uint64_t key, unsigned id)
+{
+  CloudJournalRecord r;
+  r.type = CloudJournalRecord::Type::CLIENT;
+  r.key = key;
+  r.time = std::chrono::steady_clock::now();
+  r.id = id;
+  r.address = IPv4Address(192, 168, 1, id, 5597);
+  r.a = AGeoPoint(GeoPoint(Angle::Degrees(7.7), Angle::Degrees(51.05)),
+                  1000);
+  return r;
+}
+
+static void
+SaveSnapshot(const CloudData &data)
+{
+  FileOutputStream fos(db_path);
+
+  {
+    Serialiser s(fos);
+    data.Save(s);
+    s.Flush();
+  }
+
+  fos.Commit();
+}
+
+/**
+ * Write a journal file with the given records.
+ *
+ * @param truncate the number of bytes to chop off the end
+ */
+static void
+WriteJournal(Path path, const std::vector<CloudJournalRecord> &records,
+             std::size_t truncate=0)
+{
+  StringOutputStream sos;
+
+  {
+    Serialiser s(sos);
+    WriteJournalHeader(s);
+    for (const auto &r : records)
+      r.Save(s);
+    s.Flush();
+  }
+
+  const auto &buffer = sos.GetValue();
+
+  FileOutputStream fos(path);
+  fos.Write(buffer.data(), buffer.size() - truncate);
+  fos.Commit();
+}
+
+/**
+ * Load the database files and return the (sorted) serials of all
+ * thermals.
+ */
+static std::vector<uint64_t>
+LoadSerials(CloudData &data)
+{
+  data.Load(db_path);
+
+  std::vector<uint64_t> serials;
+  for (const auto &thermal : data.thermals)
+    serials.push_back(thermal.serial);
+
+  std::sort(serials.begin(), serials.end());
+  return serials;
+}
+
+static bool
+IsRange(const std::vector<uint64_t> &serials, uint64_t n)
+{
+  if (serials.size() != n)
+    return false;
+
+  for (uint64_t i = 0; i < n; ++i)
+    if (serials[i] != i + 1)
+      return false;
+
+  return true;
+}
+
+static void
+TestTruncated()
+{
+  DeleteFiles();
+
+  CloudData source;
+  const auto &a = MakeThermal(source, 1);
+  const auto &b = MakeThermal(source, 2);
+  const auto &c = MakeThermal(source, 3);
+
+  /* the process was killed while writing the last record */
+  WriteJournal(GetJournalPath(db_path), {
+      ThermalRecord(a),
+      ClientRecord(42, 7),
+      ThermalRecord(b),
+      ThermalRecord(c),
+    }, 5);
+
+  CloudData data;
+  const auto serials = LoadSerials(data);
+  ok1(IsRange(serials, 2));
+  ok1(data.GetShard(42).clients.Find(42) != nullptr);
+
+  /* the next thermal doesn't reuse a replayed serial */
+  ok1(MakeThermal(data, 4).serial == 3);
+}
+
+static void
+TestOldAndNewJournal()
+{
+  DeleteFiles();
+
+  CloudData source;
+  const auto &a = MakeThermal(source, 1);
+  const auto &b = MakeThermal(source, 2);
+  SaveSnapshot(source);
+
+  const auto &c = MakeThermal(source, 3);
+  const auto &d = MakeThermal(source, 4);
+  WriteJournal(GetOldJournalPath(db_path),
+               {ThermalRecord(a), ThermalRecord(c)});
+
+  /* the two journals are not necessarily ordered by serial */
+  const auto &e = MakeThermal(source, 5);
+  WriteJournal(GetJournalPath(db_path),
+               {ThermalRecord(b), ThermalRecord(e), ThermalRecord(d)});
+
+  CloudData data;
+  const auto serials = LoadSerials(data);
+  ok1(IsRange(serials, 5));
+  ok1(MakeThermal(data, 6).serial == 6);
+}
+
+/**
+ * Simulate crashes during CloudJournal::Compact(), which moves the
+ * journal aside before writing the snapshot.
+ */
+static void
+TestInterruptedCompaction()
+{
+  DeleteFiles();
+
+  CloudData source;
+  std::vector<CloudJournalRecord> old_records, new_records;
+  for (unsigned i = 1; i <= 3; ++i)
+    old_records.push_back(ThermalRecord(MakeThermal(source, i)));
+
+  /* these were submitted after the journals were switched, but
+     before the snapshot was written */
+  for (unsigned i = 4; i <= 5; ++i)
+    new_records.push_back(ThermalRecord(MakeThermal(source, i)));
+
+  SaveSnapshot(source);
+
+  new_records.push_back(ThermalRecord(MakeThermal(source, 6)));
+
+  WriteJournal(GetOldJournalPath(db_path), old_records);
+  WriteJournal(GetJournalPath(db_path), new_records);
+
+  {
+    /* killed after committing the snapshot, but before deleting the
+       old journal */
+    CloudData data;
+    ok1(IsRange(LoadSerials(data), 6));
+  }
+
+  {
+    /* killed while writing the snapshot: the previous one is still
+       there */
+    File::Delete(db_path);
+
+    CloudData data;
+    ok1(IsRange(LoadSerials(data), 6));
+  }
+}
+
+/**
+ * Let the #CloudJournal compact while thermals are being submitted,
+ * stop without a final snapshot and load the result.
+ */
+static void
+TestCompact()
+{
+  DeleteFiles();
+
+  unsigned n = 0;
+
+  {
+    CloudData data;
+    CloudJournal journal(data, db_path, 1 << 20, 64);
+    journal.Start();
+
+    const auto submit = [&](unsigned count){
+      for (unsigned i = 0; i < count; ++i) {
+        const std::scoped_lock lock{data.thermal_mutex};
+        journal.Push(ThermalRecord(MakeThermal(data, ++n)));
+      }
+    };
+
+    submit(20);
+    journal.RequestCompact();
+    submit(20);
+
+    while (journal.GetStats().compactions == 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    submit(10);
+    journal.Stop();
+
+    ok1(journal.GetStats().dropped == 0);
+  }
+
+  CloudData data;
+  ok1(IsRange(LoadSerials(data), n));
+
+  DeleteFiles();
+}
+
+int main()
+{
+  plan_tests(3 + 2 + 2 + 2);
+
+  TestTruncated();
+  TestOldAndNewJournal();
+  TestInterruptedCompaction();
+  TestCompact();
+
+  return exit_status();
+}
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "thread/MPSCQueue.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <vector>
+
+static void
+TestSequential()
+{
+  MPSCQueue<unsigned> queue(4);
+  ok1(queue.capacity() == 4);
+
+  unsigned value;
+  ok1(!queue.TryPop(value));
+
+  ok1(queue.TryPush(1));
+  ok1(queue.TryPush(2));
+  ok1(queue.TryPush(3));
+  ok1(queue.TryPush(4));
+  ok1(!queue.TryPush(5));
+
+  ok1(queue.TryPop(value) && value == 1);
+  ok1(queue.TryPop(value) && value == 2);
+
+  /* wrap around */
+  ok1(queue.TryPush(5));
+  ok1(queue.TryPush(6));
+  ok1(!queue.TryPush(7));
+
+  ok1(queue.TryPop(value) && value == 3);
+  ok1(queue.TryPop(value) && value == 4);
+  ok1(queue.TryPop(value) && value == 5);
+  ok1(queue.TryPop(value) && value == 6);
+  ok1(!queue.TryPop(value));
+}
+
+struct Item {
+  unsigned producer, n;
+};
+
+static void
+TestConcurrent()
+{
+  constexpr unsigned N_PRODUCERS = 4;
+  constexpr unsigned N = 100000;
+
+  MPSCQueue<Item> queue(256);
+
+  std::vector<std::thread> producers;
+  for (unsigned p = 0; p < N_PRODUCERS; ++p)
+    producers.emplace_back([&queue, p]{
+      for (unsigned n = 1; n <= N; ++n)
+        while (!queue.TryPush({p, n}))
+          std::this_thread::yield();
+    });
+
+  /* each producer's items must arrive in order, none may be lost or
+     duplicated */
+  std::array<unsigned, N_PRODUCERS> last{};
+  bool ordered = true;
+  unsigned total = 0;
+  while (total < N_PRODUCERS * N) {
+    Item item;
+    if (!queue.TryPop(item)) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    if (item.producer >= N_PRODUCERS || item.n != last[item.producer] + 1)
+      ordered = false;
+    else
+      last[item.producer] = item.n;
+
+    ++total;
+  }
+
+  for (auto &i : producers)
+    i.join();
+
+  Item item;
+  ok1(!queue.TryPop(item));
+  ok1(ordered);
+  ok1(std::all_of(last.begin(), last.end(),
+                  [](unsigned n){ return n == N; }));
+}
+
+int main()
+{
+  plan_tests(17 + 3);
+
+  TestSequential();
+  TestConcurrent();
+
+  return exit_status();
+}
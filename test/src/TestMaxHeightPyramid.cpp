@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Terrain/MaxHeightPyramid.hpp"
+#include "Terrain/RasterBuffer.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <random>
+
+/* not a multiple of 2^OVERVIEW_BITS, and the tiles are not aligned
+   to overview pixels */
+static constexpr RasterLocation SIZE{200, 137};
+static constexpr unsigned TILE_WIDTH = 75;
+
+static constexpr RasterLocation OVERVIEW_SIZE{
+  RasterTraits::ToOverviewCeil(SIZE.x),
+  RasterTraits::ToOverviewCeil(SIZE.y),
+};
+
+static void
+Fill(RasterBuffer &buffer, std::mt19937 &rng, unsigned invalid_ratio) noexcept
+{
+  std::uniform_int_distribution<int> value(-100, 3000);
+  std::uniform_int_distribution<unsigned> invalid(0, invalid_ratio);
+
+  TerrainHeight *p = buffer.GetData();
+  for (unsigned i = 0; i < buffer.GetSize().Area(); ++i)
+    p[i] = invalid_ratio > 0 && invalid(rng) == 0
+      ? TerrainHeight::Invalid()
+      : TerrainHeight(value(rng));
+}
+
+static int
+ToExpected(TerrainHeight h) noexcept
+{
+  return h.IsInvalid() ? MaxHeightPyramid::UNKNOWN : h.GetValueOr0();
+}
+
+/**
+ * Verify that each cell of each level is exactly the maximum of all
+ * overview and tile heights beneath it.
+ */
+static bool
+Check(const MaxHeightPyramid &pyramid, const RasterBuffer &overview,
+      const RasterBuffer &fine, bool with_fine) noexcept
+{
+  for (unsigned level = 0; level < pyramid.GetLevels(); ++level) {
+    const unsigned shift = RasterTraits::OVERVIEW_BITS + level;
+
+    for (unsigned y = 0; y < SIZE.y; y += 1u << shift) {
+      for (unsigned x = 0; x < SIZE.x; x += 1u << shift) {
+        int expected = INT16_MIN;
+        for (unsigned py = y; py < std::min(y + (1u << shift), SIZE.y); ++py) {
+          for (unsigned px = x; px < std::min(x + (1u << shift), SIZE.x); ++px) {
+            const RasterLocation p{px, py};
+            expected = std::max(expected,
+                                ToExpected(overview.Get(p >> RasterTraits::OVERVIEW_BITS)));
+            if (with_fine)
+              expected = std::max(expected, ToExpected(fine.Get(p)));
+          }
+        }
+
+        if (pyramid.GetMax(level, {x, y}) != expected)
+          return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static void
+PutTiles(MaxHeightPyramid &pyramid, const RasterBuffer &fine) noexcept
+{
+  for (unsigned x = 0; x < SIZE.x; x += TILE_WIDTH) {
+    const unsigned width = std::min(TILE_WIDTH, SIZE.x - x);
+    RasterBuffer tile(width, SIZE.y);
+    for (unsigned y = 0; y < SIZE.y; ++y)
+      std::copy_n(fine.GetDataAt({x, y}), width, tile.GetData() + y * width);
+
+    pyramid.PutTile(tile, {x, 0});
+  }
+}
+
+static void
+TestPyramid(unsigned invalid_ratio)
+{
+  std::mt19937 rng(invalid_ratio);
+
+  RasterBuffer overview(OVERVIEW_SIZE.x, OVERVIEW_SIZE.y), fine(SIZE.x, SIZE.y);
+  Fill(overview, rng, invalid_ratio);
+  Fill(fine, rng, invalid_ratio * 16);
+
+  MaxHeightPyramid pyramid;
+  pyramid.Resize(OVERVIEW_SIZE);
+  ok1(pyramid.GetLevels() == 5);
+
+  /* nothing loaded yet: no block may be skipped */
+  ok1(pyramid.GetMax(0, {0, 0}) == MaxHeightPyramid::UNKNOWN);
+  ok1(pyramid.GetMax(pyramid.GetLevels() - 1, {0, 0}) ==
+      MaxHeightPyramid::UNKNOWN);
+
+  /* load the overview in two parts */
+  pyramid.PutOverview(overview, {0, 0}, {OVERVIEW_SIZE.x, 4});
+  pyramid.PutOverview(overview, {0, 4}, OVERVIEW_SIZE);
+  ok1(Check(pyramid, overview, fine, false));
+
+  PutTiles(pyramid, fine);
+  ok1(Check(pyramid, overview, fine, true));
+}
+
+int main()
+{
+  plan_tests(2 * 5 + 1);
+
+  TestPyramid(0);
+  TestPyramid(50);
+
+  MaxHeightPyramid pyramid;
+  pyramid.Resize(OVERVIEW_SIZE);
+  pyramid.Reset();
+  ok1(!pyramid.IsDefined());
+
+  return exit_status();
+}
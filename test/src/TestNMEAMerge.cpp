@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "NMEA/Info.hpp"
+#include "TestUtil.hpp"
+
+#include <array>
+#include <string>
+
+using namespace std::chrono;
+
+static constexpr TimeStamp
+At(double seconds) noexcept
+{
+  return TimeStamp{FloatDuration{seconds}};
+}
+
+static void
+Init(NMEAInfo &info, double now) noexcept
+{
+  info.Reset();
+  info.clock = At(now);
+  info.alive.Update(info.clock);
+}
+
+static void
+AddTraffic(NMEAInfo &info, uint32_t id) noexcept
+{
+  FlarmTraffic *traffic = info.flarm.traffic.AllocateTraffic();
+  traffic->Clear();
+  traffic->id = FlarmId::Parse(std::to_string(id).c_str(), nullptr);
+  traffic->valid.Update(info.clock);
+  info.flarm.traffic.modified.Update(info.clock);
+}
+
+using Devices = std::array<NMEAInfo, 3>;
+
+static NMEAInfo
+FullMerge(const Devices &devices) noexcept
+{
+  NMEAInfo result;
+  result.Reset();
+  for (const auto &i : devices)
+    result.Complement(i);
+  return result;
+}
+
+static bool
+Equals(const NMEAInfo &a, const NMEAInfo &b) noexcept
+{
+  return a.airspeed_available == b.airspeed_available &&
+    (!a.airspeed_available ||
+     (a.true_airspeed == b.true_airspeed &&
+      a.airspeed_real == b.airspeed_real)) &&
+    a.static_pressure_available == b.static_pressure_available &&
+    a.baro_altitude_available == b.baro_altitude_available &&
+    (!a.baro_altitude_available || a.baro_altitude == b.baro_altitude) &&
+    a.total_energy_vario_available == b.total_energy_vario_available &&
+    (!a.total_energy_vario_available ||
+     a.total_energy_vario == b.total_energy_vario) &&
+    a.netto_vario_available == b.netto_vario_available &&
+    a.voltage_available == b.voltage_available &&
+    (!a.voltage_available || a.voltage == b.voltage) &&
+    a.flarm.traffic.list.size() == b.flarm.traffic.list.size() &&
+    a.flarm.status.available == b.flarm.status.available &&
+    a.location_available == b.location_available;
+}
+
+/**
+ * Modify the devices, and check that merging only the modified
+ * groups (detected by the stamps) into the previous result yields
+ * the same as a full merge.
+ */
+template<typename F>
+static bool
+CheckDeltaMerge(Devices &devices, NMEAInfo &merged, double now, F &&modify)
+{
+  std::array<NMEAInfo::MergeStamps, 3> stamps;
+  for (unsigned i = 0; i < devices.size(); ++i) {
+    stamps[i] = devices[i].GetMergeStamps();
+    devices[i].clock = At(now);
+  }
+
+  modify(devices);
+
+  unsigned groups = 0;
+  for (unsigned i = 0; i < devices.size(); ++i) {
+    const auto s = devices[i].GetMergeStamps();
+    groups |= s.Compare(stamps[i]) | s.Find(devices[i].clock);
+  }
+
+  merged.ResetMerged(groups);
+  for (const auto &i : devices)
+    merged.Complement(i, groups);
+
+  return Equals(merged, FullMerge(devices));
+}
+
+static void
+TestStamps()
+{
+  NMEAInfo info;
+  Init(info, 10);
+
+  const auto a = info.GetMergeStamps();
+  ok1(a.Compare(a) == 0);
+  ok1(a.Find(info.clock) == 0);
+
+  info.ProvideTotalEnergyVario(1.5);
+  const auto b = info.GetMergeStamps();
+  ok1(b.Compare(a) == NMEAInfo::MERGE_VARIO);
+  ok1(b.Find(info.clock) == NMEAInfo::MERGE_VARIO);
+
+  /* modified again at the same clock: only Find() notices */
+  info.ProvideTotalEnergyVario(2.5);
+  const auto c = info.GetMergeStamps();
+  ok1(c.Compare(b) == 0);
+  ok1(c.Find(info.clock) == NMEAInfo::MERGE_VARIO);
+
+  AddTraffic(info, 0x123);
+  ok1(info.GetMergeStamps().Compare(c) == NMEAInfo::MERGE_FLARM);
+
+  /* expiring a traffic object does not modify a stamp */
+  info.clock = At(30);
+  const auto d = info.GetMergeStamps();
+  info.flarm.traffic.Expire(info.clock);
+  ok1(info.flarm.traffic.IsEmpty());
+  ok1(info.GetMergeStamps().Compare(d) & NMEAInfo::MERGE_FLARM);
+}
+
+static void
+TestDeltaMerge()
+{
+  Devices devices;
+  Init(devices[0], 10);
+  devices[0].location_available.Update(devices[0].clock);
+  devices[0].ProvideBaroAltitudeTrue(1000);
+  AddTraffic(devices[0], 0x111);
+  AddTraffic(devices[0], 0x222);
+
+  Init(devices[1], 10);
+  devices[1].ProvideTotalEnergyVario(1.0);
+  devices[1].ProvideTrueAirspeed(30);
+  devices[1].voltage = 12.5;
+  devices[1].voltage_available.Update(devices[1].clock);
+
+  Init(devices[2], 10);
+  devices[2].ProvideBaroAltitudeTrue(1100);
+  devices[2].ProvideTotalEnergyVario(2.0);
+  AddTraffic(devices[2], 0x333);
+
+  NMEAInfo merged = FullMerge(devices);
+
+  ok1(CheckDeltaMerge(devices, merged, 11, [](Devices &d){
+    d[1].ProvideTotalEnergyVario(1.2);
+  }));
+
+  ok1(CheckDeltaMerge(devices, merged, 11, [](Devices &d){
+    /* same clock as before */
+    d[1].ProvideTotalEnergyVario(1.4);
+  }));
+
+  ok1(CheckDeltaMerge(devices, merged, 12, [](Devices &d){
+    d[1].total_energy_vario_available.Clear();
+  }));
+
+  ok1(CheckDeltaMerge(devices, merged, 13, [](Devices &d){
+    d[0].baro_altitude_available.Clear();
+    d[1].ProvideTotalEnergyVario(1.6);
+  }));
+
+  ok1(CheckDeltaMerge(devices, merged, 14, [](Devices &d){
+    AddTraffic(d[0], 0x444);
+    d[2].voltage = 11.0;
+    d[2].voltage_available.Update(d[2].clock);
+  }));
+
+  ok1(CheckDeltaMerge(devices, merged, 20, [](Devices &d){
+    for (auto &i : d)
+      i.flarm.traffic.Expire(i.clock);
+  }));
+
+  ok1(merged.flarm.traffic.IsEmpty());
+
+  ok1(CheckDeltaMerge(devices, merged, 21, [](Devices &d){
+    d[1].ProvideTrueAirspeed(35);
+  }));
+  ok1(merged.true_airspeed == 35);
+}
+
+int main()
+{
+  plan_tests(9 + 9);
+
+  TestStamps();
+  TestDeltaMerge();
+
+  return exit_status();
+}
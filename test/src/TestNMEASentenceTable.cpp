@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "NMEA/SentenceTable.hpp"
+#include "NMEA/Checksum.hpp"
+#include "NMEA/InputLine.hpp"
+#include "TestUtil.hpp"
+
+#include <string.h>
+
+using std::string_view_literals::operator""sv;
+
+static constexpr NMEASentenceTable<6> talker{{
+  "GSA"sv, "GLL"sv, "RMC"sv, "GGA"sv, "HDM"sv, "MWV"sv,
+}};
+
+/* must be resolvable at compile time */
+static_assert(talker.Find("RMC"sv) == 2);
+static_assert(talker.Find("XYZ"sv) == talker.NOT_FOUND);
+
+static void
+TestSentenceTable()
+{
+  ok1(talker.Find("GSA"sv) == 0);
+  ok1(talker.Find("GLL"sv) == 1);
+  ok1(talker.Find("GGA"sv) == 3);
+  ok1(talker.Find("HDM"sv) == 4);
+  ok1(talker.Find("MWV"sv) == 5);
+
+  ok1(talker.Find(""sv) == talker.NOT_FOUND);
+  ok1(talker.Find("RM"sv) == talker.NOT_FOUND);
+  ok1(talker.Find("RMCX"sv) == talker.NOT_FOUND);
+  ok1(talker.Find("GSV"sv) == talker.NOT_FOUND);
+
+  /* many similar types */
+  static constexpr NMEASentenceTable<12> lx{{
+    "LXWP0"sv, "LXWP1"sv, "LXWP2"sv, "LXWP3"sv,
+    "PLXV0"sv, "PLXVC"sv, "PLXVF"sv, "PLXVS"sv,
+    "PFLAU"sv, "PFLAA"sv, "PFLAE"sv, "PFLAV"sv,
+  }};
+
+  bool found_all = true;
+  for (int i = 0; const auto type : {
+      "LXWP0"sv, "LXWP1"sv, "LXWP2"sv, "LXWP3"sv,
+      "PLXV0"sv, "PLXVC"sv, "PLXVF"sv, "PLXVS"sv,
+      "PFLAU"sv, "PFLAA"sv, "PFLAE"sv, "PFLAV"sv,
+    })
+    if (lx.Find(type) != i++)
+      found_all = false;
+
+  ok1(found_all);
+  ok1(lx.Find("LXWP4"sv) == lx.NOT_FOUND);
+  ok1(lx.Find("PFLAX"sv) == lx.NOT_FOUND);
+}
+
+static int
+Twice(int x) noexcept
+{
+  return 2 * x;
+}
+
+static int
+Negate(int x) noexcept
+{
+  return -x;
+}
+
+static void
+TestHandlerTable()
+{
+  using Handler = int (*)(int);
+  static constexpr NMEAHandlerTable<Handler, 2> handlers{{{
+    {"PGRMZ"sv, Twice},
+    {"PTAS1"sv, Negate},
+  }}};
+
+  const auto twice = handlers.Find("PGRMZ"sv);
+  ok1(twice != nullptr && twice(21) == 42);
+
+  const auto negate = handlers.Find("PTAS1"sv);
+  ok1(negate != nullptr && negate(3) == -3);
+
+  ok1(handlers.Find("PGRMM"sv) == nullptr);
+}
+
+static void
+TestChecksum()
+{
+  static constexpr char good[] =
+    "$GPRMC,082310,A,5103.5403,N,00741.5742,E,055.3,022.4,230610,000.0,W*6E";
+  const char *asterisk = FindVerifiedNMEAChecksum(good);
+  ok1(asterisk == strrchr(good, '*'));
+  ok1(VerifyNMEAChecksum(good));
+
+  ok1(FindVerifiedNMEAChecksum("$GPRMC,082310,A*00") == nullptr);
+  ok1(FindVerifiedNMEAChecksum("$GPRMC,082310,A") == nullptr);
+  ok1(FindVerifiedNMEAChecksum("$GPRMC,082310,A*") == nullptr);
+  ok1(FindVerifiedNMEAChecksum("$GPRMC,082310,A*6EX") == nullptr);
+
+  /* the checksum is calculated up to the last asterisk, but the line
+     ends at the first one, like with NMEAInputLine(const char *) */
+  char buffer[64];
+  strcpy(buffer, "$PFOO,a*b");
+  AppendNMEAChecksum(buffer);
+  asterisk = FindVerifiedNMEAChecksum(buffer);
+  ok1(asterisk == strchr(buffer, '*'));
+  ok1(NMEAInputLine(buffer, asterisk).Rest() ==
+      NMEAInputLine(buffer).Rest());
+}
+
+int main()
+{
+  plan_tests(12 + 3 + 8);
+
+  TestSentenceTable();
+  TestHandlerTable();
+  TestChecksum();
+
+  return exit_status();
+}
@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Terrain/RasterBuffer.hpp"
+#include "Terrain/InterpolationBatch.hpp"
+
+extern "C" {
+#include "tap.h"
+}
+
+#include <random>
+
+static constexpr RasterLocation SIZE{37, 29};
+static constexpr unsigned N = 1000;
+
+static void
+Fill(RasterBuffer &buffer, int16_t min, int16_t max,
+     unsigned special_ratio) noexcept
+{
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> value(min, max);
+  std::uniform_int_distribution<unsigned> special(0, special_ratio);
+  std::uniform_int_distribution<int> special_value(-32768, -30000);
+
+  TerrainHeight *p = buffer.GetData();
+  for (unsigned i = 0; i < SIZE.Area(); ++i)
+    p[i] = TerrainHeight(special_ratio > 0 && special(rng) == 0
+                         ? special_value(rng)
+                         : value(rng));
+}
+
+/**
+ * Compare the results of the batched interpolation with
+ * RasterBuffer::GetInterpolated().
+ */
+static bool
+CompareInterpolated(const RasterBuffer &buffer) noexcept
+{
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<unsigned> x(0, (SIZE.x << 8) + 0x100);
+  std::uniform_int_distribution<unsigned> y(0, (SIZE.y << 8) + 0x100);
+
+  RasterLocation locations[N];
+  for (auto &i : locations)
+    i = {x(rng), y(rng)};
+
+  /* include the corners and edges */
+  locations[0] = {0, 0};
+  locations[1] = {(SIZE.x << 8) - 1, (SIZE.y << 8) - 1};
+  locations[2] = {(SIZE.x << 8) - 1, 0};
+  locations[3] = {0, (SIZE.y << 8) - 1};
+
+  TerrainHeight result[N];
+
+  HeightInterpolationBatch batch;
+  for (unsigned i = 0; i < N; ++i)
+    buffer.GetInterpolated(locations[i], batch, result[i]);
+  batch.Flush();
+
+  for (unsigned i = 0; i < N; ++i)
+    if (result[i].GetValue() !=
+        buffer.GetInterpolated(locations[i]).GetValue())
+      return false;
+
+  return true;
+}
+
+/**
+ * Compare the interpolated RasterBuffer::ScanLine() with per-point
+ * RasterBuffer::GetInterpolated() calls.
+ */
+static bool
+CompareScanLine(const RasterBuffer &buffer, RasterLocation a,
+                RasterLocation b, unsigned size) noexcept
+{
+  TerrainHeight result[N];
+  buffer.ScanLine(a, b, result, size, true);
+
+  const int dx = b.x - a.x, dy = b.y - a.y;
+  const int n = size - 1;
+  for (int i = 0; i <= n; ++i) {
+    const RasterLocation p(a.x + (i * dx) / n, a.y + (i * dy) / n);
+    if (result[i].GetValue() != buffer.GetInterpolated(p).GetValue())
+      return false;
+  }
+
+  return true;
+}
+
+static bool
+CompareScanLines(const RasterBuffer &buffer) noexcept
+{
+  const RasterLocation max{(SIZE.x << 8) - 1, (SIZE.y << 8) - 1};
+
+  /* horizontal (forward, backward, along the bottom edge) */
+  return CompareScanLine(buffer, {0, 0x380}, {max.x, 0x380}, 200) &&
+    CompareScanLine(buffer, {max.x - 0x40, 0x1234}, {0x80, 0x1234}, N) &&
+    CompareScanLine(buffer, {0x10, max.y}, {max.x, max.y}, 77) &&
+    /* diagonal */
+    CompareScanLine(buffer, {0, 0}, max, N) &&
+    CompareScanLine(buffer, {max.x, 0x42}, {0x17, max.y}, 321);
+}
+
+static bool
+ComparePortable(int16_t min, int16_t max) noexcept
+{
+  std::mt19937 rng(2);
+  std::uniform_int_distribution<int> value(min, max);
+  std::uniform_int_distribution<int> weight(0, 0xff);
+
+  int16_t a[N], b[N], c[N], d[N], ix[N], iy[N], result[N];
+  for (unsigned i = 0; i < N; ++i) {
+    a[i] = value(rng);
+    b[i] = value(rng);
+    c[i] = value(rng);
+    d[i] = value(rng);
+    ix[i] = weight(rng);
+    iy[i] = weight(rng);
+  }
+
+  InterpolateHeightsPortable(a, b, c, d, ix, iy, result, N);
+
+  for (unsigned i = 0; i < N; ++i) {
+    const unsigned kx = 0x100 - ix[i], ky = 0x100 - iy[i];
+    const unsigned ux = ix[i], uy = iy[i];
+    const int16_t expected = (a[i] * kx * ky + b[i] * ux * ky +
+                              c[i] * kx * uy + d[i] * ux * uy) >> 16;
+    if (result[i] != expected)
+      return false;
+  }
+
+  return true;
+}
+
+int main()
+{
+  plan_tests(10);
+
+  ok1(ComparePortable(0, 3000));
+  ok1(ComparePortable(-29999, 32767));
+
+  RasterBuffer buffer;
+  buffer.Resize(SIZE);
+
+  Fill(buffer, 0, 3000, 0);
+  ok1(CompareInterpolated(buffer));
+  ok1(CompareScanLines(buffer));
+
+  Fill(buffer, -29999, 32767, 0);
+  ok1(CompareInterpolated(buffer));
+
+  ok1(CompareScanLines(buffer));
+
+  Fill(buffer, 0, 3000, 10);
+  ok1(CompareInterpolated(buffer));
+  ok1(CompareScanLines(buffer));
+
+  Fill(buffer, -29999, 32767, 3);
+  ok1(CompareInterpolated(buffer));
+  ok1(CompareScanLines(buffer));
+
+  return exit_status();
+}
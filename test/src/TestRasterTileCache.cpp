@@ -0,0 +1,283 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Terrain/RasterTileCache.hpp"
+#include "TestUtil.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+/* neither the map nor the tile size is a multiple of
+   2^OVERVIEW_BITS */
+static constexpr UnsignedPoint2D SIZE{300, 211};
+static constexpr Point2D<uint_least16_t> TILE_SIZE{70, 70};
+static constexpr UnsignedPoint2D N_TILES{
+  (SIZE.x + TILE_SIZE.x - 1) / TILE_SIZE.x,
+  (SIZE.y + TILE_SIZE.y - 1) / TILE_SIZE.y,
+};
+
+/**
+ * A #RasterTileCache filled with synthetic terrain, without a JPEG
+ * 2000 file: a few hills plus some noise, with a few water and
+ * invalid pixels.  Every other tile is loaded; the others are
+ * represented only by the overview.
+ */
+class SyntheticTileCache : public RasterTileCache {
+public:
+  explicit SyntheticTileCache(std::mt19937 &rng) noexcept {
+    SetSize(SIZE, TILE_SIZE, N_TILES);
+
+    std::vector<TerrainHeight> fine(SIZE.x * SIZE.y);
+    Generate(fine.data(), rng);
+
+    auto *o = overview.GetData();
+    const auto o_size = overview.GetSize();
+    for (unsigned y = 0; y < o_size.y; ++y)
+      for (unsigned x = 0; x < o_size.x; ++x)
+        o[y * o_size.x + x] = fine[(y << RasterTraits::OVERVIEW_BITS) * SIZE.x
+                                   + (x << RasterTraits::OVERVIEW_BITS)];
+
+    max_pyramid.PutOverview(overview, {0, 0}, o_size);
+
+    for (unsigned ty = 0; ty < N_TILES.y; ++ty) {
+      for (unsigned tx = 0; tx < N_TILES.x; ++tx) {
+        const RasterLocation start{tx * TILE_SIZE.x, ty * TILE_SIZE.y};
+        const RasterLocation end{
+          std::min(start.x + TILE_SIZE.x, SIZE.x),
+          std::min(start.y + TILE_SIZE.y, SIZE.y),
+        };
+
+        auto &tile = tiles.Get(tx, ty);
+        tile.Set(start, end);
+
+        if ((tx + ty) % 2 != 0)
+          continue;
+
+        tile.buffer.Resize(tile.size);
+        auto *dest = tile.buffer.GetData();
+        for (unsigned y = start.y; y < end.y; ++y)
+          for (unsigned x = start.x; x < end.x; ++x)
+            *dest++ = fine[y * SIZE.x + x];
+
+        max_pyramid.PutTile(tile.buffer, start);
+      }
+    }
+  }
+
+  /**
+   * Discard the #MaxHeightPyramid, which makes FirstIntersection()
+   * and GroundIntersection() walk each step of the line.
+   */
+  void DisablePyramid() noexcept {
+    max_pyramid.Reset();
+  }
+
+private:
+  static void Generate(TerrainHeight *dest, std::mt19937 &rng) noexcept {
+    std::uniform_real_distribution<double> position(0, 1);
+    std::uniform_int_distribution<int> noise(-20, 20);
+    std::uniform_int_distribution<unsigned> special(0, 500);
+
+    struct Hill {
+      double x, y, radius, height;
+    } hills[8];
+
+    for (auto &h : hills)
+      h = {
+        position(rng) * SIZE.x, position(rng) * SIZE.y,
+        10 + position(rng) * 60, 200 + position(rng) * 2500,
+      };
+
+    for (unsigned y = 0; y < SIZE.y; ++y) {
+      for (unsigned x = 0; x < SIZE.x; ++x) {
+        double height = 100;
+        for (const auto &h : hills) {
+          const double d = std::hypot(x - h.x, y - h.y) / h.radius;
+          height += h.height * std::exp(-d * d);
+        }
+
+        switch (special(rng)) {
+        case 0:
+          *dest++ = TerrainHeight::Invalid();
+          break;
+
+        case 1:
+          /* water */
+          *dest++ = TerrainHeight(-30001);
+          break;
+
+        default:
+          *dest++ = TerrainHeight(int(height) + noise(rng));
+        }
+      }
+    }
+  }
+};
+
+static bool
+Equals(TerrainHeight a, TerrainHeight b) noexcept
+{
+  return a.GetValue() == b.GetValue();
+}
+
+/**
+ * Random pixel locations, mostly in clusters (like the callers of
+ * the batch methods generate them), and some outside of the map.
+ */
+static std::vector<RasterLocation>
+RandomLocations(std::mt19937 &rng, RasterLocation size,
+                unsigned n) noexcept
+{
+  std::uniform_int_distribution<unsigned> x(0, size.x + size.x / 8);
+  std::uniform_int_distribution<unsigned> y(0, size.y + size.y / 8);
+  std::uniform_int_distribution<int> delta(-3, 3);
+
+  std::vector<RasterLocation> result;
+  result.reserve(n);
+
+  RasterLocation p{0, 0};
+  for (unsigned i = 0; i < n; ++i) {
+    if (i % 16 == 0)
+      p = {x(rng), y(rng)};
+    else
+      p = {p.x + delta(rng), p.y + delta(rng)};
+
+    result.push_back(p);
+  }
+
+  return result;
+}
+
+static void
+TestHeights(const RasterTileCache &cache, std::mt19937 &rng)
+{
+  /* not a multiple of the batch size */
+  const auto p = RandomLocations(rng, SIZE, 5003);
+  std::vector<TerrainHeight> batch(p.size());
+  cache.GetHeights(p, batch.data());
+
+  bool equal = true;
+  for (std::size_t i = 0; i < p.size(); ++i)
+    equal = equal && Equals(batch[i], cache.GetHeight(p[i]));
+
+  ok1(equal);
+}
+
+static void
+TestInterpolatedHeights(const RasterTileCache &cache, std::mt19937 &rng)
+{
+  const auto p = RandomLocations(rng, cache.GetFineSize(), 5003);
+  std::vector<TerrainHeight> batch(p.size());
+  cache.GetInterpolatedHeights(p, batch.data());
+
+  bool equal = true;
+  for (std::size_t i = 0; i < p.size(); ++i)
+    equal = equal && Equals(batch[i], cache.GetInterpolatedHeight(p[i]));
+
+  ok1(equal);
+}
+
+struct IntersectionQuery {
+  SignedRasterLocation origin, destination;
+  int h_origin, h_dest, slope_fact, h_ceiling;
+  bool can_climb;
+
+  std::optional<RasterTileCache::Intersection>
+  First(const RasterTileCache &cache) const noexcept {
+    return cache.FirstIntersection(origin, destination,
+                                   h_origin, h_dest, slope_fact,
+                                   h_ceiling, 50, can_climb);
+  }
+
+  SignedRasterLocation Ground(const RasterTileCache &cache) const noexcept {
+    return cache.GroundIntersection(origin, destination,
+                                    h_origin, slope_fact, -1000);
+  }
+};
+
+static std::vector<IntersectionQuery>
+RandomQueries(std::mt19937 &rng, unsigned n) noexcept
+{
+  std::uniform_int_distribution<int> x(0, SIZE.x - 1), y(0, SIZE.y - 1);
+  std::uniform_int_distribution<int> far_x(-100, SIZE.x + 100);
+  std::uniform_int_distribution<int> far_y(-100, SIZE.y + 100);
+  std::uniform_int_distribution<int> height(0, 4000);
+  std::uniform_int_distribution<int> slope(0, 40 << RASTER_SLOPE_FACT);
+  std::uniform_int_distribution<int> coin(0, 1);
+
+  std::vector<IntersectionQuery> result;
+  result.reserve(n);
+
+  for (unsigned i = 0; i < n; ++i) {
+    IntersectionQuery q;
+    q.origin = {x(rng), y(rng)};
+    /* some destinations are outside of the map */
+    q.destination = {far_x(rng), far_y(rng)};
+    q.h_origin = height(rng);
+    q.h_dest = height(rng);
+    q.slope_fact = slope(rng);
+    q.h_ceiling = q.h_origin + height(rng);
+    q.can_climb = coin(rng);
+    result.push_back(q);
+  }
+
+  return result;
+}
+
+static bool
+Equals(const std::optional<RasterTileCache::Intersection> &a,
+       const std::optional<RasterTileCache::Intersection> &b) noexcept
+{
+  if (!a || !b)
+    return !a && !b;
+
+  return a->location == b->location && a->height == b->height;
+}
+
+/**
+ * Verify that skipping blocks with the #MaxHeightPyramid finds the
+ * same intersections as walking each step of the line.
+ */
+static void
+TestIntersections(SyntheticTileCache &cache, std::mt19937 &rng)
+{
+  const auto queries = RandomQueries(rng, 2000);
+
+  std::vector<std::optional<RasterTileCache::Intersection>> first;
+  std::vector<SignedRasterLocation> ground;
+  first.reserve(queries.size());
+  ground.reserve(queries.size());
+
+  for (const auto &q : queries) {
+    first.push_back(q.First(cache));
+    ground.push_back(q.Ground(cache));
+  }
+
+  cache.DisablePyramid();
+
+  bool first_equal = true, ground_equal = true;
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    first_equal = first_equal && Equals(first[i], queries[i].First(cache));
+    ground_equal = ground_equal && ground[i] == queries[i].Ground(cache);
+  }
+
+  ok1(first_equal);
+  ok1(ground_equal);
+}
+
+int main()
+{
+  plan_tests(4 * 4);
+
+  for (unsigned seed = 0; seed < 4; ++seed) {
+    std::mt19937 rng(seed);
+    SyntheticTileCache cache(rng);
+
+    TestHeights(cache, rng);
+    TestInterpolatedHeights(cache, rng);
+    TestIntersections(cache, rng);
+  }
+
+  return exit_status();
+}
@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Save the decoded tiles of benalla9.xcm to a tile store, map it back
+ * and compare the heights with the tiles decoded by libjasper.
+ */
+
+#include "Terrain/RasterTileCache.hpp"
+#include "Terrain/Loader.hpp"
+#include "Operation/Operation.hpp"
+#include "io/ZipArchive.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/BufferedOutputStream.hxx"
+#include "system/FileMapping.hpp"
+#include "system/FileUtil.hpp"
+#include "system/Path.hpp"
+#include "TestUtil.hpp"
+
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+static constexpr Path store_path("output/TestTerrainTileStore.bin");
+static constexpr Path broken_path("output/TestTerrainTileStore-broken.bin");
+
+/**
+ * Emulate the header of class #FileCache, which precedes the tile
+ * store in the real cache file.
+ */
+static constexpr std::size_t PREFIX_SIZE = 37;
+
+/**
+ * The distance between two reference samples (in pixels).
+ */
+static constexpr unsigned STEP = 256;
+
+static void
+LoadOverview(ZipArchive &archive, RasterTileCache &cache)
+{
+  NullOperationEnvironment env;
+  LoadTerrainOverview(archive.get(), cache, env);
+}
+
+static void
+SaveStore(ZipArchive &archive, RasterTileCache &cache)
+{
+  FileOutputStream fos(store_path);
+  BufferedOutputStream bos(fos);
+
+  static constexpr std::byte prefix[PREFIX_SIZE]{};
+  bos.Write(prefix, sizeof(prefix));
+
+  NullOperationEnvironment env;
+  SaveTerrainTileStore(archive.get(), cache, bos, sizeof(prefix), env);
+  bos.Flush();
+  fos.Commit();
+}
+
+static std::string
+ReadStore()
+{
+  const FileMapping mapping(store_path);
+  const std::span<const std::byte> data = mapping;
+  return {(const char *)data.data(), data.size()};
+}
+
+/**
+ * Write a modified copy of the tile store to #broken_path and try to
+ * map it into a freshly loaded #RasterTileCache.
+ *
+ * @return true if MapTileStore() has rejected the file
+ */
+static bool
+IsRejected(ZipArchive &archive, const std::string &data)
+{
+  {
+    FileOutputStream fos(broken_path);
+    fos.Write(data.data(), data.size());
+    fos.Commit();
+  }
+
+  RasterTileCache cache;
+  LoadOverview(archive, cache);
+
+  const FileMapping mapping(broken_path);
+
+  try {
+    cache.MapTileStore(mapping);
+    return false;
+  } catch (const std::runtime_error &) {
+  }
+
+  return !cache.HasTileStore();
+}
+
+/**
+ * Compare the heights in a grid around the given pixel location,
+ * after loading the surrounding tiles of the #reference with
+ * libjasper.
+ *
+ * @return the number of mismatches
+ */
+static unsigned
+CompareBlock(ZipArchive &archive, RasterTileCache &reference,
+             const RasterTileCache &mapped, RasterLocation center,
+             std::mt19937 &rng)
+{
+  SharedMutex mutex;
+  do {
+    UpdateTerrainTiles(archive.get(), reference, mutex,
+                       SignedRasterLocation(center), 0);
+  } while (reference.IsDirty());
+
+  const auto size = reference.GetSize();
+  std::uniform_int_distribution<unsigned> offset(0, STEP - 1);
+  std::uniform_int_distribution<unsigned> subpixel(0, 0xff);
+
+  unsigned mismatches = 0;
+  for (unsigned i = 0; i < 64; ++i) {
+    const RasterLocation p{
+      std::min(center.x - STEP / 2 + offset(rng), size.x - 1),
+      std::min(center.y - STEP / 2 + offset(rng), size.y - 1),
+    };
+
+    if (mapped.GetHeight(p).GetValue() != reference.GetHeight(p).GetValue())
+      ++mismatches;
+
+    const RasterLocation fine{
+      (p.x << RasterTraits::SUBPIXEL_BITS) + subpixel(rng),
+      (p.y << RasterTraits::SUBPIXEL_BITS) + subpixel(rng),
+    };
+
+    if (mapped.GetInterpolatedHeight(fine).GetValue() !=
+        reference.GetInterpolatedHeight(fine).GetValue())
+      ++mismatches;
+  }
+
+  return mismatches;
+}
+
+static void
+TestRoundTrip(ZipArchive &archive)
+{
+  RasterTileCache cache;
+  LoadOverview(archive, cache);
+  ok1(cache.IsValid());
+
+  SaveStore(archive, cache);
+
+  const FileMapping mapping(store_path);
+  cache.MapTileStore(mapping);
+  ok1(cache.HasTileStore());
+  ok1(!cache.IsDirty());
+
+  RasterTileCache reference;
+  LoadOverview(archive, reference);
+
+  std::mt19937 rng(42);
+  const auto size = reference.GetSize();
+  unsigned mismatches = 0, blocks = 0;
+  for (unsigned y = STEP / 2; y < size.y + STEP / 2; y += STEP) {
+    for (unsigned x = STEP / 2; x < size.x + STEP / 2; x += STEP) {
+      const RasterLocation center{
+        std::min(x, size.x - 1),
+        std::min(y, size.y - 1),
+      };
+
+      mismatches += CompareBlock(archive, reference, cache, center, rng);
+      ++blocks;
+    }
+  }
+
+  ok1(blocks > 4);
+  ok1(mismatches == 0);
+}
+
+static void
+TestRejected(ZipArchive &archive)
+{
+  using Header = RasterTileCache::TileStoreHeader;
+
+  const std::string data = ReadStore();
+
+  /* truncated within the last tile, within the offset table and
+     within the header */
+  ok1(IsRejected(archive, data.substr(0, data.size() - 1)));
+  ok1(IsRejected(archive, data.substr(0, Header::ALIGNMENT +
+                                      sizeof(Header) + 4)));
+  ok1(IsRejected(archive, data.substr(0, Header::ALIGNMENT + 2)));
+
+  /* written by an incompatible version */
+  std::string stale = data;
+  Header header;
+  memcpy(&header, stale.data() + Header::ALIGNMENT, sizeof(header));
+  ++header.version;
+  memcpy(stale.data() + Header::ALIGNMENT, &header, sizeof(header));
+  ok1(IsRejected(archive, stale));
+
+  /* written for a different map */
+  stale = data;
+  memcpy(&header, stale.data() + Header::ALIGNMENT, sizeof(header));
+  ++header.size.x;
+  memcpy(stale.data() + Header::ALIGNMENT, &header, sizeof(header));
+  ok1(IsRejected(archive, stale));
+
+  /* the offset of the first tile points beyond the end of the file */
+  stale = data;
+  memcpy(&header, stale.data() + Header::ALIGNMENT, sizeof(header));
+  const std::size_t table = Header::ALIGNMENT + sizeof(header);
+  const unsigned n_tiles = header.n_tiles.x * header.n_tiles.y;
+  const uint64_t bogus = (data.size() + Header::ALIGNMENT - 1)
+    / Header::ALIGNMENT * Header::ALIGNMENT;
+  for (unsigned i = 0; i < n_tiles; ++i) {
+    char *p = stale.data() + table + i * sizeof(uint64_t);
+    uint64_t offset;
+    memcpy(&offset, p, sizeof(offset));
+    if (offset != 0) {
+      memcpy(p, &bogus, sizeof(bogus));
+      break;
+    }
+  }
+  ok1(IsRejected(archive, stale));
+}
+
+int main()
+{
+  plan_tests(5 + 6);
+
+  ZipArchive archive(Path("test/data/benalla9.xcm"));
+
+  TestRoundTrip(archive);
+  TestRejected(archive);
+
+  File::Delete(store_path);
+  File::Delete(broken_path);
+
+  return exit_status();
+}
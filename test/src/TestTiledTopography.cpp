@@ -0,0 +1,315 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Topography/TiledTopography.hpp"
+#include "Topography/TiledTopographyWriter.hpp"
+#include "Topography/TopographyFile.hpp"
+#include "Topography/XShape.hpp"
+#include "io/ZipArchive.hpp"
+#include "io/StringOutputStream.hxx"
+#include "system/Path.hpp"
+#include "util/StringAPI.hxx"
+#include "TestUtil.hpp"
+
+#include <zzip/zzip.h>
+
+#include <cmath>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * The layers of "topology.tpl" in benalla9.xcm.
+ */
+static constexpr struct {
+  const char *name;
+  double range;
+  int label_field;
+} layers[] = {
+  { "inwaterahydro_area", 100000, -1 },
+  { "watrcrslhydro_line", 7000, -1 },
+  { "builtupapop_area", 15000, 0 },
+  { "roadltrans_line", 15000, -1 },
+  { "railrdltrans_line", 10000, -1 },
+  { "mispopppop_point", 5000, 0 },
+};
+
+static constexpr BGRA8Color color{64, 96, 240, 255};
+
+static std::span<const std::byte>
+ToSpan(const std::string &s) noexcept
+{
+  return {(const std::byte *)s.data(), s.size()};
+}
+
+static bool
+IsNear(const GeoPoint &a, const GeoPoint &b) noexcept
+{
+  /* the points are stored as float offsets to the layer center */
+  return std::fabs((a.longitude - b.longitude).Native()) < 1e-7 &&
+    std::fabs((a.latitude - b.latitude).Native()) < 1e-7;
+}
+
+static bool
+IsNear(const GeoBounds &a, const GeoBounds &b) noexcept
+{
+  return IsNear(a.GetNorthWest(), b.GetNorthWest()) &&
+    IsNear(a.GetSouthEast(), b.GetSouthEast());
+}
+
+#ifdef ENABLE_OPENGL
+static GeoPoint
+GetPoint(const TopographyFile &file, const XShape &shape, std::size_t i)
+{
+  return file.ToGeoPoint(shape.GetPoints()[i]);
+}
+#else
+static GeoPoint
+GetPoint(const TopographyFile &, const XShape &shape, std::size_t i)
+{
+  return shape.GetPoints()[i];
+}
+#endif
+
+static bool
+IsEqual(const TopographyFile &file_a, const XShape &a,
+        const TopographyFile &file_b, const XShape &b)
+{
+  if (a.get_type() != b.get_type() || !IsNear(a.get_bounds(), b.get_bounds()))
+    return false;
+
+  const auto lines = a.GetLines();
+  if (!std::equal(lines.begin(), lines.end(),
+                  b.GetLines().begin(), b.GetLines().end()))
+    return false;
+
+  if ((a.GetLabel() == nullptr) != (b.GetLabel() == nullptr) ||
+      (a.GetLabel() != nullptr && !StringIsEqual(a.GetLabel(), b.GetLabel())))
+    return false;
+
+  std::size_t num_points = 0;
+  for (const auto n : lines)
+    num_points += n;
+
+  for (std::size_t i = 0; i < num_points; ++i)
+    if (!IsNear(GetPoint(file_a, a, i), GetPoint(file_b, b, i)))
+      return false;
+
+  return true;
+}
+
+/**
+ * Compare all (non-empty) shapes of the original shapefile with the
+ * converted ones.
+ */
+static bool
+CompareShapes(const TopographyFile &original, const TopographyFile &tiled)
+{
+  std::vector<const XShape *> a, b;
+  for (const XShape &shape : original)
+    if (!shape.GetLines().empty())
+      a.push_back(&shape);
+
+  for (const XShape &shape : tiled)
+    b.push_back(&shape);
+
+  if (a.size() != b.size())
+    return false;
+
+  for (std::size_t i = 0; i < a.size(); ++i)
+    if (!IsEqual(original, *a[i], tiled, *b[i]))
+      return false;
+
+  return true;
+}
+
+/**
+ * Compare TiledTopographyLayer::VisitShapes() with a naive search.
+ */
+static bool
+TestVisitShapes(const TiledTopographyLayer &layer, const GeoBounds &bounds)
+{
+  std::set<std::size_t> expected;
+  for (std::size_t i = 0; i < layer.size(); ++i)
+    if (layer.GetShapeBounds(i).Overlaps(bounds))
+      expected.insert(i);
+
+  std::set<std::size_t> found;
+  layer.VisitShapes(bounds, [&found](std::size_t i){
+    found.insert(i);
+  });
+
+  return found == expected;
+}
+
+static bool
+TestVisitShapes(const TiledTopographyLayer &layer)
+{
+  const GeoBounds &b = layer.GetBounds();
+  const GeoPoint center = b.GetCenter();
+  const Angle width = b.GetWidth(), height = b.GetHeight();
+
+  return TestVisitShapes(layer, b) &&
+    TestVisitShapes(layer, GeoBounds(center).Scale(1)) &&
+    TestVisitShapes(layer, GeoBounds{
+        b.GetNorthWest(),
+        GeoPoint{b.GetWest() + width / 3, b.GetNorth() - height / 3},
+      }) &&
+    TestVisitShapes(layer, GeoBounds{
+        GeoPoint{center.longitude - width / 10, center.latitude + height / 10},
+        GeoPoint{center.longitude + width / 10, center.latitude - height / 10},
+      }) &&
+    TestVisitShapes(layer, GeoBounds{
+        GeoPoint{b.GetEast() - width / 20, b.GetSouth() + height / 2},
+        GeoPoint{b.GetEast() + width, b.GetSouth() - height},
+      });
+}
+
+static std::unique_ptr<TopographyFile>
+OpenShapeFile(ZipArchive &archive, const char *shape_filename,
+              double range, int label_field)
+{
+  return std::make_unique<TopographyFile>(archive.get(), shape_filename,
+                                          range, range, range, color,
+                                          label_field);
+}
+
+static void
+TestMap(const char *path)
+{
+  ZipArchive archive{Path{path}};
+
+  std::string data;
+
+  {
+    TiledTopographyWriter writer;
+
+    for (const auto &i : layers) {
+      const std::string shape_filename = std::string{i.name} + ".shp";
+      ZZIP_STAT st;
+      zzip_dir_stat(archive.get(), shape_filename.c_str(), &st, 0);
+
+      auto file = OpenShapeFile(archive, shape_filename.c_str(),
+                                i.range, i.label_field);
+      file->LoadAll();
+      writer.AddLayer(i.name, st.st_size, *file);
+    }
+
+    StringOutputStream sos;
+    writer.Write(sos);
+    data = std::move(sos).GetValue();
+  }
+
+  const TiledTopographyFile tiled_file{ToSpan(data)};
+
+  for (const auto &i : layers) {
+    const std::string shape_filename = std::string{i.name} + ".shp";
+    ZZIP_STAT st;
+    zzip_dir_stat(archive.get(), shape_filename.c_str(), &st, 0);
+
+    /* an outdated layer must not be used */
+    ok1(tiled_file.FindLayer(i.name, st.st_size + 1) == nullptr);
+
+    const auto *layer = tiled_file.FindLayer(i.name, st.st_size);
+    ok(layer != nullptr, "%s: layer found", i.name);
+    if (layer == nullptr) {
+      skip(2, 0, "layer not found");
+      continue;
+    }
+
+    auto original = OpenShapeFile(archive, shape_filename.c_str(),
+                                  i.range, i.label_field);
+    original->LoadAll();
+
+    TopographyFile tiled(*layer, i.range, i.range, i.range, color);
+    tiled.LoadAll();
+
+    ok(CompareShapes(*original, tiled), "%s: shapes", i.name);
+    ok(TestVisitShapes(*layer), "%s: tiles", i.name);
+  }
+}
+
+static bool
+IsRejected(std::string data)
+{
+  try {
+    TiledTopographyFile file{ToSpan(data)};
+    return false;
+  } catch (const std::runtime_error &) {
+    return true;
+  }
+}
+
+/**
+ * Generate a layer without shapes.
+ */
+static std::string
+MakeLayer(double west, double south, double east, double north,
+          unsigned n_x, unsigned n_y)
+{
+  TiledTopography::LayerHeader header{};
+  header.west = west;
+  header.south = south;
+  header.east = east;
+  header.north = north;
+  header.n_tiles_x = n_x;
+  header.n_tiles_y = n_y;
+
+  std::string data((const char *)&header, sizeof(header));
+  data.append((n_x * n_y + 1) * sizeof(uint32_t), '\0');
+  return data;
+}
+
+static bool
+IsLayerRejected(const std::string &data)
+{
+  try {
+    TiledTopographyLayer layer{ToSpan(data)};
+
+    /* must not divide by a zero tile size */
+    layer.VisitShapes(layer.GetBounds().Scale(2), [](std::size_t){});
+    return false;
+  } catch (const std::runtime_error &) {
+    return true;
+  }
+}
+
+static void
+TestMalformed()
+{
+  ok1(!IsLayerRejected(MakeLayer(0.1, 0.8, 0.2, 0.9, 2, 2)));
+
+  /* a single row or column may be degenerate */
+  ok1(!IsLayerRejected(MakeLayer(0.1, 0.8, 0.1, 0.9, 1, 2)));
+  ok1(!IsLayerRejected(MakeLayer(0.1, 0.8, 0.2, 0.8, 2, 1)));
+
+  /* zero tile width or height */
+  ok1(IsLayerRejected(MakeLayer(0.1, 0.8, 0.1, 0.9, 2, 2)));
+  ok1(IsLayerRejected(MakeLayer(0.1, 0.8, 0.2, 0.8, 2, 2)));
+  ok1(IsLayerRejected(MakeLayer(0.1, 0.8, 0.2, 0.8, 1, 2)));
+
+  /* no tiles at all */
+  ok1(IsLayerRejected(MakeLayer(0.1, 0.8, 0.2, 0.9, 0, 2)));
+
+  ok1(IsRejected(""));
+  ok1(IsRejected(std::string(256, '\0')));
+
+  TiledTopography::FileHeader header{};
+  header.magic = TiledTopography::MAGIC;
+  header.version = TiledTopography::VERSION;
+  header.n_layers = 1;
+  ok1(IsRejected(std::string((const char *)&header, sizeof(header))));
+}
+
+int main()
+{
+  plan_tests(std::size(layers) * 4 + 7 + 3);
+
+  TestMap("test/data/benalla9.xcm");
+  TestMalformed();
+
+  return exit_status();
+}
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "thread/TripleBuffer.hpp"
+#include "TestUtil.hpp"
+
+#include <thread>
+
+static void
+TestSequential()
+{
+  TripleBuffer<unsigned> buffer(0);
+  ok1(!buffer.Acquire());
+  ok1(buffer.GetFront() == 0);
+
+  buffer.GetBack() = 1;
+  buffer.Publish();
+  ok1(buffer.GetFront() == 0);
+  ok1(buffer.Acquire());
+  ok1(buffer.GetFront() == 1);
+  ok1(!buffer.Acquire());
+  ok1(buffer.GetFront() == 1);
+
+  /* only the latest value is acquired */
+  buffer.GetBack() = 2;
+  buffer.Publish();
+  buffer.GetBack() = 3;
+  buffer.Publish();
+  ok1(buffer.Acquire());
+  ok1(buffer.GetFront() == 3);
+  ok1(!buffer.Acquire());
+
+  /* the consumer may modify its buffer without affecting the
+     producer */
+  buffer.GetFront() = 42;
+  buffer.GetBack() = 4;
+  buffer.Publish();
+  ok1(buffer.Acquire());
+  ok1(buffer.GetFront() == 4);
+}
+
+/**
+ * A value which is inconsistent if it was torn by a concurrent
+ * write.
+ */
+struct Sample {
+  unsigned values[64];
+
+  bool IsConsistent() const noexcept {
+    for (unsigned i = 1; i < std::size(values); ++i)
+      if (values[i] != values[0] + i)
+        return false;
+    return true;
+  }
+};
+
+static void
+TestConcurrent()
+{
+  constexpr unsigned N = 200000;
+
+  Sample initial;
+  for (unsigned i = 0; i < std::size(initial.values); ++i)
+    initial.values[i] = i;
+
+  TripleBuffer<Sample> buffer(initial);
+
+  std::thread producer([&buffer]{
+    for (unsigned n = 1; n <= N; ++n) {
+      Sample &sample = buffer.GetBack();
+      for (unsigned i = 0; i < std::size(sample.values); ++i)
+        sample.values[i] = n + i;
+      buffer.Publish();
+    }
+  });
+
+  bool consistent = true, monotonic = true;
+  unsigned last = 0;
+  while (last < N) {
+    if (!buffer.Acquire()) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    const Sample &sample = buffer.GetFront();
+    if (!sample.IsConsistent())
+      consistent = false;
+    if (sample.values[0] <= last)
+      monotonic = false;
+    last = sample.values[0];
+  }
+
+  producer.join();
+
+  ok1(consistent);
+  ok1(monotonic);
+  ok1(last == N);
+}
+
+int main()
+{
+  plan_tests(12 + 3);
+
+  TestSequential();
+  TestConcurrent();
+
+  return exit_status();
+}
@@ -0,0 +1,204 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Computer/WaypointArrivalCache.hpp"
+#include "Computer/Settings.hpp"
+#include "Task/ProtectedRoutePlanner.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Waypoint/Waypoints.hpp"
+#include "Geo/GeoVector.hpp"
+#include "NMEA/MoreData.hpp"
+#include "NMEA/Derived.hpp"
+#include "TestUtil.hpp"
+
+static const GeoPoint origin(Angle::Degrees(7.7), Angle::Degrees(51.05));
+
+/**
+ * Everything WaypointArrivalCache::Update() needs, without terrain
+ * (so all arrivals are straight glides).
+ */
+struct Fixture {
+  Waypoints waypoints;
+
+  RoutePlannerGlue glue;
+  Airspaces airspaces;
+  ProtectedRoutePlanner route_planner{glue, airspaces, nullptr};
+
+  MoreData basic;
+  DerivedInfo calculated;
+  ComputerSettings settings;
+
+  WaypointArrivalCache cache;
+
+  unsigned airfield_id, turnpoint_id, watched_id, far_id;
+
+  Fixture() noexcept {
+    airfield_id = Add(GeoVector(5000, Angle::Degrees(30)),
+                      Waypoint::Type::AIRFIELD);
+    turnpoint_id = Add(GeoVector(8000, Angle::Degrees(120)),
+                       Waypoint::Type::NORMAL);
+    watched_id = Add(GeoVector(12000, Angle::Degrees(200)),
+                     Waypoint::Type::NORMAL, true);
+    /* beyond the range of the table */
+    far_id = Add(GeoVector(400000, Angle::Degrees(300)),
+                 Waypoint::Type::AIRFIELD);
+    waypoints.Optimise();
+
+    basic.Reset();
+    basic.clock = TimeStamp{FloatDuration{1000}};
+    basic.location = origin;
+    basic.location_available.Update(basic.clock);
+    basic.gps_altitude = basic.nav_altitude = 1000;
+    basic.gps_altitude_available.Update(basic.clock);
+
+    calculated.Reset();
+    calculated.glide_polar_safety = GlidePolar(0);
+
+    settings.SetDefaults();
+    settings.polar.glide_polar_task = GlidePolar(0);
+  }
+
+  unsigned Add(GeoVector vector, Waypoint::Type type,
+               bool watched=false) noexcept {
+    Waypoint wp = waypoints.Create(vector.EndPoint(origin));
+    wp.elevation = 100;
+    wp.type = type;
+    if (watched)
+      wp.origin = WaypointOrigin::WATCHED;
+    return waypoints.Append(std::move(wp))->id;
+  }
+
+  void Update() noexcept {
+    cache.Update(waypoints, basic, calculated, settings, route_planner);
+  }
+
+  void Move(double distance) noexcept {
+    basic.location = GeoVector(distance, Angle::Degrees(90))
+      .EndPoint(basic.location);
+  }
+
+  /**
+   * Call Update() and check whether it has calculated a new table.
+   */
+  bool Recalculated() noexcept {
+    const auto old_table = cache.Get();
+    Update();
+    return cache.Get() != old_table;
+  }
+};
+
+static void
+TestFind()
+{
+  Fixture f;
+  ok1(f.cache.Get() == nullptr);
+
+  f.Update();
+  const auto table = f.cache.Get();
+  ok1(table != nullptr);
+  if (table == nullptr)
+    return;
+
+  ok1(table->waypoints_serial == f.waypoints.GetSerial());
+
+  const WaypointArrivalCalculator calculator(f.basic, f.calculated,
+                                             f.settings.polar,
+                                             f.settings.task,
+                                             &f.route_planner);
+
+  const WaypointArrival *arrival = table->Find(f.airfield_id);
+  const WaypointArrival expected =
+    calculator.Calculate(*f.waypoints.LookupId(f.airfield_id));
+  ok1(arrival != nullptr);
+  ok1(arrival != nullptr &&
+      arrival->method == WaypointArrival::Method::STRAIGHT &&
+      arrival->method == expected.method &&
+      arrival->reach.direct == expected.reach.direct);
+
+  /* watched waypoints are included, other non-landable ones are
+     not */
+  ok1(table->Find(f.watched_id) != nullptr);
+  ok1(table->Find(f.turnpoint_id) == nullptr);
+
+  ok1(table->Find(f.far_id) == nullptr);
+  ok1(table->Find(f.far_id + 1000) == nullptr);
+
+  /* without a position, the table is discarded */
+  f.basic.location_available.Clear();
+  f.Update();
+  ok1(f.cache.Get() == nullptr);
+}
+
+static void
+TestThresholds()
+{
+  Fixture f;
+  f.Update();
+
+  /* small changes don't trigger a recalculation */
+  f.Move(50);
+  ok1(!f.Recalculated());
+  f.basic.nav_altitude += 3;
+  ok1(!f.Recalculated());
+  f.calculated.wind = SpeedVector(Angle::Degrees(270), 0.5);
+  f.calculated.wind_available.Update(f.basic.clock);
+  ok1(!f.Recalculated());
+
+  /* the thresholds are measured from the last calculation, not from
+     the last call */
+  f.Move(60);
+  ok1(f.Recalculated());
+
+  f.basic.nav_altitude += 10;
+  ok1(f.Recalculated());
+
+  f.calculated.wind = SpeedVector(Angle::Degrees(270), 5);
+  ok1(f.Recalculated());
+
+  /* any change of the polar or the settings does */
+  f.calculated.glide_polar_safety.SetMC(1);
+  ok1(f.Recalculated());
+
+  f.settings.task.safety_height_arrival += 50;
+  ok1(f.Recalculated());
+
+  f.settings.task.glide.predict_wind_drift =
+    !f.settings.task.glide.predict_wind_drift;
+  ok1(f.Recalculated());
+
+  ok1(!f.Recalculated());
+}
+
+static void
+TestWaypointSerial()
+{
+  Fixture f;
+  f.Update();
+  const auto old_table = f.cache.Get();
+
+  const unsigned new_id = f.Add(GeoVector(3000, Angle::Degrees(0)),
+                                Waypoint::Type::OUTLANDING);
+  f.waypoints.Optimise();
+
+  /* the renderer must not use the old table anymore */
+  ok1(old_table->waypoints_serial != f.waypoints.GetSerial());
+  ok1(old_table->Find(new_id) == nullptr);
+
+  /* it is recalculated even though the aircraft hasn't moved */
+  f.Update();
+  const auto table = f.cache.Get();
+  ok1(table != old_table);
+  ok1(table->waypoints_serial == f.waypoints.GetSerial());
+  ok1(table->Find(new_id) != nullptr);
+}
+
+int main()
+{
+  plan_tests(10 + 10 + 5);
+
+  TestFind();
+  TestThresholds();
+  TestWaypointSerial();
+
+  return exit_status();
+}
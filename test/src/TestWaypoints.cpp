@@ -6,6 +6,7 @@
 #include "test_debug.hpp"
 
 #include <functional>
+#include <span>
 
 #include <stdio.h>
 #include <tchar.h>
@@ -217,6 +218,45 @@ TestGetNearest(const Waypoints &waypoints, const GeoPoint &center)
   ok1(waypoint->original_id == 6);
 }
 
+static bool
+TestGetNearestN(const Waypoints &waypoints, const GeoPoint &location,
+                double range, std::size_t n, unsigned first_id,
+                std::size_t expected_results,
+                bool (*predicate)(const Waypoint &))
+{
+  WaypointPtr buffer[200];
+  const auto found = waypoints.GetNearestIf(location, range,
+                                            std::span{buffer}.first(n),
+                                            predicate);
+  if (found != expected_results)
+    return false;
+
+  /* the spiral waypoints are ordered by distance from the center */
+  for (std::size_t i = 0; i < found; ++i)
+    if (buffer[i]->original_id != first_id + i)
+      return false;
+
+  return true;
+}
+
+static bool
+AlwaysTrue(const Waypoint &) {
+  return true;
+}
+
+static void
+TestGetNearestN(const Waypoints &waypoints, const GeoPoint &center)
+{
+  ok1(TestGetNearestN(waypoints, center, 10000, 0, 0, 0, AlwaysTrue));
+  ok1(TestGetNearestN(waypoints, center, 10000, 1, 0, 1, AlwaysTrue));
+  ok1(TestGetNearestN(waypoints, center, 10000, 5, 0, 5, AlwaysTrue));
+  ok1(TestGetNearestN(waypoints, center, 10500, 20, 0, 11, AlwaysTrue));
+  ok1(TestGetNearestN(waypoints, center, 1000000, 100, 0, 100, AlwaysTrue));
+  ok1(TestGetNearestN(waypoints, center, 1000000, 200, 0, 151, AlwaysTrue));
+  ok1(TestGetNearestN(waypoints, center, 10000, 3, 6, 3, OriginalIDAbove5));
+  ok1(TestGetNearestN(waypoints, center, 1, 3, 6, 0, OriginalIDAbove5));
+}
+
 static void
 TestIterator(const Waypoints &waypoints)
 {
@@ -284,7 +324,7 @@ main(int argc, char** argv)
   if (!ParseArgs(argc, argv))
     return 0;
 
-  plan_tests(52);
+  plan_tests(60);
 
   Waypoints waypoints;
   GeoPoint center(Angle::Degrees(51.4), Angle::Degrees(7.85));
@@ -300,6 +340,7 @@ main(int argc, char** argv)
   TestNamePrefixVisitor(waypoints);
   TestRangeVisitor(waypoints, center);
   TestGetNearest(waypoints, center);
+  TestGetNearestN(waypoints, center);
   TestIterator(waypoints);
 
   ok(TestCopy(waypoints), "waypoint copy", 0);
@@ -18,11 +18,114 @@
 #include "Operation/Operation.hpp"
 #include "system/FileUtil.hpp"
 #include "util/PrintException.hxx"
+#include "thread/WorkerPool.hpp"
 
 #include <zzip/zzip.h>
 
 #include <string.h>
 
+/**
+ * Count the sample points around the origin where the two solutions
+ * disagree on reachability or arrival height.
+ */
+static unsigned
+CountDifferences(const RasterMap &map, const TerrainRoute &route,
+                 const ReachFan &a, const ReachFan &b,
+                 const GeoPoint origin, unsigned n, int tolerance)
+{
+  unsigned differences = 0;
+  for (unsigned i = 0; i < n; ++i) {
+    for (unsigned j = 0; j < n; ++j) {
+      double fx = (double)i / (n - 1) * 2 - 1;
+      double fy = (double)j / (n - 1) * 2 - 1;
+      GeoPoint x(origin.longitude + Angle::Degrees(0.3 * fx),
+                 origin.latitude + Angle::Degrees(0.3 * fy));
+      AGeoPoint adest(x, map.GetInterpolatedHeight(x).GetValueOr0());
+
+      const auto ra = a.FindPositiveArrival(adest, route.GetReachPolar());
+      const auto rb = b.FindPositiveArrival(adest, route.GetReachPolar());
+      if (ra->terrain_valid != rb->terrain_valid ||
+          (ra->IsReachableTerrain() &&
+           std::abs(ra->terrain - rb->terrain) > tolerance))
+        ++differences;
+    }
+  }
+
+  return differences;
+}
+
+/**
+ * Move the origin in small steps and compare ReachFan::Update() with
+ * a full ReachFan::Solve().
+ */
+static void
+test_reach_update(const RasterMap &map, TerrainRoute &route,
+                  RoutePlannerConfig config, AGeoPoint origin)
+{
+  constexpr unsigned N = 40;
+
+  /* this is where incremental updates make a difference */
+  config.reach_calc_mode = RoutePlannerConfig::ReachMode::TURNING;
+
+  ReachFan incremental;
+  route.UpdateReach(incremental, origin, config, INT_MAX, true, false);
+
+  for (unsigned step = 0; step < 5; ++step) {
+    origin.longitude += Angle::Degrees(0.001);
+    origin.latitude += Angle::Degrees(0.0005);
+    origin.altitude -= 2;
+
+    route.UpdateReach(incremental, origin, config, INT_MAX, true, false);
+    const auto full = route.SolveReach(origin, config, INT_MAX, true, false);
+
+    const unsigned differences =
+      CountDifferences(map, route, incremental, full, origin, N, 50);
+    printf("# step %u: %u of %u samples differ\n", step, differences, N * N);
+    ok1(differences <= N * N / 20);
+  }
+
+  /* a big move falls back to a full solve */
+  origin.longitude += Angle::Degrees(0.1);
+  route.UpdateReach(incremental, origin, config, INT_MAX, true, false);
+  const auto full = route.SolveReach(origin, config, INT_MAX, true, false);
+  ok1(CountDifferences(map, route, incremental, full, origin, N, 0) == 0);
+}
+
+/**
+ * Solve with a #ReachForEach and compare with the serial solution;
+ * the result must be identical regardless of the order in which the
+ * rays and gaps are solved.
+ */
+static void
+test_reach_parallel(const RasterMap &map, TerrainRoute &route,
+                    RoutePlannerConfig config, const AGeoPoint origin)
+{
+  constexpr unsigned N = 40;
+
+  /* produce many gaps to be solved concurrently */
+  config.reach_calc_mode = RoutePlannerConfig::ReachMode::TURNING;
+
+  const auto serial = route.SolveReach(origin, config, INT_MAX, true, false);
+
+  const ReachForEach reverse = [](unsigned n, const auto &f){
+    for (unsigned i = n; i-- > 0;)
+      f(i);
+  };
+
+  ReachFan reversed;
+  route.UpdateReach(reversed, origin, config, INT_MAX, true, false, &reverse);
+  ok1(CountDifferences(map, route, reversed, serial, origin, N, 0) == 0);
+
+  WorkerPool pool(3);
+  const ReachForEach threads = [&pool](unsigned n, const auto &f){
+    pool.ForEach(n, [&f](unsigned i){ f(i); });
+  };
+
+  ReachFan parallel;
+  route.UpdateReach(parallel, origin, config, INT_MAX, true, false, &threads);
+  ok1(CountDifferences(map, route, parallel, serial, origin, N, 0) == 0);
+}
+
 static void
 test_reach(const RasterMap &map, double mwind, double mc, double height_min_working)
 {
@@ -80,6 +183,9 @@ test_reach(const RasterMap &map, double mwind, double mc, double height_min_work
     fout << "\n";
   }
 
+  test_reach_update(map, route, config, aorigin);
+  test_reach_parallel(map, route, config, aorigin);
+
   //  double pd = map.PixelDistance(origin, 1);
   //  printf("# pixel size %g\n", (double)pd);
 }
@@ -118,7 +224,7 @@ try {
   } while (map.IsDirty());
   zzip_dir_close(dir);
 
-  plan_tests(6);
+  plan_tests(4 * 8);
   test_reach(map, 0, 0.1, 0);
   test_reach(map, 0, 0.1, 750);
   test_reach(map, 0, 0.1, 500);
@@ -3,6 +3,7 @@
 #include "Computer/TraceComputer.hpp"
 #include "Computer/FlyingComputer.hpp"
 #include "Engine/Contest/ContestManager.hpp"
+#include "thread/WorkerPool.hpp"
 #include "Computer/Settings.hpp"
 #include "system/ConvertPathName.hpp"
 #include "system/FileUtil.hpp"
@@ -12,6 +13,7 @@
 #include "test_debug.hpp"
 #include "util/PrintException.hxx"
 
+#include <ctime>
 #include <fstream>
 
 extern "C" {
@@ -110,9 +112,18 @@ protected:
   virtual void OnReset() {}
 };
 
-static bool
-test_replay(const Contest olc_type,
-            const ContestResult &official_score)
+/**
+ * Replay the flight through a #ContestManager, calling UpdateIdle()
+ * after each fix, and then solve exhaustively.
+ *
+ * @param cpu_per_fix receives the CPU time spent in UpdateIdle() per
+ * fix [us]
+ * @param for_each if not nullptr, then it is passed to
+ * ContestManager::SolveExhaustive()
+ */
+static ContestStatistics
+replay(const Contest olc_type, bool incremental, double &cpu_per_fix,
+       const ContestForEach *for_each=nullptr)
 {
   Directory::Create(Path(_T("output/results")));
   std::ofstream f("output/results/res-sample.txt");
@@ -168,11 +179,16 @@ test_replay(const Contest olc_type,
                                  trace_computer.GetFull(),
                                  trace_computer.GetSprint());
   contest_manager.SetHandicap(settings_computer.contest.handicap);
+  contest_manager.SetIncremental(incremental);
+
+  std::clock_t cpu = 0;
+  unsigned n_fixes = 0;
 
   DerivedInfo calculated;
 
   while (sim.Update(basic)) {
     n_samples++;
+    n_fixes++;
 
     flying_computer.Compute(glide_polar.GetVTakeoff(),
 			    basic, calculated,
@@ -182,8 +198,10 @@ test_replay(const Contest olc_type,
     
     trace_computer.Update(settings_computer, basic, calculated);
     
+    const std::clock_t start = std::clock();
     contest_manager.UpdateIdle();
-  
+    cpu += std::clock() - start;
+
     if (verbose>1) {
       sim.print(f, basic);
       f.flush();
@@ -194,15 +212,103 @@ test_replay(const Contest olc_type,
     do_print = (++print_counter % output_skip ==0) && verbose;
   };
 
-  contest_manager.SolveExhaustive();
+  if (for_each != nullptr)
+    contest_manager.SolveExhaustive(*for_each);
+  else
+    contest_manager.SolveExhaustive();
 
   if (verbose) {
     PrintDistanceCounts();
   }
-  return compare_scores(official_score, 
-                        contest_manager.GetStats().GetResult(0));
+
+  cpu_per_fix = n_fixes > 0
+    ? 1e6 * cpu / CLOCKS_PER_SEC / n_fixes
+    : 0;
+
+  return contest_manager.GetStats();
 }
 
+static bool
+test_replay(const Contest olc_type,
+            const ContestResult &official_score)
+{
+  double cpu_per_fix;
+  return compare_scores(official_score,
+                        replay(olc_type, false, cpu_per_fix).GetResult(0));
+}
+
+/**
+ * Compare the incremental solver (which carries its state over when
+ * the trace gets thinned) with the non-incremental one.
+ *
+ * The incremental mode is an approximation: it considers only the
+ * newest points as finish candidates, and after thinning, it
+ * continues from paths whose removed points were replaced with their
+ * predecessors.  Its result may therefore differ slightly (in either
+ * direction) from the full solve; this test prints the difference and
+ * allows 0.1% of the score.
+ */
+static bool
+test_incremental(const Contest olc_type, const char *name)
+{
+  double full_cpu, incremental_cpu;
+  const auto full = replay(olc_type, false, full_cpu).GetResult(0);
+  const auto incremental =
+    replay(olc_type, true, incremental_cpu).GetResult(0);
+
+  std::cout << "# " << name << " CPU time per fix: full=" << full_cpu
+            << "us incremental=" << incremental_cpu << "us ("
+            << (full_cpu > 0 ? incremental_cpu / full_cpu : 0)
+            << "x)\n";
+
+  std::cout << "# " << name << " incremental-full: score="
+            << incremental.score - full.score
+            << " distance=" << incremental.distance - full.distance
+            << "m time=" << (incremental.time - full.time).count()
+            << "s\n";
+
+  if (verbose) {
+    output_score("#  Full:", full);
+    output_score("#  Incremental:", incremental);
+  }
+
+  return fabs(incremental.score - full.score) <= 0.001 * full.score;
+}
+
+/**
+ * Verify that running the independent solvers of a contest
+ * concurrently (like ContestComputer::SolveExhaustive() does) finds
+ * exactly the same results as running them one after another.
+ */
+static bool
+test_parallel(const Contest olc_type)
+{
+  double serial_cpu, parallel_cpu;
+  const auto serial = replay(olc_type, false, serial_cpu);
+
+  /* one worker thread plus the calling thread, even on a single
+     core machine */
+  WorkerPool pool(1);
+  const ContestForEach for_each = [&pool](unsigned n, const auto &f){
+    pool.ForEach(n, [&f](unsigned i){ f(i); });
+  };
+
+  const auto parallel = replay(olc_type, false, parallel_cpu, &for_each);
+
+  for (unsigned i = 0; i < ContestStatistics::N; ++i) {
+    const auto &a = serial.result[i], &b = parallel.result[i];
+    if (verbose) {
+      output_score("#  Serial:", a);
+      output_score("#  Parallel:", b);
+    }
+
+    if (a.score != b.score || a.distance != b.distance ||
+        a.time != b.time)
+      return false;
+  }
+
+  return true;
+}
 
 int main(int argc, char** argv) 
 try {
@@ -210,7 +316,7 @@ try {
     return 0;
   }
 
-  plan_tests(5);
+  plan_tests(9);
 
   ok(test_replay(Contest::OLC_LEAGUE, official_score_sprint),
      "replay league", 0);
@@ -223,6 +329,13 @@ try {
   ok(test_replay(Contest::OLC_PLUS, official_score_plus),
      "replay plus", 0);
 
+  ok(test_incremental(Contest::OLC_CLASSIC, "classic"),
+     "incremental classic", 0);
+  ok(test_incremental(Contest::DMST, "dmst"), "incremental dmst", 0);
+
+  ok(test_parallel(Contest::OLC_PLUS), "parallel plus", 0);
+  ok(test_parallel(Contest::XCONTEST), "parallel xcontest", 0);
+
   return exit_status();
 } catch (const std::runtime_error &e) {
   PrintException(e);
@@ -28,6 +28,7 @@ test_troute(const RasterMap &map, double mwind, double mc, int ceiling)
   GlideSettings settings;
   settings.SetDefaults();
   RoutePlannerConfig config;
+  config.SetDefaults();
   config.mode = RoutePlannerConfig::Mode::BOTH;
 
   GlidePolar polar(mc);